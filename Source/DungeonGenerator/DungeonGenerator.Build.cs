@@ -39,6 +39,9 @@ public class DungeonGenerator : ModuleRules
 				"SlateCore",
 				"UMG",
 				"Foliage",
+				"MeshDescription",
+				"StaticMeshDescription",
+				"PhysicsCore",
 			}
 		);
 		if (Target.bBuildEditor)
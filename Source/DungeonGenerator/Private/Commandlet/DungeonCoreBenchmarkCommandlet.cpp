@@ -0,0 +1,648 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Commandlet/DungeonCoreBenchmarkCommandlet.h"
+#include "Core/Generator.h"
+#include "Core/GenerateParameter.h"
+#include "Core/Debug/Debug.h"
+#include "Core/Helper/Crc.h"
+#include "Core/Math/PerlinNoise.h"
+#include "Core/Math/Point.h"
+#include "Core/Math/Random.h"
+#include "Core/PathGeneration/DelaunayTriangulation3D.h"
+#include "Core/PathGeneration/MinimumSpanningTree.h"
+#include "Core/PathGeneration/PathFinder.h"
+#include "Core/RoomGeneration/Room.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+
+#include <HAL/MemoryBase.h>
+#include <HAL/PlatformTime.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+#include <algorithm>
+#include <tuple>
+#include <memory>
+#include <vector>
+
+namespace
+{
+	// 計測中のスレッドだけが数えるメモリ確保の回数とバイト数
+	thread_local bool IsCountingAllocations = false;
+	thread_local uint64 CountedAllocationCount = 0;
+	thread_local uint64 CountedAllocationBytes = 0;
+
+	/**
+	 * Counts allocations made on threads that enabled counting and forwards everything to the original allocator.
+	 * It is installed into GMalloc once and never removed, so memory allocated before the installation is freed by
+	 * the same allocator, and worker threads never see a released wrapper.
+	 *
+	 * 数える事を有効にしたスレッドのメモリ確保を数えて、全ての処理を元のアロケーターに転送します。
+	 * GMallocには一度だけ組み込み、取り外さないので、組み込む前に確保したメモリも同じアロケーターで解放され、
+	 * ワーカースレッドが解放済みのラッパーを参照する事もありません。
+	 */
+	class FDungeonAllocationCounter final : public FMalloc
+	{
+	public:
+		/**
+		 * Installs the counter into GMalloc on the first call
+		 * 最初の呼び出しでGMallocにカウンターを組み込みます
+		 */
+		static void Install()
+		{
+			// 意図的に解放しません（終了処理中もGMallocから参照されるため）
+			static FDungeonAllocationCounter* counter = [] {
+				auto* result = new FDungeonAllocationCounter(GMalloc);
+				GMalloc = result;
+				return result;
+			}();
+			(void)counter;
+		}
+
+		virtual void* Malloc(SIZE_T count, uint32 alignment) override
+		{
+			Count(count);
+			return mInner->Malloc(count, alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T count, uint32 alignment) override
+		{
+			Count(count);
+			return mInner->TryMalloc(count, alignment);
+		}
+
+		virtual void* Realloc(void* original, SIZE_T count, uint32 alignment) override
+		{
+			Count(count);
+			return mInner->Realloc(original, count, alignment);
+		}
+
+		virtual void* TryRealloc(void* original, SIZE_T count, uint32 alignment) override
+		{
+			Count(count);
+			return mInner->TryRealloc(original, count, alignment);
+		}
+
+		virtual void Free(void* original) override { mInner->Free(original); }
+		virtual SIZE_T QuantizeSize(SIZE_T count, uint32 alignment) override { return mInner->QuantizeSize(count, alignment); }
+		virtual bool GetAllocationSize(void* original, SIZE_T& sizeOut) override { return mInner->GetAllocationSize(original, sizeOut); }
+		virtual void Trim(bool trimThreadCaches) override { mInner->Trim(trimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { mInner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { mInner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void UpdateStats() override { mInner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& outStats) override { mInner->GetAllocatorStats(outStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& ar) override { mInner->DumpAllocatorStats(ar); }
+		virtual bool IsInternallyThreadSafe() const override { return mInner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return mInner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return mInner->GetDescriptiveName(); }
+
+	private:
+		explicit FDungeonAllocationCounter(FMalloc* inner)
+			: mInner(inner)
+		{
+		}
+
+		static void Count(const SIZE_T count)
+		{
+			if (IsCountingAllocations)
+			{
+				++CountedAllocationCount;
+				CountedAllocationBytes += count;
+			}
+		}
+
+		FMalloc* mInner;
+	};
+
+	/**
+	 * Counts the allocations of the current thread while in scope
+	 * スコープ内で現在のスレッドのメモリ確保を数えます
+	 */
+	class FScopedAllocationCounting final
+	{
+	public:
+		FScopedAllocationCounting()
+		{
+			CountedAllocationCount = 0;
+			CountedAllocationBytes = 0;
+			IsCountingAllocations = true;
+		}
+
+		~FScopedAllocationCounting()
+		{
+			IsCountingAllocations = false;
+		}
+
+		uint64 GetAllocationCount() const { return CountedAllocationCount; }
+		uint64 GetAllocationBytes() const { return CountedAllocationBytes; }
+	};
+
+	struct FBenchmarkResult final
+	{
+		FString Name;
+		int32 Iterations = 0;
+		double NanosecondsPerOperation = 0.0;
+		double AllocationsPerOperation = 0.0;
+		double BytesPerOperation = 0.0;
+	};
+
+	class FBenchmarkRunner final
+	{
+	public:
+		explicit FBenchmarkRunner(const FString& filter)
+			: mFilter(filter)
+		{
+		}
+
+		/**
+		 * Measure the function. setup is called before each operation and excluded from the measurement.
+		 * 関数を計測します。setupは各操作の前に呼ばれ、計測から除外されます
+		 */
+		template<typename Setup, typename Function>
+		void Run(const FString& name, const int32 iterations, Setup&& setup, Function&& function)
+		{
+			if (!mFilter.IsEmpty() && !name.Contains(mFilter))
+				return;
+
+			// warm up
+			setup();
+			function();
+
+			double seconds = 0.0;
+			uint64 allocationCount = 0;
+			uint64 allocationBytes = 0;
+			for (int32 i = 0; i < iterations; ++i)
+			{
+				setup();
+				FScopedAllocationCounting allocationCounting;
+				const double start = FPlatformTime::Seconds();
+				function();
+				seconds += FPlatformTime::Seconds() - start;
+				allocationCount += allocationCounting.GetAllocationCount();
+				allocationBytes += allocationCounting.GetAllocationBytes();
+			}
+
+			FBenchmarkResult& result = mResults.AddDefaulted_GetRef();
+			result.Name = name;
+			result.Iterations = iterations;
+			result.NanosecondsPerOperation = seconds * 1e9 / iterations;
+			result.AllocationsPerOperation = static_cast<double>(allocationCount) / iterations;
+			result.BytesPerOperation = static_cast<double>(allocationBytes) / iterations;
+			DUNGEON_GENERATOR_DISPLAY(TEXT("%-48s %12.1f ns/op %10.2f allocs/op %12.1f bytes/op (%d ops)"),
+				*result.Name, result.NanosecondsPerOperation, result.AllocationsPerOperation, result.BytesPerOperation, result.Iterations);
+		}
+
+		/**
+		 * Measure a cheap operation in batches of batchSize
+		 * 軽い操作をbatchSize回まとめて計測します
+		 */
+		template<typename Function>
+		void RunBatched(const FString& name, const int32 iterations, const int32 batchSize, Function&& function)
+		{
+			const int32 count = mResults.Num();
+			Run(name, iterations, [] {}, [&function, batchSize]
+				{
+					for (int32 i = 0; i < batchSize; ++i)
+						function();
+				}
+			);
+			if (mResults.Num() > count)
+			{
+				FBenchmarkResult& result = mResults.Last();
+				result.Iterations *= batchSize;
+				result.NanosecondsPerOperation /= batchSize;
+				result.AllocationsPerOperation /= batchSize;
+				result.BytesPerOperation /= batchSize;
+			}
+		}
+
+		const TArray<FBenchmarkResult>& GetResults() const { return mResults; }
+
+	private:
+		FString mFilter;
+		TArray<FBenchmarkResult> mResults;
+	};
+
+	// 最適化で計算が消されないようにするための出力先
+	volatile uint64 BenchmarkSink = 0;
+
+	constexpr uint32_t BenchmarkSeed = 0x5eed1234;
+
+	std::shared_ptr<dungeon::Voxel> MakeBenchmarkVoxel(const uint32_t width, const uint32_t depth, const uint32_t height)
+	{
+		dungeon::GenerateParameter parameter;
+		parameter.SetWidth(width);
+		parameter.SetDepth(depth);
+		parameter.SetHeight(height);
+		auto voxel = std::make_shared<dungeon::Voxel>(parameter);
+
+		// 部屋と通路が混在する状態を作る
+		const auto random = std::make_shared<dungeon::Random>(BenchmarkSeed);
+		for (int32 i = 0; i < 32; ++i)
+		{
+			const FIntVector min(random->Get<uint32_t>(width - 8), random->Get<uint32_t>(depth - 8), random->Get<uint32_t>(std::max(1u, height - 2)));
+			const FIntVector max = min + FIntVector(random->Get<uint32_t>(2, 8), random->Get<uint32_t>(2, 8), 2);
+			voxel->Rectangle(min, max, dungeon::Grid::CreateDeck(random, static_cast<uint16_t>(i + 1), 0), dungeon::Grid::CreateFloor(random, static_cast<uint16_t>(i + 1), 0));
+		}
+		return voxel;
+	}
+
+	std::vector<std::shared_ptr<const dungeon::Point>> MakeBenchmarkPoints(const size_t count, const bool withRooms)
+	{
+		const auto random = std::make_shared<dungeon::Random>(BenchmarkSeed);
+		std::vector<std::shared_ptr<const dungeon::Point>> points;
+		points.reserve(count);
+		for (size_t i = 0; i < count; ++i)
+		{
+			const FIntVector location(random->Get<int32_t>(0, 1000), random->Get<int32_t>(0, 1000), random->Get<int32_t>(0, 100));
+			if (withRooms)
+			{
+				const auto room = std::make_shared<dungeon::Room>(location, FIntVector(4, 4, 2));
+				points.emplace_back(std::make_shared<dungeon::Point>(room));
+			}
+			else
+			{
+				points.emplace_back(std::make_shared<dungeon::Point>(location.X, location.Y, location.Z));
+			}
+		}
+		return points;
+	}
+
+	/**
+	 * A* over an open square plane, exercising PathFinder's open, pop and commit
+	 * 障害物の無い正方形の平面をA*で検索し、PathFinderのOpen、Pop、Commitを計測します
+	 */
+	void RunPathFinder(const int32 size)
+	{
+		const FIntVector start(0, 0, 0);
+		const FIntVector goal(size - 1, size - 1, 0);
+
+		dungeon::PathFinder pathFinder;
+		pathFinder.Start(start, goal, dungeon::PathFinder::SearchDirection::Any);
+
+		uint64_t key;
+		dungeon::PathFinder::NodeType nodeType;
+		uint32_t cost;
+		FIntVector location;
+		dungeon::Direction direction;
+		dungeon::PathFinder::SearchDirection searchDirection;
+		while (pathFinder.Pop(key, nodeType, cost, location, direction, searchDirection))
+		{
+			if (location == goal)
+				break;
+
+			for (uint8_t i = 0; i < 4; ++i)
+			{
+				const auto index = static_cast<dungeon::Direction::Index>(i);
+				const FIntVector next = location + dungeon::Direction::GetVector(index);
+				if (next.X < 0 || next.Y < 0 || next.X >= size || next.Y >= size)
+					continue;
+				pathFinder.Open(key, dungeon::PathFinder::NodeType::Aisle, cost + 1, next, goal, dungeon::Direction(index), dungeon::PathFinder::SearchDirection::Any);
+			}
+		}
+		pathFinder.Commit(location);
+		BenchmarkSink = BenchmarkSink + pathFinder.CloseSize();
+	}
+
+	/**
+	 * Generate a dungeon with a fixed parameter
+	 * 固定のパラメータでダンジョンを生成します
+	 */
+	std::shared_ptr<const dungeon::Generator> GenerateBenchmarkDungeon(const uint32_t seed)
+	{
+		dungeon::GenerateParameter parameter;
+		parameter.GetRandom()->SetSeed(seed);
+		parameter.SetNumberOfCandidateRooms(24);
+		parameter.SetNumberOfCandidateFloors(3);
+		parameter.SetMinRoomWidth(3);
+		parameter.SetMaxRoomWidth(8);
+		parameter.SetMinRoomDepth(3);
+		parameter.SetMaxRoomDepth(8);
+		parameter.SetMinRoomHeight(2);
+		parameter.SetMaxRoomHeight(4);
+		parameter.SetHorizontalRoomMargin(2);
+		parameter.SetVerticalRoomMargin(1);
+		parameter.SetMissionGraph(false);
+		parameter.SetExpansionPolicy(dungeon::ExpansionPolicy::ExpandHorizontally);
+
+		auto generator = std::make_shared<dungeon::Generator>();
+		generator->Generate(parameter);
+		if (generator->GetLastError() != dungeon::Generator::Error::Success || generator->GetVoxel() == nullptr)
+			return nullptr;
+		return generator;
+	}
+
+	/**
+	 * The former visibility trace: steps a quarter grid along the segment and checks every cell change
+	 * 以前の視線判定：線分を1/4グリッドずつ進めてグリッドの変化を調べます
+	 */
+	bool QuarterGridTraceVisibility(const dungeon::Voxel& voxel, const FIntVector& start, const FIntVector& goal)
+	{
+		const auto isTraversable = [](const dungeon::Grid& grid)
+			{
+				return grid.IsKindOfRoomType() || grid.IsKindOfAisleType() || grid.IsKindOfSlopeType();
+			};
+		const auto isTransitionOpen = [&voxel, &isTraversable](const FIntVector& fromCell, const FIntVector& toCell)
+			{
+				if (!voxel.Contain(fromCell) || !voxel.Contain(toCell))
+					return false;
+				const dungeon::Grid& fromGrid = voxel.Get(fromCell);
+				const dungeon::Grid& toGrid = voxel.Get(toCell);
+				if (!isTraversable(fromGrid) || !isTraversable(toGrid))
+					return false;
+
+				const FIntVector delta = toCell - fromCell;
+				if (delta == FIntVector(1, 0, 0))
+					return !fromGrid.HasEastWall() && !toGrid.HasWestWall();
+				if (delta == FIntVector(-1, 0, 0))
+					return !fromGrid.HasWestWall() && !toGrid.HasEastWall();
+				if (delta == FIntVector(0, 1, 0))
+					return !fromGrid.HasSouthWall() && !toGrid.HasNorthWall();
+				if (delta == FIntVector(0, -1, 0))
+					return !fromGrid.HasNorthWall() && !toGrid.HasSouthWall();
+				if (delta == FIntVector(0, 0, 1))
+					return !fromGrid.HasCeiling() && !toGrid.HasFloor();
+				if (delta == FIntVector(0, 0, -1))
+					return !fromGrid.HasFloor() && !toGrid.HasCeiling();
+				return false;
+			};
+		const auto canTraverseDelta = [&isTransitionOpen](const FIntVector& from, const FIntVector& to)
+			{
+				const FIntVector delta = to - from;
+				if (FMath::Abs(delta.X) > 1 || FMath::Abs(delta.Y) > 1 || FMath::Abs(delta.Z) > 1)
+					return false;
+
+				std::vector<FIntVector> axisSteps;
+				if (delta.X != 0)
+					axisSteps.emplace_back(delta.X, 0, 0);
+				if (delta.Y != 0)
+					axisSteps.emplace_back(0, delta.Y, 0);
+				if (delta.Z != 0)
+					axisSteps.emplace_back(0, 0, delta.Z);
+				if (axisSteps.empty())
+					return true;
+
+				std::sort(axisSteps.begin(), axisSteps.end(), [](const FIntVector& l, const FIntVector& r) { return std::tie(l.X, l.Y, l.Z) < std::tie(r.X, r.Y, r.Z); });
+				do
+				{
+					FIntVector cell = from;
+					bool open = true;
+					for (const FIntVector& axisStep : axisSteps)
+					{
+						if (!isTransitionOpen(cell, cell + axisStep))
+						{
+							open = false;
+							break;
+						}
+						cell += axisStep;
+					}
+					if (open)
+						return true;
+				} while (std::next_permutation(axisSteps.begin(), axisSteps.end(), [](const FIntVector& l, const FIntVector& r) { return std::tie(l.X, l.Y, l.Z) < std::tie(r.X, r.Y, r.Z); }));
+				return false;
+			};
+
+		const FVector startLocation = FVector(start) + FVector(0.5);
+		const FVector goalLocation = FVector(goal) + FVector(0.5);
+		const int32 stepCount = FMath::Max(1, FMath::CeilToInt(FVector::Distance(startLocation, goalLocation) / 0.25));
+		FIntVector currentCell = start;
+		for (int32 stepIndex = 1; stepIndex <= stepCount; ++stepIndex)
+		{
+			const FVector location = FMath::Lerp(startLocation, goalLocation, static_cast<double>(stepIndex) / stepCount);
+			const FIntVector nextCell(FMath::FloorToInt(location.X), FMath::FloorToInt(location.Y), FMath::FloorToInt(location.Z));
+			if (!voxel.Contain(nextCell) || !canTraverseDelta(currentCell, nextCell))
+				return false;
+			currentCell = nextCell;
+		}
+		return canTraverseDelta(currentCell, goal);
+	}
+}
+
+UDungeonCoreBenchmarkCommandlet::UDungeonCoreBenchmarkCommandlet(const FObjectInitializer& initializer)
+	: Super(initializer)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDungeonCoreBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString filter;
+	FParse::Value(*Params, TEXT("Filter="), filter);
+
+	FDungeonAllocationCounter::Install();
+	FBenchmarkRunner runner(filter);
+
+	// Random
+	{
+		dungeon::Random random(BenchmarkSeed);
+		runner.RunBatched(TEXT("Random::Get<uint32_t>"), 100, 100000, [&random] { BenchmarkSink = BenchmarkSink + random.Get<uint32_t>(); });
+		runner.RunBatched(TEXT("Random::Get<float>"), 100, 100000, [&random] { BenchmarkSink = BenchmarkSink + static_cast<uint64>(random.Get<float>() * 1000.f); });
+		runner.RunBatched(TEXT("Random::Get<int32_t>(from,to)"), 100, 100000, [&random] { BenchmarkSink = BenchmarkSink + random.Get<int32_t>(-100, 100); });
+		runner.RunBatched(TEXT("Random::Get<bool>"), 100, 100000, [&random] { BenchmarkSink = BenchmarkSink + random.Get<bool>(); });
+	}
+
+	// PerlinNoise
+	{
+		const dungeon::PerlinNoise perlinNoise(std::make_shared<dungeon::Random>(BenchmarkSeed));
+		float x = 0.f;
+		runner.RunBatched(TEXT("PerlinNoise::OctaveNoise(6, x, y)"), 100, 10000, [&perlinNoise, &x]
+			{
+				x += 0.013f;
+				BenchmarkSink = BenchmarkSink + static_cast<uint64>(perlinNoise.OctaveNoise(6, x, x * 0.5f) * 1000.f);
+			}
+		);
+		runner.RunBatched(TEXT("PerlinNoise::OctaveNoise(6, x, y, z)"), 100, 10000, [&perlinNoise, &x]
+			{
+				x += 0.013f;
+				BenchmarkSink = BenchmarkSink + static_cast<uint64>(perlinNoise.OctaveNoise(6, x, x * 0.5f, x * 0.25f) * 1000.f);
+			}
+		);
+	}
+
+	// Voxel
+	{
+		const auto voxel = MakeBenchmarkVoxel(128, 128, 16);
+		const size_t voxelBytes = voxel->GetAllocatedSize();
+		runner.Run(TEXT("Voxel::Each (128x128x16)"), 50, [] {}, [&voxel]
+			{
+				uint64 floorCount = 0;
+				voxel->Each([&floorCount](const FIntVector&, const dungeon::Grid& grid)
+					{
+						floorCount += grid.CanBuildFloor(true);
+						return true;
+					}
+				);
+				BenchmarkSink = BenchmarkSink + floorCount;
+			}
+		);
+		runner.Run(TEXT("Voxel::Rectangle (16x16x4)"), 1000, [] {}, [&voxel]
+			{
+				voxel->Rectangle(FIntVector(8, 8, 2), FIntVector(24, 24, 6), dungeon::Grid(dungeon::Grid::Type::Deck), dungeon::Grid(dungeon::Grid::Type::Floor));
+			}
+		);
+		runner.Run(FString::Printf(TEXT("GenerateCrc32FromData (voxel %d KiB)"), static_cast<int32>(voxelBytes / 1024)), 50, [] {}, [&voxel]
+			{
+				BenchmarkSink = BenchmarkSink + voxel->CalculateCRC32();
+			}
+		);
+	}
+
+	// Grid
+	{
+		std::vector<dungeon::Grid> grids;
+		for (size_t type = 0; type < static_cast<size_t>(dungeon::Grid::Type::OutOfBounds); ++type)
+		{
+			for (uint8_t direction = 0; direction < 4; ++direction)
+			{
+				grids.emplace_back(static_cast<dungeon::Grid::Type>(type), dungeon::Direction(static_cast<dungeon::Direction::Index>(direction)), static_cast<uint16_t>(type + 1));
+			}
+		}
+		const auto eachPair = [&grids](auto&& function)
+			{
+				for (const auto& from : grids)
+					for (const auto& to : grids)
+						for (uint8_t direction = 0; direction < 4; ++direction)
+							function(from, to, static_cast<dungeon::Direction::Index>(direction));
+			};
+		const int32 pairCount = static_cast<int32>(grids.size() * grids.size() * 4);
+
+		runner.Run(FString::Printf(TEXT("Grid::CanBuildWall (x%d)"), pairCount), 200, [] {}, [&eachPair]
+			{
+				eachPair([](const dungeon::Grid& from, const dungeon::Grid& to, const dungeon::Direction::Index direction)
+					{
+						BenchmarkSink = BenchmarkSink + from.CanBuildWall(to, direction, false);
+					}
+				);
+			}
+		);
+		runner.Run(FString::Printf(TEXT("Grid::CanBuildGate (x%d)"), pairCount), 200, [] {}, [&eachPair]
+			{
+				eachPair([](const dungeon::Grid& from, const dungeon::Grid& to, const dungeon::Direction::Index direction)
+					{
+						BenchmarkSink = BenchmarkSink + from.CanBuildGate(to, direction, false);
+					}
+				);
+			}
+		);
+		runner.Run(FString::Printf(TEXT("Grid::CanBuildRoof (x%d)"), pairCount / 4), 200, [] {}, [&grids]
+			{
+				for (const auto& from : grids)
+					for (const auto& to : grids)
+						BenchmarkSink = BenchmarkSink + from.CanBuildRoof(to, true);
+			}
+		);
+		runner.Run(FString::Printf(TEXT("Grid::CanBuildFloor/Slope (x%d)"), static_cast<int32>(grids.size())), 10000, [] {}, [&grids]
+			{
+				for (const auto& grid : grids)
+					BenchmarkSink = BenchmarkSink + grid.CanBuildFloor(true) + grid.CanBuildSlope();
+			}
+		);
+	}
+
+	// PathFinder
+	for (const int32 size : { 16, 32, 64 })
+	{
+		runner.Run(FString::Printf(TEXT("PathFinder open/pop/commit (%dx%d)"), size, size), 20, [] {}, [size] { RunPathFinder(size); });
+	}
+
+	// DelaunayTriangulation3D / MinimumSpanningTree
+	for (const size_t count : { 10, 50, 100, 500, 1000, 2000 })
+	{
+		const auto points = MakeBenchmarkPoints(count, false);
+		const int32 iterations = count <= 100 ? 100 : (count <= 500 ? 10 : 3);
+		runner.Run(FString::Printf(TEXT("DelaunayTriangulation3D (%d points)"), static_cast<int32>(count)), iterations, [] {}, [&points]
+			{
+				const dungeon::DelaunayTriangulation3D delaunayTriangulation(points);
+				BenchmarkSink = BenchmarkSink + delaunayTriangulation.IsValid();
+			}
+		);
+
+		const auto roomPoints = MakeBenchmarkPoints(count, true);
+		const dungeon::DelaunayTriangulation3D delaunayTriangulation(roomPoints);
+		if (delaunayTriangulation.IsValid())
+		{
+			const auto random = std::make_shared<dungeon::Random>();
+			runner.Run(FString::Printf(TEXT("MinimumSpanningTree (%d points)"), static_cast<int32>(count)), iterations,
+				[&random] { random->SetSeed(BenchmarkSeed); },
+				[&random, &delaunayTriangulation]
+				{
+					const dungeon::MinimumSpanningTree minimumSpanningTree(random, delaunayTriangulation, 0, dungeon::StartLocationPolicy::UseSouthernMost, 1);
+					BenchmarkSink = BenchmarkSink + minimumSpanningTree.Size();
+				}
+			);
+		}
+	}
+
+	// Voxel::TraceVisibility on generated dungeons
+	// The results are checked against a reference by the DungeonGenerator.Core.Voxel.TraceVisibility automation test
+	// 結果は自動テストのDungeonGenerator.Core.Voxel.TraceVisibilityで基準の実装と比較しています
+	for (const uint32_t seed : { 1u, 2u, 3u })
+	{
+		const auto generator = GenerateBenchmarkDungeon(seed);
+		if (generator == nullptr)
+		{
+			DUNGEON_GENERATOR_WARNING(TEXT("Failed to generate the dungeon for seed %u"), seed);
+			continue;
+		}
+		const dungeon::Voxel& voxel = *generator->GetVoxel();
+
+		std::vector<FIntVector> cells;
+		voxel.Each([&cells](const FIntVector& location, const dungeon::Grid& grid)
+			{
+				if (grid.IsKindOfRoomType() || grid.IsKindOfAisleType() || grid.IsKindOfSlopeType())
+					cells.push_back(location);
+				return true;
+			}
+		);
+		if (cells.size() < 2)
+			continue;
+
+		dungeon::Random random(seed);
+		std::vector<std::pair<FIntVector, FIntVector>> pairs;
+		pairs.reserve(4096);
+		for (int32 attempt = 0; pairs.size() < 4096 && attempt < 1000000; ++attempt)
+		{
+			const FIntVector& start = cells[random.Get<size_t>(cells.size())];
+			const FIntVector& goal = cells[random.Get<size_t>(cells.size())];
+			if ((goal - start).GetAbsMax() <= 24)
+				pairs.emplace_back(start, goal);
+		}
+
+		runner.Run(FString::Printf(TEXT("Voxel::TraceVisibility (seed %u, x%d)"), seed, static_cast<int32>(pairs.size())), 20, [] {}, [&voxel, &pairs]
+			{
+				for (const auto& pair : pairs)
+					BenchmarkSink = BenchmarkSink + voxel.TraceVisibility(pair.first, pair.second);
+			}
+		);
+		runner.Run(FString::Printf(TEXT("Former quarter-grid trace (seed %u, x%d)"), seed, static_cast<int32>(pairs.size())), 5, [] {}, [&voxel, &pairs]
+			{
+				for (const auto& pair : pairs)
+					BenchmarkSink = BenchmarkSink + QuarterGridTraceVisibility(voxel, pair.first, pair.second);
+			}
+		);
+	}
+
+	FString outputPath;
+	if (FParse::Value(*Params, TEXT("Output="), outputPath))
+	{
+		TArray<FString> lines;
+		lines.Add(TEXT("Name,Operations,NanosecondsPerOperation,AllocationsPerOperation,BytesPerOperation"));
+		for (const FBenchmarkResult& result : runner.GetResults())
+		{
+			lines.Add(FString::Printf(TEXT("\"%s\",%d,%lf,%lf,%lf"), *result.Name, result.Iterations, result.NanosecondsPerOperation, result.AllocationsPerOperation, result.BytesPerOperation));
+		}
+		if (!FFileHelper::SaveStringArrayToFile(lines, *outputPath))
+		{
+			DUNGEON_GENERATOR_ERROR(TEXT("Failed to write '%s'"), *outputPath);
+			return 1;
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Commandlet/DungeonReplayCommandlet.h"
+#include "Core/Generator.h"
+#include "Core/GenerateReplay.h"
+#include "Core/Debug/Debug.h"
+#include "Core/Helper/Stopwatch.h"
+#include "PluginInformation.h"
+
+#include <ProfilingDebugging/CpuProfilerTrace.h>
+
+UDungeonReplayCommandlet::UDungeonReplayCommandlet(const FObjectInitializer& initializer)
+	: Super(initializer)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDungeonReplayCommandlet::Main(const FString& Params)
+{
+	FString replayPath;
+	if (!FParse::Value(*Params, TEXT("Replay="), replayPath))
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("Usage: -run=DungeonReplay -Replay=<file> [-Repeat=<count>]"));
+		return 1;
+	}
+
+	int32 repeatCount = 1;
+	FParse::Value(*Params, TEXT("Repeat="), repeatCount);
+	repeatCount = FMath::Max(repeatCount, 1);
+
+	dungeon::GenerateReplay replay;
+	if (!replay.Load(TCHAR_TO_UTF8(*replayPath)))
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("Failed to load replay '%s'"), *replayPath);
+		return 1;
+	}
+
+	const auto& seeds = replay.GetSeeds();
+	DUNGEON_GENERATOR_DISPLAY(TEXT("DungeonReplay: '%s', captured with version '%s', seeds x=%08x y=%08x z=%08x w=%08x"),
+		*replayPath, UTF8_TO_TCHAR(replay.GetPluginVersionName().c_str()), seeds[0], seeds[1], seeds[2], seeds[3]);
+	if (replay.GetPluginVersion() != DUNGEON_GENERATOR_PLUGIN_VERSION)
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("The replay was captured with version '%s' but this is '%s'. The result may differ."),
+			UTF8_TO_TCHAR(replay.GetPluginVersionName().c_str()), TEXT(DUNGEON_GENERATOR_PLUGIN_VERSION_NAME));
+	}
+
+	int32 exitCode = 0;
+	uint32 firstCrc32 = 0;
+	for (int32 repeat = 0; repeat < repeatCount; ++repeat)
+	{
+		dungeon::GenerateParameter generateParameter = replay.Restore();
+		const auto generator = std::make_shared<dungeon::Generator>();
+
+		dungeon::Stopwatch stopwatch;
+		{
+			TRACE_CPUPROFILER_EVENT_SCOPE(DungeonReplay_Generate);
+			generator->Generate(generateParameter);
+		}
+		const double totalTime = stopwatch.Lap();
+
+		const dungeon::Generator::Error error = generator->GetLastError();
+		const uint32 crc32 = error == dungeon::Generator::Error::Success ? generator->CalculateCRC32() : 0;
+		DUNGEON_GENERATOR_DISPLAY(TEXT("Run %d: %s, %.3f seconds, CRC32 %08x, allocated %.2f KiB, peak path finder %.2f KiB"),
+			repeat,
+			UTF8_TO_TCHAR(dungeon::Generator::GetErrorName(error)),
+			totalTime,
+			crc32,
+			static_cast<double>(generator->GetAllocatedSize()) / 1024.0,
+			static_cast<double>(generator->GetPeakPathFinderAllocatedSize()) / 1024.0
+		);
+		for (size_t phase = 0; phase < static_cast<size_t>(dungeon::Generator::Phase::Count); ++phase)
+		{
+			const auto phaseType = static_cast<dungeon::Generator::Phase>(phase);
+			DUNGEON_GENERATOR_DISPLAY(TEXT("  %-36s %.3f seconds"),
+				UTF8_TO_TCHAR(dungeon::Generator::GetPhaseName(phaseType)), generator->GetPhaseTime(phaseType));
+		}
+
+		if (error != dungeon::Generator::Error::Success)
+			exitCode = 1;
+
+		// 同じ再現情報からは同じダンジョンが生成されるはず
+		if (repeat == 0)
+		{
+			firstCrc32 = crc32;
+		}
+		else if (firstCrc32 != crc32)
+		{
+			DUNGEON_GENERATOR_ERROR(TEXT("Run %d is not deterministic: CRC32 %08x differs from %08x"), repeat, crc32, firstCrc32);
+			exitCode = 1;
+		}
+	}
+
+	return exitCode;
+}
@@ -0,0 +1,228 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Commandlet/DungeonSeedSweepCommandlet.h"
+#include "DungeonSimplifiedCollisionBuilder.h"
+#include "Core/Generator.h"
+#include "Core/GenerateParameter.h"
+#include "Core/Debug/Debug.h"
+#include "Core/Helper/Stopwatch.h"
+#include "Core/Voxelization/Voxel.h"
+#include "Parameter/DungeonGenerateParameter.h"
+#include "Validation/DungeonParameterValidator.h"
+#include "PluginInformation.h"
+
+#include <Async/ParallelFor.h>
+#include <Misc/FileHelper.h>
+#include <Misc/Paths.h>
+#include <array>
+
+namespace
+{
+	/**
+	 * Result of generating one seed
+	 * 一つの乱数の種の生成結果
+	 */
+	struct FSeedSweepResult final
+	{
+		int32 Seed = 0;
+		dungeon::Generator::Error Error = dungeon::Generator::Error::Success;
+		int32 RoomCount = 0;
+		int32 AisleCount = 0;
+		FIntVector VoxelSize = FIntVector::ZeroValue;
+		double TotalTime = 0.0;
+		std::array<double, static_cast<size_t>(dungeon::Generator::Phase::Count)> PhaseTime{};
+		uint32 Crc32 = 0;
+		int32 CollisionFaceCount = 0;
+		int32 CollisionBoxCount = 0;
+		int32 CollisionErrorCount = 0;
+	};
+}
+
+UDungeonSeedSweepCommandlet::UDungeonSeedSweepCommandlet(const FObjectInitializer& initializer)
+	: Super(initializer)
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+}
+
+int32 UDungeonSeedSweepCommandlet::Main(const FString& Params)
+{
+	FString parameterPath;
+	if (!FParse::Value(*Params, TEXT("Parameter="), parameterPath))
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("Usage: -run=DungeonSeedSweep -Parameter=/Game/Path/Asset -SeedStart=1 -SeedCount=1000 [-Output=<csv>] [-SingleThread] [-ValidateCollision]"));
+		return 1;
+	}
+
+	int32 seedStart = 1;
+	int32 seedCount = 1000;
+	FParse::Value(*Params, TEXT("SeedStart="), seedStart);
+	FParse::Value(*Params, TEXT("SeedCount="), seedCount);
+	const bool singleThread = FParse::Param(*Params, TEXT("SingleThread"));
+	const bool validateCollision = FParse::Param(*Params, TEXT("ValidateCollision"));
+	if (seedCount <= 0)
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("SeedCount must be greater than zero"));
+		return 1;
+	}
+
+	const UDungeonGenerateParameter* parameter = LoadObject<UDungeonGenerateParameter>(nullptr, *parameterPath);
+	if (!IsValid(parameter))
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("Failed to load UDungeonGenerateParameter '%s'"), *parameterPath);
+		return 1;
+	}
+
+	FString outputPath;
+	if (!FParse::Value(*Params, TEXT("Output="), outputPath))
+	{
+		outputPath = dungeon::GetDebugDirectory() / FString::Printf(TEXT("SeedSweep_%s_%d_%d.csv"), *parameter->GetName(), seedStart, seedCount);
+	}
+
+	TArray<FDungeonValidationIssue> validationIssues;
+	FDungeonParameterValidator::Validate(parameter, validationIssues, false);
+	if (validationIssues.ContainsByPredicate([](const FDungeonValidationIssue& issue) { return issue.Severity == EDungeonValidationSeverity::Error; }))
+	{
+		for (const FDungeonValidationIssue& issue : validationIssues)
+		{
+			if (issue.Severity == EDungeonValidationSeverity::Error)
+				DUNGEON_GENERATOR_ERROR(TEXT("Validation Error [%s] %s"), *issue.Code.ToString(), *issue.Message.ToString());
+		}
+		return 1;
+	}
+
+	DUNGEON_GENERATOR_DISPLAY(TEXT("DungeonSeedSweep: version '%s', parameter '%s', seeds %d..%d"),
+		TEXT(DUNGEON_GENERATOR_PLUGIN_VERSION_NAME), *parameterPath, seedStart, seedStart + seedCount - 1);
+
+	// The core generator does not touch UObjects, so each seed can run on its own worker thread
+	// コアの生成器はUObjectに触れないので、乱数の種毎にワーカースレッドで実行できます
+	TArray<FSeedSweepResult> results;
+	results.SetNum(seedCount);
+	dungeon::Stopwatch sweepStopwatch;
+	// 箱の厚みは検証結果に影響しません
+	const FDungeonSimplifiedCollisionBuilder collisionBuilder(parameter->GetGridSize().To3D(), 20.0, parameter->IsMergeRooms());
+	ParallelFor(seedCount, [parameter, seedStart, validateCollision, &collisionBuilder, &results](const int32 index)
+		{
+			FSeedSweepResult& result = results[index];
+			result.Seed = seedStart + index;
+
+			dungeon::GenerateParameter generateParameter;
+			parameter->ToGenerateParameter(generateParameter, result.Seed, 1);
+
+			dungeon::Stopwatch stopwatch;
+			const auto generator = std::make_shared<dungeon::Generator>();
+			generator->Generate(generateParameter);
+			result.TotalTime = stopwatch.Lap();
+
+			result.Error = generator->GetLastError();
+			result.RoomCount = static_cast<int32>(generator->GetRoomCount());
+			generator->EachAisle([&result](const dungeon::Aisle&)
+				{
+					++result.AisleCount;
+					return true;
+				}
+			);
+			if (const auto& voxel = generator->GetVoxel())
+			{
+				result.VoxelSize = FIntVector(voxel->GetWidth(), voxel->GetDepth(), voxel->GetHeight());
+			}
+			for (size_t phase = 0; phase < result.PhaseTime.size(); ++phase)
+			{
+				result.PhaseTime[phase] = generator->GetPhaseTime(static_cast<dungeon::Generator::Phase>(phase));
+			}
+			if (result.Error == dungeon::Generator::Error::Success)
+			{
+				result.Crc32 = generator->CalculateCRC32();
+
+				// ボクセルから求めた面を簡略化したコリジョンの箱がちょうど一度ずつ覆っているか検証します（配置したタイルとは比較しません）
+				if (validateCollision && generator->GetVoxel())
+				{
+					FDungeonSimplifiedCollisionBuilder::Partitions partitions;
+					result.CollisionFaceCount = collisionBuilder.Build(*generator->GetVoxel(), partitions);
+					for (const auto& partition : partitions)
+						result.CollisionBoxCount += partition.Value.Num();
+					result.CollisionErrorCount = collisionBuilder.Validate(*generator->GetVoxel(), partitions);
+				}
+			}
+		},
+		singleThread ? EParallelForFlags::ForceSingleThread : EParallelForFlags::Unbalanced
+	);
+	const double sweepTime = sweepStopwatch.Lap();
+
+	// CSVを出力
+	TArray<FString> lines;
+	lines.Reserve(seedCount + 1);
+	{
+		FString header = TEXT("Seed,Result,Rooms,Aisles,VoxelWidth,VoxelDepth,VoxelHeight,TotalSeconds");
+		for (size_t phase = 0; phase < static_cast<size_t>(dungeon::Generator::Phase::Count); ++phase)
+		{
+			header += TEXT(",");
+			header += UTF8_TO_TCHAR(dungeon::Generator::GetPhaseName(static_cast<dungeon::Generator::Phase>(phase)));
+		}
+		header += TEXT(",CRC32");
+		if (validateCollision)
+			header += TEXT(",CollisionFaces,CollisionBoxes,CollisionMergeErrors");
+		lines.Add(MoveTemp(header));
+	}
+
+	int32 failureCount = 0;
+	int32 collisionFailureCount = 0;
+	double slowestTime = 0.0;
+	int32 slowestSeed = 0;
+	for (const FSeedSweepResult& result : results)
+	{
+		FString line = FString::Printf(TEXT("%d,%s,%d,%d,%d,%d,%d,%lf"),
+			result.Seed,
+			UTF8_TO_TCHAR(dungeon::Generator::GetErrorName(result.Error)),
+			result.RoomCount,
+			result.AisleCount,
+			result.VoxelSize.X, result.VoxelSize.Y, result.VoxelSize.Z,
+			result.TotalTime
+		);
+		for (const double phaseTime : result.PhaseTime)
+		{
+			line += FString::Printf(TEXT(",%lf"), phaseTime);
+		}
+		line += FString::Printf(TEXT(",%08x"), result.Crc32);
+		if (validateCollision)
+			line += FString::Printf(TEXT(",%d,%d,%d"), result.CollisionFaceCount, result.CollisionBoxCount, result.CollisionErrorCount);
+		lines.Add(MoveTemp(line));
+
+		if (result.Error != dungeon::Generator::Error::Success)
+			++failureCount;
+		if (result.CollisionErrorCount > 0)
+			++collisionFailureCount;
+		if (slowestTime < result.TotalTime)
+		{
+			slowestTime = result.TotalTime;
+			slowestSeed = result.Seed;
+		}
+	}
+
+	if (!FFileHelper::SaveStringArrayToFile(lines, *outputPath))
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("Failed to write '%s'"), *outputPath);
+		return 1;
+	}
+
+	DUNGEON_GENERATOR_DISPLAY(TEXT("DungeonSeedSweep: %d seeds in %lf seconds, %d failed (%.2f%%), slowest seed %d (%lf seconds), output '%s'"),
+		seedCount, sweepTime,
+		failureCount, 100.0 * failureCount / seedCount,
+		slowestSeed, slowestTime,
+		*outputPath
+	);
+
+	if (collisionFailureCount > 0)
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("DungeonSeedSweep: merged collision boxes do not cover the voxel faces exactly once in %d seeds"), collisionFailureCount);
+		return 1;
+	}
+
+	return 0;
+}
@@ -365,6 +365,8 @@ namespace dungeon
 		 * ゴール部屋のサイズ
 		 */
 		FIntVector mGoalRoomSize = { 0, 0, 0 };
+
+		friend class GenerateReplay;
 	};
 }
 
@@ -0,0 +1,185 @@
+/**
+ * ダンジョン生成の再現情報に関するソースファイル
+ *
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "GenerateReplay.h"
+#include "Math/Random.h"
+#include "../PluginInformation.h"
+#include <fstream>
+#include <sstream>
+#include <type_traits>
+#include <unordered_map>
+
+namespace dungeon
+{
+	namespace
+	{
+		// 再現ファイルの書式のバージョン
+		constexpr uint32_t ReplayFileVersion = 1;
+
+		using Values = std::unordered_map<std::string, std::string>;
+
+		template<typename T>
+		bool Read(const Values& values, const char* key, T& value) noexcept
+		{
+			const auto i = values.find(key);
+			if (i == values.end())
+				return false;
+
+			std::istringstream stream(i->second);
+			if constexpr (std::is_same_v<T, bool> || std::is_enum_v<T> || sizeof(T) == 1)
+			{
+				// uint8_tを文字として読まないように整数で読む
+				uint32_t integer;
+				stream >> integer;
+				value = static_cast<T>(integer);
+			}
+			else
+			{
+				stream >> value;
+			}
+			return !stream.fail();
+		}
+
+		bool Read(const Values& values, const char* key, FIntVector& value) noexcept
+		{
+			const auto i = values.find(key);
+			if (i == values.end())
+				return false;
+
+			char comma0, comma1;
+			std::istringstream stream(i->second);
+			stream >> value.X >> comma0 >> value.Y >> comma1 >> value.Z;
+			return !stream.fail();
+		}
+	}
+
+	void GenerateReplay::Capture(const GenerateParameter& parameter) noexcept
+	{
+		// 乱数生成器は共有されているので、種だけを記録して複製する
+		mParameter = parameter;
+		mParameter.mRandom = std::make_shared<Random>();
+		parameter.GetRandom()->GetSeeds(mSeeds[0], mSeeds[1], mSeeds[2], mSeeds[3]);
+		mPluginVersion = DUNGEON_GENERATOR_PLUGIN_VERSION;
+		mPluginVersionName = DUNGEON_GENERATOR_PLUGIN_VERSION_NAME;
+	}
+
+	GenerateParameter GenerateReplay::Restore() const noexcept
+	{
+		GenerateParameter parameter = mParameter;
+		parameter.mRandom = std::make_shared<Random>();
+		parameter.mRandom->SetSeeds(mSeeds[0], mSeeds[1], mSeeds[2], mSeeds[3]);
+		return parameter;
+	}
+
+	bool GenerateReplay::Save(const std::string& path) const noexcept
+	{
+		std::ofstream stream(path);
+		if (!stream)
+			return false;
+
+		const GenerateParameter& p = mParameter;
+		stream << "# DungeonGenerator generation replay\n";
+		stream << "FileVersion=" << ReplayFileVersion << '\n';
+		stream << "PluginVersion=" << mPluginVersion << '\n';
+		stream << "PluginVersionName=" << mPluginVersionName << '\n';
+		stream << "Seeds=" << mSeeds[0] << ',' << mSeeds[1] << ',' << mSeeds[2] << ',' << mSeeds[3] << '\n';
+		stream << "Width=" << p.mWidth << '\n';
+		stream << "Depth=" << p.mDepth << '\n';
+		stream << "Height=" << p.mHeight << '\n';
+		stream << "ExpansionPolicy=" << static_cast<uint32_t>(p.mDungeonExpansionPolicy) << '\n';
+		stream << "StartLocationPolicy=" << static_cast<uint32_t>(p.mStartLocationPolicy) << '\n';
+		stream << "StartRoomCount=" << static_cast<uint32_t>(p.mStartRoomCount) << '\n';
+		stream << "NumberOfCandidateFloors=" << static_cast<uint32_t>(p.mNumberOfCandidateFloors) << '\n';
+		stream << "NumberOfCandidateRooms=" << static_cast<uint32_t>(p.mNumberOfCandidateRooms) << '\n';
+		stream << "MergeRooms=" << p.mMergeRooms << '\n';
+		stream << "UseMissionGraph=" << p.mUseMissionGraph << '\n';
+		stream << "AisleComplexity=" << static_cast<uint32_t>(p.mAisleComplexity) << '\n';
+		stream << "AisleCeilingHeightPolicy=" << static_cast<uint32_t>(p.mAisleCeilingHeightPolicy) << '\n';
+		stream << "GenerateSlopeInRoom=" << p.mGenerateSlopeInRoom << '\n';
+		stream << "GenerateStructuralColumn=" << p.mGenerateStructuralColumn << '\n';
+		stream << "SkylightChancePercent=" << static_cast<uint32_t>(p.mSkylightChancePercent) << '\n';
+		stream << "MinRoomWidth=" << p.mMinRoomWidth << '\n';
+		stream << "MaxRoomWidth=" << p.mMaxRoomWidth << '\n';
+		stream << "MinRoomDepth=" << p.mMinRoomDepth << '\n';
+		stream << "MaxRoomDepth=" << p.mMaxRoomDepth << '\n';
+		stream << "MinRoomHeight=" << p.mMinRoomHeight << '\n';
+		stream << "MaxRoomHeight=" << p.mMaxRoomHeight << '\n';
+		stream << "HorizontalRoomMargin=" << p.mHorizontalRoomMargin << '\n';
+		stream << "VerticalRoomMargin=" << p.mVerticalRoomMargin << '\n';
+		stream << "StartRoomSize=" << p.mStartRoomSize.X << ',' << p.mStartRoomSize.Y << ',' << p.mStartRoomSize.Z << '\n';
+		stream << "GoalRoomSize=" << p.mGoalRoomSize.X << ',' << p.mGoalRoomSize.Y << ',' << p.mGoalRoomSize.Z << '\n';
+		return stream.good();
+	}
+
+	bool GenerateReplay::Load(const std::string& path) noexcept
+	{
+		std::ifstream stream(path);
+		if (!stream)
+			return false;
+
+		Values values;
+		std::string line;
+		while (std::getline(stream, line))
+		{
+			if (line.empty() || line[0] == '#')
+				continue;
+			const size_t separator = line.find('=');
+			if (separator == std::string::npos)
+				continue;
+			values[line.substr(0, separator)] = line.substr(separator + 1);
+		}
+
+		uint32_t fileVersion = 0;
+		if (!Read(values, "FileVersion", fileVersion) || fileVersion != ReplayFileVersion)
+			return false;
+
+		{
+			const auto i = values.find("Seeds");
+			if (i == values.end())
+				return false;
+			char comma0, comma1, comma2;
+			std::istringstream seedStream(i->second);
+			seedStream >> mSeeds[0] >> comma0 >> mSeeds[1] >> comma1 >> mSeeds[2] >> comma2 >> mSeeds[3];
+			if (seedStream.fail())
+				return false;
+		}
+
+		const auto found = values.find("PluginVersionName");
+		mPluginVersionName = found != values.end() ? found->second : std::string();
+
+		GenerateParameter& p = mParameter;
+		p.mRandom = std::make_shared<Random>();
+		bool result = Read(values, "PluginVersion", mPluginVersion);
+		result &= Read(values, "Width", p.mWidth);
+		result &= Read(values, "Depth", p.mDepth);
+		result &= Read(values, "Height", p.mHeight);
+		result &= Read(values, "ExpansionPolicy", p.mDungeonExpansionPolicy);
+		result &= Read(values, "StartLocationPolicy", p.mStartLocationPolicy);
+		result &= Read(values, "StartRoomCount", p.mStartRoomCount);
+		result &= Read(values, "NumberOfCandidateFloors", p.mNumberOfCandidateFloors);
+		result &= Read(values, "NumberOfCandidateRooms", p.mNumberOfCandidateRooms);
+		result &= Read(values, "MergeRooms", p.mMergeRooms);
+		result &= Read(values, "UseMissionGraph", p.mUseMissionGraph);
+		result &= Read(values, "AisleComplexity", p.mAisleComplexity);
+		result &= Read(values, "AisleCeilingHeightPolicy", p.mAisleCeilingHeightPolicy);
+		result &= Read(values, "GenerateSlopeInRoom", p.mGenerateSlopeInRoom);
+		result &= Read(values, "GenerateStructuralColumn", p.mGenerateStructuralColumn);
+		result &= Read(values, "SkylightChancePercent", p.mSkylightChancePercent);
+		result &= Read(values, "MinRoomWidth", p.mMinRoomWidth);
+		result &= Read(values, "MaxRoomWidth", p.mMaxRoomWidth);
+		result &= Read(values, "MinRoomDepth", p.mMinRoomDepth);
+		result &= Read(values, "MaxRoomDepth", p.mMaxRoomDepth);
+		result &= Read(values, "MinRoomHeight", p.mMinRoomHeight);
+		result &= Read(values, "MaxRoomHeight", p.mMaxRoomHeight);
+		result &= Read(values, "HorizontalRoomMargin", p.mHorizontalRoomMargin);
+		result &= Read(values, "VerticalRoomMargin", p.mVerticalRoomMargin);
+		result &= Read(values, "StartRoomSize", p.mStartRoomSize);
+		result &= Read(values, "GoalRoomSize", p.mGoalRoomSize);
+		return result;
+	}
+}
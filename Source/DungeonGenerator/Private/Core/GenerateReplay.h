@@ -0,0 +1,85 @@
+/**
+ * ダンジョン生成の再現情報に関するヘッダーファイル
+ *
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include "GenerateParameter.h"
+#include <array>
+#include <string>
+
+namespace dungeon
+{
+	/**
+	 * Generation replay
+	 * Records the resolved parameter passed to Generator::Generate and the random seeds at entry,
+	 * so that a slow or failed generation can be re-run exactly outside the original session.
+	 *
+	 * ダンジョン生成の再現情報
+	 * Generator::Generateに渡した解決済みのパラメータと開始時の乱数の種を記録し、
+	 * 遅い生成や失敗した生成を元のセッションの外で正確に再実行できるようにします。
+	 */
+	class GenerateReplay final
+	{
+	public:
+		/**
+		 * コンストラクタ
+		 */
+		GenerateReplay() = default;
+
+		/**
+		 * デストラクタ
+		 */
+		~GenerateReplay() = default;
+
+		/**
+		 * Record the parameter and the random seeds immediately before Generator::Generate
+		 * Generator::Generateの直前のパラメータと乱数の種を記録します
+		 */
+		void Capture(const GenerateParameter& parameter) noexcept;
+
+		/**
+		 * Create a parameter that reproduces the recorded generation
+		 * 記録した生成を再現するパラメータを生成します
+		 */
+		GenerateParameter Restore() const noexcept;
+
+		/**
+		 * ファイルに保存します
+		 * @return		trueなら成功
+		 */
+		bool Save(const std::string& path) const noexcept;
+
+		/**
+		 * ファイルから読み込みます
+		 * @return		trueなら成功
+		 */
+		bool Load(const std::string& path) noexcept;
+
+		/**
+		 * 記録したプラグインのバージョンを取得します
+		 */
+		uint32_t GetPluginVersion() const noexcept;
+
+		/**
+		 * 記録したプラグインのバージョン名を取得します
+		 */
+		const std::string& GetPluginVersionName() const noexcept;
+
+		/**
+		 * 記録した乱数の種を取得します
+		 */
+		const std::array<uint32_t, 4>& GetSeeds() const noexcept;
+
+	private:
+		GenerateParameter mParameter;
+		std::array<uint32_t, 4> mSeeds = { 0, 0, 0, 0 };
+		uint32_t mPluginVersion = 0;
+		std::string mPluginVersionName;
+	};
+}
+
+#include "GenerateReplay.inl"
@@ -0,0 +1,27 @@
+/**
+ * ダンジョン生成の再現情報に関するインラインファイル
+ *
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+
+namespace dungeon
+{
+	inline uint32_t GenerateReplay::GetPluginVersion() const noexcept
+	{
+		return mPluginVersion;
+	}
+
+	inline const std::string& GenerateReplay::GetPluginVersionName() const noexcept
+	{
+		return mPluginVersionName;
+	}
+
+	inline const std::array<uint32_t, 4>& GenerateReplay::GetSeeds() const noexcept
+	{
+		return mSeeds;
+	}
+}
@@ -10,6 +10,7 @@
 #include "GenerateParameter.h"
 #include "Debug/Config.h"
 #include "Debug/Debug.h"
+#include "Helper/AllocatedSize.h"
 #include "Helper/Finalizer.h"
 #include "Helper/Stopwatch.h"
 #include "Math/Math.h"
@@ -47,6 +48,7 @@ namespace dungeon
 		Identifier::ResetCounter();
 		mLastError = Error::Success;
 		mGenerateParameter = parameter;
+		mPhaseTime.fill(0.0);
 
 		// 生成
 		// TODO:リトライする仕組みの検討をして下さい。部屋の間隔を広げると成功する可能性が上がるかもしれません。
@@ -102,56 +104,116 @@ namespace dungeon
 		}
 		else
 		{
+			Stopwatch stopwatch;
 			UpdateMeshAttributes();
+			mPhaseTime[static_cast<size_t>(Phase::UpdateMeshAttributes)] += stopwatch.Lap();
 		}
 
 		return mLastError == Error::Success;
 	}
 
+	const char* Generator::GetPhaseName(const Phase phase) noexcept
+	{
+		static constexpr const char* names[] = {
+			"GenerateRooms",
+			"SeparateRooms",
+			"ExtractionAisles",
+			"AdjustRooms",
+			"ExpandSpace",
+			"MarkBranchIdAndDepthFromStart",
+			"DetectFloorHeightAndDepthFromStart",
+			"MissionGraph",
+			"GenerateVoxel",
+			"UpdateMeshAttributes",
+		};
+		static_assert(std::size(names) == static_cast<size_t>(Phase::Count));
+		return names[static_cast<size_t>(phase)];
+	}
+
+	const char* Generator::GetErrorName(const Error error) noexcept
+	{
+		switch (error)
+		{
+		case Error::Success: return "Success";
+		case Error::SeparateRoomsFailed: return "SeparateRoomsFailed";
+		case Error::TriangulationFailed: return "TriangulationFailed";
+		case Error::GateSearchFailed: return "GateSearchFailed";
+		case Error::RouteSearchFailed: return "RouteSearchFailed";
+		case Error::GoalPointIsOutsideGoalRange: return "GoalPointIsOutsideGoalRange";
+		default: return "Unknown";
+		}
+	}
+
 	bool Generator::GenerateImpl() noexcept
 	{
+		// フェーズ毎の時間を計測する
+		Stopwatch phaseStopwatch;
+		const auto lapPhase = [this, &phaseStopwatch](const Phase phase)
+			{
+				mPhaseTime[static_cast<size_t>(phase)] += phaseStopwatch.Lap();
+			};
+
 		// 部屋の生成
-		if (GenerateRooms() == false)
+		const bool generateRoomsResult = GenerateRooms();
+		lapPhase(Phase::GenerateRooms);
+		if (generateRoomsResult == false)
 			return false;
 
 		// 部屋の分離
-		if (SeparateRooms(2, 0) == SeparateRoomsResult::Failed)
+		const SeparateRoomsResult firstSeparateRoomsResult = SeparateRooms(2, 0);
+		lapPhase(Phase::SeparateRooms);
+		if (firstSeparateRoomsResult == SeparateRoomsResult::Failed)
 			return false;
 
 		SeparateRoomsResult separateRoomsResult;
 		uint8_t subPhase = 0;
 		do {
 			// 通路の生成
-			if (ExtractionAisles() == false)
+			const bool extractionAislesResult = ExtractionAisles();
+			lapPhase(Phase::ExtractionAisles);
+			if (extractionAislesResult == false)
 				return false;
 
 			// 開始部屋と終了部屋のサブレベルを配置する隙間を調整
 			if (AdjustedStartAndGoalSubLevel() == false)
+			{
+				lapPhase(Phase::AdjustRooms);
 				return false;
+			}
 
 			// 部屋の大きさを調整する
 			AdjustRoomSize();
+			lapPhase(Phase::AdjustRooms);
 
 			// 部屋の分離
 			separateRoomsResult = SeparateRooms(6, subPhase);
+			lapPhase(Phase::SeparateRooms);
 			if (separateRoomsResult == SeparateRoomsResult::Failed)
 				return false;
 			++subPhase;
 		} while (separateRoomsResult != SeparateRoomsResult::Completed);
 
 		// 全ての部屋が収まるように空間を拡張します
-		if (ExpandSpace() == false)
+		const bool expandSpaceResult = ExpandSpace();
+		if (expandSpaceResult)
+		{
+			// Pointの同期
+			AdjustPoints();
+		}
+		lapPhase(Phase::ExpandSpace);
+		if (expandSpaceResult == false)
 			return false;
 
-		// Pointの同期
-		AdjustPoints();
-
 		// ブランチIDと各部屋の深さの生成
-		if (MarkBranchIdAndDepthFromStart() == false)
+		const bool markBranchIdResult = MarkBranchIdAndDepthFromStart();
+		lapPhase(Phase::MarkBranchIdAndDepthFromStart);
+		if (markBranchIdResult == false)
 			return false;
 
 		// 階層情報と全体の深さの生成
-		if (DetectFloorHeightAndDepthFromStart() == false)
+		const bool detectFloorHeightResult = DetectFloorHeightAndDepthFromStart();
+		lapPhase(Phase::DetectFloorHeightAndDepthFromStart);
+		if (detectFloorHeightResult == false)
 			return false;
 
 		// 部屋と通路に意味付けする
@@ -191,11 +253,15 @@ namespace dungeon
 #endif
 		}
 
+		lapPhase(Phase::MissionGraph);
+
 		// スタート部屋とゴール部屋のコールバックを呼ぶ
 		InvokeRoomCallbacks();
 
 		// ボクセル情報を生成します
-		if (GenerateVoxel() == false)
+		const bool generateVoxelResult = GenerateVoxel();
+		lapPhase(Phase::GenerateVoxel);
+		if (generateVoxelResult == false)
 			return false;
 
 		return true;
@@ -2023,6 +2089,25 @@ namespace dungeon
 		return mVoxel->HasWestWall(position);
 	}
 
+	size_t Generator::GetAllocatedSize() const noexcept
+	{
+		// shared_ptrの制御ブロック
+		static constexpr size_t SharedControlBlockSize = sizeof(void*) * 2;
+
+		size_t size = sizeof(Generator);
+		if (mVoxel)
+			size += sizeof(Voxel) + SharedControlBlockSize + mVoxel->GetAllocatedSize();
+		size += GetNodeContainerAllocatedSize(mRooms) + mRooms.size() * (sizeof(Room) + SharedControlBlockSize);
+		size += GetContiguousContainerAllocatedSize(mFloorHeight);
+		size += GetContiguousContainerAllocatedSize(mAisles) + mAisles.size() * 2 * (sizeof(Point) + SharedControlBlockSize);
+		return size;
+	}
+
+	size_t Generator::GetPeakPathFinderAllocatedSize() const noexcept
+	{
+		return mVoxel ? mVoxel->GetPeakPathFinderAllocatedSize() : 0;
+	}
+
 	uint32_t Generator::CalculateCRC32(const uint32_t hash) const noexcept
 	{
 		return mVoxel ? mVoxel->CalculateCRC32(hash) : hash;
@@ -11,6 +11,7 @@
 #include "Math/PerlinNoise.h"
 #include "RoomGeneration/Aisle.h"
 #include "RoomGeneration/Room.h"
+#include <array>
 #include <atomic>
 #include <functional>
 #include <list>
@@ -45,6 +46,25 @@ namespace dungeon
 			GoalPointIsOutsideGoalRange,
 		};
 
+		/**
+		 * Generation phase for time measurement
+		 * 時間計測用の生成フェーズ
+		 */
+		enum class Phase : uint8_t
+		{
+			GenerateRooms,
+			SeparateRooms,
+			ExtractionAisles,
+			AdjustRooms,
+			ExpandSpace,
+			MarkBranchIdAndDepthFromStart,
+			DetectFloorHeightAndDepthFromStart,
+			MissionGraph,
+			GenerateVoxel,
+			UpdateMeshAttributes,
+			Count
+		};
+
 	public:
 		/**
 		 * コンストラクタ
@@ -70,6 +90,26 @@ namespace dungeon
 		 */
 		Error GetLastError() const noexcept;
 
+		/**
+		 * Get the time spent in the phase by the last Generate (including retries)
+		 * 直前のGenerateでフェーズに費やした時間を取得します（リトライを含む）
+		 * @param[in]	phase	生成フェーズ
+		 * @return		seconds
+		 */
+		double GetPhaseTime(const Phase phase) const noexcept;
+
+		/**
+		 * Get the name of the phase
+		 * フェーズ名を取得します
+		 */
+		static const char* GetPhaseName(const Phase phase) noexcept;
+
+		/**
+		 * Get the name of the error
+		 * エラー名を取得します
+		 */
+		static const char* GetErrorName(const Error error) noexcept;
+
 		/**
 		 * 生成パラメータを取得します
 		 */
@@ -324,6 +364,18 @@ namespace dungeon
 		 */
 		uint32_t CalculateCRC32(const uint32_t hash = 0xffffffffU) const noexcept;
 
+		/**
+		 * 生成結果（ボクセル、部屋、通路）が確保しているメモリ量を見積もります
+		 * @return 確保しているバイト数
+		 */
+		size_t GetAllocatedSize() const noexcept;
+
+		/**
+		 * 生成中にPathFinderが確保したメモリ量の最大値を取得します
+		 * @return 確保したバイト数の最大値
+		 */
+		size_t GetPeakPathFinderAllocatedSize() const noexcept;
+
 	private:
 		bool GenerateImpl() noexcept;
 		bool GenerateRooms() noexcept;
@@ -429,6 +481,8 @@ namespace dungeon
 
 		uint8_t mDeepestDepthFromStart = 0;
 
+		std::array<double, static_cast<size_t>(Phase::Count)> mPhaseTime{};
+
 		Error mLastError = Error::Success;
 	};
 }
@@ -15,6 +15,11 @@ namespace dungeon
 		return mLastError;
 	}
 
+	inline double Generator::GetPhaseTime(const Phase phase) const noexcept
+	{
+		return mPhaseTime[static_cast<size_t>(phase)];
+	}
+
 	inline void Generator::OnQueryParts(const std::function<void(QueryPartsType&)>& function) noexcept
 	{
 		mOnQueryParts = function;
@@ -0,0 +1,43 @@
+/**
+ * メモリ使用量の見積もりヘッダーファイル
+ *
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <cstddef>
+
+namespace dungeon
+{
+	/**
+	 * std::vector等の連続したコンテナが確保しているメモリ量を見積もります
+	 */
+	template<typename Container>
+	size_t GetContiguousContainerAllocatedSize(const Container& container) noexcept
+	{
+		return container.capacity() * sizeof(typename Container::value_type);
+	}
+
+	/**
+	 * std::unordered_map/std::unordered_setが確保しているメモリ量を見積もります
+	 * ノード（値と次ノードへのポインタ）とバケット配列を加算します
+	 */
+	template<typename Container>
+	size_t GetHashContainerAllocatedSize(const Container& container) noexcept
+	{
+		return container.size() * (sizeof(typename Container::value_type) + sizeof(void*) * 2)
+			+ container.bucket_count() * sizeof(void*);
+	}
+
+	/**
+	 * std::map/std::set/std::listが確保しているメモリ量を見積もります
+	 * ノード（値と3つのポインタと色情報）を加算します
+	 */
+	template<typename Container>
+	size_t GetNodeContainerAllocatedSize(const Container& container) noexcept
+	{
+		return container.size() * (sizeof(typename Container::value_type) + sizeof(void*) * 4);
+	}
+}
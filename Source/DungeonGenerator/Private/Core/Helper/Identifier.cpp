@@ -10,5 +10,5 @@
 
 namespace dungeon
 {
-	Identifier::IdentifierType Identifier::mCounter = 0;
+	thread_local Identifier::IdentifierType Identifier::mCounter = 0;
 }
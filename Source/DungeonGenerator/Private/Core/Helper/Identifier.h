@@ -65,7 +65,9 @@ namespace dungeon
 		static constexpr uint8_t BitCount = 2;
 		static constexpr uint8_t Shift = sizeof(mIdentifier) * 8 - BitCount;
 		static constexpr IdentifierType MaskCounter = static_cast<IdentifierType>(~0) >> BitCount;
-		static IdentifierType mCounter;
+		// Generators may run in parallel (seed sweeps), so each thread counts independently
+		// 生成器は並列に実行される事があるため（シード探索など）、スレッド毎にカウントします
+		static thread_local IdentifierType mCounter;
 
 		friend struct std::hash<Identifier>;
 	};
@@ -90,6 +90,15 @@ namespace dungeon
 		 */
 		void GetSeeds(uint32_t& x, uint32_t& y, uint32_t& z, uint32_t& w) const noexcept;
 
+		/**
+		 * Restore the random number seed obtained by GetSeeds
+		 * @param[in]	x		Random number seeds
+		 * @param[in]	y		Random number seeds
+		 * @param[in]	z		Random number seeds
+		 * @param[in]	w		Random number seeds
+		 */
+		void SetSeeds(const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t w) noexcept;
+
 	private:
 		/**
 		 * Get a random number of type uint32_t
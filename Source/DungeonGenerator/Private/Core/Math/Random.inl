@@ -69,6 +69,14 @@ namespace dungeon
 		w = mW;
 	}
 
+	inline void Random::SetSeeds(const uint32_t x, const uint32_t y, const uint32_t z, const uint32_t w) noexcept
+	{
+		mX = x;
+		mY = y;
+		mZ = z;
+		mW = w;
+	}
+
 	inline void Random::SetSeed(const uint32_t seed)
 	{
 		mX = 123456789;
@@ -7,6 +7,7 @@
  */
 
 #pragma once
+#include "../Helper/AllocatedSize.h"
 #include "../Helper/NonCopyable.h"
 #include "../Helper/Direction.h"
 #include "PathNodeSwitcher.h"
@@ -103,6 +104,12 @@ namespace dungeon
 		 */
 		size_t CloseSize() const noexcept;
 
+		/**
+		 * 検索中に確保しているメモリ量を見積もります
+		 * @return 確保しているバイト数
+		 */
+		size_t GetAllocatedSize() const noexcept;
+
 		/**
 		 * 最も有望な位置を取得します
 		 * @param[out]	nextKey				次に開く事ができるノードのキー
@@ -25,6 +25,16 @@ namespace dungeon
 		return mClose.size();
 	}
 
+	inline size_t PathFinder::GetAllocatedSize() const noexcept
+	{
+		size_t size = GetNodeContainerAllocatedSize(mOpen)
+			+ GetHashContainerAllocatedSize(mClose)
+			+ mNoEntryNodeSwitcher.GetAllocatedSize();
+		if (mResult)
+			size += sizeof(Result) + GetContiguousContainerAllocatedSize(mResult->mRoute);
+		return size;
+	}
+
 	inline uint64_t PathFinder::Hash(const FIntVector& location) noexcept
 	{
 		return
@@ -8,6 +8,7 @@ All Rights Reserved.
 */
 
 #pragma once
+#include "../Helper/AllocatedSize.h"
 #include <algorithm>
 #include <unordered_map>
 
@@ -161,6 +162,16 @@ namespace dungeon
 			mUsedNodeCache.clear();
 		}
 
+		/*
+		確保しているメモリ量を見積もります
+		*/
+		size_t GetAllocatedSize() const noexcept
+		{
+			return GetHashContainerAllocatedSize(mReserved)
+				+ GetHashContainerAllocatedSize(mUsed)
+				+ GetHashContainerAllocatedSize(mUsedNodeCache);
+		}
+
 	private:
 		std::unordered_map<uint64_t, Node> mReserved;
 		std::unordered_map<uint64_t, Node> mUsed;
@@ -130,6 +130,12 @@ namespace dungeon
 		 */
 		bool IsInvalidIdentifier() const noexcept;
 
+		/**
+		 * 種類、属性、識別子が同じか判定します
+		 * インクリメンタルな再生成で変化したグリッドを調べるために使います
+		 */
+		bool IsSameStructure(const Grid& other) const noexcept;
+
 		/**
 		 * 小道具を取得します
 		 */
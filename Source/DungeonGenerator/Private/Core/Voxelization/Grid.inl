@@ -167,6 +167,14 @@ namespace dungeon
 		return mIdentifier == InvalidIdentifier;
 	}
 
+	inline bool Grid::IsSameStructure(const Grid& other) const noexcept
+	{
+		return
+			mType == other.mType &&
+			mPack.mBitSet == other.mPack.mBitSet &&
+			mIdentifier == other.mIdentifier;
+	}
+
 	inline uint8_t Grid::GetDepthRatioFromStart() const noexcept
 	{
 		return mDepthRatioFromStart;
@@ -442,6 +442,15 @@ namespace dungeon
 #endif
 		}
 
+		// 検索中に確保したメモリ量の最大値を記録する（Commitで中間データは解放される）
+		{
+			const size_t allocatedSize = pathFinder.GetAllocatedSize();
+			size_t peak = mPeakPathFinderAllocatedSize.load(std::memory_order_relaxed);
+			while (peak < allocatedSize && !mPeakPathFinderAllocatedSize.compare_exchange_weak(peak, allocatedSize, std::memory_order_relaxed))
+			{
+			}
+		}
+
 #if WITH_EDITOR & JENKINS_FOR_DEVELOP
 		const size_t closeNodeSize = pathFinder.CloseSize();
 		const size_t openNodeSize = pathFinder.OpenSize();
@@ -903,6 +912,162 @@ namespace dungeon
 		return crc32;
 	}
 
+	bool Voxel::CollectChangedGrids(const Voxel& previous, std::vector<bool>& changed) const
+	{
+		if (mWidth != previous.mWidth || mDepth != previous.mDepth || mHeight != previous.mHeight)
+			return false;
+
+		const size_t size = static_cast<size_t>(mWidth) * mDepth * mHeight;
+		changed.assign(size, false);
+		for (size_t index = 0; index < size; ++index)
+		{
+			if (!mGrids.get()[index].IsSameStructure(previous.mGrids.get()[index]))
+				changed[index] = true;
+		}
+		return true;
+	}
+
+	bool Voxel::IsVisibilityTraversable(const Grid& grid) noexcept
+	{
+		return
+			grid.IsKindOfRoomType() ||
+			grid.IsKindOfAisleType() ||
+			grid.IsKindOfSlopeType();
+	}
+
+	bool Voxel::IsVisibilityTransitionOpen(const FIntVector& from, const uint8_t axis, const int32_t step) const noexcept
+	{
+		FIntVector to = from;
+		to[axis] += step;
+		if (!Contain(from) || !Contain(to))
+			return false;
+
+		const Grid& fromGrid = Get(from);
+		const Grid& toGrid = Get(to);
+		if (!IsVisibilityTraversable(fromGrid) || !IsVisibilityTraversable(toGrid))
+			return false;
+
+		switch (axis)
+		{
+		case 0:
+			return step > 0
+				? !fromGrid.HasEastWall() && !toGrid.HasWestWall()
+				: !fromGrid.HasWestWall() && !toGrid.HasEastWall();
+		case 1:
+			return step > 0
+				? !fromGrid.HasSouthWall() && !toGrid.HasNorthWall()
+				: !fromGrid.HasNorthWall() && !toGrid.HasSouthWall();
+		default:
+			return step > 0
+				? !fromGrid.HasCeiling() && !toGrid.HasFloor()
+				: !fromGrid.HasFloor() && !toGrid.HasCeiling();
+		}
+	}
+
+	/*
+	 * グリッド中心から中心への線分なので、k番目の境界を越える時刻は (2k+1) / (2|delta|) になります。
+	 * 時刻を整数の分数のまま比較するので、辺や頂点を通過する場合も誤差無く判定できます。
+	 */
+	bool Voxel::TraceVisibility(const FIntVector& start, const FIntVector& goal) const noexcept
+	{
+		if (!Contain(start) || !Contain(goal))
+			return false;
+
+		const FIntVector delta = goal - start;
+		if (delta == FIntVector::ZeroValue)
+			return true;
+
+		int32_t steps[3];
+		int64_t numerators[3];
+		int64_t denominators[3];
+		int32_t remainingCrossings[3];
+		for (uint8_t axis = 0; axis < 3; ++axis)
+		{
+			steps[axis] = delta[axis] > 0 ? 1 : -1;
+			numerators[axis] = 1;
+			denominators[axis] = 2 * static_cast<int64_t>(std::abs(delta[axis]));
+			remainingCrossings[axis] = std::abs(delta[axis]);
+		}
+
+		// 同時に境界を越える軸をいずれかの順序で通過できるか調べる
+		const auto isPathOpen = [this, &steps](FIntVector cell, const uint8_t* order, const uint8_t count)
+			{
+				for (uint8_t i = 0; i < count; ++i)
+				{
+					const uint8_t axis = order[i];
+					if (!IsVisibilityTransitionOpen(cell, axis, steps[axis]))
+						return false;
+					cell[axis] += steps[axis];
+				}
+				return true;
+			};
+
+		FIntVector current = start;
+		while (remainingCrossings[0] + remainingCrossings[1] + remainingCrossings[2] > 0)
+		{
+			// 最も早く境界を越える軸を探す
+			uint8_t first = 3;
+			for (uint8_t axis = 0; axis < 3; ++axis)
+			{
+				if (remainingCrossings[axis] <= 0)
+					continue;
+				if (first == 3 || numerators[axis] * denominators[first] < numerators[first] * denominators[axis])
+					first = axis;
+			}
+
+			uint8_t axes[3];
+			uint8_t axisCount = 0;
+			for (uint8_t axis = 0; axis < 3; ++axis)
+			{
+				if (remainingCrossings[axis] <= 0)
+					continue;
+				if (numerators[axis] * denominators[first] == numerators[first] * denominators[axis])
+					axes[axisCount++] = axis;
+			}
+
+			bool open;
+			if (axisCount == 1)
+			{
+				open = IsVisibilityTransitionOpen(current, axes[0], steps[axes[0]]);
+			}
+			else if (axisCount == 2)
+			{
+				// 辺を通過する
+				const uint8_t reverse[2] = { axes[1], axes[0] };
+				open = isPathOpen(current, axes, 2) || isPathOpen(current, reverse, 2);
+			}
+			else
+			{
+				// 頂点を通過する
+				static constexpr uint8_t orders[6][3] = {
+					{ 0, 1, 2 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 }, { 2, 1, 0 }
+				};
+				open = false;
+				for (const auto& order : orders)
+				{
+					if (isPathOpen(current, order, 3))
+					{
+						open = true;
+						break;
+					}
+				}
+			}
+			if (!open)
+				return false;
+
+			for (uint8_t i = 0; i < axisCount; ++i)
+			{
+				const uint8_t axis = axes[i];
+				current[axis] += steps[axis];
+				numerators[axis] += 2;
+				--remainingCrossings[axis];
+			}
+		}
+
+		check(current == goal);
+		return true;
+	}
+
 	void Voxel::GenerateImageForDebug(const std::string& filename) const
 	{
 #if defined(DEBUG_GENERATE_BITMAP_FILE)
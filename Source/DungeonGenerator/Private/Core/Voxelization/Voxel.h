@@ -365,7 +365,51 @@ namespace dungeon
 		 */
 		uint32_t CalculateCRC32(const uint32_t hash = 0xffffffffU) const noexcept;
 
+		/**
+		 * 前回のボクセルと比べて種類、属性、識別子が変化したグリッドを調べます
+		 * @param[in]	previous	前回のボクセル
+		 * @param[out]	changed		グリッドの番号ごとに変化したらtrue
+		 * @return		大きさが違う場合はfalse。全てのグリッドが変化したとみなして下さい
+		 */
+		bool CollectChangedGrids(const Voxel& previous, std::vector<bool>& changed) const;
+
+		/**
+		 * 2つのグリッドの中心を結ぶ視線が壁、床、天井に遮られずに通るか調べます
+		 * Amanatides-Wooの3D DDAで線分が通過するグリッドを一度ずつ訪れます。
+		 * 線分がグリッドの辺や頂点を通過する場合は、いずれかの軸の順序で通過できれば通れるとみなします。
+		 * @param[in]	start	開始グリッドの座標
+		 * @param[in]	goal	終了グリッドの座標
+		 * @return		trueならば視線が通る
+		 */
+		bool TraceVisibility(const FIntVector& start, const FIntVector& goal) const noexcept;
+
+		/**
+		 * 隣接するグリッドへ視線が通過できるか調べます
+		 * @param[in]	from	移動元の座標
+		 * @param[in]	axis	移動する軸（0:X 1:Y 2:Z）
+		 * @param[in]	step	移動方向（1または-1）
+		 * @return		trueならば通過できる
+		 */
+		bool IsVisibilityTransitionOpen(const FIntVector& from, const uint8_t axis, const int32_t step) const noexcept;
+
+		/**
+		 * グリッドが確保しているメモリ量を取得します
+		 * @return 確保しているバイト数
+		 */
+		size_t GetAllocatedSize() const noexcept;
+
+		/**
+		 * 通路検索中にPathFinderが確保したメモリ量の最大値を取得します
+		 * @return 確保したバイト数の最大値
+		 */
+		size_t GetPeakPathFinderAllocatedSize() const noexcept;
+
 	private:
+		/**
+		 * 視線が通過できるグリッドか調べます
+		 */
+		static bool IsVisibilityTraversable(const Grid& grid) noexcept;
+
 		/**
 		 * 通行可能か調べます
 		 * @param[in]	location		座標
@@ -469,6 +513,9 @@ namespace dungeon
 		uint32_t mDepth;
 		uint32_t mHeight;
 
+		// FindAisleは並列に実行されるためatomicで更新します
+		mutable std::atomic<size_t> mPeakPathFinderAllocatedSize = 0;
+
 		Error mLastError = Error::Success;
 	};
 }
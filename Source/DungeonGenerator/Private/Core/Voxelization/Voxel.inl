@@ -87,6 +87,16 @@ namespace dungeon
 		return mLastError;
 	}
 
+	inline size_t Voxel::GetAllocatedSize() const noexcept
+	{
+		return static_cast<size_t>(mWidth) * mDepth * mHeight * sizeof(Grid);
+	}
+
+	inline size_t Voxel::GetPeakPathFinderAllocatedSize() const noexcept
+	{
+		return mPeakPathFinderAllocatedSize.load(std::memory_order_relaxed);
+	}
+
 	inline bool Voxel::Contain(const FIntVector& location) const noexcept
 	{
 		return
@@ -0,0 +1,207 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonActorPool.h"
+#include "DungeonGenerateBase.h"
+#include "MainLevel/DungeonComponentActivatorComponent.h"
+#include <Components/HierarchicalInstancedStaticMeshComponent.h>
+#include <Engine/StaticMesh.h>
+#include <Engine/StaticMeshActor.h>
+#include <Misc/EngineVersionComparison.h>
+
+namespace
+{
+	template<typename T>
+	T* PopValid(TArray<TObjectPtr<T>>& objects)
+	{
+		while (!objects.IsEmpty())
+		{
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+			T* object = objects.Pop(EAllowShrinking::No);
+#else
+			T* object = objects.Pop(false);
+#endif
+			if (IsValid(object))
+				return object;
+		}
+		return nullptr;
+	}
+}
+
+/*
+ * 生成時に作った結合メッシュのように一度しか使わないメッシュを持つアクターは
+ * 再利用される事が無いので返却せずに破棄させます。
+ */
+bool FDungeonActorPool::ReleaseStaticMeshActor(AStaticMeshActor* actor)
+{
+	if (!IsValid(actor) || actor->GetClass() != AStaticMeshActor::StaticClass())
+		return false;
+
+	UStaticMeshComponent* staticMeshComponent = actor->GetStaticMeshComponent();
+	UStaticMesh* staticMesh = IsValid(staticMeshComponent) ? staticMeshComponent->GetStaticMesh() : nullptr;
+	if (!IsValid(staticMesh) || staticMesh->HasAnyFlags(RF_Transient))
+		return false;
+
+	if (auto* dungeonComponentActivatorComponent = actor->FindComponentByClass<UDungeonComponentActivatorComponent>())
+		dungeonComponentActivatorComponent->ResetForPool();
+
+	// タグを外してDestroySpawnedActorsの対象から外します
+	actor->Tags.Remove(ADungeonGenerateBase::GetDungeonGeneratorTag());
+	actor->SetActorHiddenInGame(true);
+	actor->SetActorEnableCollision(false);
+
+	mStaticMeshActors.FindOrAdd(staticMesh).Actors.Add(actor);
+	++mNum;
+	return true;
+}
+
+AStaticMeshActor* FDungeonActorPool::AcquireStaticMeshActor(const UStaticMesh* staticMesh)
+{
+	FDungeonPooledStaticMeshActors* pooled = mStaticMeshActors.Find(const_cast<UStaticMesh*>(staticMesh));
+	if (pooled == nullptr)
+		return nullptr;
+
+	const int32 count = pooled->Actors.Num();
+	AStaticMeshActor* actor = PopValid(pooled->Actors);
+	mNum -= count - pooled->Actors.Num();
+	if (actor == nullptr)
+		return nullptr;
+
+	actor->Tags.AddUnique(ADungeonGenerateBase::GetDungeonGeneratorTag());
+	return actor;
+}
+
+bool FDungeonActorPool::ReleaseInstancedStaticMeshComponent(UInstancedStaticMeshComponent* component)
+{
+	if (!IsValid(component))
+		return false;
+
+	UStaticMesh* staticMesh = component->GetStaticMesh();
+	if (!IsValid(staticMesh))
+		return false;
+
+	// 登録したままインスタンスだけ消すので、描画も衝突もしません
+	component->ClearInstances();
+
+	ComponentMap& componentMap = Cast<UHierarchicalInstancedStaticMeshComponent>(component) ? mHierarchicalInstancedStaticMeshComponents : mInstancedStaticMeshComponents;
+	componentMap.FindOrAdd(staticMesh).Components.Add(component);
+	++mNum;
+	return true;
+}
+
+UInstancedStaticMeshComponent* FDungeonActorPool::AcquireInstancedStaticMeshComponent(const UStaticMesh* staticMesh, const bool hierarchical)
+{
+	return AcquireInstancedStaticMeshComponent(hierarchical ? mHierarchicalInstancedStaticMeshComponents : mInstancedStaticMeshComponents, staticMesh);
+}
+
+UInstancedStaticMeshComponent* FDungeonActorPool::AcquireInstancedStaticMeshComponent(ComponentMap& componentMap, const UStaticMesh* staticMesh)
+{
+	FDungeonPooledInstancedStaticMeshComponents* pooled = componentMap.Find(const_cast<UStaticMesh*>(staticMesh));
+	if (pooled == nullptr)
+		return nullptr;
+
+	const int32 count = pooled->Components.Num();
+	UInstancedStaticMeshComponent* component = PopValid(pooled->Components);
+	mNum -= count - pooled->Components.Num();
+	return component;
+}
+
+void FDungeonActorPool::Trim(const double budgetSeconds)
+{
+	if (mNum <= 0)
+		return;
+
+	const double startTime = FPlatformTime::Seconds();
+	do
+	{
+		if (!TrimOne())
+		{
+			// 無効になったオブジェクトしか残っていません
+			mNum = 0;
+			break;
+		}
+	} while (mNum > 0 && FPlatformTime::Seconds() - startTime < budgetSeconds);
+}
+
+bool FDungeonActorPool::TrimOne()
+{
+	for (auto iterator = mStaticMeshActors.CreateIterator(); iterator; ++iterator)
+	{
+		TArray<TObjectPtr<AStaticMeshActor>>& actors = iterator.Value().Actors;
+		const int32 count = actors.Num();
+		AStaticMeshActor* actor = PopValid(actors);
+		mNum -= count - actors.Num();
+		if (actors.IsEmpty())
+			iterator.RemoveCurrent();
+		if (actor)
+		{
+			actor->Destroy();
+			return true;
+		}
+	}
+
+	for (ComponentMap* componentMap : { &mInstancedStaticMeshComponents, &mHierarchicalInstancedStaticMeshComponents })
+	{
+		for (auto iterator = componentMap->CreateIterator(); iterator; ++iterator)
+		{
+			TArray<TObjectPtr<UInstancedStaticMeshComponent>>& components = iterator.Value().Components;
+			const int32 count = components.Num();
+			UInstancedStaticMeshComponent* component = PopValid(components);
+			mNum -= count - components.Num();
+			if (components.IsEmpty())
+				iterator.RemoveCurrent();
+			if (component)
+			{
+				component->DestroyComponent();
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+void FDungeonActorPool::DestroyAll()
+{
+	for (auto& pair : mStaticMeshActors)
+	{
+		for (AStaticMeshActor* actor : pair.Value.Actors)
+		{
+			if (IsValid(actor))
+				actor->Destroy();
+		}
+	}
+	mStaticMeshActors.Empty();
+
+	for (ComponentMap* componentMap : { &mInstancedStaticMeshComponents, &mHierarchicalInstancedStaticMeshComponents })
+	{
+		for (auto& pair : *componentMap)
+		{
+			for (UInstancedStaticMeshComponent* component : pair.Value.Components)
+			{
+				if (IsValid(component))
+					component->DestroyComponent();
+			}
+		}
+		componentMap->Empty();
+	}
+
+	mNum = 0;
+}
+
+SIZE_T FDungeonActorPool::GetAllocatedSize() const
+{
+	SIZE_T size = mStaticMeshActors.GetAllocatedSize()
+		+ mInstancedStaticMeshComponents.GetAllocatedSize()
+		+ mHierarchicalInstancedStaticMeshComponents.GetAllocatedSize();
+	for (const auto& pair : mStaticMeshActors)
+		size += pair.Value.Actors.GetAllocatedSize();
+	for (const auto& pair : mInstancedStaticMeshComponents)
+		size += pair.Value.Components.GetAllocatedSize();
+	for (const auto& pair : mHierarchicalInstancedStaticMeshComponents)
+		size += pair.Value.Components.GetAllocatedSize();
+	return size;
+}
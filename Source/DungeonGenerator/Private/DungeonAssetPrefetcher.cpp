@@ -0,0 +1,131 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonAssetPrefetcher.h"
+#include "Core/Debug/Debug.h"
+#include <Engine/AssetManager.h>
+#include <Engine/StreamableManager.h>
+#include <HAL/PlatformTime.h>
+
+FDungeonAssetPrefetcher::~FDungeonAssetPrefetcher()
+{
+	if (mHandle.IsValid())
+		mHandle->CancelHandle();
+	if (mPreviousHandle.IsValid())
+		mPreviousHandle->CancelHandle();
+}
+
+/*
+ * 読み込み済みのアセットも要求に含めるのは、ハンドルで参照を保持してガベージコレクションで解放させないためです。
+ */
+void FDungeonAssetPrefetcher::Prefetch(const TArray<FSoftObjectPath>& blueprintPaths)
+{
+	// 新しい要求が参照を保持するまで前回のハンドルを残します
+	if (mPreviousHandle.IsValid())
+		mPreviousHandle->CancelHandle();
+	mPreviousHandle = mHandle;
+	mHandle.Reset();
+
+	mRequestedCount = 0;
+	mResidentCount = 0;
+	mWaitedSpawnCount = 0;
+
+	TArray<FSoftObjectPath> classPaths;
+	classPaths.Reserve(blueprintPaths.Num());
+	for (const FSoftObjectPath& blueprintPath : blueprintPaths)
+	{
+		const FSoftObjectPath classPath = ToClassPath(blueprintPath);
+		if (classPath.IsNull() || classPaths.Contains(classPath))
+			continue;
+
+		classPaths.Add(classPath);
+		if (classPath.ResolveObject())
+			++mResidentCount;
+	}
+	mRequestedCount = classPaths.Num();
+
+	if (classPaths.IsEmpty())
+	{
+		mPreviousHandle.Reset();
+		return;
+	}
+
+	mStartTime = FPlatformTime::Seconds();
+	mHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		MoveTemp(classPaths),
+		FStreamableDelegate::CreateLambda([weakThis = weak_from_this()]()
+			{
+				if (const auto prefetcher = weakThis.lock())
+					prefetcher->OnPrefetched();
+			}
+		),
+		FStreamableManager::AsyncLoadHighPriority
+	);
+}
+
+void FDungeonAssetPrefetcher::OnPrefetched()
+{
+	if (mPreviousHandle.IsValid())
+	{
+		mPreviousHandle->CancelHandle();
+		mPreviousHandle.Reset();
+	}
+
+	DUNGEON_GENERATOR_LOG(TEXT("Asset prefetch: %d requested, %d resident, %d streamed in %.3f seconds, %d spawns waited")
+		, mRequestedCount
+		, mResidentCount
+		, mRequestedCount - mResidentCount
+		, FPlatformTime::Seconds() - mStartTime
+		, mWaitedSpawnCount
+	);
+}
+
+void FDungeonAssetPrefetcher::LoadClass(const FSoftObjectPath& blueprintPath, TFunction<void(UClass*)>&& onLoaded)
+{
+	if (!LoadClassAsync(blueprintPath, MoveTemp(onLoaded)))
+	{
+		++mWaitedSpawnCount;
+		DUNGEON_GENERATOR_VERBOSE(TEXT("Asset prefetch: %s is not resident yet, spawn is deferred"), *blueprintPath.ToString());
+	}
+}
+
+bool FDungeonAssetPrefetcher::LoadClassAsync(const FSoftObjectPath& blueprintPath, TFunction<void(UClass*)>&& onLoaded)
+{
+	const FSoftObjectPath classPath = ToClassPath(blueprintPath);
+	if (classPath.IsNull())
+	{
+		onLoaded(nullptr);
+		return true;
+	}
+
+	if (UClass* actorClass = Cast<UClass>(classPath.ResolveObject()))
+	{
+		onLoaded(actorClass);
+		return true;
+	}
+
+	UAssetManager::GetStreamableManager().RequestAsyncLoad(
+		classPath,
+		FStreamableDelegate::CreateLambda([classPath, onLoaded = MoveTemp(onLoaded)]()
+			{
+				onLoaded(Cast<UClass>(classPath.ResolveObject()));
+			}
+		),
+		FStreamableManager::AsyncLoadHighPriority
+	);
+	return false;
+}
+
+FSoftObjectPath FDungeonAssetPrefetcher::ToClassPath(const FSoftObjectPath& blueprintPath)
+{
+	if (!blueprintPath.IsValid())
+		return FSoftObjectPath();
+
+	const FString path = blueprintPath.ToString();
+	if (path.EndsWith(TEXT("_C")))
+		return blueprintPath;
+	return FSoftObjectPath(path + TEXT("_C"));
+}
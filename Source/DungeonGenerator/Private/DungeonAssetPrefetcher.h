@@ -0,0 +1,77 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <memory>
+
+struct FStreamableHandle;
+
+/**
+ * Streams in the soft referenced actor blueprints that the generated layout will spawn.
+ * The prefetch is requested as one asynchronous batch right after the core generation,
+ * and the world is built with the assets that are already resident.
+ * Spawns whose class is not resident yet wait for streaming instead of loading synchronously.
+ *
+ * 生成したレイアウトがスポーンするソフト参照のアクターのブループリントを読み込みます。
+ * コアの生成の直後に一つの非同期の読み込みとして要求し、ワールドは読み込み済みのアセットで構築します。
+ * クラスがまだ読み込まれていないスポーンは、同期読み込みをせずに読み込みの完了を待ちます。
+ */
+class FDungeonAssetPrefetcher final : public std::enable_shared_from_this<FDungeonAssetPrefetcher>
+{
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	FDungeonAssetPrefetcher() = default;
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonAssetPrefetcher();
+
+	/**
+	 * ブループリントの非同期読み込みを開始します
+	 * 前回の読み込みのハンドルは読み込みが終わるまで保持するので、再生成で同じアセットは解放されません
+	 * @param[in]	blueprintPaths		ブループリントのパス
+	 */
+	void Prefetch(const TArray<FSoftObjectPath>& blueprintPaths);
+
+	/**
+	 * ブループリントのクラスを取得して関数を呼び出します
+	 * 読み込み済みなら直ちに、そうでなければ読み込みの完了後に呼び出します
+	 * @param[in]	blueprintPath		ブループリントのパス
+	 * @param[in]	onLoaded			クラスを受け取る関数（読み込みに失敗した場合はnullptr）
+	 */
+	void LoadClass(const FSoftObjectPath& blueprintPath, TFunction<void(UClass*)>&& onLoaded);
+
+	/**
+	 * ブループリントのクラスを取得して関数を呼び出します
+	 * 読み込み済みなら直ちに、そうでなければ読み込みの完了後に呼び出します
+	 * 読み込みを待ったスポーンを数えないので、ジェネレーターの読み込みが無い場合にだけ使って下さい
+	 * @param[in]	blueprintPath		ブループリントのパス
+	 * @param[in]	onLoaded			クラスを受け取る関数（読み込みに失敗した場合はnullptr）
+	 * @return		直ちに呼び出したらtrue
+	 */
+	static bool LoadClassAsync(const FSoftObjectPath& blueprintPath, TFunction<void(UClass*)>&& onLoaded);
+
+	/**
+	 * ブループリントのパスをクラスのパスに変換します
+	 */
+	static FSoftObjectPath ToClassPath(const FSoftObjectPath& blueprintPath);
+
+private:
+	void OnPrefetched();
+
+	TSharedPtr<FStreamableHandle> mHandle;
+	TSharedPtr<FStreamableHandle> mPreviousHandle;
+	double mStartTime = 0.0;
+	int32 mRequestedCount = 0;
+	int32 mResidentCount = 0;
+	int32 mWaitedSpawnCount = 0;
+};
@@ -9,6 +9,8 @@
  */
 
 #include "DungeonGenerateActor.h"
+#include "DungeonSimplifiedCollisionBuilder.h"
+#include "DungeonSimplifiedCollisionComponent.h"
 #include "Core/Generator.h"
 #include "Core/Debug/BuildInformation.h"
 #include "Core/Debug/Debug.h"
@@ -17,6 +19,7 @@
 #include "Core/Math/Vector.h"
 #include "Core/Voxelization/Grid.h"
 #include "Core/Voxelization/Voxel.h"
+#include "MainLevel/DungeonComponentActivatorComponent.h"
 #include "MainLevel/DungeonMainLevelScriptActor.h"
 #include "PluginInformation.h"
 #include "Parameter/DungeonGenerateParameter.h"
@@ -24,7 +27,14 @@
 #include <Components/HierarchicalInstancedStaticMeshComponent.h>
 #include <Engine/LevelStreaming.h>
 #include <Engine/NetDriver.h>
+#include <Engine/StaticMeshActor.h>
+#include <EngineUtils.h>
+#include <HAL/IConsoleManager.h>
 #include <Kismet/GameplayStatics.h>
+#include <Misc/EngineVersionComparison.h>
+#include <NavigationSystem.h>
+#include <NavMesh/NavMeshBoundsVolume.h>
+#include <NavMesh/RecastNavMesh.h>
 
 #include "Core/Debug/MeasureTime.h"
 
@@ -35,6 +45,23 @@
 
 #define LOCTEXT_NAMESPACE "ADungeonGenerateActor"
 
+namespace
+{
+	// 床の厚みを含めるためにダーティ領域を下方向に広げる距離(cm)
+	constexpr double NavigationDirtyAreaMarginZ = 50.0;
+
+	// 簡略化したコリジョンに置き換えるタイルをまとめる結合メッシュのキーのビット
+	constexpr uint64 CollisionReplacedMergedMeshKeyBit = 1ull << 62;
+
+	TAutoConsoleVariable<int32> CVarValidateSimplifiedCollision(
+		TEXT("DungeonGenerator.ValidateSimplifiedCollision"),
+		0,
+		TEXT("Compares the simplified collision boxes with the bounds of the placed floor, wall and roof tiles after generation.\n")
+		TEXT("0: off, 1: log tiles that no box overlaps or that a trace through the tile does not hit"),
+		ECVF_Default
+	);
+}
+
 ADungeonGenerateActor::ADungeonGenerateActor(const FObjectInitializer& initializer)
 	: Super(initializer)
 	, BuildJobTag(TEXT(DUNGEON_GENERATOR_PLUGIN_VERSION_NAME "-" JENKINS_JOB_TAG))
@@ -111,6 +138,8 @@ void ADungeonGenerateActor::Tick(float DeltaSeconds)
 	// Calling the parent class
 	Super::Tick(DeltaSeconds);
 
+	ProcessInstancedMeshTreeBuilds();
+	ProcessNavigationBuild();
 
 #if WITH_EDITORONLY_DATA && (UE_BUILD_SHIPPING == 0)
 	DrawDebugInformation();
@@ -135,45 +164,110 @@ void ADungeonGenerateActor::OnPostDungeonGeneration(const bool result)
 	}
 }
 
+bool ADungeonGenerateActor::UseVoxelRoomOccupancy() const
+{
+	return RoomOccupancyMethod == EDungeonRoomOccupancyMethod::VoxelLookup;
+}
+
 
 ////////// InstancedStaticMesh //////////
-uint32 ADungeonGenerateActor::InstancedMeshHash(const FVector& position, const double quantizationSize)
+/*
+ * クラスターの3次元のセル座標を各軸21ビットに詰めます。
+ * 負の座標も扱えるように床関数でセル座標を求めています。
+ */
+uint64 ADungeonGenerateActor::InstancedMeshClusterKey(const FVector& position) const
 {
-	uint32 x = static_cast<uint32>(position.X / quantizationSize);
-	uint32 y = static_cast<uint32>(position.Y / quantizationSize);
-	y <<= 16;
-	x &= 0xFFFF;
-	return y | x;
+	const auto pack = [](const double value, const double origin, const double size) -> uint64
+	{
+		constexpr uint64 AxisMask = (1ull << 21) - 1;
+		return static_cast<uint64>(FMath::FloorToInt64((value - origin) / size)) & AxisMask;
+	};
+	return
+		pack(position.X, mInstancedMeshClusterOrigin.X, mInstancedMeshClusterSize.X) |
+		(pack(position.Y, mInstancedMeshClusterOrigin.Y, mInstancedMeshClusterSize.Y) << 21) |
+		(pack(position.Z, mInstancedMeshClusterOrigin.Z, mInstancedMeshClusterSize.Z) << 42);
+}
+
+/*
+ * 各軸21ビットのセル座標を符号拡張して戻し、セルの中心を求めます
+ */
+FVector ADungeonGenerateActor::InstancedMeshClusterCenter(const uint64 key) const
+{
+	const auto unpack = [key](const int32 shift) -> double
+	{
+		constexpr int64 AxisSign = 1ll << 20;
+		const int64 value = static_cast<int64>((key >> shift) & ((1ull << 21) - 1));
+		return static_cast<double>((value ^ AxisSign) - AxisSign) + 0.5;
+	};
+	return mInstancedMeshClusterOrigin + FVector(unpack(0), unpack(21), unpack(42)) * mInstancedMeshClusterSize;
+}
+
+FVector ADungeonGenerateActor::ComputeInstancedMeshClusterSize() const
+{
+	constexpr int32 DefaultHorizontalClusterGridCount = 5;
+
+	if (!IsValid(DungeonGenerateParameter))
+		return FVector(25 * 100);
+
+	const FDungeonGridSize gridSize = DungeonGenerateParameter->GetGridSize();
+	const int32 x = InstancedMeshClusterGridSize.X > 0 ? InstancedMeshClusterGridSize.X : DefaultHorizontalClusterGridCount;
+	const int32 y = InstancedMeshClusterGridSize.Y > 0 ? InstancedMeshClusterGridSize.Y : DefaultHorizontalClusterGridCount;
+	const int32 z = InstancedMeshClusterGridSize.Z > 0 ? InstancedMeshClusterGridSize.Z : FMath::Max(DungeonGenerateParameter->GetRoomHeight().Max, 1);
+	return FVector(
+		FMath::Max(gridSize.HorizontalSize * x, 1.f),
+		FMath::Max(gridSize.HorizontalSize * y, 1.f),
+		FMath::Max(gridSize.VerticalSize * z, 1.f)
+	);
 }
 
 void ADungeonGenerateActor::BeginInstanceTransaction()
 {
+	// パーティションのセルは生成後に決まるので、揃えるまでは設定した大きさのセルを使います
+	if (!mInstancedMeshClusterAlignedToPartition)
+	{
+		mInstancedMeshClusterOrigin = FVector::ZeroVector;
+		mInstancedMeshClusterSize = ComputeInstancedMeshClusterSize();
+	}
+
 	for (auto& chunk : mInstancedMeshCluster)
 	{
 		chunk.Value.BeginTransaction();
 	}
+
+	mMergedMeshCluster.Reset();
 }
 
 void ADungeonGenerateActor::AddInstance(UStaticMesh* staticMesh, const FTransform& transform, const EDungeonMeshGenerationMethod meshGenerationMethod)
 {
+	if (CVarValidateSimplifiedCollision.GetValueOnGameThread() > 0 && IsValid(staticMesh) && mCollisionReplacedMeshes.Contains(staticMesh))
+		mCollisionReplacedTileBounds.Add(staticMesh->GetBounds().GetBox().TransformBy(transform).ShiftBy(-GetActorLocation()));
+
+	if (meshGenerationMethod == EDungeonMeshGenerationMethod::MergedStaticMesh)
+	{
+		AddMergedMesh(staticMesh, transform);
+		return;
+	}
+
 	check(
 		meshGenerationMethod == EDungeonMeshGenerationMethod::InstancedStaticMesh ||
 		meshGenerationMethod == EDungeonMeshGenerationMethod::HierarchicalInstancedStaticMesh
 	);
 
-	double quantizationSize = 25 * 100;
-	if (mParameter)
-		quantizationSize = mParameter->GetGridSize().HorizontalSize * 5.f;
-	const uint32 hash = InstancedMeshHash(transform.GetTranslation(), quantizationSize);
-	auto& chunk = mInstancedMeshCluster.FindOrAdd(hash);
-	if (meshGenerationMethod == EDungeonMeshGenerationMethod::InstancedStaticMesh)
+	// 変化していないグリッドの前回のインスタンスはそのまま残す
+	const bool hierarchical = meshGenerationMethod == EDungeonMeshGenerationMethod::HierarchicalInstancedStaticMesh;
+	if (ReuseIncrementalRegenerationInstance(staticMesh, transform, hierarchical))
+		return;
+
+	const uint64 key = InstancedMeshClusterKey(transform.GetTranslation());
+	auto& chunk = mInstancedMeshCluster.FindOrAdd(key);
+	if (!hierarchical)
 	{
-		auto* component = chunk.FindOrCreateInstance(this, staticMesh);
+		auto* component = chunk.FindOrCreateInstance(this, staticMesh, &mActorPool);
 		component->AddInstance(transform);
 	}
 	else
 	{
-		auto* component = chunk.FindOrCreateHierarchicalInstance(this, staticMesh);
+		auto* component = chunk.FindOrCreateHierarchicalInstance(this, staticMesh, &mActorPool);
 		component->AddInstance(transform);
 	}
 }
@@ -184,24 +278,219 @@ void ADungeonGenerateActor::EndInstanceTransaction()
 
 	mInstancedMeshCluster.Shrink();
 
+	mPendingInstancedMeshTreeBuilds.Reset();
+	mBuildingInstancedMeshTrees.Reset();
 	for (auto& chunk : mInstancedMeshCluster)
 	{
-		chunk.Value.EndTransaction();
+		chunk.Value.EndTransaction(mPendingInstancedMeshTreeBuilds);
+		chunk.Value.DisableCollision(mCollisionReplacedMeshes);
 	}
 
 	if (mInstancedMeshCullDistance.Min < mInstancedMeshCullDistance.Max)
 		ApplyInstancedMeshCullDistance();
 
+	BuildMergedMeshes();
+	ScheduleInstancedMeshTreeBuilds();
+
 	MEASURE_TIME_LAP(stopwatch, TEXT("EndInstanceTransaction Time"));
 }
 
+void ADungeonGenerateActor::ScheduleInstancedMeshTreeBuilds()
+{
+	const UWorld* world = GetWorld();
+	if (world && world->IsGameWorld())
+	{
+		// ゲーム中はツリー構築をTickで予算の範囲に分散して開始します
+		if (mInstancedMeshReady)
+		{
+			mInstancedMeshReady = false;
+			mDefaultTickInterval = GetActorTickInterval();
+			SetActorTickInterval(0.f);
+		}
+	}
+	else
+	{
+		// エディタではその場で全ての非同期構築を開始します
+		for (const auto& component : mPendingInstancedMeshTreeBuilds)
+		{
+			if (component.IsValid())
+				component->BuildTreeIfOutdated(true, false);
+		}
+		mPendingInstancedMeshTreeBuilds.Reset();
+	}
+}
+
 void ADungeonGenerateActor::DestroyAllInstance()
 {
-	for (auto& chunk : mInstancedMeshCluster)
+	// 破棄したレイアウトの生成成功は通知しません
+	mGenerationSuccessDeferred = false;
+	mPendingInstancedMeshTreeBuilds.Reset();
+	mBuildingInstancedMeshTrees.Reset();
+	if (!mInstancedMeshReady)
 	{
-		chunk.Value.DestroyAll();
+		mInstancedMeshReady = true;
+		SetActorTickInterval(mDefaultTickInterval);
 	}
-	mInstancedMeshCluster.Reset();
+
+	// インクリメンタルな再生成では前回のインスタンスを再利用するので残します
+	if (mRetainInstancedMeshClusters)
+	{
+		mRetainInstancedMeshClusters = false;
+	}
+	else
+	{
+		// ゲーム中はコンポーネントを破棄せずに次の生成のためにプールへ返却します
+		const UWorld* world = GetWorld();
+		FDungeonActorPool* pool = world && world->IsGameWorld() ? &mActorPool : nullptr;
+		for (auto& chunk : mInstancedMeshCluster)
+		{
+			chunk.Value.DestroyAll(pool);
+		}
+		mInstancedMeshCluster.Reset();
+	}
+
+	DestroySimplifiedCollision();
+}
+
+/*
+ * タイルの位置のグリッドが属する部屋または通路の識別子でタイルをまとめます。
+ * 識別子が無いグリッドのタイルは3次元セルでまとめます。
+ */
+void ADungeonGenerateActor::AddMergedMesh(UStaticMesh* staticMesh, const FTransform& transform)
+{
+	uint64 key = InstancedMeshClusterKey(transform.GetTranslation()) | (1ull << 63);
+
+	const std::shared_ptr<const dungeon::Generator>& generator = GetGenerator();
+	if (generator && IsValid(DungeonGenerateParameter))
+	{
+		const std::shared_ptr<dungeon::Voxel>& voxel = generator->GetVoxel();
+		const FIntVector location = DungeonGenerateParameter->ToGrid(transform.GetTranslation() - GetActorLocation());
+		if (voxel && voxel->Contain(location))
+		{
+			const dungeon::Grid& grid = voxel->Get(location);
+			if (!grid.IsInvalidIdentifier())
+			{
+				key = static_cast<dungeon::Identifier::IdentifierType>(grid.GetIdentifier());
+
+				// 当たり判定を置き換えるタイルは別の結合メッシュにします
+				if (mCollisionReplacedMeshes.Contains(staticMesh))
+					key |= CollisionReplacedMergedMeshKeyBit;
+			}
+		}
+	}
+
+	mMergedMeshCluster.FindOrAdd(key).Add(staticMesh, transform);
+}
+
+/*
+ * 部屋または通路ごとに一つのStaticMeshActorをスポーンするので、
+ * 負荷制御は部屋または通路の単位で行われます。
+ * 結合したアクターは複数のパーティションにまたがるので、境界に重なる全てのパーティションに登録します。
+ */
+void ADungeonGenerateActor::BuildMergedMeshes()
+{
+	if (mMergedMeshCluster.IsEmpty())
+		return;
+
+	MEASURE_TIME_START(stopwatch);
+
+	int32 mergedActorCount = 0;
+	TArray<UStaticMesh*> unmergedStaticMeshes;
+	TArray<FTransform> unmergedTransforms;
+	for (const auto& pair : mMergedMeshCluster)
+	{
+		const FVector pivot = pair.Value.GetCenter();
+		if (UStaticMesh* mergedStaticMesh = pair.Value.Build(GetTransientPackage(), pivot, unmergedStaticMeshes, unmergedTransforms))
+		{
+			if (AStaticMeshActor* actor = SpawnStaticMeshActor(mergedStaticMesh, TEXT("Meshes/Merged"), FTransform(pivot), ESpawnActorCollisionHandlingMethod::AlwaysSpawn))
+			{
+				if (pair.Key & CollisionReplacedMergedMeshKeyBit)
+					actor->GetStaticMeshComponent()->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+				if (auto* dungeonComponentActivatorComponent = actor->FindComponentByClass<UDungeonComponentActivatorComponent>())
+					dungeonComponentActivatorComponent->SetPartitionRegistrationWorldBounds(actor->GetStaticMeshComponent()->Bounds.GetBox());
+				++mergedActorCount;
+			}
+		}
+	}
+
+	// CPUから頂点を読めないメッシュは従来通りタイルごとにスポーンします
+	if (!unmergedStaticMeshes.IsEmpty())
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("%d tiles could not be merged. Enable Allow CPU Access on the tile meshes."), unmergedStaticMeshes.Num());
+		for (int32 index = 0; index < unmergedStaticMeshes.Num(); ++index)
+			SpawnStaticMeshActor(unmergedStaticMeshes[index], TEXT("Meshes/Merged"), unmergedTransforms[index], ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+	}
+
+	DUNGEON_GENERATOR_LOG(TEXT("Merged static meshes: %d actors for %d rooms and aisles"), mergedActorCount, mMergedMeshCluster.Num());
+	mMergedMeshCluster.Empty();
+
+	MEASURE_TIME_LAP(stopwatch, TEXT("BuildMergedMeshes Time"));
+}
+
+void ADungeonGenerateActor::ProcessInstancedMeshTreeBuilds()
+{
+	if (mInstancedMeshReady)
+		return;
+
+	// 非同期構築が終わったコンポーネントを取り除きます
+	for (int32 index = mBuildingInstancedMeshTrees.Num() - 1; index >= 0; --index)
+	{
+		const auto* component = mBuildingInstancedMeshTrees[index].Get();
+		if (component == nullptr || !component->IsAsyncBuilding())
+		{
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+			mBuildingInstancedMeshTrees.RemoveAtSwap(index, EAllowShrinking::No);
+#else
+			mBuildingInstancedMeshTrees.RemoveAtSwap(index, 1, false);
+#endif
+		}
+	}
+
+	// 予算の範囲で非同期構築を開始します（最初の1つは予算に関係なく開始します）
+	const double budgetSeconds = static_cast<double>(InstancedMeshTreeBuildBudgetMilliseconds) / 1000.0;
+	const double startTime = FPlatformTime::Seconds();
+	int32 launchCount = 0;
+	while (!mPendingInstancedMeshTreeBuilds.IsEmpty())
+	{
+		if (launchCount > 0 && FPlatformTime::Seconds() - startTime >= budgetSeconds)
+			break;
+
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+		auto* component = mPendingInstancedMeshTreeBuilds.Pop(EAllowShrinking::No).Get();
+#else
+		auto* component = mPendingInstancedMeshTreeBuilds.Pop(false).Get();
+#endif
+		if (!IsValid(component))
+			continue;
+
+		component->BuildTreeIfOutdated(true, false);
+		++launchCount;
+
+		if (component->IsAsyncBuilding())
+			mBuildingInstancedMeshTrees.Add(component);
+	}
+
+	if (mPendingInstancedMeshTreeBuilds.IsEmpty() && mBuildingInstancedMeshTrees.IsEmpty())
+		FinishInstancedMeshTreeBuilds();
+}
+
+void ADungeonGenerateActor::FinishInstancedMeshTreeBuilds()
+{
+	mInstancedMeshReady = true;
+	SetActorTickInterval(mDefaultTickInterval);
+
+	DUNGEON_GENERATOR_VERBOSE(TEXT("%s: All instanced mesh trees have been built"), *GetName());
+	if (mGenerationSuccessDeferred)
+	{
+		mGenerationSuccessDeferred = false;
+		EndDungeonGeneration();
+	}
+	OnInstancedMeshReady.Broadcast();
+}
+
+bool ADungeonGenerateActor::IsInstancedMeshReady() const noexcept
+{
+	return mInstancedMeshReady;
 }
 
 void ADungeonGenerateActor::SetInstancedMeshCullDistance(const FInt32Interval& cullDistance)
@@ -210,6 +499,116 @@ void ADungeonGenerateActor::SetInstancedMeshCullDistance(const FInt32Interval& c
 	ApplyInstancedMeshCullDistance();
 }
 
+/*
+ * パーティションのセルはレベル上の全てのダンジョンの範囲から生成後に決まります。
+ * 前回と同じセルなら生成時からパーティションのセルでまとめているので、組み直しは不要です。
+ */
+void ADungeonGenerateActor::AlignInstancedMeshClustersToPartitions(const FVector& partitionOrigin, const FVector& partitionSize)
+{
+	if (partitionSize.X <= 0. || partitionSize.Y <= 0. || partitionSize.Z <= 0.)
+		return;
+
+	const bool cellChanged =
+		!mInstancedMeshClusterAlignedToPartition ||
+		!mInstancedMeshClusterOrigin.Equals(partitionOrigin) ||
+		!mInstancedMeshClusterSize.Equals(partitionSize);
+	mInstancedMeshClusterAlignedToPartition = true;
+	mInstancedMeshClusterOrigin = partitionOrigin;
+	mInstancedMeshClusterSize = partitionSize;
+	if (cellChanged)
+		RegroupInstancedMeshClusters();
+
+	for (auto& pair : mInstancedMeshCluster)
+	{
+		pair.Value.SetPartitionActivator(this, InstancedMeshClusterCenter(pair.Key));
+	}
+}
+
+/*
+ * 全てのインスタンスを取り出して、現在のセルのクラスターに登録し直します。
+ * コンポーネントは一度プールへ返却してから取り出すので、作り直しは最小限になります。
+ */
+void ADungeonGenerateActor::RegroupInstancedMeshClusters()
+{
+	if (mInstancedMeshCluster.IsEmpty())
+		return;
+
+	MEASURE_TIME_START(stopwatch);
+
+	struct FInstances final
+	{
+		UStaticMesh* StaticMesh;
+		bool Hierarchical;
+		TArray<FTransform> Transforms;
+	};
+	TArray<FInstances> instances;
+	for (const auto& pair : mInstancedMeshCluster)
+	{
+		pair.Value.EachInstances([&instances](UStaticMesh* staticMesh, const bool hierarchical, const TArray<FTransform>& transforms)
+			{
+				instances.Add({ staticMesh, hierarchical, transforms });
+			}
+		);
+	}
+
+	const UWorld* world = GetWorld();
+	FDungeonActorPool* pool = world && world->IsGameWorld() ? &mActorPool : nullptr;
+	for (auto& pair : mInstancedMeshCluster)
+	{
+		pair.Value.DestroyAll(pool);
+	}
+	mInstancedMeshCluster.Reset();
+
+	for (const FInstances& instance : instances)
+	{
+		for (const FTransform& transform : instance.Transforms)
+		{
+			auto& chunk = mInstancedMeshCluster.FindOrAdd(InstancedMeshClusterKey(transform.GetTranslation()));
+			if (instance.Hierarchical)
+				chunk.FindOrCreateHierarchicalInstance(this, instance.StaticMesh, pool)->AddInstance(transform);
+			else
+				chunk.FindOrCreateInstance(this, instance.StaticMesh, pool)->AddInstance(transform);
+		}
+	}
+
+	mPendingInstancedMeshTreeBuilds.Reset();
+	for (auto& chunk : mInstancedMeshCluster)
+	{
+		chunk.Value.EndTransaction(mPendingInstancedMeshTreeBuilds);
+		chunk.Value.DisableCollision(mCollisionReplacedMeshes);
+	}
+
+	if (mInstancedMeshCullDistance.Min < mInstancedMeshCullDistance.Max)
+		ApplyInstancedMeshCullDistance();
+
+	ScheduleInstancedMeshTreeBuilds();
+
+	MEASURE_TIME_LAP(stopwatch, TEXT("RegroupInstancedMeshClusters Time"));
+}
+
+SIZE_T ADungeonGenerateActor::GetAllocatedSize() const
+{
+	SIZE_T size = Super::GetAllocatedSize();
+	size += mInstancedMeshCluster.GetAllocatedSize();
+	for (const auto& pair : mInstancedMeshCluster)
+	{
+		size += pair.Value.GetAllocatedSize();
+	}
+	return size;
+}
+
+void ADungeonGenerateActor::ReportAllocatedSize(FOutputDevice& outputDevice) const
+{
+	Super::ReportAllocatedSize(outputDevice);
+
+	SIZE_T instancedMeshClusterSize = mInstancedMeshCluster.GetAllocatedSize();
+	for (const auto& pair : mInstancedMeshCluster)
+	{
+		instancedMeshClusterSize += pair.Value.GetAllocatedSize();
+	}
+	outputDevice.Logf(TEXT("  InstancedMesh   : %.2f KiB (%d clusters)"), static_cast<double>(instancedMeshClusterSize) / 1024.0, mInstancedMeshCluster.Num());
+}
+
 void ADungeonGenerateActor::ApplyInstancedMeshCullDistance()
 {
 	for (auto& pair : mInstancedMeshCluster)
@@ -273,6 +672,9 @@ void ADungeonGenerateActor::PreGenerateImplementation()
 		);
 	}
 
+	// 簡略化したコリジョンに置き換えるメッシュを集める
+	CollectCollisionReplacedMeshes();
+
 	// インスタンスメッシュの登録開始
 	BeginInstanceTransaction();
 
@@ -296,6 +698,9 @@ void ADungeonGenerateActor::PreGenerateImplementation()
 			MEASURE_TIME_LAP(stopwatch, TEXT("MovePlayerStart Time"));
 		}
 
+		// 床、壁、天井の簡略化したコリジョンを生成
+		BuildSimplifiedCollision();
+
 		// スタート部屋とゴール部屋の位置を記録
 		StartRoomLocation = GetStartLocation();
 		GoalRoomLocation = GetGoalLocation();
@@ -332,9 +737,16 @@ void ADungeonGenerateActor::PreGenerateImplementation()
 		}
 #endif
 
-		// ダンジョン生成完了
-		EndDungeonGeneration();
-		MEASURE_TIME_LAP(stopwatch, TEXT("EndDungeonGeneration (success path) Time"));
+		// ダンジョン生成完了（ツリーの構築を待つ場合はEndInstanceTransactionの後で通知）
+		if (NotifyGenerationSuccessAfterInstancedMeshReady)
+		{
+			mGenerationSuccessDeferred = true;
+		}
+		else
+		{
+			EndDungeonGeneration();
+			MEASURE_TIME_LAP(stopwatch, TEXT("EndDungeonGeneration (success path) Time"));
+		}
 	}
 	else
 	{
@@ -349,6 +761,13 @@ void ADungeonGenerateActor::PreGenerateImplementation()
 
 	// インスタンスメッシュを登録完了
 	EndInstanceTransaction();
+
+	// 構築するツリーが無ければ直ちに成功を通知します
+	if (mGenerationSuccessDeferred && mInstancedMeshReady)
+	{
+		mGenerationSuccessDeferred = false;
+		EndDungeonGeneration();
+	}
 }
 
 void ADungeonGenerateActor::PostGenerateImplementation() const
@@ -374,20 +793,259 @@ void ADungeonGenerateActor::Dispose(const bool flushStreamLevels)
 	Super::Dispose(flushStreamLevels);
 }
 
+/*
+ * DirtyOccupiedTilesではNavMeshBoundsVolumeがダンジョンを覆っている間は変更しません。
+ * 範囲を変更すると範囲内の全タイルが再構築されるため、ダンジョンが範囲からはみ出した時だけ合わせます。
+ */
 void ADungeonGenerateActor::FitNavMeshBoundsVolume()
 {
 	MEASURE_TIME_START(stopwatch);
 
-	Super::FitNavMeshBoundsVolume();
-	MEASURE_TIME_LAP(stopwatch, TEXT("Super::FitNavMeshBoundsVolume Time"));
+	if (NavigationBuildMethod == EDungeonNavigationBuildMethod::DirtyOccupiedTiles && ContainNavMeshBoundsVolume(CalculateBoundingBox()))
+	{
+		const int32 dirtyAreaCount = DirtyOccupiedNavigationTiles(FBox(EForceInit::ForceInit));
+		MEASURE_TIME_LAP(stopwatch, TEXT("DirtyOccupiedNavigationTiles Time"));
+		DUNGEON_GENERATOR_LOG(TEXT("%s: %d navigation dirty areas added"), *GetName(), dirtyAreaCount);
+	}
+	else
+	{
+		Super::FitNavMeshBoundsVolume();
+		MEASURE_TIME_LAP(stopwatch, TEXT("Super::FitNavMeshBoundsVolume Time"));
+	}
+	BeginNavigationBuild();
 
-	if (DungeonMeshGenerationMethod != EDungeonMeshGenerationMethod::StaticMesh)
+	if (DungeonMeshGenerationMethod != EDungeonMeshGenerationMethod::StaticMesh && DungeonMeshGenerationMethod != EDungeonMeshGenerationMethod::MergedStaticMesh)
 	{
 		ReregisterAllComponents();
 		MEASURE_TIME_LAP(stopwatch, TEXT("ReregisterAllComponents Time"));
 	}
 }
 
+/*
+ * スロープ、キャットウォーク、柱と共用しているメッシュは箱で表せないので置き換えません。
+ */
+void ADungeonGenerateActor::CollectCollisionReplacedMeshes()
+{
+	mCollisionReplacedMeshes.Reset();
+	mCollisionReplacedTileBounds.Reset();
+	if (!GenerateSimplifiedCollision || !IsValid(DungeonGenerateParameter))
+		return;
+
+	DungeonGenerateParameter->EachFloorParts([this](const FDungeonMeshPartsWithDirection& parts)
+		{
+			mCollisionReplacedMeshes.Add(parts.StaticMesh);
+		}
+	);
+	DungeonGenerateParameter->EachWallParts([this](const FDungeonMeshParts& parts)
+		{
+			mCollisionReplacedMeshes.Add(parts.StaticMesh);
+		}
+	);
+	DungeonGenerateParameter->EachRoofParts([this](const FDungeonMeshPartsWithDirection& parts)
+		{
+			mCollisionReplacedMeshes.Add(parts.StaticMesh);
+		}
+	);
+
+	const auto keep = [this](const FDungeonMeshParts& parts)
+		{
+			mCollisionReplacedMeshes.Remove(parts.StaticMesh);
+		};
+	DungeonGenerateParameter->EachSlopeParts(keep);
+	DungeonGenerateParameter->EachCatwalkParts(keep);
+	DungeonGenerateParameter->EachPillarParts(keep);
+	mCollisionReplacedMeshes.Remove(nullptr);
+}
+
+/*
+ * 部屋または通路ごとに一つのコンポーネントを作ります。
+ * 箱はダンジョンの原点からの相対座標なので、アクターのルートに取り付けます。
+ */
+void ADungeonGenerateActor::BuildSimplifiedCollision()
+{
+	if (!GenerateSimplifiedCollision || !IsValid(DungeonGenerateParameter))
+		return;
+
+	const std::shared_ptr<const dungeon::Generator>& generator = GetGenerator();
+	if (!generator || !generator->GetVoxel())
+		return;
+
+	MEASURE_TIME_START(stopwatch);
+
+	const FDungeonSimplifiedCollisionBuilder builder(DungeonGenerateParameter->GetGridSize().To3D(), SimplifiedCollisionThickness, DungeonGenerateParameter->IsMergeRooms());
+	FDungeonSimplifiedCollisionBuilder::Partitions partitions;
+	const int32 faceCount = builder.Build(*generator->GetVoxel(), partitions);
+
+	int32 boxCount = 0;
+	for (const auto& partition : partitions)
+	{
+		auto* component = NewObject<UDungeonSimplifiedCollisionComponent>(this);
+		component->SetupAttachment(GetRootComponent());
+		component->SetBoxes(partition.Value);
+		AddInstanceComponent(component);
+		component->RegisterComponent();
+		mSimplifiedCollisionComponents.Add(component);
+		boxCount += partition.Value.Num();
+	}
+
+	/*
+	 * StaticMeshActorとしてスポーンしたタイルの当たり判定を無効にします
+	 * タグは全てのダンジョンで共通なので、このアクターがスポーンしたアクターだけを対象にします
+	 */
+	const bool validate = CVarValidateSimplifiedCollision.GetValueOnGameThread() > 0;
+	if (!mCollisionReplacedMeshes.IsEmpty() &&
+		(DungeonMeshGenerationMethod == EDungeonMeshGenerationMethod::StaticMesh || DungeonWallRoofPillarMeshGenerationMethod == EDungeonMeshGenerationMethod::StaticMesh))
+	{
+		for (const TWeakObjectPtr<AStaticMeshActor>& actor : GetSpawnedStaticMeshActors())
+		{
+			if (!actor.IsValid())
+				continue;
+
+			UStaticMeshComponent* staticMeshComponent = actor->GetStaticMeshComponent();
+			if (IsValid(staticMeshComponent) &&
+				staticMeshComponent->ComponentHasTag(GetDungeonGeneratorTerrainTag()) &&
+				mCollisionReplacedMeshes.Contains(staticMeshComponent->GetStaticMesh()))
+			{
+				staticMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+				if (validate)
+					mCollisionReplacedTileBounds.Add(staticMeshComponent->Bounds.GetBox().ShiftBy(-GetActorLocation()));
+			}
+		}
+	}
+
+	DUNGEON_GENERATOR_LOG(TEXT("Simplified collision: %d faces merged into %d boxes for %d rooms and aisles"), faceCount, boxCount, partitions.Num());
+
+	// 配置したタイルと箱を比較します
+	if (validate)
+	{
+		int32 traceErrorCount = 0;
+		const int32 overlapErrorCount = builder.ValidateTiles(mCollisionReplacedTileBounds, partitions, traceErrorCount);
+		if (overlapErrorCount > 0 || traceErrorCount > 0)
+		{
+			DUNGEON_GENERATOR_WARNING(TEXT("Simplified collision: %d of %d tiles overlap no box, %d traces through tiles hit no box near the tile"),
+				overlapErrorCount, mCollisionReplacedTileBounds.Num(), traceErrorCount);
+		}
+		else
+		{
+			DUNGEON_GENERATOR_LOG(TEXT("Simplified collision: all %d tiles are overlapped and hit by boxes"), mCollisionReplacedTileBounds.Num());
+		}
+	}
+	mCollisionReplacedTileBounds.Reset();
+	MEASURE_TIME_LAP(stopwatch, TEXT("BuildSimplifiedCollision Time"));
+}
+
+void ADungeonGenerateActor::DestroySimplifiedCollision()
+{
+	for (UDungeonSimplifiedCollisionComponent* component : mSimplifiedCollisionComponents)
+	{
+		if (IsValid(component))
+			component->DestroyComponent();
+	}
+	mSimplifiedCollisionComponents.Reset();
+}
+
+bool ADungeonGenerateActor::ContainNavMeshBoundsVolume(const FBox& bounds) const
+{
+	for (TActorIterator<ANavMeshBoundsVolume> iterator(GetWorld()); iterator; ++iterator)
+	{
+		if (iterator->GetComponentsBoundingBox(true).IsInsideOrOn(bounds))
+			return true;
+	}
+	return false;
+}
+
+/*
+ * 床、スロープ、階段のグリッドをナビゲーションメッシュのタイル単位でまとめて、
+ * タイルごとに一つのダーティ領域を追加します。
+ * 領域は歩けるグリッドを囲む大きさなので、重なるタイルだけが非同期で再構築されます。
+ */
+int32 ADungeonGenerateActor::DirtyOccupiedNavigationTiles(const FBox& bounds)
+{
+	UNavigationSystemV1* navigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const auto generator = GetGenerator();
+	if (navigationSystem == nullptr || generator == nullptr || generator->GetVoxel() == nullptr || !IsValid(mParameter))
+		return 0;
+
+	double tileSize = 0.0;
+	if (const ARecastNavMesh* recastNavMesh = Cast<ARecastNavMesh>(navigationSystem->GetDefaultNavDataInstance(FNavigationSystem::DontCreate)))
+		tileSize = recastNavMesh->GetTileSizeUU();
+
+	const FVector gridSize = mParameter->GetGridSize().To3D();
+	if (tileSize <= 0.0)
+		tileSize = FMath::Max(gridSize.X, gridSize.Y);
+	const FVector origin = GetActorLocation();
+
+	TMap<FIntPoint, FBox> tiles;
+	generator->GetVoxel()->Each([&](const FIntVector& location, const dungeon::Grid& grid)
+		{
+			if (grid.CanBuildFloor(false) || grid.CanBuildSlope())
+			{
+				const FVector min = origin + FVector(location) * gridSize;
+				const FBox cell(min, min + gridSize);
+				if (!bounds.IsValid || bounds.Intersect(cell))
+				{
+					const FIntPoint tile(FMath::FloorToInt(min.X / tileSize), FMath::FloorToInt(min.Y / tileSize));
+					tiles.FindOrAdd(tile, FBox(EForceInit::ForceInit)) += cell;
+				}
+			}
+			return true;
+		}
+	);
+
+	TArray<FBox> dirtyAreas;
+	dirtyAreas.Reserve(tiles.Num());
+	for (const auto& tile : tiles)
+	{
+		FBox dirtyArea = tile.Value;
+		dirtyArea.Min.Z -= NavigationDirtyAreaMarginZ;
+		dirtyAreas.Add(dirtyArea);
+	}
+	if (!dirtyAreas.IsEmpty())
+		navigationSystem->AddDirtyAreas(dirtyAreas, ENavigationDirtyFlag::All);
+
+	return dirtyAreas.Num();
+}
+
+void ADungeonGenerateActor::DirtyNavigationInBounds(const FBox& bounds)
+{
+	if (!bounds.IsValid)
+		return;
+
+	const int32 dirtyAreaCount = DirtyOccupiedNavigationTiles(bounds);
+	DUNGEON_GENERATOR_VERBOSE(TEXT("%s: %d navigation dirty areas added in %s"), *GetName(), dirtyAreaCount, *bounds.ToString());
+	BeginNavigationBuild();
+}
+
+void ADungeonGenerateActor::BeginNavigationBuild()
+{
+	mNavigationReady = false;
+	mNavigationBuildRequestFrame = GFrameCounter;
+}
+
+/*
+ * ダーティ領域はナビゲーションシステムの次のTickでタイルの再構築に変換されるので、
+ * 要求したフレームの間は構築中か判定しません。
+ */
+void ADungeonGenerateActor::ProcessNavigationBuild()
+{
+	if (mNavigationReady || GFrameCounter <= mNavigationBuildRequestFrame + 1)
+		return;
+
+	UNavigationSystemV1* navigationSystem = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	if (navigationSystem && navigationSystem->IsNavigationBuildInProgress())
+		return;
+
+	mNavigationReady = true;
+
+	DUNGEON_GENERATOR_VERBOSE(TEXT("%s: Navigation has been built"), *GetName());
+	OnNavigationReady.Broadcast();
+}
+
+bool ADungeonGenerateActor::IsNavigationReady() const noexcept
+{
+	return mNavigationReady;
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 // BluePrint Useful Functions
 // サーバープロセスで実行する
@@ -423,11 +1081,27 @@ void ADungeonGenerateActor::GenerateDungeonWithParameter_Implementation(UDungeon
 	MulticastOnGenerateDungeon();
 }
 
+// サーバープロセスで実行する
+void ADungeonGenerateActor::RegenerateDungeonIncrementally_Implementation(UDungeonGenerateParameter* dungeonGenerateParameter)
+{
+	if (mIsGeneratingDungeon)
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("RegenerateDungeonIncrementally ignored because dungeon generation is already in progress."));
+		return;
+	}
+
+#if JENKINS_FOR_DEVELOP
+	DUNGEON_GENERATOR_LOG(TEXT("ServerOnRegenerateDungeonIncrementally: %s"), HasAuthority() ? TEXT("Server") : TEXT("Client"));
+#endif
+
+	if (IsValid(dungeonGenerateParameter))
+		DungeonGenerateParameter = dungeonGenerateParameter;
+	MulticastOnRegenerateDungeonIncrementally();
+}
+
 // 全てのクライアントプロセスで実行する
 void ADungeonGenerateActor::MulticastOnGenerateDungeon_Implementation()
 {
-	MEASURE_TIME_START(stopwatch);
-
 	if (mIsGeneratingDungeon)
 	{
 		DUNGEON_GENERATOR_ERROR(TEXT("MulticastOnGenerateDungeon ignored because dungeon generation is already in progress."));
@@ -437,7 +1111,48 @@ void ADungeonGenerateActor::MulticastOnGenerateDungeon_Implementation()
 #if JENKINS_FOR_DEVELOP
 	DUNGEON_GENERATOR_LOG(TEXT("MulticastOnGenerateDungeon: %s"), HasAuthority() ? TEXT("Server") : TEXT("Client"));
 #endif
+	GenerateImplementation(false);
+}
+
+// 全てのクライアントプロセスで実行する
+void ADungeonGenerateActor::MulticastOnRegenerateDungeonIncrementally_Implementation()
+{
+	if (mIsGeneratingDungeon)
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("MulticastOnRegenerateDungeonIncrementally ignored because dungeon generation is already in progress."));
+		return;
+	}
+
+#if JENKINS_FOR_DEVELOP
+	DUNGEON_GENERATOR_LOG(TEXT("MulticastOnRegenerateDungeonIncrementally: %s"), HasAuthority() ? TEXT("Server") : TEXT("Client"));
+#endif
+	GenerateImplementation(true);
+}
+
+void ADungeonGenerateActor::GenerateImplementation(const bool incremental)
+{
+	MEASURE_TIME_START(stopwatch);
+
 	TGuardValue<bool> generatingGuard(mIsGeneratingDungeon, true);
+
+	// Disposeで破棄される前に前回の地形アクターとインスタンスを再利用の候補にする
+	if (incremental && IsValid(DungeonGenerateParameter) && BeginIncrementalRegeneration())
+	{
+		// クラスターのセルが変わるとインスタンスが別のクラスターに属するので、その場合は候補にしない
+		if (mInstancedMeshClusterAlignedToPartition || mInstancedMeshClusterSize.Equals(ComputeInstancedMeshClusterSize()))
+		{
+			for (const auto& chunk : mInstancedMeshCluster)
+			{
+				chunk.Value.EachComponents([this](UInstancedStaticMeshComponent* component)
+					{
+						AddIncrementalRegenerationCandidate(component);
+					}
+				);
+			}
+			mRetainInstancedMeshClusters = true;
+		}
+	}
+
 	PreGenerateImplementation();
 	PostGenerateImplementation();
 
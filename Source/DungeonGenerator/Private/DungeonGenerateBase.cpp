@@ -12,9 +12,11 @@
 
 
 #include "Core/Generator.h"
+#include "Core/GenerateReplay.h"
 #include "Core/Debug/Debug.h"
 #include "Core/Debug/Config.h"
 #include "Core/Debug/MeasureTime.h"
+#include "Core/Helper/AllocatedSize.h"
 #include "Core/Helper/Direction.h"
 #include "Core/Helper/Identifier.h"
 #include "Core/Helper/Stopwatch.h"
@@ -33,6 +35,9 @@
 
 #include "PluginInformation.h"
 
+#include "DungeonAssetPrefetcher.h"
+#include "DungeonIncrementalRegeneration.h"
+#include "DungeonRoomOccupancyTracker.h"
 #include "Helper/DungeonAisleGridMap.h"
 #include "Helper/DungeonDirection.h"
 
@@ -49,8 +54,11 @@
 #include <Engine/PlayerStartPIE.h>
 #include <Engine/StaticMeshActor.h>
 #include <Engine/Texture2D.h>
+#include <HAL/FileManager.h>
+#include <HAL/IConsoleManager.h>
 #include <Kismet/GameplayStatics.h>
 #include <Misc/EngineVersionComparison.h>
+#include <Misc/ScopeExit.h>
 #include <NavMesh/NavMeshBoundsVolume.h>
 #include <NavMesh/RecastNavMesh.h>
 #include <Engine/Polys.h>
@@ -82,6 +90,28 @@ namespace
 	const FString LevelsFolderPath = TEXT("/Levels/");
 	const FString InteriorsFolderPath = TEXT("Interiors");
 
+	// 生成後に余ったプールのオブジェクトを破棄するのに1フレームで使う秒数
+	constexpr double ActorPoolTrimBudgetSeconds = 0.5 / 1000.0;
+
+	/*
+	 * 生成の再現情報を記録するモード
+	 * 0: 記録しない, 1: 失敗または遅い生成を記録する, 2: 全ての生成を記録する
+	 */
+	TAutoConsoleVariable<int32> CVarReplayCapture(
+		TEXT("DungeonGenerator.ReplayCapture"),
+		0,
+		TEXT("Captures a replay of the core generation to Saved/DungeonGenerator/Replay.\n")
+		TEXT("0: off, 1: failed or slow generations, 2: every generation"),
+		ECVF_Default
+	);
+
+	TAutoConsoleVariable<float> CVarReplayCaptureSlowSeconds(
+		TEXT("DungeonGenerator.ReplayCaptureSlowSeconds"),
+		1.f,
+		TEXT("Generations slower than this are captured when DungeonGenerator.ReplayCapture is 1"),
+		ECVF_Default
+	);
+
 	constexpr bool operator==(const EDungeonRoomItem left, const dungeon::Room::Item right)
 	{
 		return static_cast<uint8_t>(left) == static_cast<uint8_t>(right);
@@ -96,6 +126,14 @@ namespace
 	{
 		return static_cast<EDungeonRoomLocatorParts>(parts);
 	}
+	// 簡略化したコリジョンのために無効にしたタイルの当たり判定を既定に戻します
+	void RestoreDefaultCollision(const AStaticMeshActor* actor)
+	{
+		UStaticMeshComponent* staticMeshComponent = actor->GetStaticMeshComponent();
+		if (IsValid(staticMeshComponent))
+			staticMeshComponent->SetCollisionEnabled(CastChecked<UPrimitiveComponent>(staticMeshComponent->GetArchetype())->GetCollisionEnabled());
+	}
+
 	uint8 MakeNeighborMask6(const dungeon::Grid& grid)
 	{
 		uint8 mask = 0;
@@ -243,6 +281,8 @@ ADungeonGenerateBase::ADungeonGenerateBase(const FObjectInitializer& initializer
 void ADungeonGenerateBase::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Dispose(false);
+	mActorPool.DestroyAll();
+	mAssetPrefetcher.reset();
 
 	// Calling the parent class
 	Super::EndPlay(EndPlayReason);
@@ -255,6 +295,14 @@ void ADungeonGenerateBase::Tick(float DeltaSeconds)
 
 	// 予約されたスポーンを実行
 	mDungeonDeferredSpawnManager.Update();
+
+	// プレイヤーのいる部屋をまとめて更新
+	if (mRoomOccupancyTracker)
+		mRoomOccupancyTracker->Update(GetWorld());
+
+	// 生成で再利用されなかったプールのオブジェクトを少しずつ破棄
+	if (mGenerated)
+		mActorPool.Trim(ActorPoolTrimBudgetSeconds);
 }
 
 /*
@@ -349,9 +397,22 @@ AActor* ADungeonGenerateBase::SpawnActorWithFolderPath(UClass* actorClass, const
  * スポーンしたアクターを全て破棄します
  * DungeonGeneratorというタグが付いたアクターが対象です。
  */
-void ADungeonGenerateBase::DestroySpawnedActors() const
+void ADungeonGenerateBase::DestroySpawnedActors()
 {
-	DestroySpawnedActors(GetWorld());
+	UWorld* world = GetWorld();
+
+	// ゲーム中はこのアクターがスポーンした地形のStaticMeshActorを破棄せずにプールへ返却します。
+	// 同じタグを持つ他のダンジョンのアクターは対象にしません。
+	if (IsValid(world) && world->IsGameWorld())
+	{
+		for (const TWeakObjectPtr<AStaticMeshActor>& staticMeshActor : mSpawnedStaticMeshActors)
+		{
+			if (staticMeshActor.IsValid())
+				mActorPool.ReleaseStaticMeshActor(staticMeshActor.Get());
+		}
+	}
+
+	DestroySpawnedActors(world);
 }
 
 /*
@@ -432,6 +493,11 @@ void ADungeonGenerateBase::OnPostDungeonGeneration(const bool result)
 {
 }
 
+bool ADungeonGenerateBase::UseVoxelRoomOccupancy() const
+{
+	return false;
+}
+
 
 
 
@@ -453,6 +519,10 @@ bool ADungeonGenerateBase::IsGenerated() const noexcept
 void ADungeonGenerateBase::Dispose(const bool flushStreamLevels)
 {
 	mDungeonDeferredSpawnManager.CancelAll(/*bNotifyCallbacks=*/false);
+	mRoomOccupancyTracker.reset();
+
+	// 読み込み待ちのスポーンを破棄したレイアウトに出さない
+	++mGenerationSerial;
 
 	// 生成済みなら破棄する
 	if (mGenerated == true)
@@ -470,6 +540,95 @@ void ADungeonGenerateBase::Dispose(const bool flushStreamLevels)
 		// 生成済みフラグをリセットする
 		mGenerated = false;
 	}
+	mSpawnedStaticMeshActors.Reset();
+}
+
+/*
+ * 前回の地形アクターからタグを外してDisposeで破棄されないようにし、再利用の候補にします。
+ * 派生クラスや生成時に作ったメッシュを持つアクターは再利用しないので候補にしません。
+ */
+bool ADungeonGenerateBase::BeginIncrementalRegeneration()
+{
+	mIncrementalRegeneration.reset();
+
+	UWorld* world = GetWorld();
+	if (!mGenerated || !mGenerator || !IsValid(world))
+		return false;
+
+	mIncrementalRegeneration = std::make_shared<FDungeonIncrementalRegeneration>(mGenerator, GetActorLocation());
+
+	TArray<AActor*> actors;
+	UGameplayStatics::GetAllActorsWithTag(world, GetDungeonGeneratorTag(), actors);
+	for (AActor* actor : actors)
+	{
+		auto* staticMeshActor = Cast<AStaticMeshActor>(actor);
+		if (!IsValid(staticMeshActor) || staticMeshActor->GetClass() != AStaticMeshActor::StaticClass())
+			continue;
+
+		const UStaticMeshComponent* staticMeshComponent = staticMeshActor->GetStaticMeshComponent();
+		if (!IsValid(staticMeshComponent) || !staticMeshComponent->ComponentHasTag(GetDungeonGeneratorTerrainTag()))
+			continue;
+
+		const UStaticMesh* staticMesh = staticMeshComponent->GetStaticMesh();
+		if (!IsValid(staticMesh) || staticMesh->HasAnyFlags(RF_Transient))
+			continue;
+
+		staticMeshActor->Tags.Remove(GetDungeonGeneratorTag());
+		mIncrementalRegeneration->AddCandidate(staticMeshActor);
+	}
+
+	return true;
+}
+
+void ADungeonGenerateBase::AddIncrementalRegenerationCandidate(UInstancedStaticMeshComponent* component)
+{
+	if (mIncrementalRegeneration)
+		mIncrementalRegeneration->AddCandidate(component);
+}
+
+bool ADungeonGenerateBase::ReuseIncrementalRegenerationInstance(const UStaticMesh* staticMesh, const FTransform& transform, const bool hierarchical)
+{
+	return mIncrementalRegeneration && mIncrementalRegeneration->ReuseInstance(staticMesh, transform, hierarchical);
+}
+
+/*
+ * 再利用されなかった前回の地形アクターを破棄します。
+ * ゲーム中はプールへ返却して次の生成で使えるようにします。
+ * 再利用されなかった前回のメッシュインスタンスはコンポーネントから取り除きます。
+ */
+void ADungeonGenerateBase::FinishIncrementalRegeneration()
+{
+	if (!mIncrementalRegeneration)
+		return;
+
+	int32 removedInstanceCount = 0;
+	for (const auto& pair : mIncrementalRegeneration->TakeUnusedInstances())
+	{
+		if (UInstancedStaticMeshComponent* component = pair.Key.Get())
+		{
+			component->RemoveInstances(pair.Value);
+			removedInstanceCount += pair.Value.Num();
+		}
+	}
+
+	const TArray<AStaticMeshActor*> unusedActors = mIncrementalRegeneration->TakeUnusedActors();
+	const UWorld* world = GetWorld();
+	const bool isGameWorld = IsValid(world) && world->IsGameWorld();
+	for (AStaticMeshActor* actor : unusedActors)
+	{
+		if (!isGameWorld || !mActorPool.ReleaseStaticMeshActor(actor))
+			actor->Destroy();
+	}
+
+	DUNGEON_GENERATOR_LOG(TEXT("Incremental regeneration: %d changed grids, %d terrain actors reused, %d discarded, %d terrain instances reused, %d removed"),
+		mIncrementalRegeneration->GetChangedGridCount(),
+		mIncrementalRegeneration->GetReusedCount(),
+		unusedActors.Num(),
+		mIncrementalRegeneration->GetReusedInstanceCount(),
+		removedInstanceCount
+	);
+
+	mIncrementalRegeneration.reset();
 }
 
 /*
@@ -480,6 +639,18 @@ void ADungeonGenerateBase::Dispose(const bool flushStreamLevels)
 bool ADungeonGenerateBase::BeginDungeonGeneration(const UDungeonGenerateParameter* parameter, const bool hasAuthority)
 {
 	MEASURE_TIME_START(stopwatch);
+
+	// 生成に失敗しても再利用されなかった前回の地形アクターを残さない
+	ON_SCOPE_EXIT
+	{
+		FinishIncrementalRegeneration();
+	};
+
+	// 生成中のメモリ使用量を各フェーズの終了時に計測して最大値を記録する
+	const uint64 usedPhysicalAtStart = FPlatformMemory::GetStats().UsedPhysical;
+	mGenerationSampledAllocatedSize = 0;
+	mGenerationSampledUsedPhysicalDelta = 0;
+
 	dungeon::GenerateParameter generateParameter;
 	if (!BeginDungeonGenerationPhase_Prepare(parameter, hasAuthority, generateParameter))
 	{
@@ -493,13 +664,16 @@ bool ADungeonGenerateBase::BeginDungeonGeneration(const UDungeonGenerateParamete
 	}
 	MEASURE_TIME_LAP(stopwatch, TEXT(" BeginDungeonGenerationPhase_InitializeCore"));
 
-	if (!BeginDungeonGenerationPhase_RunGenerator(generateParameter, hasAuthority))
+	const bool runGeneratorResult = BeginDungeonGenerationPhase_RunGenerator(generateParameter, hasAuthority);
+	SampleGenerationMemory(usedPhysicalAtStart);
+	if (!runGeneratorResult)
 	{
 		return false;
 	}
 	MEASURE_TIME_LAP(stopwatch, TEXT(" BeginDungeonGenerationPhase_RunGenerator"));
 
 	BeginDungeonGenerationPhase_BuildWorld(generateParameter, hasAuthority);
+	SampleGenerationMemory(usedPhysicalAtStart);
 	MEASURE_TIME_LAP(stopwatch, TEXT(" BeginDungeonGenerationPhase_BuildWorld"));
 
 	return true;
@@ -577,73 +751,14 @@ bool ADungeonGenerateBase::BeginDungeonGenerationPhase_Prepare(const UDungeonGen
 			// Client
 			randomSeed = mParameter->GetGeneratedRandomSeed();
 		}
-		generateParameter.GetRandom()->SetSeed(randomSeed);
-		generateParameter.SetNumberOfCandidateRooms(mParameter->NumberOfCandidateRooms);
-		generateParameter.SetMinRoomWidth(mParameter->RoomWidth.Min);
-		generateParameter.SetMaxRoomWidth(mParameter->RoomWidth.Max);
-		generateParameter.SetMinRoomDepth(mParameter->RoomDepth.Min);
-		generateParameter.SetMaxRoomDepth(mParameter->RoomDepth.Max);
-		generateParameter.SetMinRoomHeight(mParameter->RoomHeight.Min);
-		generateParameter.SetMaxRoomHeight(mParameter->RoomHeight.Max);
-		generateParameter.SetMergeRooms(mParameter->MergeRooms);
-		generateParameter.SetMissionGraph(mParameter->IsUseMissionGraph());
-		generateParameter.SetAisleComplexity(mParameter->GetAisleComplexity());
-		generateParameter.SetAisleCeilingHeightPolicy(static_cast<dungeon::AisleCeilingHeightPolicy>(mParameter->GetAisleCeilingHeightPolicy()));
-		generateParameter.SetGenerateSlopeInRoom(mParameter->GenerateSlopeInRoom);
-		generateParameter.SetGenerateStructuralColumn(mParameter->GenerateStructuralColumn);
-		generateParameter.SetSkylightChancePercent(mParameter->SkylightChancePercent);
-		EDungeonStartLocationPolicy startLocationPolicy = mParameter->StartLocationPolicy;
-		if (mParameter->IsUseMissionGraph())
-		{
-			if (startLocationPolicy == EDungeonStartLocationPolicy::UseMultiStart)
-			{
-				DUNGEON_GENERATOR_WARNING(TEXT("StartLocationPolicy requires UseMissionGraph disabled. Falling back to UseSouthernMost."));
-				startLocationPolicy = EDungeonStartLocationPolicy::UseSouthernMost;
-			}
-		}
-		generateParameter.SetStartLocationPolicy(static_cast<dungeon::StartLocationPolicy>(startLocationPolicy));
-		uint8 startRoomCount = 1;
-		if (startLocationPolicy == EDungeonStartLocationPolicy::UseMultiStart)
+		int32 playerStartCount = 0;
+		if (mParameter->StartLocationPolicy == EDungeonStartLocationPolicy::UseMultiStart)
 		{
 			TArray<APlayerStart*> startPoints;
 			CollectPlayerStartExceptPlayerStartPIE(startPoints);
-			if (startPoints.IsEmpty())
-			{
-				DUNGEON_GENERATOR_WARNING(TEXT("UseMultiStart requires at least one PlayerStart. Falling back to a single start room."));
-			}
-			startRoomCount = static_cast<uint8>(FMath::Clamp(startPoints.Num(), 1, 255));
-		}
-		generateParameter.SetStartRoomCount(startRoomCount);
-
-		if (mParameter->MergeRooms)
-		{
-			generateParameter.SetHorizontalRoomMargin(0);
-			generateParameter.SetVerticalRoomMargin(0);
-			generateParameter.SetExpansionPolicy(dungeon::ExpansionPolicy::ExpandHorizontally);
-			generateParameter.SetNumberOfCandidateFloors(0);
-			generateParameter.SetMissionGraph(false);
-			generateParameter.SetAisleComplexity(0);
-		}
-		else
-		{
-			generateParameter.SetHorizontalRoomMargin(mParameter->RoomMargin);
-			if (mParameter->ExpansionPolicy == EDungeonExpansionPolicy::Flat)
-			{
-				generateParameter.SetVerticalRoomMargin(0);
-				generateParameter.SetExpansionPolicy(dungeon::ExpansionPolicy::Flat);
-				generateParameter.SetNumberOfCandidateFloors(0);
-			}
-			else
-			{
-				generateParameter.SetVerticalRoomMargin(mParameter->VerticalRoomMargin);
-				generateParameter.SetExpansionPolicy(static_cast<dungeon::ExpansionPolicy>(mParameter->ExpansionPolicy));
-				generateParameter.SetNumberOfCandidateFloors(mParameter->NumberOfCandidateFloors);
-			}
+			playerStartCount = startPoints.Num();
 		}
-
-		check(generateParameter.GetMinRoomWidth() <= generateParameter.GetMaxRoomWidth());
-		check(generateParameter.GetMinRoomDepth() <= generateParameter.GetMaxRoomDepth());
-		check(generateParameter.GetMinRoomHeight() <= generateParameter.GetMaxRoomHeight());
+		mParameter->ToGenerateParameter(generateParameter, randomSeed, playerStartCount);
 	}
 
 	return true;
@@ -675,6 +790,25 @@ bool ADungeonGenerateBase::BeginDungeonGenerationPhase_InitializeCore(const dung
 	return true;
 }
 
+void ADungeonGenerateBase::SaveGenerateReplay(const dungeon::GenerateReplay& replay, const double seconds) const
+{
+	const dungeon::Generator::Error error = mGenerator->GetLastError();
+	const FString directory = dungeon::GetDebugDirectory() / TEXT("Replay");
+	IFileManager::Get().MakeDirectory(*directory, true);
+
+	const FString path = directory / FString::Printf(TEXT("%s_%s_%s.dgreplay"),
+		*FDateTime::Now().ToString(TEXT("%Y%m%d-%H%M%S-%s")), *GetName(), UTF8_TO_TCHAR(dungeon::Generator::GetErrorName(error)));
+	if (replay.Save(TCHAR_TO_UTF8(*path)))
+	{
+		DUNGEON_GENERATOR_DISPLAY(TEXT("Captured generation replay '%s' (%s, %.3f seconds). Run it with -run=DungeonReplay -Replay=\"%s\""),
+			*path, UTF8_TO_TCHAR(dungeon::Generator::GetErrorName(error)), seconds, *path);
+	}
+	else
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Failed to write generation replay '%s'"), *path);
+	}
+}
+
 bool ADungeonGenerateBase::BeginDungeonGenerationPhase_RunGenerator(dungeon::GenerateParameter& generateParameter, const bool hasAuthority)
 {
 #if defined(DEBUG_ENABLE_INFORMATION_FOR_REPLICATION)
@@ -694,8 +828,16 @@ bool ADungeonGenerateBase::BeginDungeonGenerationPhase_RunGenerator(dungeon::Gen
 
 	// ダンジョンを生成
 	OnPreDungeonGeneration();
+	const int32 replayCapture = CVarReplayCapture.GetValueOnGameThread();
+	dungeon::GenerateReplay replay;
+	if (replayCapture > 0)
+		replay.Capture(generateParameter);
+	dungeon::Stopwatch generateStopwatch;
 	mGenerator->Generate(generateParameter);
+	const double generateSeconds = generateStopwatch.Lap();
 	const dungeon::Generator::Error generatorError = mGenerator->GetLastError();
+	if (replayCapture >= 2 || (replayCapture == 1 && (dungeon::Generator::Error::Success != generatorError || generateSeconds >= CVarReplayCaptureSlowSeconds.GetValueOnGameThread())))
+		SaveGenerateReplay(replay, generateSeconds);
 	OnPostDungeonGeneration(dungeon::Generator::Error::Success == generatorError);
 
 	// 生成エラーを確認する
@@ -727,6 +869,16 @@ void ADungeonGenerateBase::BeginDungeonGenerationPhase_BuildWorld(const dungeon:
 {
 	MEASURE_TIME_START(stopwatch);
 
+	// インクリメンタルな再生成なら前回から変化したグリッドを調べる
+	if (mIncrementalRegeneration && mGenerator && mGenerator->GetVoxel())
+	{
+		mIncrementalRegeneration->CollectChangedGrids(*mGenerator->GetVoxel(), mParameter->GetGridSize().To3D());
+		MEASURE_TIME_LAP(stopwatch, TEXT("  Collect changed grids"));
+	}
+
+	// スポーンするアクターの読み込みを開始
+	CreateImplement_PrefetchAssets(hasAuthority);
+	MEASURE_TIME_LAP(stopwatch, TEXT("  Request asset prefetch"));
 
 	// メッシュの生成
 	{
@@ -744,6 +896,7 @@ void ADungeonGenerateBase::BeginDungeonGenerationPhase_BuildWorld(const dungeon:
 		CreateImplement_Navigation(hasAuthority);
 		// DungeonRoomSensor::OnInitializeを呼び出す
 		CreateImplement_FinishSpawnRoomSensor(roomSensorCache);
+		CreateImplement_RoomOccupancy(roomSensorCache, hasAuthority);
 	}
 
 	// Blueprintから使用できる乱数を生成します
@@ -754,15 +907,22 @@ void ADungeonGenerateBase::BeginDungeonGenerationPhase_BuildWorld(const dungeon:
 
 	mParameter->OnEndGeneration(random, mAisleGridMap, [this, hasAuthority](const FSoftObjectPath& spawnPath, const FTransform& transform)
 		{
-			if (hasAuthority)
+			if (hasAuthority && mAssetPrefetcher)
 			{
-				const FSoftObjectPath path(spawnPath.ToString() + "_C");
-				const TSoftClassPtr<AActor> softClassPointer(path);
-				auto* actorClass = softClassPointer.LoadSynchronous();
-
-				FActorSpawnParameters actorSpawnParameters;
-				actorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-				SpawnActorWithFolderPath(actorClass, ActorsFolderPath, transform, actorSpawnParameters);
+				// 読み込まれていなければ読み込みの完了後にスポーンします
+				mAssetPrefetcher->LoadClass(spawnPath, [weakThis = TWeakObjectPtr<ADungeonGenerateBase>(this), generationSerial = mGenerationSerial, transform](UClass* actorClass)
+					{
+						if (!weakThis.IsValid() || actorClass == nullptr)
+							return;
+						// 読み込み中に再生成または破棄された
+						if (weakThis->mGenerationSerial != generationSerial)
+							return;
+
+						FActorSpawnParameters actorSpawnParameters;
+						actorSpawnParameters.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+						weakThis->SpawnActorWithFolderPath(actorClass, weakThis->ActorsFolderPath, transform, actorSpawnParameters);
+					}
+				);
 			}
 		}
 	);
@@ -1000,7 +1160,7 @@ void ADungeonGenerateBase::CreateImplement_AddFloorAndSlope(const CreateImplemen
 {
 	if (mOnAddSlope && cp.mGrid.CanBuildSlope())
 	{
-		const uint8 neighborMask6 = MakeNeighborMask6(mGenerator->GetGrid(cp.mGridLocation));
+		const uint8 neighborMask6 = MakeNeighborMask6(cp.mGrid);
 		/*
 		スロープのメッシュを生成
 		メッシュは原点からX軸とY軸方向に伸びており、面はZ軸が上面になっています。
@@ -1021,7 +1181,7 @@ void ADungeonGenerateBase::CreateImplement_AddFloorAndSlope(const CreateImplemen
 	}
 	else if (mOnAddFloor && cp.mGrid.CanBuildFloor(true))
 	{
-		const uint8 neighborMask6 = MakeNeighborMask6(mGenerator->GetGrid(cp.mGridLocation));
+		const uint8 neighborMask6 = MakeNeighborMask6(cp.mGrid);
 		/*
 		床のメッシュを生成
 		メッシュは原点からX軸とY軸方向に伸びており、面はZ軸が上面になっています。
@@ -1057,7 +1217,7 @@ void ADungeonGenerateBase::CreateImplement_AddFloorAndSlope(const CreateImplemen
 */
 void ADungeonGenerateBase::CreateImplement_ReserveWall(const CreateImplementParameter& cp)
 {
-	const uint8 neighborMask6 = MakeNeighborMask6(mGenerator->GetGrid(cp.mGridLocation));
+	const uint8 neighborMask6 = MakeNeighborMask6(cp.mGrid);
 	/*
 	壁のメッシュを生成
 	メッシュは原点からY軸とZ軸方向に伸びており、面はX軸が正面（北側の壁）になっています。
@@ -1182,7 +1342,7 @@ void ADungeonGenerateBase::CreateImplement_AddRoof(const CreateImplementParamete
 
 	if (cp.mGrid.CanBuildRoof(mGenerator->GetGrid(cp.mGridLocation.X, cp.mGridLocation.Y, cp.mGridLocation.Z + 1), true))
 	{
-		const uint8 neighborMask6 = MakeNeighborMask6(mGenerator->GetGrid(cp.mGridLocation));
+		const uint8 neighborMask6 = MakeNeighborMask6(cp.mGrid);
 		const UDungeonMeshSetDatabase* dungeonMeshSetDatabase;
 		//if (cp.mGrid.IsKindOfRoomType())
 		if (dungeon::Identifier(cp.mGrid.GetIdentifier()).IsType(dungeon::Identifier::Type::Aisle) == false)
@@ -1497,6 +1657,61 @@ void ADungeonGenerateBase::CreateImplement_AddPillarAndTorch(const CreateImpleme
 ADungeonRoomSensorBaseはリプリケートされない前提のアクターなので
 必ず同期乱数(GetSynchronizedRandom)を使ってください。
 */
+/*
+ * メッシュなどのパーツはパラメータからハードな参照を持つので、パラメータと一緒に読み込まれています。
+ * ソフトな参照はルームセンサーと通路がスポーンするアクターだけなので、レイアウトが使うものを集めて要求します。
+ * ルームセンサーのクラスは部屋ごとに同期乱数で選ぶため、候補のクラスを全て対象にします。
+ */
+void ADungeonGenerateBase::CreateImplement_PrefetchAssets(const bool hasAuthority)
+{
+	check(IsValid(mParameter));
+
+	// スポーンはサーバーだけが行います
+	if (!hasAuthority)
+		return;
+
+	bool rooms = false;
+	bool key = false;
+	bool uniqueKey = false;
+	mGenerator->ForEach([&rooms, &key, &uniqueKey](const std::shared_ptr<const dungeon::Room>& room)
+		{
+			const dungeon::Room::Parts parts = room->GetParts();
+			if (parts == dungeon::Room::Parts::Hall || parts == dungeon::Room::Parts::Hanare)
+				rooms = true;
+			if (room->GetItem() == dungeon::Room::Item::Key)
+				key = true;
+			if (room->GetItem() == dungeon::Room::Item::UniqueKey)
+				uniqueKey = true;
+		}
+	);
+
+	TArray<UClass*> roomSensorClasses;
+	if (UClass* roomSensorClass = mParameter->GetRoomSensorClass())
+		roomSensorClasses.Add(roomSensorClass);
+
+	TArray<FSoftObjectPath> blueprintPaths;
+	if (const auto* roomSensorDatabase = mParameter->GetRoomSensorDatabase())
+	{
+		for (const auto& roomSensorClass : roomSensorDatabase->GetRoomSensorClasses())
+		{
+			if (IsValid(roomSensorClass))
+				roomSensorClasses.AddUnique(roomSensorClass);
+		}
+		if (mAisleGridMap)
+			blueprintPaths.Append(roomSensorDatabase->GetSpawnActorInAisle());
+	}
+
+	for (const UClass* roomSensorClass : roomSensorClasses)
+	{
+		if (const auto* roomSensor = Cast<ADungeonRoomSensorBase>(roomSensorClass->GetDefaultObject()))
+			roomSensor->CollectSpawnActorPaths(blueprintPaths, rooms, key, uniqueKey);
+	}
+
+	if (!mAssetPrefetcher)
+		mAssetPrefetcher = std::make_shared<FDungeonAssetPrefetcher>();
+	mAssetPrefetcher->Prefetch(blueprintPaths);
+}
+
 void ADungeonGenerateBase::CreateImplement_PrepareSpawnRoomSensor(RoomAndRoomSensorMap& roomSensorCache, const bool hasAuthority) const
 {
 	check(IsValid(mParameter));
@@ -1538,6 +1753,8 @@ void ADungeonGenerateBase::CreateImplement_PrepareSpawnRoomSensor(RoomAndRoomSen
 						room->GetDepthFromStart(),
 						mGenerator->GetDeepestDepthFromStart()
 					);
+					if (IsValid(roomSensorActor) && UseVoxelRoomOccupancy())
+						roomSensorActor->DisableOverlapSensor();
 					roomSensorCache[room.get()] = roomSensorActor;
 				}
 			}
@@ -1567,6 +1784,22 @@ void ADungeonGenerateBase::CreateImplement_FinishSpawnRoomSensor(const RoomAndRo
 }
 
 
+/*
+ * ルームセンサーはサーバーだけにスポーンするので、追跡もサーバーだけで行います。
+ */
+void ADungeonGenerateBase::CreateImplement_RoomOccupancy(const RoomAndRoomSensorMap& roomSensorCache, const bool hasAuthority)
+{
+	mRoomOccupancyTracker.reset();
+	if (!hasAuthority || !UseVoxelRoomOccupancy() || !mGenerator || !mGenerator->GetVoxel())
+		return;
+
+	mRoomOccupancyTracker = std::make_shared<FDungeonRoomOccupancyTracker>(mGenerator->GetVoxel(), GetActorLocation(), mParameter->GetGridSize().To3D());
+	for (const auto& roomSensorActor : roomSensorCache)
+		mRoomOccupancyTracker->Register(roomSensorActor.second);
+
+	DUNGEON_GENERATOR_VERBOSE(TEXT("Room occupancy: tracking %d room sensors by voxel lookup"), mRoomOccupancyTracker->GetRoomSensorCount());
+}
+
 void ADungeonGenerateBase::CreateImplement_AddChandelier(const RoomAndRoomSensorMap& roomSensorCache, const bool hasAuthority) const
 {
 	MEASURE_TIME_START(stopwatch);
@@ -2198,11 +2431,40 @@ StaticMeshActorを使って地形をスポーンします。
 生成したアクターにDungeonComponentActivatorComponentを追加して処理負荷制御を行います。
 CRC32の計算を行うのでサーバーとクライアントの同期ずれを検出する事ができます。
 */
-AStaticMeshActor* ADungeonGenerateBase::SpawnStaticMeshActor(UStaticMesh* staticMesh, const FString& folderPath, const FTransform& transform, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod, const EStaticMeshPartitionRegistrationFace registrationFace) const
+AStaticMeshActor* ADungeonGenerateBase::SpawnStaticMeshActor(UStaticMesh* staticMesh, const FString& folderPath, const FTransform& transform, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod, const EStaticMeshPartitionRegistrationFace registrationFace)
 {
-	AStaticMeshActor* actor = SpawnActorDeferredImpl<AStaticMeshActor>(folderPath, transform, nullptr, spawnActorCollisionHandlingMethod);
-	if (IsValid(actor) == false)
-		return nullptr;
+	// 変化していないグリッドの前回の地形アクターはそのまま残す
+	if (mIncrementalRegeneration)
+	{
+		if (AStaticMeshActor* actor = mIncrementalRegeneration->Reuse(staticMesh, transform))
+		{
+			actor->Tags.AddUnique(GetDungeonGeneratorTag());
+#if WITH_EDITOR
+			actor->SetFolderPath(FName(dungeon::GetBaseDirectoryName() + TEXT("/") + folderPath));
+#endif
+			RestoreDefaultCollision(actor);
+			mSpawnedStaticMeshActors.Add(actor);
+			mCrc32AtCreation = ADungeonVerifiableActor::GenerateCrc32(transform, mCrc32AtCreation);
+			return actor;
+		}
+	}
+
+	// 前回の生成でプールしたアクターがあれば再利用する
+	AStaticMeshActor* actor = mActorPool.AcquireStaticMeshActor(staticMesh);
+	const bool reused = actor != nullptr;
+	if (reused)
+	{
+		actor->SetActorTransform(transform, false, nullptr, ETeleportType::ResetPhysics);
+#if WITH_EDITOR
+		actor->SetFolderPath(FName(dungeon::GetBaseDirectoryName() + TEXT("/") + folderPath));
+#endif
+	}
+	else
+	{
+		actor = SpawnActorDeferredImpl<AStaticMeshActor>(folderPath, transform, nullptr, spawnActorCollisionHandlingMethod);
+		if (IsValid(actor) == false)
+			return nullptr;
+	}
 
 	UStaticMeshComponent* staticMeshComponent = GetValid(actor->GetStaticMeshComponent());
 	const auto updateFixedPartitionRegistrationLocation = [registrationFace, staticMeshComponent](UDungeonComponentActivatorComponent* dungeonComponentActivatorComponent)
@@ -2246,17 +2508,34 @@ AStaticMeshActor* ADungeonGenerateBase::SpawnStaticMeshActor(UStaticMesh* static
 		staticMeshComponent->ComponentTags.AddUnique(GetDungeonGeneratorTerrainTag());
 	}
 
-	// 負荷制御コンポーネントを追加する
-	if (auto* dungeonComponentActivatorComponent = FindOrAddComponentActivatorComponent(actor))
+	if (reused)
 	{
-		dungeonComponentActivatorComponent->SetEnableCollisionEnableControl(false);
-		updateFixedPartitionRegistrationLocation(dungeonComponentActivatorComponent);
+		RestoreDefaultCollision(actor);
+		actor->SetActorEnableCollision(true);
+		actor->SetActorHiddenInGame(false);
+
+		if (auto* dungeonComponentActivatorComponent = actor->FindComponentByClass<UDungeonComponentActivatorComponent>())
+		{
+			updateFixedPartitionRegistrationLocation(dungeonComponentActivatorComponent);
+			dungeonComponentActivatorComponent->ReuseFromPool();
+		}
 	}
+	else
+	{
+		// 負荷制御コンポーネントを追加する
+		if (auto* dungeonComponentActivatorComponent = FindOrAddComponentActivatorComponent(actor))
+		{
+			dungeonComponentActivatorComponent->SetEnableCollisionEnableControl(false);
+			updateFixedPartitionRegistrationLocation(dungeonComponentActivatorComponent);
+		}
 
-	actor->FinishSpawning(transform, true);
+		actor->FinishSpawning(transform, true);
+
+		if (auto* dungeonComponentActivatorComponent = actor->FindComponentByClass<UDungeonComponentActivatorComponent>())
+			updateFixedPartitionRegistrationLocation(dungeonComponentActivatorComponent);
+	}
 
-	if (auto* dungeonComponentActivatorComponent = actor->FindComponentByClass<UDungeonComponentActivatorComponent>())
-		updateFixedPartitionRegistrationLocation(dungeonComponentActivatorComponent);
+	mSpawnedStaticMeshActors.Add(actor);
 
 	// CRC32を記録（必ずサーバーとクライアント両方で計算しないとCRC32が一致しなくなる）
 	mCrc32AtCreation = ADungeonVerifiableActor::GenerateCrc32(transform, mCrc32AtCreation);
@@ -2382,6 +2661,7 @@ ADungeonRoomSensorBase* ADungeonGenerateBase::SpawnRoomSensorActorDeferred(UClas
 	ADungeonRoomSensorBase* actor = SpawnActorDeferredImpl<ADungeonRoomSensorBase>(actorClass, SensorsFolderPath, transform, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
 	if (IsValid(actor))
 	{
+		actor->mAssetPrefetcher = mAssetPrefetcher;
 		const bool success = actor->InvokePrepare(
 			GetRandom(),
 			identifier,
@@ -2506,6 +2786,68 @@ uint32_t ADungeonGenerateBase::CalculateCRC32() const noexcept
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
+SIZE_T ADungeonGenerateBase::GetAllocatedSize() const
+{
+	SIZE_T size = 0;
+	if (mGenerator)
+		size += mGenerator->GetAllocatedSize();
+	if (mLocalRandom)
+		size += sizeof(dungeon::Random);
+	// UDungeonAisleGridMapは別のオブジェクトとして集計されるので含めません
+	size += dungeon::GetContiguousContainerAllocatedSize(mReservedWallInfo);
+	size += mActorPool.GetAllocatedSize();
+	return size;
+}
+
+void ADungeonGenerateBase::SampleGenerationMemory(const uint64 usedPhysicalAtStart)
+{
+	// PathFinderは通路生成後に解放されるので最大値を加算する
+	SIZE_T allocatedSize = GetAllocatedSize();
+	if (mGenerator)
+		allocatedSize += mGenerator->GetPeakPathFinderAllocatedSize();
+	mGenerationSampledAllocatedSize = std::max(mGenerationSampledAllocatedSize, allocatedSize);
+
+	const uint64 usedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+	if (usedPhysical > usedPhysicalAtStart)
+		mGenerationSampledUsedPhysicalDelta = std::max(mGenerationSampledUsedPhysicalDelta, usedPhysical - usedPhysicalAtStart);
+}
+
+void ADungeonGenerateBase::ReportAllocatedSize(FOutputDevice& outputDevice) const
+{
+	const auto toKiB = [](const uint64 size) { return static_cast<double>(size) / 1024.0; };
+
+	outputDevice.Logf(TEXT("%s: %.2f KiB"), *GetName(), toKiB(GetAllocatedSize()));
+	if (mGenerator)
+	{
+		const auto& voxel = mGenerator->GetVoxel();
+		outputDevice.Logf(TEXT("  Generator       : %.2f KiB"), toKiB(mGenerator->GetAllocatedSize()));
+		outputDevice.Logf(TEXT("  Voxel           : %.2f KiB (%d x %d x %d)"),
+			toKiB(voxel ? voxel->GetAllocatedSize() : 0),
+			voxel ? voxel->GetWidth() : 0, voxel ? voxel->GetDepth() : 0, voxel ? voxel->GetHeight() : 0);
+		int32 aisleCount = 0;
+		mGenerator->EachAisle([&aisleCount](const dungeon::Aisle&)
+			{
+				++aisleCount;
+				return true;
+			}
+		);
+		outputDevice.Logf(TEXT("  Rooms / Aisles  : %d / %d"), static_cast<int32>(mGenerator->GetRoomCount()), aisleCount);
+		outputDevice.Logf(TEXT("  PathFinder peak : %.2f KiB"), toKiB(mGenerator->GetPeakPathFinderAllocatedSize()));
+	}
+	if (IsValid(mAisleGridMap))
+	{
+		outputDevice.Logf(TEXT("  AisleGridMap    : %.2f KiB (separate object)"), toKiB(mAisleGridMap->GetAllocatedSize()));
+	}
+	outputDevice.Logf(TEXT("  ActorPool       : %.2f KiB (%d objects)"), toKiB(mActorPool.GetAllocatedSize()), mActorPool.Num());
+	outputDevice.Logf(TEXT("  Generation max  : %.2f KiB (process physical +%.2f KiB, sampled at phase ends)"),
+		toKiB(mGenerationSampledAllocatedSize), toKiB(mGenerationSampledUsedPhysicalDelta));
+}
+
+void ADungeonGenerateBase::GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(CumulativeResourceSize);
+	CumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetAllocatedSize());
+}
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 #if WITH_EDITOR
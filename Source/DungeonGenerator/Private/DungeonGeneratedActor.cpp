@@ -25,7 +25,35 @@ bool ADungeonGeneratedActor::Generate(const UDungeonGenerateParameter* parameter
 	}
 
 	TGuardValue<bool> generatingGuard(mIsGeneratingDungeon, true);
+	return GenerateImplementation(parameter);
+}
+
+/*
+ * 自身もDungeonGeneratorタグを持つので、Disposeで破棄されないように一時的にタグを外します。
+ */
+bool ADungeonGeneratedActor::RegenerateIncrementally(const UDungeonGenerateParameter* parameter)
+{
+	if (mIsGeneratingDungeon)
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("RegenerateIncrementally ignored because dungeon generation is already in progress."));
+		return false;
+	}
 
+	TGuardValue<bool> generatingGuard(mIsGeneratingDungeon, true);
+
+	if (IsValid(parameter))
+		BeginIncrementalRegeneration();
+
+	const bool tagged = Tags.Remove(GetDungeonGeneratorTag()) > 0;
+	Dispose(true);
+	if (tagged)
+		Tags.AddUnique(GetDungeonGeneratorTag());
+
+	return GenerateImplementation(parameter);
+}
+
+bool ADungeonGeneratedActor::GenerateImplementation(const UDungeonGenerateParameter* parameter)
+{
 	const bool generated = BeginDungeonGeneration(parameter, true);
 	if (generated)
 	{
@@ -5,9 +5,46 @@
  */
 
 #include "DungeonGeneratorModule.h"
+#include "DungeonGenerateBase.h"
+#include "MainLevel/DungeonMainLevelScriptActor.h"
+#include <Engine/World.h>
+#include <EngineUtils.h>
+#include <HAL/IConsoleManager.h>
 
 //#define LOCTEXT_NAMESPACE "FDungeonGeneratorModule"
 
+namespace
+{
+	/*
+	 * memreportから呼び出されるメモリ使用量の出力コマンド
+	 * Config/DefaultEngine.iniの[MemReportCommands]に登録しています
+	 */
+	FAutoConsoleCommandWithWorldArgsAndOutputDevice DungeonGeneratorMemReportCommand(
+		TEXT("DungeonGenerator.MemReport"),
+		TEXT("Outputs the memory held by the generated dungeons and the partitions"),
+		FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>&, UWorld* world, FOutputDevice& outputDevice)
+			{
+				if (!IsValid(world))
+					return;
+
+				outputDevice.Logf(TEXT("DungeonGenerator memory report"));
+				SIZE_T totalSize = 0;
+				for (TActorIterator<ADungeonGenerateBase> iterator(world); iterator; ++iterator)
+				{
+					iterator->ReportAllocatedSize(outputDevice);
+					totalSize += iterator->GetAllocatedSize();
+				}
+				if (const auto* levelScriptActor = Cast<ADungeonMainLevelScriptActor>(world->GetLevelScriptActor()))
+				{
+					levelScriptActor->ReportAllocatedSize(outputDevice);
+					totalSize += levelScriptActor->GetAllocatedSize();
+				}
+				outputDevice.Logf(TEXT("Total: %.2f KiB"), static_cast<double>(totalSize) / 1024.0);
+			}
+		)
+	);
+}
+
 void FDungeonGeneratorModule::StartupModule()
 {
 }
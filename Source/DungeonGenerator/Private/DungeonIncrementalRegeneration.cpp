@@ -0,0 +1,204 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonIncrementalRegeneration.h"
+#include "Core/Generator.h"
+#include "Core/Voxelization/Voxel.h"
+#include <Components/HierarchicalInstancedStaticMeshComponent.h>
+#include <Engine/StaticMeshActor.h>
+
+FDungeonIncrementalRegeneration::FKey::FKey(const UStaticMesh* staticMesh, const FTransform& transform)
+	: StaticMesh(staticMesh)
+{
+	// 浮動小数点の誤差で一致しなくならないように丸めます
+	const FVector location = transform.GetLocation();
+	const FRotator rotation = transform.Rotator();
+	const FVector scale = transform.GetScale3D();
+	Location = FIntVector(FMath::RoundToInt(location.X), FMath::RoundToInt(location.Y), FMath::RoundToInt(location.Z));
+	Rotation = FIntVector(FMath::RoundToInt(rotation.Pitch * 10.0), FMath::RoundToInt(rotation.Yaw * 10.0), FMath::RoundToInt(rotation.Roll * 10.0));
+	Scale = FIntVector(FMath::RoundToInt(scale.X * 1000.0), FMath::RoundToInt(scale.Y * 1000.0), FMath::RoundToInt(scale.Z * 1000.0));
+}
+
+bool FDungeonIncrementalRegeneration::FKey::operator==(const FKey& other) const noexcept
+{
+	return
+		StaticMesh == other.StaticMesh &&
+		Location == other.Location &&
+		Rotation == other.Rotation &&
+		Scale == other.Scale;
+}
+
+FDungeonIncrementalRegeneration::FDungeonIncrementalRegeneration(const std::shared_ptr<const dungeon::Generator>& previousGenerator, const FVector& origin)
+	: mPreviousGenerator(previousGenerator)
+	, mOrigin(origin)
+{
+}
+
+void FDungeonIncrementalRegeneration::AddCandidate(AStaticMeshActor* actor)
+{
+	const UStaticMeshComponent* staticMeshComponent = IsValid(actor) ? actor->GetStaticMeshComponent() : nullptr;
+	if (!IsValid(staticMeshComponent))
+		return;
+
+	mCandidates.FindOrAdd(FKey(staticMeshComponent->GetStaticMesh(), actor->GetActorTransform())).Add(actor);
+}
+
+/*
+ * インスタンスはコンポーネントのローカル座標で登録されているので、
+ * 生成時に要求されるトランスフォームと同じ座標系で比べられます。
+ */
+void FDungeonIncrementalRegeneration::AddCandidate(UInstancedStaticMeshComponent* component)
+{
+	if (!IsValid(component) || !IsValid(component->GetStaticMesh()))
+		return;
+
+	const bool hierarchical = Cast<UHierarchicalInstancedStaticMeshComponent>(component) != nullptr;
+	const int32 instanceCount = component->GetInstanceCount();
+	for (int32 index = 0; index < instanceCount; ++index)
+	{
+		FTransform transform;
+		if (component->GetInstanceTransform(index, transform))
+			mInstanceCandidates.FindOrAdd(FKey(component->GetStaticMesh(), transform)).Add({ component, index, hierarchical });
+	}
+}
+
+/*
+ * 壁、天井、柱はグリッドの境界に配置されるので、変化したグリッドを囲む
+ * 3x3x3のグリッドを変化したとみなします。
+ */
+void FDungeonIncrementalRegeneration::CollectChangedGrids(const dungeon::Voxel& voxel, const FVector& gridSize)
+{
+	mGridSize = gridSize;
+	mVoxelSize = FIntVector(voxel.GetWidth(), voxel.GetDepth(), voxel.GetHeight());
+	mAllChanged = true;
+	mChangedGridCount = mVoxelSize.X * mVoxelSize.Y * mVoxelSize.Z;
+
+	if (!mPreviousGenerator || !mPreviousGenerator->GetVoxel())
+		return;
+
+	std::vector<bool> changed;
+	if (!voxel.CollectChangedGrids(*mPreviousGenerator->GetVoxel(), changed))
+		return;
+
+	mChangedGrids.assign(changed.size(), false);
+	mChangedGridCount = 0;
+	for (int32 z = 0; z < mVoxelSize.Z; ++z)
+	{
+		for (int32 y = 0; y < mVoxelSize.Y; ++y)
+		{
+			for (int32 x = 0; x < mVoxelSize.X; ++x)
+			{
+				if (!changed[voxel.Index(x, y, z)])
+					continue;
+
+				++mChangedGridCount;
+				for (int32 dz = FMath::Max(z - 1, 0); dz <= FMath::Min(z + 1, mVoxelSize.Z - 1); ++dz)
+				{
+					for (int32 dy = FMath::Max(y - 1, 0); dy <= FMath::Min(y + 1, mVoxelSize.Y - 1); ++dy)
+					{
+						for (int32 dx = FMath::Max(x - 1, 0); dx <= FMath::Min(x + 1, mVoxelSize.X - 1); ++dx)
+						{
+							mChangedGrids[voxel.Index(dx, dy, dz)] = true;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	// 前回のボクセルは比較にしか使わないので解放します
+	mPreviousGenerator.reset();
+	mAllChanged = false;
+}
+
+bool FDungeonIncrementalRegeneration::IsChanged(const FVector& location) const
+{
+	if (mAllChanged)
+		return true;
+
+	const FVector gridLocation = (location - mOrigin) / mGridSize;
+	const int32 x = FMath::FloorToInt(gridLocation.X);
+	const int32 y = FMath::FloorToInt(gridLocation.Y);
+	const int32 z = FMath::FloorToInt(gridLocation.Z);
+	if (x < 0 || y < 0 || z < 0 || x >= mVoxelSize.X || y >= mVoxelSize.Y || z >= mVoxelSize.Z)
+		return true;
+
+	const size_t index = (static_cast<size_t>(z) * mVoxelSize.Y + y) * mVoxelSize.X + x;
+	return mChangedGrids[index];
+}
+
+AStaticMeshActor* FDungeonIncrementalRegeneration::Reuse(const UStaticMesh* staticMesh, const FTransform& transform)
+{
+	if (mCandidates.IsEmpty() || IsChanged(transform.GetLocation()))
+		return nullptr;
+
+	TArray<TWeakObjectPtr<AStaticMeshActor>>* actors = mCandidates.Find(FKey(staticMesh, transform));
+	if (actors == nullptr)
+		return nullptr;
+
+	while (!actors->IsEmpty())
+	{
+		AStaticMeshActor* actor = actors->Pop().Get();
+		if (IsValid(actor))
+		{
+			++mReusedCount;
+			return actor;
+		}
+	}
+	return nullptr;
+}
+
+bool FDungeonIncrementalRegeneration::ReuseInstance(const UStaticMesh* staticMesh, const FTransform& transform, const bool hierarchical)
+{
+	if (mInstanceCandidates.IsEmpty() || IsChanged(transform.GetLocation()))
+		return false;
+
+	TArray<FInstance>* instances = mInstanceCandidates.Find(FKey(staticMesh, transform));
+	if (instances == nullptr)
+		return false;
+
+	for (int32 index = instances->Num() - 1; index >= 0; --index)
+	{
+		const FInstance& instance = (*instances)[index];
+		if (instance.Hierarchical == hierarchical && instance.Component.IsValid())
+		{
+			instances->RemoveAtSwap(index);
+			++mReusedInstanceCount;
+			return true;
+		}
+	}
+	return false;
+}
+
+TArray<AStaticMeshActor*> FDungeonIncrementalRegeneration::TakeUnusedActors()
+{
+	TArray<AStaticMeshActor*> unusedActors;
+	for (auto& pair : mCandidates)
+	{
+		for (const auto& actor : pair.Value)
+		{
+			if (actor.IsValid())
+				unusedActors.Add(actor.Get());
+		}
+	}
+	mCandidates.Empty();
+	return unusedActors;
+}
+
+TMap<TWeakObjectPtr<UInstancedStaticMeshComponent>, TArray<int32>> FDungeonIncrementalRegeneration::TakeUnusedInstances()
+{
+	TMap<TWeakObjectPtr<UInstancedStaticMeshComponent>, TArray<int32>> unusedInstances;
+	for (auto& pair : mInstanceCandidates)
+	{
+		for (const FInstance& instance : pair.Value)
+		{
+			if (instance.Component.IsValid())
+				unusedInstances.FindOrAdd(instance.Component).Add(instance.Index);
+		}
+	}
+	mInstanceCandidates.Empty();
+	return unusedInstances;
+}
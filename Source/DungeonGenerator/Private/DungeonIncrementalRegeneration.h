@@ -0,0 +1,163 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <memory>
+#include <vector>
+
+class AStaticMeshActor;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+namespace dungeon
+{
+	class Generator;
+	class Voxel;
+}
+
+/**
+ * Reuses terrain actors and terrain mesh instances of the previous dungeon when regenerating.
+ * A terrain actor or instance is reused when the new generation requests the same mesh at the same
+ * transform and neither its grid nor the neighbouring grids that share its walls changed.
+ *
+ * 再生成時に前回のダンジョンの地形アクターと地形のメッシュインスタンスを再利用します。
+ * 新しい生成が同じメッシュを同じトランスフォームで要求し、そのグリッドと
+ * 壁を共有する隣のグリッドが変化していなければ地形アクターやインスタンスを再利用します。
+ */
+class FDungeonIncrementalRegeneration final
+{
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 *
+	 * @param[in]	previousGenerator	前回の生成に使ったジェネレーター
+	 * @param[in]	origin				ダンジョンの原点のワールド座標
+	 */
+	FDungeonIncrementalRegeneration(const std::shared_ptr<const dungeon::Generator>& previousGenerator, const FVector& origin);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonIncrementalRegeneration() = default;
+
+	/**
+	 * 再利用の候補となる地形アクターを追加します
+	 */
+	void AddCandidate(AStaticMeshActor* actor);
+
+	/**
+	 * 再利用の候補となる地形のメッシュインスタンスをコンポーネントから全て追加します
+	 */
+	void AddCandidate(UInstancedStaticMeshComponent* component);
+
+	/**
+	 * 新しいボクセルと前回のボクセルを比べて変化したグリッドを調べます
+	 *
+	 * @param[in]	voxel		新しいボクセル
+	 * @param[in]	gridSize	グリッドの大きさ
+	 */
+	void CollectChangedGrids(const dungeon::Voxel& voxel, const FVector& gridSize);
+
+	/**
+	 * 同じメッシュとトランスフォームを持つ変化していない地形アクターを取り出します
+	 *
+	 * @return		再利用できるアクターが無ければnullptr
+	 */
+	AStaticMeshActor* Reuse(const UStaticMesh* staticMesh, const FTransform& transform);
+
+	/**
+	 * 同じメッシュとトランスフォームを持つ変化していない地形のメッシュインスタンスを残します
+	 *
+	 * @param[in]	hierarchical	HierarchicalInstancedStaticMeshComponentのインスタンスを要求するならtrue
+	 * @return		再利用できるインスタンスが無ければfalse
+	 */
+	bool ReuseInstance(const UStaticMesh* staticMesh, const FTransform& transform, const bool hierarchical);
+
+	/**
+	 * 再利用されなかった地形アクターを取り出します
+	 */
+	TArray<AStaticMeshActor*> TakeUnusedActors();
+
+	/**
+	 * 再利用されなかった地形のメッシュインスタンスの番号をコンポーネントごとに取り出します
+	 */
+	TMap<TWeakObjectPtr<UInstancedStaticMeshComponent>, TArray<int32>> TakeUnusedInstances();
+
+	/**
+	 * 再利用したアクターの数
+	 */
+	int32 GetReusedCount() const noexcept;
+
+	/**
+	 * 再利用したメッシュインスタンスの数
+	 */
+	int32 GetReusedInstanceCount() const noexcept;
+
+	/**
+	 * 変化したグリッドの数
+	 */
+	int32 GetChangedGridCount() const noexcept;
+
+private:
+	struct FKey final
+	{
+		const UStaticMesh* StaticMesh = nullptr;
+		FIntVector Location;
+		FIntVector Rotation;
+		FIntVector Scale;
+
+		FKey(const UStaticMesh* staticMesh, const FTransform& transform);
+		bool operator==(const FKey& other) const noexcept;
+
+		friend uint32 GetTypeHash(const FKey& key)
+		{
+			uint32 hash = GetTypeHash(key.StaticMesh);
+			hash = HashCombine(hash, GetTypeHash(key.Location));
+			hash = HashCombine(hash, GetTypeHash(key.Rotation));
+			return HashCombine(hash, GetTypeHash(key.Scale));
+		}
+	};
+
+	struct FInstance final
+	{
+		TWeakObjectPtr<UInstancedStaticMeshComponent> Component;
+		int32 Index;
+		bool Hierarchical;
+	};
+
+	bool IsChanged(const FVector& location) const;
+
+	std::shared_ptr<const dungeon::Generator> mPreviousGenerator;
+	TMap<FKey, TArray<TWeakObjectPtr<AStaticMeshActor>>> mCandidates;
+	TMap<FKey, TArray<FInstance>> mInstanceCandidates;
+	// グリッドの番号ごとに、自身か壁を共有する隣のグリッドが変化したらtrue
+	std::vector<bool> mChangedGrids;
+	FVector mOrigin;
+	FVector mGridSize = FVector::OneVector;
+	FIntVector mVoxelSize = FIntVector::ZeroValue;
+	int32 mReusedCount = 0;
+	int32 mReusedInstanceCount = 0;
+	int32 mChangedGridCount = 0;
+	bool mAllChanged = true;
+};
+
+inline int32 FDungeonIncrementalRegeneration::GetReusedCount() const noexcept
+{
+	return mReusedCount;
+}
+
+inline int32 FDungeonIncrementalRegeneration::GetReusedInstanceCount() const noexcept
+{
+	return mReusedInstanceCount;
+}
+
+inline int32 FDungeonIncrementalRegeneration::GetChangedGridCount() const noexcept
+{
+	return mChangedGridCount;
+}
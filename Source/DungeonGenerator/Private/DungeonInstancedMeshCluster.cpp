@@ -5,12 +5,13 @@
  */
 
 #include "DungeonInstancedMeshCluster.h"
+#include "DungeonActorPool.h"
 #include "DungeonGenerateBase.h"
 #include "Core/Debug/Debug.h"
-#include "Core/Helper/Stopwatch.h"
+#include "MainLevel/DungeonComponentActivatorComponent.h"
 #include <Components/HierarchicalInstancedStaticMeshComponent.h>
 
-UInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrCreateInstance(AActor* actor, UStaticMesh* staticMesh)
+UInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrCreateInstance(AActor* actor, UStaticMesh* staticMesh, FDungeonActorPool* pool)
 {
 	for (auto& component : mComponents)
 	{
@@ -21,6 +22,16 @@ UInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrCreateInstanc
 		}
 	}
 
+	// プールにあれば再利用
+	if (pool)
+	{
+		if (auto* component = pool->AcquireInstancedStaticMeshComponent(staticMesh, false))
+		{
+			mComponents.Add(component);
+			return component;
+		}
+	}
+
     // UInstancedStaticMeshComponentを生成
 	auto* component = NewObject<UInstancedStaticMeshComponent>(actor);
 	actor->AddInstanceComponent(component);
@@ -32,7 +43,7 @@ UInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrCreateInstanc
 	return component;
 }
 
-UHierarchicalInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrCreateHierarchicalInstance(AActor* actor, UStaticMesh* staticMesh)
+UHierarchicalInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrCreateHierarchicalInstance(AActor* actor, UStaticMesh* staticMesh, FDungeonActorPool* pool)
 {
 	for (auto& component : mComponents)
 	{
@@ -43,6 +54,17 @@ UHierarchicalInstancedStaticMeshComponent* FDungeonInstancedMeshCluster::FindOrC
 		}
 	}
 
+	// プールにあれば再利用
+	if (pool)
+	{
+		if (auto* component = Cast<UHierarchicalInstancedStaticMeshComponent>(pool->AcquireInstancedStaticMeshComponent(staticMesh, true)))
+		{
+			component->bAutoRebuildTreeOnInstanceChanges = false;
+			mComponents.Add(component);
+			return component;
+		}
+	}
+
     // UHierarchicalInstancedStaticMeshComponentを生成
 	auto* component = NewObject<UHierarchicalInstancedStaticMeshComponent>(actor);
 	actor->AddInstanceComponent(component);
@@ -66,13 +88,12 @@ void FDungeonInstancedMeshCluster::BeginTransaction()
 	}
 }
 
-void FDungeonInstancedMeshCluster::EndTransaction()
+/*
+ * 数万インスタンスのツリー構築をここで同期的に行うとヒッチになるので、
+ * 構築は呼び出し元がフレームごとの予算の範囲で非同期に開始します。
+ */
+void FDungeonInstancedMeshCluster::EndTransaction(TArray<TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent>>& outdatedComponents)
 {
-#if defined(DEBUG_ENABLE_MEASURE_GENERATION_TIME)
-	dungeon::Stopwatch stopwatch;
-	int32 buildTreeCount = 0;
-#endif
-
 	mComponents.Shrink();
 
 	for (auto& component : mComponents)
@@ -80,22 +101,27 @@ void FDungeonInstancedMeshCluster::EndTransaction()
 		if (auto* hierarchicalInstancedStaticMeshComponent = Cast<UHierarchicalInstancedStaticMeshComponent>(component))
 		{
 			hierarchicalInstancedStaticMeshComponent->bAutoRebuildTreeOnInstanceChanges = true;
-			hierarchicalInstancedStaticMeshComponent->BuildTreeIfOutdated(true, false);
-#if defined(DEBUG_ENABLE_MEASURE_GENERATION_TIME)
-			++buildTreeCount;
-#endif
+			if (!hierarchicalInstancedStaticMeshComponent->IsTreeFullyBuilt())
+				outdatedComponents.Add(hierarchicalInstancedStaticMeshComponent);
 		}
 	}
-
-#if defined(DEBUG_ENABLE_MEASURE_GENERATION_TIME)
-	DUNGEON_GENERATOR_LOG(TEXT("FDungeonInstancedMeshCluster::EndTransaction Time: %lf seconds, BuildTreeCount=%d"), stopwatch.Lap(), buildTreeCount);
-#endif
 }
 
-void FDungeonInstancedMeshCluster::DestroyAll()
+void FDungeonInstancedMeshCluster::DestroyAll(FDungeonActorPool* pool)
 {
+	// パーティションが隠したコンポーネントを戻してからプールへ返却します
+	if (IsValid(mActivatorComponent))
+	{
+		mActivatorComponent->ResetForPool();
+		mActivatorComponent->DestroyComponent();
+	}
+	mActivatorComponent = nullptr;
+
 	for (auto& component : mComponents)
 	{
+		if (pool && pool->ReleaseInstancedStaticMeshComponent(component))
+			continue;
+
 		if (IsValid(component))
 		{
 			component->UnregisterComponent();
@@ -116,3 +142,79 @@ void FDungeonInstancedMeshCluster::SetCullDistance(const FInt32Interval& cullDis
 		}
 	}
 }
+
+void FDungeonInstancedMeshCluster::DisableCollision(const TSet<const UStaticMesh*>& staticMeshes)
+{
+	for (auto& component : mComponents)
+	{
+		if (IsValid(component))
+		{
+			const ECollisionEnabled::Type collisionEnabled = staticMeshes.Contains(component->GetStaticMesh())
+				? ECollisionEnabled::NoCollision
+				: CastChecked<UPrimitiveComponent>(component->GetArchetype())->GetCollisionEnabled();
+			component->SetCollisionEnabled(collisionEnabled);
+		}
+	}
+}
+
+/*
+ * アクティベータはオーナーアクターのTickやAIではなく、このクラスターのコンポーネントの表示だけを制御します。
+ * 当たり判定は残すので、非アクティブなパーティションでも地形をすり抜けません。
+ */
+void FDungeonInstancedMeshCluster::SetPartitionActivator(AActor* actor, const FVector& partitionRegistrationLocation)
+{
+	TArray<UActorComponent*> components;
+	components.Reserve(mComponents.Num());
+	for (const auto& component : mComponents)
+		components.Add(component);
+
+	if (!IsValid(mActivatorComponent))
+	{
+		mActivatorComponent = NewObject<UDungeonComponentActivatorComponent>(actor);
+		mActivatorComponent->SetEnableOwnerActorTickControl(false);
+		mActivatorComponent->SetEnableOwnerActorAiControl(false);
+		mActivatorComponent->SetEnableComponentActivationControl(false);
+		mActivatorComponent->SetEnableLightCastShadowControl(false);
+		mActivatorComponent->SetEnableCollisionEnableControl(false);
+		mActivatorComponent->SetFixedPartitionRegistrationWorldLocation(partitionRegistrationLocation);
+		mActivatorComponent->SetControlledComponents(components);
+		actor->AddInstanceComponent(mActivatorComponent);
+		mActivatorComponent->RegisterComponent();
+	}
+	else
+	{
+		mActivatorComponent->SetFixedPartitionRegistrationWorldLocation(partitionRegistrationLocation);
+		mActivatorComponent->SetControlledComponents(components);
+	}
+}
+
+void FDungeonInstancedMeshCluster::EachInstances(const std::function<void(UStaticMesh*, bool, const TArray<FTransform>&)>& function) const
+{
+	TArray<FTransform> transforms;
+	for (const auto& component : mComponents)
+	{
+		if (!IsValid(component))
+			continue;
+
+		const int32 instanceCount = component->GetInstanceCount();
+		transforms.SetNum(instanceCount);
+		for (int32 index = 0; index < instanceCount; ++index)
+			component->GetInstanceTransform(index, transforms[index]);
+		function(component->GetStaticMesh(), Cast<UHierarchicalInstancedStaticMeshComponent>(component) != nullptr, transforms);
+	}
+}
+
+void FDungeonInstancedMeshCluster::EachComponents(const std::function<void(UInstancedStaticMeshComponent*)>& function) const
+{
+	for (const auto& component : mComponents)
+	{
+		if (IsValid(component))
+			function(component);
+	}
+}
+
+SIZE_T FDungeonInstancedMeshCluster::GetAllocatedSize() const
+{
+	// コンポーネントはmemreportが別に集計するので配列だけを数えます
+	return mComponents.GetAllocatedSize();
+}
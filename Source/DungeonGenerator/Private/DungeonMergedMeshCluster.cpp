@@ -0,0 +1,215 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonMergedMeshCluster.h"
+#include "Core/Debug/Debug.h"
+#include <Engine/StaticMesh.h>
+#include <MeshDescription.h>
+#include <PhysicsEngine/BodySetup.h>
+#include <StaticMeshAttributes.h>
+#include <StaticMeshResources.h>
+
+void FDungeonMergedMeshCluster::Add(UStaticMesh* staticMesh, const FTransform& transform)
+{
+	if (!IsValid(staticMesh))
+		return;
+
+	mStaticMeshes.Add(staticMesh);
+	mTransforms.Add(transform);
+}
+
+bool FDungeonMergedMeshCluster::IsEmpty() const noexcept
+{
+	return mStaticMeshes.IsEmpty();
+}
+
+FVector FDungeonMergedMeshCluster::GetCenter() const
+{
+	FBox bounds(ForceInit);
+	for (const FTransform& transform : mTransforms)
+		bounds += transform.GetTranslation();
+	return bounds.IsValid ? bounds.GetCenter() : FVector::ZeroVector;
+}
+
+/*
+ * クックされたゲームではAllow CPU Accessが有効なメッシュだけ頂点をCPUから読めます。
+ */
+bool FDungeonMergedMeshCluster::CanMerge(const UStaticMesh* staticMesh)
+{
+	if (!IsValid(staticMesh))
+		return false;
+
+	const FStaticMeshRenderData* renderData = staticMesh->GetRenderData();
+	if (renderData == nullptr || renderData->LODResources.IsEmpty())
+		return false;
+
+#if WITH_EDITOR
+	return true;
+#else
+	return staticMesh->bAllowCPUAccess;
+#endif
+}
+
+/*
+ * 各タイルのLOD0の描画データをCPUで読み、pivotを原点とした座標に変換して
+ * 一つのMeshDescriptionにまとめます。同じマテリアルのセクションは同じポリゴングループに
+ * まとめるので、描画コールは部屋ごとのマテリアルの数になります。
+ */
+UStaticMesh* FDungeonMergedMeshCluster::Build(UObject* outer, const FVector& pivot, TArray<UStaticMesh*>& unmergedStaticMeshes, TArray<FTransform>& unmergedTransforms) const
+{
+	FMeshDescription meshDescription;
+	FStaticMeshAttributes attributes(meshDescription);
+	attributes.Register();
+
+	auto vertexPositions = attributes.GetVertexPositions();
+	auto vertexInstanceNormals = attributes.GetVertexInstanceNormals();
+	auto vertexInstanceTangents = attributes.GetVertexInstanceTangents();
+	auto vertexInstanceBinormalSigns = attributes.GetVertexInstanceBinormalSigns();
+	auto vertexInstanceUVs = attributes.GetVertexInstanceUVs();
+	auto polygonGroupMaterialSlotNames = attributes.GetPolygonGroupMaterialSlotNames();
+
+	// UVチャンネル数は結合するメッシュの最大に合わせます
+	int32 numTexCoords = 1;
+	for (const UStaticMesh* staticMesh : mStaticMeshes)
+	{
+		if (CanMerge(staticMesh))
+			numTexCoords = FMath::Max(numTexCoords, static_cast<int32>(staticMesh->GetRenderData()->LODResources[0].GetNumTexCoords()));
+	}
+	vertexInstanceUVs.SetNumChannels(FMath::Min(numTexCoords, static_cast<int32>(MAX_STATIC_TEXCOORDS)));
+
+	TMap<UMaterialInterface*, FPolygonGroupID> polygonGroups;
+	TArray<FStaticMaterial> staticMaterials;
+	TArray<FVertexInstanceID> vertexInstanceIDs;
+	int32 mergedTileCount = 0;
+
+	for (int32 tileIndex = 0; tileIndex < mStaticMeshes.Num(); ++tileIndex)
+	{
+		UStaticMesh* staticMesh = mStaticMeshes[tileIndex];
+		const FTransform& tileTransform = mTransforms[tileIndex];
+		if (!CanMerge(staticMesh))
+		{
+			unmergedStaticMeshes.Add(staticMesh);
+			unmergedTransforms.Add(tileTransform);
+			continue;
+		}
+
+		const FStaticMeshLODResources& lodResources = staticMesh->GetRenderData()->LODResources[0];
+		const FPositionVertexBuffer& positionVertexBuffer = lodResources.VertexBuffers.PositionVertexBuffer;
+		const FStaticMeshVertexBuffer& staticMeshVertexBuffer = lodResources.VertexBuffers.StaticMeshVertexBuffer;
+		const int32 vertexCount = static_cast<int32>(positionVertexBuffer.GetNumVertices());
+		const int32 tileTexCoords = FMath::Min(static_cast<int32>(staticMeshVertexBuffer.GetNumTexCoords()), vertexInstanceUVs.GetNumChannels());
+
+		FTransform transform = tileTransform;
+		transform.AddToTranslation(-pivot);
+
+		// 法線は逆転置行列で変換し、反転したスケールでは三角形の向きを戻します
+		const FVector scale = transform.GetScale3D();
+		const FVector inverseScale(
+			FMath::IsNearlyZero(scale.X) ? 0.0 : 1.0 / scale.X,
+			FMath::IsNearlyZero(scale.Y) ? 0.0 : 1.0 / scale.Y,
+			FMath::IsNearlyZero(scale.Z) ? 0.0 : 1.0 / scale.Z
+		);
+		const bool mirrored = transform.GetDeterminant() < 0.f;
+
+		meshDescription.ReserveNewVertices(vertexCount);
+		meshDescription.ReserveNewVertexInstances(vertexCount);
+		vertexInstanceIDs.SetNumUninitialized(vertexCount);
+		for (int32 vertexIndex = 0; vertexIndex < vertexCount; ++vertexIndex)
+		{
+			const FVertexID vertexID = meshDescription.CreateVertex();
+			vertexPositions[vertexID] = FVector3f(transform.TransformPosition(FVector(positionVertexBuffer.VertexPosition(vertexIndex))));
+
+			const FVertexInstanceID vertexInstanceID = meshDescription.CreateVertexInstance(vertexID);
+			vertexInstanceIDs[vertexIndex] = vertexInstanceID;
+
+			const FVector4f tangentZ = staticMeshVertexBuffer.VertexTangentZ(vertexIndex);
+			const FVector4f tangentX = staticMeshVertexBuffer.VertexTangentX(vertexIndex);
+			const FVector normal = transform.GetRotation().RotateVector(FVector(tangentZ.X, tangentZ.Y, tangentZ.Z) * inverseScale);
+			const FVector tangent = transform.TransformVector(FVector(tangentX.X, tangentX.Y, tangentX.Z));
+			vertexInstanceNormals[vertexInstanceID] = FVector3f(normal.GetSafeNormal());
+			vertexInstanceTangents[vertexInstanceID] = FVector3f(tangent.GetSafeNormal());
+			vertexInstanceBinormalSigns[vertexInstanceID] = mirrored ? -tangentZ.W : tangentZ.W;
+
+			for (int32 uvIndex = 0; uvIndex < tileTexCoords; ++uvIndex)
+				vertexInstanceUVs.Set(vertexInstanceID, uvIndex, staticMeshVertexBuffer.GetVertexUV(vertexIndex, uvIndex));
+		}
+
+		for (const FStaticMeshSection& section : lodResources.Sections)
+		{
+			UMaterialInterface* material = staticMesh->GetMaterial(section.MaterialIndex);
+			FPolygonGroupID polygonGroupID;
+			if (const FPolygonGroupID* found = polygonGroups.Find(material))
+			{
+				polygonGroupID = *found;
+			}
+			else
+			{
+				const FName slotName(*FString::Printf(TEXT("Material%d"), staticMaterials.Num()));
+				polygonGroupID = meshDescription.CreatePolygonGroup();
+				polygonGroupMaterialSlotNames[polygonGroupID] = slotName;
+				polygonGroups.Add(material, polygonGroupID);
+				staticMaterials.Emplace(material, slotName);
+			}
+
+			meshDescription.ReserveNewTriangles(section.NumTriangles);
+			for (uint32 triangle = 0; triangle < section.NumTriangles; ++triangle)
+			{
+				const uint32 firstIndex = section.FirstIndex + triangle * 3;
+				FVertexInstanceID corners[3] = {
+					vertexInstanceIDs[lodResources.IndexBuffer.GetIndex(firstIndex + 0)],
+					vertexInstanceIDs[lodResources.IndexBuffer.GetIndex(firstIndex + 1)],
+					vertexInstanceIDs[lodResources.IndexBuffer.GetIndex(firstIndex + 2)]
+				};
+				if (mirrored)
+					Swap(corners[1], corners[2]);
+				meshDescription.CreateTriangle(polygonGroupID, corners);
+			}
+		}
+
+		++mergedTileCount;
+	}
+
+	if (mergedTileCount == 0)
+		return nullptr;
+
+	UStaticMesh* mergedStaticMesh = NewObject<UStaticMesh>(outer, NAME_None, RF_Transient);
+	mergedStaticMesh->SetStaticMaterials(staticMaterials);
+	mergedStaticMesh->bAllowCPUAccess = true;
+	mergedStaticMesh->NeverStream = true;
+
+	UStaticMesh::FBuildMeshDescriptionsParams buildParameters;
+	buildParameters.bBuildSimpleCollision = false;
+	buildParameters.bCommitMeshDescription = false;
+	buildParameters.bFastBuild = true;
+	buildParameters.bAllowCpuAccess = true;
+	if (!mergedStaticMesh->BuildFromMeshDescriptions({ &meshDescription }, buildParameters))
+	{
+		DUNGEON_GENERATOR_ERROR(TEXT("Failed to build merged static mesh (%d tiles)"), mergedTileCount);
+		return nullptr;
+	}
+
+	// 結合したメッシュは形状が複雑なので、描画用の三角形をそのまま衝突判定に使います
+	mergedStaticMesh->CreateBodySetup();
+	if (UBodySetup* bodySetup = mergedStaticMesh->GetBodySetup())
+	{
+		bodySetup->CollisionTraceFlag = CTF_UseComplexAsSimple;
+		bodySetup->InvalidatePhysicsData();
+		bodySetup->CreatePhysicsMeshes();
+	}
+
+	return mergedStaticMesh;
+}
+
+void FDungeonMergedMeshCluster::Reset()
+{
+	mStaticMeshes.Reset();
+	mTransforms.Reset();
+}
+
+SIZE_T FDungeonMergedMeshCluster::GetAllocatedSize() const
+{
+	return mStaticMeshes.GetAllocatedSize() + mTransforms.GetAllocatedSize();
+}
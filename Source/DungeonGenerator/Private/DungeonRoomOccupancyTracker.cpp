@@ -0,0 +1,103 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonRoomOccupancyTracker.h"
+#include "Core/Helper/Identifier.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+#include "SubActor/DungeonRoomSensorBase.h"
+#include <Engine/World.h>
+#include <GameFramework/Pawn.h>
+#include <GameFramework/PlayerController.h>
+
+FDungeonRoomOccupancyTracker::FDungeonRoomOccupancyTracker(const std::shared_ptr<const dungeon::Voxel>& voxel, const FVector& origin, const FVector& gridSize)
+	: mVoxel(voxel)
+	, mOrigin(origin)
+	, mGridSize(gridSize)
+{
+}
+
+void FDungeonRoomOccupancyTracker::Register(ADungeonRoomSensorBase* roomSensor)
+{
+	if (IsValid(roomSensor))
+		mRoomSensors.Add(static_cast<uint16>(roomSensor->GetIdentifier()), roomSensor);
+}
+
+/*
+ * オーバーラップイベントと同じく、プレイヤーコントローラーが操作するポーンだけを対象にします。
+ * 全てのポーンの部屋を求めてから前回と比較するので、部屋の移動は退室、入室の順に通知します。
+ */
+void FDungeonRoomOccupancyTracker::Update(const UWorld* world)
+{
+	if (!IsValid(world) || !mVoxel)
+		return;
+
+	mCurrentRooms.Reset();
+	for (auto iterator = world->GetPlayerControllerIterator(); iterator; ++iterator)
+	{
+		const APlayerController* playerController = iterator->Get();
+		if (!IsValid(playerController))
+			continue;
+		APawn* pawn = playerController->GetPawn();
+		if (!IsValid(pawn))
+			continue;
+		mCurrentRooms.Add(pawn, FindRoomIdentifier(pawn->GetActorLocation()));
+	}
+
+	for (const auto& previousRoom : mPreviousRooms)
+	{
+		const uint16* currentRoom = mCurrentRooms.Find(previousRoom.Key);
+		if (currentRoom == nullptr || *currentRoom != previousRoom.Value)
+			Leave(previousRoom.Value, previousRoom.Key.Get());
+	}
+
+	for (const auto& currentRoom : mCurrentRooms)
+	{
+		const uint16* previousRoom = mPreviousRooms.Find(currentRoom.Key);
+		if (previousRoom == nullptr || *previousRoom != currentRoom.Value)
+			Enter(currentRoom.Value);
+	}
+
+	Swap(mPreviousRooms, mCurrentRooms);
+}
+
+uint16 FDungeonRoomOccupancyTracker::FindRoomIdentifier(const FVector& location) const
+{
+	const FVector gridLocation = (location - mOrigin) / mGridSize;
+	const int32 x = FMath::FloorToInt32(gridLocation.X);
+	const int32 y = FMath::FloorToInt32(gridLocation.Y);
+	const int32 z = FMath::FloorToInt32(gridLocation.Z);
+	if (x < 0 || y < 0 || z < 0)
+		return InvalidRoomIdentifier;
+
+	const dungeon::Grid& grid = mVoxel->Get(x, y, z);
+	const uint16 identifier = grid.GetIdentifier();
+	if (!dungeon::Identifier::IsType(identifier, dungeon::Identifier::Type::Room))
+		return InvalidRoomIdentifier;
+	return mRoomSensors.Contains(identifier) ? identifier : InvalidRoomIdentifier;
+}
+
+void FDungeonRoomOccupancyTracker::Enter(const uint16 roomIdentifier) const
+{
+	const TWeakObjectPtr<ADungeonRoomSensorBase>* roomSensor = mRoomSensors.Find(roomIdentifier);
+	if (roomSensor && roomSensor->IsValid())
+		(*roomSensor)->InvokeEnter();
+}
+
+/*
+ * 部屋の底面より下で退室した場合は奈落に落ちたと判断します。
+ */
+void FDungeonRoomOccupancyTracker::Leave(const uint16 roomIdentifier, const APawn* pawn) const
+{
+	const TWeakObjectPtr<ADungeonRoomSensorBase>* roomSensor = mRoomSensors.Find(roomIdentifier);
+	if (roomSensor == nullptr || !roomSensor->IsValid())
+		return;
+
+	const bool fallToAbyss = IsValid(pawn) && pawn->GetActorLocation().Z < (*roomSensor)->GetRoomSize().Min.Z;
+	(*roomSensor)->InvokeLeave(fallToAbyss);
+	if (fallToAbyss)
+		(*roomSensor)->OnFallToAbyss.Broadcast();
+}
@@ -0,0 +1,86 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <memory>
+
+class ADungeonRoomSensorBase;
+class APawn;
+class UWorld;
+
+namespace dungeon
+{
+	class Voxel;
+}
+
+/**
+ * Tracks which room each player pawn is in by looking up the generated voxel.
+ * Positions are mapped to room identifiers once per tick in a batch, and the room sensors
+ * receive the same enter and leave notifications as their overlap events.
+ * The room sensors do not need box collision while this is used.
+ *
+ * 生成したボクセルを参照して、プレイヤーのポーンがどの部屋にいるかを追跡します。
+ * ティック毎に位置をまとめて部屋の識別子に変換し、ルームセンサーにはオーバーラップイベントと
+ * 同じ入室と退室の通知を行います。これを使う間、ルームセンサーは箱のコリジョンを必要としません。
+ */
+class FDungeonRoomOccupancyTracker final
+{
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 * @param[in]	voxel		生成したボクセル
+	 * @param[in]	origin		ボクセルの原点のワールド座標
+	 * @param[in]	gridSize	グリッドの大きさ
+	 */
+	FDungeonRoomOccupancyTracker(const std::shared_ptr<const dungeon::Voxel>& voxel, const FVector& origin, const FVector& gridSize);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonRoomOccupancyTracker() = default;
+
+	/**
+	 * ルームセンサーを登録します
+	 * @param[in]	roomSensor	部屋の識別子を持つルームセンサー
+	 */
+	void Register(ADungeonRoomSensorBase* roomSensor);
+
+	/**
+	 * プレイヤーのポーンがいる部屋を更新して、入室と退室をルームセンサーに通知します
+	 * @param[in]	world		プレイヤーコントローラーを探すワールド
+	 */
+	void Update(const UWorld* world);
+
+	/**
+	 * 登録されたルームセンサーの数
+	 */
+	int32 GetRoomSensorCount() const noexcept;
+
+private:
+	uint16 FindRoomIdentifier(const FVector& location) const;
+	void Enter(const uint16 roomIdentifier) const;
+	void Leave(const uint16 roomIdentifier, const APawn* pawn) const;
+
+	static constexpr uint16 InvalidRoomIdentifier = static_cast<uint16>(~0);
+
+	std::shared_ptr<const dungeon::Voxel> mVoxel;
+	FVector mOrigin;
+	FVector mGridSize;
+
+	TMap<uint16, TWeakObjectPtr<ADungeonRoomSensorBase>> mRoomSensors;
+
+	// 前回と今回の更新でポーンがいた部屋
+	TMap<TWeakObjectPtr<APawn>, uint16> mPreviousRooms;
+	TMap<TWeakObjectPtr<APawn>, uint16> mCurrentRooms;
+};
+
+inline int32 FDungeonRoomOccupancyTracker::GetRoomSensorCount() const noexcept
+{
+	return mRoomSensors.Num();
+}
@@ -0,0 +1,254 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonSimplifiedCollisionBuilder.h"
+#include "Core/Helper/Direction.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+#include <vector>
+
+namespace
+{
+	// タイルと箱を比較する時の許容誤差
+	constexpr double TileValidationTolerance = 1.0;
+}
+
+FDungeonSimplifiedCollisionBuilder::FDungeonSimplifiedCollisionBuilder(const FVector& gridSize, const double thickness, const bool mergeRooms)
+	: mGridSize(gridSize)
+	, mThickness(FMath::Max(thickness, 1.0))
+	, mMergeRooms(mergeRooms)
+{
+}
+
+/*
+ * 平面ごとに、未処理の面からX方向へ伸ばせるだけ伸ばし、
+ * 次にその幅のままY方向へ伸ばせるだけ伸ばした矩形を一つの箱にします。
+ */
+int32 FDungeonSimplifiedCollisionBuilder::Build(const dungeon::Voxel& voxel, Partitions& outPartitions) const
+{
+	Planes planes;
+	CollectFaces(voxel, planes);
+
+	int32 faceCount = 0;
+	std::vector<bool> faces;
+	for (const auto& plane : planes)
+	{
+		FIntPoint min(MAX_int32, MAX_int32);
+		FIntPoint max(MIN_int32, MIN_int32);
+		for (const FIntPoint& point : plane.Value)
+		{
+			min = min.ComponentMin(point);
+			max = max.ComponentMax(point);
+		}
+
+		const int32 width = max.X - min.X + 1;
+		const int32 height = max.Y - min.Y + 1;
+		faces.assign(static_cast<size_t>(width) * height, false);
+		for (const FIntPoint& point : plane.Value)
+			faces[(point.Y - min.Y) * width + (point.X - min.X)] = true;
+		faceCount += plane.Value.Num();
+
+		TArray<FBox>& boxes = outPartitions.FindOrAdd(GetPartition(plane.Key));
+		for (int32 v = 0; v < height; ++v)
+		{
+			for (int32 u = 0; u < width; ++u)
+			{
+				if (!faces[v * width + u])
+					continue;
+
+				int32 u1 = u + 1;
+				while (u1 < width && faces[v * width + u1])
+					++u1;
+
+				int32 v1 = v + 1;
+				for (; v1 < height; ++v1)
+				{
+					bool filled = true;
+					for (int32 x = u; x < u1 && filled; ++x)
+						filled = faces[v1 * width + x];
+					if (!filled)
+						break;
+				}
+
+				for (int32 y = v; y < v1; ++y)
+				{
+					for (int32 x = u; x < u1; ++x)
+						faces[y * width + x] = false;
+				}
+
+				boxes.Add(ToBox(plane.Key, min + FIntPoint(u, v), min + FIntPoint(u1, v1)));
+			}
+		}
+	}
+
+	return faceCount;
+}
+
+int32 FDungeonSimplifiedCollisionBuilder::Validate(const dungeon::Voxel& voxel, const Partitions& partitions) const
+{
+	Planes planes;
+	CollectFaces(voxel, planes);
+
+	int32 errorCount = 0;
+	for (const auto& plane : planes)
+	{
+		const TArray<FBox>* boxes = partitions.Find(GetPartition(plane.Key));
+		for (const FIntPoint& point : plane.Value)
+		{
+			const FVector center = ToBox(plane.Key, point, point + FIntPoint(1, 1)).GetCenter();
+			int32 coveredCount = 0;
+			if (boxes)
+			{
+				for (const FBox& box : *boxes)
+				{
+					if (box.IsInside(center))
+						++coveredCount;
+				}
+			}
+			if (coveredCount != 1)
+				++errorCount;
+		}
+	}
+	return errorCount;
+}
+
+/*
+ * 箱の数が少ないので、全ての箱を総当たりで調べます。
+ */
+int32 FDungeonSimplifiedCollisionBuilder::ValidateTiles(const TArray<FBox>& tileBounds, const Partitions& partitions, int32& outTraceErrorCount) const
+{
+	TArray<FBox> boxes;
+	for (const auto& partition : partitions)
+		boxes.Append(partition.Value);
+
+	int32 overlapErrorCount = 0;
+	outTraceErrorCount = 0;
+	for (const FBox& tile : tileBounds)
+	{
+		const FBox expandedTile = tile.ExpandBy(TileValidationTolerance);
+
+		bool overlapped = false;
+		for (const FBox& box : boxes)
+		{
+			if (box.Intersect(expandedTile))
+			{
+				overlapped = true;
+				break;
+			}
+		}
+		if (!overlapped)
+			++overlapErrorCount;
+
+		// タイルの最も薄い軸に沿って、グリッドの大きさの分だけトレースします
+		const FVector size = tile.GetSize();
+		int32 axis = 0;
+		if (size.Y < size[axis])
+			axis = 1;
+		if (size.Z < size[axis])
+			axis = 2;
+		FVector direction = FVector::ZeroVector;
+		direction[axis] = mGridSize[axis];
+		const FVector center = tile.GetCenter();
+		const FVector start = center - direction;
+		const FVector end = center + direction;
+
+		bool hit = false;
+		for (const FBox& box : boxes)
+		{
+			FVector hitLocation;
+			FVector hitNormal;
+			float hitTime;
+			if (FMath::LineExtentBoxIntersection(box, start, end, FVector::ZeroVector, hitLocation, hitNormal, hitTime) &&
+				tile.ExpandBy(mThickness + TileValidationTolerance).IsInsideOrOn(hitLocation))
+			{
+				hit = true;
+				break;
+			}
+		}
+		if (!hit)
+			++outTraceErrorCount;
+	}
+	return overlapErrorCount;
+}
+
+/*
+ * 床、壁、天井のメッシュを配置する条件はADungeonGenerateBaseと同じです。
+ * スロープとキャットウォークは箱で表せないので含めません。
+ */
+void FDungeonSimplifiedCollisionBuilder::CollectFaces(const dungeon::Voxel& voxel, Planes& outPlanes) const
+{
+	voxel.Each([this, &voxel, &outPlanes](const FIntVector& location, const dungeon::Grid& grid)
+		{
+			const uint16 partition = grid.GetIdentifier();
+			if (!grid.CanBuildSlope() && grid.CanBuildFloor(true) && !grid.IsCatwalk())
+				outPlanes.FindOrAdd(MakePlaneKey(partition, Face::Floor, location.Z)).Emplace(location.X, location.Y);
+
+			if (grid.CanBuildRoof(voxel.Get(location.X, location.Y, location.Z + 1), true))
+				outPlanes.FindOrAdd(MakePlaneKey(partition, Face::Roof, location.Z + 1)).Emplace(location.X, location.Y);
+
+			if (grid.CanBuildWall(voxel.Get(location.X, location.Y - 1, location.Z), dungeon::Direction::North, mMergeRooms))
+				outPlanes.FindOrAdd(MakePlaneKey(partition, Face::North, location.Y)).Emplace(location.X, location.Z);
+			if (grid.CanBuildWall(voxel.Get(location.X, location.Y + 1, location.Z), dungeon::Direction::South, mMergeRooms))
+				outPlanes.FindOrAdd(MakePlaneKey(partition, Face::South, location.Y + 1)).Emplace(location.X, location.Z);
+			if (grid.CanBuildWall(voxel.Get(location.X + 1, location.Y, location.Z), dungeon::Direction::East, mMergeRooms))
+				outPlanes.FindOrAdd(MakePlaneKey(partition, Face::East, location.X + 1)).Emplace(location.Y, location.Z);
+			if (grid.CanBuildWall(voxel.Get(location.X - 1, location.Y, location.Z), dungeon::Direction::West, mMergeRooms))
+				outPlanes.FindOrAdd(MakePlaneKey(partition, Face::West, location.X)).Emplace(location.Y, location.Z);
+
+			return true;
+		}
+	);
+}
+
+FBox FDungeonSimplifiedCollisionBuilder::ToBox(const uint64 planeKey, const FIntPoint& min, const FIntPoint& max) const
+{
+	const Face face = static_cast<Face>((planeKey >> 32) & 0xff);
+	const int32 plane = static_cast<int32>(static_cast<uint32>(planeKey));
+
+	switch (face)
+	{
+	case Face::Floor:
+		return FBox(
+			FVector(min.X * mGridSize.X, min.Y * mGridSize.Y, plane * mGridSize.Z - mThickness),
+			FVector(max.X * mGridSize.X, max.Y * mGridSize.Y, plane * mGridSize.Z));
+
+	case Face::Roof:
+		return FBox(
+			FVector(min.X * mGridSize.X, min.Y * mGridSize.Y, plane * mGridSize.Z),
+			FVector(max.X * mGridSize.X, max.Y * mGridSize.Y, plane * mGridSize.Z + mThickness));
+
+	case Face::North:
+		return FBox(
+			FVector(min.X * mGridSize.X, plane * mGridSize.Y - mThickness, min.Y * mGridSize.Z),
+			FVector(max.X * mGridSize.X, plane * mGridSize.Y, max.Y * mGridSize.Z));
+
+	case Face::South:
+		return FBox(
+			FVector(min.X * mGridSize.X, plane * mGridSize.Y, min.Y * mGridSize.Z),
+			FVector(max.X * mGridSize.X, plane * mGridSize.Y + mThickness, max.Y * mGridSize.Z));
+
+	case Face::East:
+		return FBox(
+			FVector(plane * mGridSize.X, min.X * mGridSize.Y, min.Y * mGridSize.Z),
+			FVector(plane * mGridSize.X + mThickness, max.X * mGridSize.Y, max.Y * mGridSize.Z));
+
+	case Face::West:
+	default:
+		return FBox(
+			FVector(plane * mGridSize.X - mThickness, min.X * mGridSize.Y, min.Y * mGridSize.Z),
+			FVector(plane * mGridSize.X, max.X * mGridSize.Y, max.Y * mGridSize.Z));
+	}
+}
+
+uint64 FDungeonSimplifiedCollisionBuilder::MakePlaneKey(const uint16 partition, const Face face, const int32 plane) noexcept
+{
+	return (static_cast<uint64>(partition) << 40) | (static_cast<uint64>(face) << 32) | static_cast<uint32>(plane);
+}
+
+uint16 FDungeonSimplifiedCollisionBuilder::GetPartition(const uint64 planeKey) noexcept
+{
+	return static_cast<uint16>(planeKey >> 40);
+}
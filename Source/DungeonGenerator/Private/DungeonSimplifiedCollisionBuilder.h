@@ -0,0 +1,97 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+
+namespace dungeon
+{
+	class Voxel;
+}
+
+/**
+ * Builds simplified box collision of floors, walls and ceilings from the voxel.
+ * Faces of the same room or aisle on the same plane are merged into as few boxes as possible.
+ * The boxes are placed outside the grids so that they do not intrude into the walkable space.
+ *
+ * ボクセルから床、壁、天井の簡略化した箱のコリジョンを作ります。
+ * 同じ部屋または通路の同じ平面上の面を、できるだけ少ない箱にまとめます。
+ * 箱は歩ける空間に入り込まないようにグリッドの外側に配置します。
+ */
+class FDungeonSimplifiedCollisionBuilder final
+{
+public:
+	// 部屋または通路の識別子ごとの箱（ダンジョンの原点からの相対座標）
+	using Partitions = TMap<uint16, TArray<FBox>>;
+
+	/**
+	 * constructor
+	 * コンストラクタ
+	 *
+	 * @param[in]	gridSize	グリッドの大きさ
+	 * @param[in]	thickness	箱の厚み
+	 * @param[in]	mergeRooms	部屋を結合しているか
+	 */
+	FDungeonSimplifiedCollisionBuilder(const FVector& gridSize, const double thickness, const bool mergeRooms);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonSimplifiedCollisionBuilder() = default;
+
+	/**
+	 * 部屋または通路ごとの箱を作ります
+	 * @param[in]	voxel			ボクセル
+	 * @param[out]	outPartitions	部屋または通路ごとの箱
+	 * @return		まとめる前の面の数
+	 */
+	int32 Build(const dungeon::Voxel& voxel, Partitions& outPartitions) const;
+
+	/**
+	 * ボクセルから求めた全ての面がちょうど一つの箱で覆われているか調べます
+	 * 配置したタイルのコリジョンとの比較はDungeonGenerator.SimplifiedCollisionの自動テストで行います
+	 * @param[in]	voxel			ボクセル
+	 * @param[in]	partitions		Buildで作った箱
+	 * @return		覆われていないか重複して覆われている面の数
+	 */
+	int32 Validate(const dungeon::Voxel& voxel, const Partitions& partitions) const;
+
+	/**
+	 * 配置したタイルと箱を比較します
+	 * タイルのバウンディングボックスが箱と重なるか、タイルの最も薄い軸に沿ってタイルの中心を通る
+	 * トレースがタイルの近くで箱に当たるかを調べます
+	 * @param[in]	tileBounds		置き換えたタイルのバウンディングボックス（ダンジョンの原点からの相対座標）
+	 * @param[in]	partitions		Buildで作った箱
+	 * @param[out]	outTraceErrorCount	トレースが箱に当たらなかったか、離れた位置で当たったタイルの数
+	 * @return		箱と重ならないタイルの数
+	 */
+	int32 ValidateTiles(const TArray<FBox>& tileBounds, const Partitions& partitions, int32& outTraceErrorCount) const;
+
+private:
+	enum class Face : uint8
+	{
+		Floor,
+		Roof,
+		North,
+		South,
+		East,
+		West
+	};
+
+	// 平面ごとの面（平面のキーと平面上の座標）
+	using Planes = TMap<uint64, TArray<FIntPoint>>;
+
+	void CollectFaces(const dungeon::Voxel& voxel, Planes& outPlanes) const;
+	FBox ToBox(const uint64 planeKey, const FIntPoint& min, const FIntPoint& max) const;
+
+	static uint64 MakePlaneKey(const uint16 partition, const Face face, const int32 plane) noexcept;
+	static uint16 GetPartition(const uint64 planeKey) noexcept;
+
+	FVector mGridSize;
+	double mThickness;
+	bool mMergeRooms;
+};
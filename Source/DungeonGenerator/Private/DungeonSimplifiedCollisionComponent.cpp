@@ -0,0 +1,61 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "DungeonSimplifiedCollisionComponent.h"
+#include <Engine/CollisionProfile.h>
+#include <PhysicsEngine/BodySetup.h>
+
+UDungeonSimplifiedCollisionComponent::UDungeonSimplifiedCollisionComponent(const FObjectInitializer& objectInitializer)
+	: Super(objectInitializer)
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	bHiddenInGame = true;
+	CastShadow = false;
+	SetGenerateOverlapEvents(false);
+	SetCollisionProfileName(UCollisionProfile::BlockAll_ProfileName);
+}
+
+void UDungeonSimplifiedCollisionComponent::SetBoxes(const TArray<FBox>& boxes)
+{
+	if (mBodySetup == nullptr)
+	{
+		mBodySetup = NewObject<UBodySetup>(this, NAME_None, RF_Transient);
+		mBodySetup->CollisionTraceFlag = CTF_UseSimpleAsComplex;
+		mBodySetup->BodySetupGuid = FGuid::NewGuid();
+		mBodySetup->bNeverNeedsCookedCollisionData = true;
+	}
+
+	mBodySetup->RemoveSimpleCollision();
+	mLocalBounds.Init();
+	for (const FBox& box : boxes)
+	{
+		const FVector size = box.GetSize();
+		FKBoxElem boxElem(size.X, size.Y, size.Z);
+		boxElem.Center = box.GetCenter();
+		mBodySetup->AggGeom.BoxElems.Add(boxElem);
+		mLocalBounds += box;
+	}
+	mBoxCount = boxes.Num();
+
+	// 箱だけなのでクックは不要です
+	mBodySetup->InvalidatePhysicsData();
+	mBodySetup->CreatePhysicsMeshes();
+
+	RecreatePhysicsState();
+	UpdateBounds();
+}
+
+UBodySetup* UDungeonSimplifiedCollisionComponent::GetBodySetup()
+{
+	return mBodySetup;
+}
+
+FBoxSphereBounds UDungeonSimplifiedCollisionComponent::CalcBounds(const FTransform& LocalToWorld) const
+{
+	if (!mLocalBounds.IsValid)
+		return FBoxSphereBounds(LocalToWorld.GetLocation(), FVector::ZeroVector, 0.f);
+	return FBoxSphereBounds(mLocalBounds).TransformBy(LocalToWorld);
+}
@@ -9,6 +9,7 @@
 */
 
 #include "Helper/DungeonAisleGridMap.h"
+#include "Core/Helper/AllocatedSize.h"
 
 UDungeonAisleGridMap::UDungeonAisleGridMap(const FObjectInitializer& initializer)
 	: Super(initializer)
@@ -34,6 +35,22 @@ void UDungeonAisleGridMap::Register(const int32 identifier, const EDungeonDirect
 	}
 }
 
+SIZE_T UDungeonAisleGridMap::GetAllocatedSize() const
+{
+	SIZE_T size = dungeon::GetHashContainerAllocatedSize(mAisleGridMap);
+	for (const auto& aisleGrid : mAisleGridMap)
+	{
+		size += aisleGrid.second.GetAllocatedSize();
+	}
+	return size;
+}
+
+void UDungeonAisleGridMap::GetResourceSizeEx(FResourceSizeEx& cumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(cumulativeResourceSize);
+	cumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetAllocatedSize());
+}
+
 void UDungeonAisleGridMap::ForEach(const FDungeonAisleGridMapLoopSignature& OnLoop) const
 {
 	for (const auto& aisleGrid : mAisleGridMap)
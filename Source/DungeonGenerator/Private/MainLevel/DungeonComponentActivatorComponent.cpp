@@ -14,17 +14,24 @@
 #include <Engine/Level.h>
 #include <Engine/World.h>
 
-static constexpr double DisplacementOfInitialLocation = 100;
-static constexpr double MovementDetectionDistance = 1;
+namespace
+{
+	// 制御するコンポーネントが指定されていなければオーナーアクターの全てのコンポーネントを記録します
+	template<typename T, typename Function>
+	void StashControlledComponents(DungeonComponentActivationSaver<T>& saver, const AActor* owner, const TArray<TWeakObjectPtr<UActorComponent>>& controlledComponents, Function&& function)
+	{
+		if (controlledComponents.IsEmpty())
+			saver.Stash(owner, Forward<Function>(function));
+		else
+			saver.Stash(controlledComponents, Forward<Function>(function));
+	}
+}
 
 UDungeonComponentActivatorComponent::UDungeonComponentActivatorComponent(const FObjectInitializer& objectInitializer)
 	: Super(objectInitializer)
 {
-	PrimaryComponentTick.bCanEverTick = true;
-	PrimaryComponentTick.bStartWithTickEnabled = true;
-
-	// GameThread以外からの呼び出しを許可
-	PrimaryComponentTick.bRunOnAnyThread = true;
+	// 移動するアクターはADungeonMainLevelScriptActorがまとめて追跡するのでTick不要
+	PrimaryComponentTick.bCanEverTick = false;
 }
 
 FVector UDungeonComponentActivatorComponent::GetPartitionRegistrationWorldLocation(const AActor* ownerActor) const noexcept
@@ -41,6 +48,30 @@ bool UDungeonComponentActivatorComponent::HasFixedPartitionRegistrationWorldLoca
 	return bHasFixedPartitionRegistrationWorldLocation;
 }
 
+void UDungeonComponentActivatorComponent::SetControlledComponents(const TArray<UActorComponent*>& components)
+{
+	mControlledComponents.Reset(components.Num());
+	for (UActorComponent* component : components)
+	{
+		if (IsValid(component))
+			mControlledComponents.Add(component);
+	}
+}
+
+/*
+ * BeginPlay後に設定された場合は移動の追跡をやめて、その場で登録し直します。
+ */
+void UDungeonComponentActivatorComponent::SetPartitionRegistrationWorldBounds(const FBox& worldBounds)
+{
+	mPartitionRegistrationWorldBounds = worldBounds;
+
+	if (auto* levelScript = mDungeonLevelScriptActor.Get())
+	{
+		levelScript->UnregisterMovableActivatorComponent(this);
+		RefreshPartitionRegistration(levelScript);
+	}
+}
+
 void UDungeonComponentActivatorComponent::BeginPlay()
 {
 	Super::BeginPlay();
@@ -61,25 +92,6 @@ void UDungeonComponentActivatorComponent::BeginPlay()
 				{
 					mDungeonLevelScriptActor = levelScript;
 
-					// 動かないならTick不要
-					const auto* rootSceneComponent = ownerActor->GetRootComponent();
-					const bool bHasFixedRegistrationLocation = HasFixedPartitionRegistrationWorldLocation();
-					if (bHasFixedRegistrationLocation || (rootSceneComponent && rootSceneComponent->Mobility != EComponentMobility::Movable))
-					{
-						if (!bHasFixedRegistrationLocation)
-						{
-							DUNGEON_GENERATOR_VERBOSE(TEXT("The tick is stopped because the Mobility of actor ‘%s’ is Static."), *ownerActor->GetName());
-						}
-						if (bHasFixedRegistrationLocation)
-						{
-							DUNGEON_GENERATOR_VERBOSE(TEXT("The tick is stopped because actor '%s' uses a fixed partition registration location."), *ownerActor->GetName());
-						}
-						SetComponentTickEnabled(false);
-					}
-
-					// 初回起動のため少しずらした座標を記録
-					mLastLocation = registrationLocation + FVector(0, DisplacementOfInitialLocation, 0);
-
 					// 制御対象のポイントライト派生クラスを回収
 					for (auto* component : ownerActor->GetComponents())
 					{
@@ -101,14 +113,42 @@ void UDungeonComponentActivatorComponent::BeginPlay()
 			}
 		}
 
-		// ADungeonMainLevelScriptActorではないならTick不要
-		if (mDungeonLevelScriptActor.Get() == nullptr)
+		TickImplement(registrationLocation);
+		RegisterMovableTracking(ownerActor);
+	}
+}
+
+/*
+ * 動くアクターだけを追跡してもらう
+ */
+void UDungeonComponentActivatorComponent::RegisterMovableTracking(const AActor* ownerActor)
+{
+	if (!IsValid(ownerActor))
+		return;
+
+	if (auto* levelScript = mDungeonLevelScriptActor.Get())
+	{
+		const auto* rootSceneComponent = ownerActor->GetRootComponent();
+		if (HasFixedPartitionRegistrationWorldLocation())
 		{
-			DUNGEON_GENERATOR_VERBOSE(TEXT("Stopping tick because persistent script for actor ‘%s’ not found."), *ownerActor->GetName());
-			SetComponentTickEnabled(false);
+			DUNGEON_GENERATOR_VERBOSE(TEXT("Actor '%s' is not tracked because it uses a fixed partition registration location."), *ownerActor->GetName());
+		}
+		else if (mPartitionRegistrationWorldBounds.IsValid)
+		{
+			DUNGEON_GENERATOR_VERBOSE(TEXT("Actor '%s' is not tracked because it uses partition registration bounds."), *ownerActor->GetName());
+		}
+		else if (rootSceneComponent && rootSceneComponent->Mobility != EComponentMobility::Movable)
+		{
+			DUNGEON_GENERATOR_VERBOSE(TEXT("Actor '%s' is not tracked because its Mobility is not Movable."), *ownerActor->GetName());
+		}
+		else
+		{
+			levelScript->RegisterMovableActivatorComponent(this);
 		}
-
-		TickImplement(registrationLocation);
+	}
+	else
+	{
+		DUNGEON_GENERATOR_VERBOSE(TEXT("Actor '%s' is not tracked because the persistent level script is not ADungeonMainLevelScriptActor."), *ownerActor->GetName());
 	}
 }
 
@@ -116,6 +156,8 @@ void UDungeonComponentActivatorComponent::EndPlay(const EEndPlayReason::Type end
 {
 	Super::EndPlay(endPlayReason);
 
+	if (auto* levelScript = mDungeonLevelScriptActor.Get())
+		levelScript->UnregisterMovableActivatorComponent(this);
 	mDungeonLevelScriptActor.Reset();
 
 #if WITH_EDITOR
@@ -126,22 +168,6 @@ void UDungeonComponentActivatorComponent::EndPlay(const EEndPlayReason::Type end
 #endif
 }
 
-void UDungeonComponentActivatorComponent::TickComponent(float deltaTime, enum ELevelTick tickType, FActorComponentTickFunction* thisTickFunction)
-{
-	Super::TickComponent(deltaTime, tickType, thisTickFunction);
-
-	if (const auto* ownerActor = GetValid(GetOwner()))
-	{
-		// 移動した？
-		const FVector currentLocation = GetPartitionRegistrationWorldLocation(ownerActor);
-		if (FVector::DistSquared(mLastLocation, currentLocation) >= MovementDetectionDistance * MovementDetectionDistance)
-		{
-			TickImplement(currentLocation);
-			mLastLocation = currentLocation;
-		}
-	}
-}
-
 void UDungeonComponentActivatorComponent::RefreshPartitionRegistration(ADungeonMainLevelScriptActor* dungeonMainLevelScriptActor)
 {
 	if (UDungeonPartition* lastDungeonPartition = mLastDungeonPartition.Get())
@@ -149,14 +175,16 @@ void UDungeonComponentActivatorComponent::RefreshPartitionRegistration(ADungeonM
 		lastDungeonPartition->UnregisterActivatorComponent(this);
 	}
 	mLastDungeonPartition.Reset();
+	UnregisterFromAdditionalPartitions();
 
 	mDungeonLevelScriptActor = dungeonMainLevelScriptActor;
 
+	if (mPooled)
+		return;
+
 	if (const auto* ownerActor = GetOwner())
 	{
-		const FVector currentLocation = GetPartitionRegistrationWorldLocation(ownerActor);
-		TickImplement(currentLocation);
-		mLastLocation = currentLocation;
+		TickImplement(GetPartitionRegistrationWorldLocation(ownerActor));
 	}
 }
 
@@ -169,42 +197,101 @@ void UDungeonComponentActivatorComponent::TickImplement(const FVector& location)
 		if (levelScript->IsEnableLoadControl())
 		{
 #endif
-			// 新しい座標のUDungeonPartitionを検索
-			auto* currentDungeonPartition = levelScript->Find(location);
+			if (mPartitionRegistrationWorldBounds.IsValid)
+			{
+				// 境界に重なる全てのUDungeonPartitionに登録
+				TArray<UDungeonPartition*> dungeonPartitions;
+				levelScript->FindPartitions(mPartitionRegistrationWorldBounds, dungeonPartitions);
+				MoveToPartitions(dungeonPartitions);
+			}
+			else
+			{
+				// 新しい座標のUDungeonPartitionに移動
+				MoveToPartition(levelScript->Find(location));
+			}
+#if WITH_EDITOR && (UE_BUILD_SHIPPING == 0)
+		}
+#endif
+	}
+}
 
-			// 古い座標のUDungeonPartitionを検索
-			auto* lastDungeonPartition = mLastDungeonPartition.Get();
+void UDungeonComponentActivatorComponent::MoveToPartition(UDungeonPartition* currentDungeonPartition)
+{
+	// 古い座標のUDungeonPartitionを検索
+	auto* lastDungeonPartition = mLastDungeonPartition.Get();
 
-			// UDungeonPartitionを移動した？
-			if (lastDungeonPartition != currentDungeonPartition)
-			{
+	// UDungeonPartitionを移動した？
+	if (lastDungeonPartition != currentDungeonPartition)
+	{
 #if WITH_EDITOR
-				if (const auto* ownerActor = GetOwner())
-				{
-					DUNGEON_GENERATOR_VERBOSE(TEXT("Actor '%s' has been registered for partitioning"), *ownerActor->GetName());
-				}
+		if (const auto* ownerActor = GetOwner())
+		{
+			DUNGEON_GENERATOR_VERBOSE(TEXT("Actor '%s' has been registered for partitioning"), *ownerActor->GetName());
+		}
 #endif
 
-				// 古いUDungeonPartitionから退出
-				if (IsValid(lastDungeonPartition))
-				{
-					lastDungeonPartition->UnregisterActivatorComponent(this);
-				}
+		// 古いUDungeonPartitionから退出
+		if (IsValid(lastDungeonPartition))
+		{
+			lastDungeonPartition->UnregisterActivatorComponent(this);
+		}
 
-				// 新しいUDungeonPartitionに登録
-				if (IsValid(currentDungeonPartition))
-				{
-					currentDungeonPartition->RegisterActivatorComponent(this);
-				}
+		// 新しいUDungeonPartitionに登録
+		if (IsValid(currentDungeonPartition))
+		{
+			currentDungeonPartition->RegisterActivatorComponent(this);
+		}
 
-				mLastDungeonPartition = currentDungeonPartition;
-			}
-#if WITH_EDITOR && (UE_BUILD_SHIPPING == 0)
+		mLastDungeonPartition = currentDungeonPartition;
+	}
+}
+
+/*
+ * 先頭のパーティションはmLastDungeonPartitionとして、残りは追加のパーティションとして登録します。
+ */
+void UDungeonComponentActivatorComponent::MoveToPartitions(const TArray<UDungeonPartition*>& currentDungeonPartitions)
+{
+	MoveToPartition(currentDungeonPartitions.IsEmpty() ? nullptr : currentDungeonPartitions[0]);
+
+	UnregisterFromAdditionalPartitions();
+	for (int32 index = 1; index < currentDungeonPartitions.Num(); ++index)
+	{
+		if (UDungeonPartition* dungeonPartition = GetValid(currentDungeonPartitions[index]))
+		{
+			dungeonPartition->RegisterActivatorComponent(this);
+			mAdditionalDungeonPartitions.Add(dungeonPartition);
 		}
-#endif
 	}
 }
 
+void UDungeonComponentActivatorComponent::UnregisterFromAdditionalPartitions()
+{
+	for (const auto& additionalDungeonPartition : mAdditionalDungeonPartitions)
+	{
+		if (UDungeonPartition* dungeonPartition = additionalDungeonPartition.Get())
+			dungeonPartition->UnregisterActivatorComponent(this);
+	}
+	mAdditionalDungeonPartitions.Reset();
+}
+
+bool UDungeonComponentActivatorComponent::IsAnyRegisteredPartitionActivate() const
+{
+	if (const UDungeonPartition* lastDungeonPartition = mLastDungeonPartition.Get())
+	{
+		if (lastDungeonPartition->IsPartitionActivate())
+			return true;
+	}
+	for (const auto& additionalDungeonPartition : mAdditionalDungeonPartitions)
+	{
+		if (const UDungeonPartition* dungeonPartition = additionalDungeonPartition.Get())
+		{
+			if (dungeonPartition->IsPartitionActivate())
+				return true;
+		}
+	}
+	return false;
+}
+
 void UDungeonComponentActivatorComponent::CallPartitionActivate()
 {
 #if WITH_EDITOR
@@ -232,6 +319,10 @@ void UDungeonComponentActivatorComponent::CallPartitionActivate()
 
 void UDungeonComponentActivatorComponent::CallPartitionInactivate()
 {
+	// 複数のパーティションに登録している場合は、全てが非アクティブになるまで無効にしません
+	if (!mAdditionalDungeonPartitions.IsEmpty() && IsAnyRegisteredPartitionActivate())
+		return;
+
 	auto* owner = GetOwner();
 	if (IsValid(owner))
 	{
@@ -259,6 +350,33 @@ void UDungeonComponentActivatorComponent::CallPartitionInactivate()
 	}
 }
 
+void UDungeonComponentActivatorComponent::ResetForPool()
+{
+	if (auto* levelScript = mDungeonLevelScriptActor.Get())
+		levelScript->UnregisterMovableActivatorComponent(this);
+
+	if (UDungeonPartition* lastDungeonPartition = mLastDungeonPartition.Get())
+		lastDungeonPartition->UnregisterActivatorComponent(this);
+	mLastDungeonPartition.Reset();
+	UnregisterFromAdditionalPartitions();
+
+	// 非アクティブなパーティションで無効にした状態を戻します
+	CallPartitionActivate();
+
+	bHasFixedPartitionRegistrationWorldLocation = false;
+	mPartitionRegistrationWorldBounds.Init();
+	mPooled = true;
+}
+
+void UDungeonComponentActivatorComponent::ReuseFromPool()
+{
+	mPooled = false;
+	RefreshPartitionRegistration(mDungeonLevelScriptActor.Get());
+
+	// ResetForPoolで追跡から外したので、動くアクターなら追跡し直してもらう
+	RegisterMovableTracking(GetOwner());
+}
+
 // Actor
 void UDungeonComponentActivatorComponent::SaveAndDisableActorTickEnable(const EDungeonComponentActivateReason activateReason)
 {
@@ -308,7 +426,7 @@ void UDungeonComponentActivatorComponent::SaveAndDisableComponentActivation(cons
 	if (previousEnabled != currentEnabled)
 	{
 		// Deactivate after preserving component activation
-		mComponentActivationSaver.Stash(owner, [](UActorComponent* component)
+		StashControlledComponents(mComponentActivationSaver, owner, mControlledComponents, [](UActorComponent* component)
 			{
 				std::pair<bool, bool> result;
 				result.second = component->IsActive();
@@ -358,7 +476,7 @@ void UDungeonComponentActivatorComponent::SaveAndDisableCollisionEnable(const ED
 	const bool currentEnabled = mComponentCollisionEnabled.all();
 	if (previousEnabled != currentEnabled)
 	{
-		mComponentCollisionEnabledSaver.Stash(owner, [](UActorComponent* component)
+		StashControlledComponents(mComponentCollisionEnabledSaver, owner, mControlledComponents, [](UActorComponent* component)
 			{
 				std::pair<bool, ECollisionEnabled::Type> result;
 
@@ -412,7 +530,7 @@ void UDungeonComponentActivatorComponent::SaveAndDisableVisibility(const EDungeo
 	const bool currentEnabled = mComponentVisibility.all();
 	if (previousEnabled != currentEnabled)
 	{
-		mComponentVisibilitySaver.Stash(owner, [](UActorComponent* component)
+		StashControlledComponents(mComponentVisibilitySaver, owner, mControlledComponents, [](UActorComponent* component)
 			{
 				std::pair<bool, bool> result;
 
@@ -0,0 +1,480 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "MainLevel/DungeonLoadControlSimulator.h"
+#include "MainLevel/DungeonMainLevelScriptActor.h"
+#include "MainLevel/DungeonPartition.h"
+#include "DungeonGenerateBase.h"
+#include "Core/Generator.h"
+#include "Core/Debug/Debug.h"
+#include "Core/Math/Point.h"
+#include "Core/RoomGeneration/Aisle.h"
+#include "Core/RoomGeneration/Room.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+#include "Parameter/DungeonGenerateParameter.h"
+#include <EngineUtils.h>
+#include <HAL/PlatformTime.h>
+#include <Misc/OutputDevice.h>
+
+namespace
+{
+	template<typename T>
+	T Percentile(TArray<T> values, const double percentile)
+	{
+		if (values.IsEmpty())
+			return T();
+		values.Sort();
+		const int32 index = FMath::Clamp(FMath::CeilToInt32(percentile * values.Num()) - 1, 0, values.Num() - 1);
+		return values[index];
+	}
+
+	template<typename T>
+	double Average(const TArray<T>& values)
+	{
+		if (values.IsEmpty())
+			return 0.0;
+		double total = 0.0;
+		for (const T value : values)
+			total += value;
+		return total / values.Num();
+	}
+}
+
+FDungeonLoadControlSimulator::FDungeonLoadControlSimulator(ADungeonMainLevelScriptActor* levelScriptActor)
+	: mLevelScriptActor(levelScriptActor)
+{
+}
+
+bool FDungeonLoadControlSimulator::Run(const FSettings& settings)
+{
+	mSettings = settings;
+	mFrames.Reset();
+	mTimeToVisibleSeconds.Reset();
+	mVisibilityWaits.Reset();
+	mTimeToActiveSeconds.Reset();
+	mActivationWaits.Reset();
+	mPendingPredictions.Reset();
+	mPredictions.Reset();
+	mPrefetchCount = 0;
+	mPawns.Reset();
+
+	if (!IsValid(mLevelScriptActor))
+		return false;
+	if (!mLevelScriptActor->IsPartitionLoadControlAvailable())
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Load control simulation: partition load control is not available"));
+		return false;
+	}
+
+	if (mSettings.ViewerPaths.IsEmpty())
+		BuildRoutes();
+	else
+		BuildFixedRoutes();
+	if (mRoutes.IsEmpty())
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Load control simulation: no aisle to walk along"));
+		return false;
+	}
+
+	mRandom.Initialize(mSettings.RandomSeed);
+	mPartitionCount = mLevelScriptActor->DungeonPartitions.Num();
+
+	if (mSettings.ViewerPaths.IsEmpty())
+	{
+		mPawns.SetNum(FMath::Max(mSettings.PawnCount, 1));
+		for (FPawn& pawn : mPawns)
+		{
+			int32 nodeIndex;
+			do
+			{
+				nodeIndex = mRandom.RandRange(0, mRoutesByNode.Num() - 1);
+			} while (mRoutesByNode[nodeIndex].IsEmpty());
+			StartRoute(pawn, nodeIndex);
+		}
+	}
+	else
+	{
+		// 固定した経路はポーン毎に一つずつ割り当てる
+		mPawns.SetNum(mRoutes.Num());
+		for (int32 pawnIndex = 0; pawnIndex < mPawns.Num(); ++pawnIndex)
+		{
+			mPawns[pawnIndex].RouteIndex = pawnIndex;
+			mPawns[pawnIndex].Location = GetWaypoint(mPawns[pawnIndex], 0);
+		}
+	}
+
+	// 先読みの設定を一時的に上書きする
+	const bool enablePartitionPrefetch = mLevelScriptActor->bEnablePartitionPrefetch;
+	if (mSettings.Prefetch >= 0)
+		mLevelScriptActor->bEnablePartitionPrefetch = mSettings.Prefetch != 0;
+	const uint32 prefetchCount = mLevelScriptActor->mPartitionPrefetchCount;
+	const float partitionPrefetchSeconds = mLevelScriptActor->PartitionPrefetchSeconds;
+	if (mSettings.PrefetchSeconds >= 0.f)
+		mLevelScriptActor->PartitionPrefetchSeconds = mSettings.PrefetchSeconds;
+
+	// 切り替えの予算を一時的に上書きする
+	const float partitionTransitionBudgetMilliseconds = mLevelScriptActor->PartitionTransitionBudgetMilliseconds;
+	if (mSettings.TransitionBudgetMilliseconds >= 0.f)
+		mLevelScriptActor->PartitionTransitionBudgetMilliseconds = mSettings.TransitionBudgetMilliseconds;
+
+	// 1フレームの切り替えの最大数を一時的に上書きする
+	const int32 maxPartitionActivationsPerFrame = mLevelScriptActor->MaxPartitionActivationsPerFrame;
+	const int32 maxPartitionInactivationsPerFrame = mLevelScriptActor->MaxPartitionInactivationsPerFrame;
+	if (mSettings.MaxActivationsPerFrame >= 0)
+		mLevelScriptActor->MaxPartitionActivationsPerFrame = mSettings.MaxActivationsPerFrame;
+	if (mSettings.MaxInactivationsPerFrame >= 0)
+		mLevelScriptActor->MaxPartitionInactivationsPerFrame = mSettings.MaxInactivationsPerFrame;
+
+	const int32 frameCount = FMath::Max(mSettings.FrameCount, 1);
+	const float deltaSeconds = FMath::Max(mSettings.DeltaSeconds, UE_KINDA_SMALL_NUMBER);
+	// 予測した位置に着くまでのフレーム数（端数の分を1フレーム足す）
+	const int32 predictionFrameCount = FMath::CeilToInt32(FMath::Max(mLevelScriptActor->PartitionPrefetchSeconds, 0.f) / deltaSeconds) + 1;
+	mFrames.Reserve(frameCount);
+	for (int32 frameIndex = 0; frameIndex < frameCount; ++frameIndex)
+	{
+		for (FPawn& pawn : mPawns)
+			Advance(pawn, mSettings.PawnSpeed * deltaSeconds);
+
+		FFrame& frame = mFrames.AddDefaulted_GetRef();
+		const uint32 activationCount = mLevelScriptActor->mPartitionActivationCount;
+		const uint32 inactivationCount = mLevelScriptActor->mPartitionInactivationCount;
+
+		// ADungeonMainLevelScriptActor::Tickと同じ順序で負荷コントロールを実行する
+		const uint64 loadControlStart = FPlatformTime::Cycles64();
+		mLevelScriptActor->Begin();
+		for (int32 pawnIndex = 0; pawnIndex < mPawns.Num(); ++pawnIndex)
+		{
+			const FPawn& pawn = mPawns[pawnIndex];
+			mLevelScriptActor->Mark(GetSimulatedViewerId(pawnIndex), pawn.Location, pawn.Stopped ? FVector::ZeroVector : pawn.Direction * mSettings.PawnSpeed);
+		}
+		mLevelScriptActor->End(deltaSeconds);
+		frame.LoadControlMilliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - loadControlStart);
+
+		// Markと同じ条件で先読みした予測を記録する
+		for (int32 pawnIndex = 0; pawnIndex < mPawns.Num(); ++pawnIndex)
+		{
+			FPawn& pawn = mPawns[pawnIndex];
+			const ADungeonMainLevelScriptActor::FPartitionViewer* viewer = mLevelScriptActor->mPartitionViewers.Find(GetSimulatedViewerId(pawnIndex));
+			if (viewer == nullptr || viewer->PredictedPartitionIndex == pawn.PredictedPartitionIndex)
+				continue;
+
+			pawn.PredictedPartitionIndex = viewer->PredictedPartitionIndex;
+			if (mLevelScriptActor->DungeonPartitions.IsValidIndex(viewer->PredictedPartitionIndex) && viewer->PredictedPartitionIndex != viewer->PartitionIndex)
+				mPendingPredictions.Add({ pawnIndex, frameIndex, viewer->PredictedPartitionIndex, pawn.Location, false });
+		}
+
+		if (mLevelScriptActor->MaxShadowCastingPointAndSpotLights > 0)
+		{
+			const uint64 shadowStart = FPlatformTime::Cycles64();
+			mLevelScriptActor->UpdateShadowCastingPointAndSpotLights(mPawns[0].Location, mPawns[0].Direction);
+			frame.ShadowMilliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - shadowStart);
+		}
+
+		frame.Activations = static_cast<int32>(mLevelScriptActor->mPartitionActivationCount - activationCount);
+		frame.Inactivations = static_cast<int32>(mLevelScriptActor->mPartitionInactivationCount - inactivationCount);
+		frame.QueueDepth = mLevelScriptActor->mPendingPartitionActivations.Num() + mLevelScriptActor->mPendingPartitionInactivations.Num();
+		for (const UDungeonPartition* partition : mLevelScriptActor->DungeonPartitions)
+		{
+			if (IsValid(partition) && partition->IsPartitionActivate())
+				++frame.ActivePartitions;
+		}
+		for (const FPawn& pawn : mPawns)
+		{
+			const int32 partitionIndex = mLevelScriptActor->FindPartitionIndex(pawn.Location);
+			if (!mLevelScriptActor->DungeonPartitions.IsValidIndex(partitionIndex))
+				continue;
+			const UDungeonPartition* partition = mLevelScriptActor->DungeonPartitions[partitionIndex];
+			if (IsValid(partition) && !partition->IsPartitionActivate())
+				++frame.InactiveViewerPartitions;
+		}
+
+		// 新しく入ったパーティションを記録する
+		for (FPawn& pawn : mPawns)
+		{
+			const int32 partitionIndex = mLevelScriptActor->FindPartitionIndex(pawn.Location);
+			if (partitionIndex != pawn.PartitionIndex && mLevelScriptActor->DungeonPartitions.IsValidIndex(partitionIndex))
+			{
+				mVisibilityWaits.Add({ partitionIndex, frameIndex });
+				mActivationWaits.Add({ partitionIndex, frameIndex });
+			}
+			pawn.PartitionIndex = partitionIndex;
+		}
+
+		// 先読みの秒数以内に予測したパーティションへ入ったか判定する
+		for (int32 i = 0; i < mPendingPredictions.Num();)
+		{
+			FPrediction& prediction = mPendingPredictions[i];
+			prediction.Hit = mPawns[prediction.PawnIndex].PartitionIndex == prediction.PartitionIndex;
+			if (prediction.Hit || frameIndex - prediction.Frame >= predictionFrameCount)
+			{
+				mPredictions.Add(prediction);
+				mPendingPredictions.RemoveAt(i);
+			}
+			else
+			{
+				++i;
+			}
+		}
+
+		// 見えるパーティションが全てアクティブになるまでの時間を計測する
+		for (int32 i = mVisibilityWaits.Num() - 1; i >= 0; --i)
+		{
+			const FVisibilityWait& visibilityWait = mVisibilityWaits[i];
+			if (IsVisibleSetActive(visibilityWait.PartitionIndex))
+			{
+				mTimeToVisibleSeconds.Add(static_cast<float>(frameIndex - visibilityWait.EnteredFrame) * deltaSeconds);
+				mVisibilityWaits.RemoveAtSwap(i);
+			}
+		}
+
+		// 入ったパーティション自体がアクティブになるまでの時間を計測する
+		for (int32 i = mActivationWaits.Num() - 1; i >= 0; --i)
+		{
+			const FVisibilityWait& activationWait = mActivationWaits[i];
+			const UDungeonPartition* partition = mLevelScriptActor->DungeonPartitions[activationWait.PartitionIndex];
+			if (!IsValid(partition) || partition->IsPartitionActivate())
+			{
+				mTimeToActiveSeconds.Add(static_cast<float>(frameIndex - activationWait.EnteredFrame) * deltaSeconds);
+				mActivationWaits.RemoveAtSwap(i);
+			}
+		}
+	}
+
+	mPrefetchCount = mLevelScriptActor->mPartitionPrefetchCount - prefetchCount;
+	mLevelScriptActor->bEnablePartitionPrefetch = enablePartitionPrefetch;
+	mLevelScriptActor->PartitionPrefetchSeconds = partitionPrefetchSeconds;
+	mLevelScriptActor->PartitionTransitionBudgetMilliseconds = partitionTransitionBudgetMilliseconds;
+	mLevelScriptActor->MaxPartitionActivationsPerFrame = maxPartitionActivationsPerFrame;
+	mLevelScriptActor->MaxPartitionInactivationsPerFrame = maxPartitionInactivationsPerFrame;
+
+	// 実際のプレイヤーに従った状態に戻す
+	mLevelScriptActor->ApplyCurrentPartitionActivationState();
+
+	return true;
+}
+
+void FDungeonLoadControlSimulator::BuildRoutes()
+{
+	mRoutes.Reset();
+	mRoutesByNode.Reset();
+
+	UWorld* world = mLevelScriptActor->GetWorld();
+	if (!IsValid(world))
+		return;
+
+	TMap<const dungeon::Room*, int32> nodeIndices;
+	for (TActorIterator<ADungeonGenerateBase> iterator(world); iterator; ++iterator)
+	{
+		const ADungeonGenerateBase* dungeonGenerateActor = *iterator;
+		if (!IsValid(dungeonGenerateActor) || !IsValid(dungeonGenerateActor->mParameter))
+			continue;
+
+		const std::shared_ptr<const dungeon::Generator> generator = dungeonGenerateActor->GetGenerator();
+		if (generator == nullptr || generator->GetVoxel() == nullptr)
+			continue;
+
+		const UDungeonGenerateParameter* parameter = dungeonGenerateActor->mParameter;
+		const FVector gridSize = parameter->GetGridSize().To3D();
+		const FVector actorLocation = dungeonGenerateActor->GetActorLocation();
+		const FVector eyeOffset(0., 0., gridSize.Z * 0.5);
+
+		// 通路グリッドを通路毎に回収する
+		TMap<uint16, TArray<FVector>> aisleGrids;
+		generator->GetVoxel()->Each([&aisleGrids, parameter, &gridSize, &actorLocation, &eyeOffset](const FIntVector& location, const dungeon::Grid& grid)
+			{
+				if (grid.GetType() == dungeon::Grid::Type::Aisle)
+				{
+					const FVector position = parameter->ToWorld(location) + actorLocation + FVector(gridSize.X * 0.5, gridSize.Y * 0.5, 0.) + eyeOffset;
+					aisleGrids.FindOrAdd(static_cast<uint16>(grid.GetIdentifier())).Add(position);
+				}
+				return true;
+			}
+		);
+
+		// 部屋の床の中心から通路グリッドを辿って接続先の部屋に向かう経路を作る
+		generator->EachAisle([this, &nodeIndices, &aisleGrids, &gridSize, &actorLocation, &eyeOffset](const dungeon::Aisle& aisle)
+			{
+				const std::shared_ptr<dungeon::Room>& room0 = aisle.GetPoint(0)->GetOwnerRoom();
+				const std::shared_ptr<dungeon::Room>& room1 = aisle.GetPoint(1)->GetOwnerRoom();
+				if (room0 == nullptr || room1 == nullptr)
+					return true;
+
+				FRoute& route = mRoutes.AddDefaulted_GetRef();
+				FVector current = FVector(room0->GetGroundCenter()) * gridSize + actorLocation + eyeOffset;
+				route.Waypoints.Add(current);
+				if (TArray<FVector>* grids = aisleGrids.Find(static_cast<uint16>(aisle.GetIdentifier())))
+				{
+					// 最も近い通路グリッドを順に辿る
+					while (!grids->IsEmpty())
+					{
+						int32 nearestIndex = 0;
+						double nearestDistance = TNumericLimits<double>::Max();
+						for (int32 i = 0; i < grids->Num(); ++i)
+						{
+							const double distance = FVector::DistSquared(current, (*grids)[i]);
+							if (nearestDistance > distance)
+							{
+								nearestDistance = distance;
+								nearestIndex = i;
+							}
+						}
+						current = (*grids)[nearestIndex];
+						route.Waypoints.Add(current);
+						grids->RemoveAtSwap(nearestIndex);
+					}
+				}
+				route.Waypoints.Add(FVector(room1->GetGroundCenter()) * gridSize + actorLocation + eyeOffset);
+
+				const dungeon::Room* rooms[2] = { room0.get(), room1.get() };
+				for (int32 i = 0; i < 2; ++i)
+				{
+					if (const int32* nodeIndex = nodeIndices.Find(rooms[i]))
+						route.Nodes[i] = *nodeIndex;
+					else
+						route.Nodes[i] = nodeIndices.Add(rooms[i], nodeIndices.Num());
+				}
+				return true;
+			}
+		);
+	}
+
+	mRoutesByNode.SetNum(nodeIndices.Num());
+	for (int32 routeIndex = 0; routeIndex < mRoutes.Num(); ++routeIndex)
+	{
+		const FRoute& route = mRoutes[routeIndex];
+		mRoutesByNode[route.Nodes[0]].Add(routeIndex);
+		if (route.Nodes[1] != route.Nodes[0])
+			mRoutesByNode[route.Nodes[1]].Add(routeIndex);
+	}
+}
+
+void FDungeonLoadControlSimulator::BuildFixedRoutes()
+{
+	mRoutes.Reset();
+	mRoutesByNode.Reset();
+
+	for (const TArray<FVector>& viewerPath : mSettings.ViewerPaths)
+	{
+		if (!viewerPath.IsEmpty())
+			mRoutes.AddDefaulted_GetRef().Waypoints = viewerPath;
+	}
+}
+
+void FDungeonLoadControlSimulator::StartRoute(FPawn& pawn, const int32 nodeIndex)
+{
+	const TArray<int32>& routeIndices = mRoutesByNode[nodeIndex];
+	check(!routeIndices.IsEmpty());
+
+	pawn.RouteIndex = routeIndices[mRandom.RandRange(0, routeIndices.Num() - 1)];
+	pawn.Reverse = mRoutes[pawn.RouteIndex].Nodes[0] != nodeIndex;
+	pawn.WaypointIndex = 0;
+	pawn.Location = GetWaypoint(pawn, 0);
+}
+
+void FDungeonLoadControlSimulator::Advance(FPawn& pawn, float distance)
+{
+	// 短い経路が続いても抜けられるように反復回数を制限する
+	for (int32 step = 0; distance > 0.f && step < 1024; ++step)
+	{
+		const int32 nextWaypointIndex = pawn.WaypointIndex + 1;
+		if (nextWaypointIndex >= GetWaypointCount(pawn))
+		{
+			// 固定した経路は終点で止まる
+			if (!mSettings.ViewerPaths.IsEmpty())
+			{
+				pawn.Stopped = true;
+				break;
+			}
+
+			const FRoute& route = mRoutes[pawn.RouteIndex];
+			StartRoute(pawn, route.Nodes[pawn.Reverse ? 0 : 1]);
+			continue;
+		}
+
+		const FVector toNext = GetWaypoint(pawn, nextWaypointIndex) - pawn.Location;
+		const float length = toNext.Size();
+		if (length > UE_KINDA_SMALL_NUMBER)
+			pawn.Direction = toNext / length;
+
+		if (length > distance)
+		{
+			pawn.Location += pawn.Direction * distance;
+			break;
+		}
+
+		pawn.Location = GetWaypoint(pawn, nextWaypointIndex);
+		pawn.WaypointIndex = nextWaypointIndex;
+		distance -= length;
+	}
+}
+
+const FVector& FDungeonLoadControlSimulator::GetWaypoint(const FPawn& pawn, const int32 step) const
+{
+	const TArray<FVector>& waypoints = mRoutes[pawn.RouteIndex].Waypoints;
+	return waypoints[pawn.Reverse ? waypoints.Num() - 1 - step : step];
+}
+
+int32 FDungeonLoadControlSimulator::GetWaypointCount(const FPawn& pawn) const
+{
+	return mRoutes[pawn.RouteIndex].Waypoints.Num();
+}
+
+bool FDungeonLoadControlSimulator::IsVisibleSetActive(const int32 partitionIndex) const
+{
+	const auto& partitions = mLevelScriptActor->DungeonPartitions;
+	for (int32 targetIndex = 0; targetIndex < partitions.Num(); ++targetIndex)
+	{
+		if (!mLevelScriptActor->IsPrecomputedPartitionVisible(partitionIndex, targetIndex))
+			continue;
+		if (IsValid(partitions[targetIndex]) && !partitions[targetIndex]->IsPartitionActivate())
+			return false;
+	}
+	return true;
+}
+
+void FDungeonLoadControlSimulator::Report(FOutputDevice& outputDevice) const
+{
+	TArray<double> loadControlMilliseconds;
+	TArray<double> shadowMilliseconds;
+	TArray<int32> churn;
+	TArray<int32> queueDepth;
+	TArray<int32> activePartitions;
+	int32 totalActivations = 0;
+	int32 totalInactivations = 0;
+	for (const FFrame& frame : mFrames)
+	{
+		loadControlMilliseconds.Add(frame.LoadControlMilliseconds);
+		shadowMilliseconds.Add(frame.ShadowMilliseconds);
+		churn.Add(frame.Activations + frame.Inactivations);
+		queueDepth.Add(frame.QueueDepth);
+		activePartitions.Add(frame.ActivePartitions);
+		totalActivations += frame.Activations;
+		totalInactivations += frame.Inactivations;
+	}
+
+	outputDevice.Logf(TEXT("DungeonGenerator load control simulation: %d frames, %d pawns, %d partitions, %d routes"),
+		mFrames.Num(), mPawns.Num(), mPartitionCount, mRoutes.Num());
+	outputDevice.Logf(TEXT("  Load control (ms)   : avg %.4f, p50 %.4f, p95 %.4f, p99 %.4f, max %.4f"),
+		Average(loadControlMilliseconds), Percentile(loadControlMilliseconds, 0.5), Percentile(loadControlMilliseconds, 0.95), Percentile(loadControlMilliseconds, 0.99), Percentile(loadControlMilliseconds, 1.0));
+	outputDevice.Logf(TEXT("  Shadow lights (ms)  : avg %.4f, p95 %.4f, max %.4f"),
+		Average(shadowMilliseconds), Percentile(shadowMilliseconds, 0.95), Percentile(shadowMilliseconds, 1.0));
+	outputDevice.Logf(TEXT("  Churn (per frame)   : avg %.3f, p95 %d, max %d (activations %d, inactivations %d)"),
+		Average(churn), Percentile(churn, 0.95), Percentile(churn, 1.0), totalActivations, totalInactivations);
+	outputDevice.Logf(TEXT("  Queue depth         : avg %.3f, p95 %d, max %d"),
+		Average(queueDepth), Percentile(queueDepth, 0.95), Percentile(queueDepth, 1.0));
+	outputDevice.Logf(TEXT("  Active partitions   : avg %.2f, max %d"),
+		Average(activePartitions), Percentile(activePartitions, 1.0));
+	outputDevice.Logf(TEXT("  Time to visible (s) : avg %.4f, p50 %.4f, p95 %.4f, max %.4f (%d entries, %d unresolved)"),
+		Average(mTimeToVisibleSeconds), Percentile(mTimeToVisibleSeconds, 0.5), Percentile(mTimeToVisibleSeconds, 0.95), Percentile(mTimeToVisibleSeconds, 1.0),
+		mTimeToVisibleSeconds.Num(), mVisibilityWaits.Num());
+	outputDevice.Logf(TEXT("  Time to active (s)  : avg %.4f, p50 %.4f, p95 %.4f, max %.4f (%d entries, %d unresolved)"),
+		Average(mTimeToActiveSeconds), Percentile(mTimeToActiveSeconds, 0.5), Percentile(mTimeToActiveSeconds, 0.95), Percentile(mTimeToActiveSeconds, 1.0),
+		mTimeToActiveSeconds.Num(), mActivationWaits.Num());
+	outputDevice.Logf(TEXT("  Prefetch            : %u activations"), mPrefetchCount);
+	outputDevice.Logf(TEXT("  Prefetch prediction : %d hits, %d misses (%d unresolved)"),
+		GetPredictionHitCount(), GetPredictionMissCount(), mPendingPredictions.Num());
+}
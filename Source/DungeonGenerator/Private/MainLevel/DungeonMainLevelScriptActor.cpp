@@ -7,9 +7,13 @@
 #include "MainLevel/DungeonMainLevelScriptActor.h"
 #include "MainLevel/DungeonComponentActivatorComponent.h"
 #include "MainLevel/DungeonPartition.h"
+#include "MainLevel/DungeonPartitionVisibilityCache.h"
 #include "DungeonGenerateActor.h"
 #include "Core/Generator.h"
 #include "Core/Debug/Debug.h"
+#include "Core/Math/Point.h"
+#include "Core/RoomGeneration/Aisle.h"
+#include "Core/RoomGeneration/Room.h"
 #include "Core/Voxelization/Grid.h"
 #include "Core/Voxelization/Voxel.h"
 #include "Parameter/DungeonGenerateParameter.h"
@@ -20,11 +24,14 @@
 #include <Engine/World.h>
 #include <EngineUtils.h>
 #include <GameFramework/Pawn.h>
+#include <GameFramework/PlayerController.h>
 #include <Kismet/GameplayStatics.h>
 #include <Misc/EngineVersionComparison.h>
+#include <Misc/ScopeExit.h>
+#include <Algo/Sort.h>
 #include <array>
 #include <algorithm>
-#include <functional>
+#include <atomic>
 #include <limits>
 
 namespace
@@ -97,6 +104,118 @@ namespace
 		);
 		return delta.SizeSquared();
 	}
+
+	// ポータル探索が広い部屋で組み合わせ爆発しないように、送信元ごとの探索数に上限を設けます
+	constexpr int32 MaxPortalVisitsPerSourcePartition = 16384;
+	constexpr int32 MaxPortalTraversalDepth = 48;
+	constexpr double PortalClipTolerance = 0.01;
+
+	// 可視性の計算方法を変更した場合は更新して、以前の結果のキャッシュを使わないようにしてください
+	constexpr uint32 PartitionVisibilityAlgorithmVersion = 2;
+
+	/*
+	 * Sutherland-Hodgman で凸多角形を平面の表側に切り取ります
+	 */
+	template<typename Polygon>
+	void ClipPortalPolygon(const Polygon& source, const FPlane& plane, Polygon& destination) noexcept
+	{
+		destination.Reset();
+		const int32 vertexCount = source.Num();
+		for (int32 i = 0; i < vertexCount; ++i)
+		{
+			const FVector& current = source[i];
+			const FVector& next = source[(i + 1) % vertexCount];
+			const double currentDistance = plane.PlaneDot(current);
+			const double nextDistance = plane.PlaneDot(next);
+			const bool currentInside = currentDistance >= -PortalClipTolerance;
+			const bool nextInside = nextDistance >= -PortalClipTolerance;
+			if (currentInside)
+				destination.Add(current);
+			if (currentInside != nextInside)
+			{
+				const double ratio = currentDistance / (currentDistance - nextDistance);
+				destination.Add(FMath::Lerp(current, next, ratio));
+			}
+		}
+	}
+
+	/*
+	 * 送信元の領域とポータルを分離する平面（ポータルの辺と送信元の頂点を通る平面）を集めます。
+	 * 送信元のどの点からポータルを通る視線も、分離平面のポータル側に留まるので、
+	 * 次のポータルを切り取っても見える可能性のある領域は失われません。
+	 */
+	template<typename Polygon, typename Planes>
+	void AppendSeparatingPlanes(const FBox& sourceBounds, const Polygon& polygon, Planes& outPlanes)
+	{
+		FVector corners[8];
+		for (int32 i = 0; i < 8; ++i)
+		{
+			corners[i].X = (i & 1) ? sourceBounds.Max.X : sourceBounds.Min.X;
+			corners[i].Y = (i & 2) ? sourceBounds.Max.Y : sourceBounds.Min.Y;
+			corners[i].Z = (i & 4) ? sourceBounds.Max.Z : sourceBounds.Min.Z;
+		}
+
+		const int32 vertexCount = polygon.Num();
+		for (int32 i = 0; i < vertexCount; ++i)
+		{
+			const FVector& edge0 = polygon[i];
+			const FVector& edge1 = polygon[(i + 1) % vertexCount];
+			for (const FVector& corner : corners)
+			{
+				const FVector normal = FVector::CrossProduct(edge1 - edge0, corner - edge0).GetSafeNormal();
+				if (normal.IsNearlyZero())
+					continue;
+
+				// ポータルが表側、送信元が裏側になる向きを決めます
+				// ポータルが平面上にある場合は送信元の側から決めます
+				FPlane plane(edge0, normal);
+				double polygonSide = 0.0;
+				for (const FVector& vertex : polygon)
+				{
+					const double distance = plane.PlaneDot(vertex);
+					if (FMath::Abs(distance) > FMath::Abs(polygonSide))
+						polygonSide = distance;
+				}
+				if (FMath::Abs(polygonSide) <= PortalClipTolerance)
+				{
+					double sourceSide = 0.0;
+					for (const FVector& sourceCorner : corners)
+					{
+						const double distance = plane.PlaneDot(sourceCorner);
+						if (FMath::Abs(distance) > FMath::Abs(sourceSide))
+							sourceSide = distance;
+					}
+					if (sourceSide > 0.0)
+						plane = plane.Flip();
+				}
+				else if (polygonSide < 0.0)
+				{
+					plane = plane.Flip();
+				}
+
+				bool separating = true;
+				for (const FVector& vertex : polygon)
+				{
+					if (plane.PlaneDot(vertex) < -PortalClipTolerance)
+					{
+						separating = false;
+						break;
+					}
+				}
+				for (int32 j = 0; separating && j < 8; ++j)
+				{
+					if (plane.PlaneDot(corners[j]) > PortalClipTolerance)
+						separating = false;
+				}
+				if (separating)
+					outPlanes.Add(plane);
+			}
+		}
+	}
+
+	// 移動したとみなす距離と、移動するアクティベータを並列に調べる最小数
+	constexpr double MovableActivatorDetectionDistance = 1.0;
+	constexpr int32 MinParallelMovableActivatorCount = 64;
 }
 
 ADungeonMainLevelScriptActor::ADungeonMainLevelScriptActor(const FObjectInitializer& objectInitializer)
@@ -153,6 +272,7 @@ bool ADungeonMainLevelScriptActor::ExecutePartitionBuild(const FPartitionBuildOp
 
 	CommitPartitionBuildContext(context);
 	BuildPartitionRuntimeData(context);
+	AlignDungeonActorInstancedMeshClusters(context);
 	ApplyDungeonActorCullDistances(context);
 	FinalizePartitionBuild(options, true);
 	return true;
@@ -344,6 +464,8 @@ void ADungeonMainLevelScriptActor::ResetPartitionBuildState()
 	mPartitionGridCount = FIntVector(AutoPartitionHorizontalMinGridCount, AutoPartitionHorizontalMinGridCount, AutoPartitionVerticalMinGridCount);
 	DungeonPartitions.Reset();
 	mPartitionIndexByCell.Reset();
+	mPartitionAisleLinks.Reset();
+	ResetPendingRegisteredPartitions();
 	ResetPrecomputedPartitionVisibility();
 	ResetPartitionTransitionQueue();
 }
@@ -367,12 +489,43 @@ void ADungeonMainLevelScriptActor::CommitPartitionBuildContext(const FPartitionB
 void ADungeonMainLevelScriptActor::BuildPartitionRuntimeData(const FPartitionBuildContext& context)
 {
 	BuildSparsePartitionGraph(context.DungeonGenerateActors);
-	BuildPartitionVisibilitySamples(context.DungeonGenerateActors);
-	BuildPartitionConnectedComponents();
-	BuildPrecomputedPartitionVisibility();
+	BuildPartitionAisleLinks(context.DungeonGenerateActors);
+
+	const bool useCache = bUsePrecomputedPartitionVisibility && bUsePartitionVisibilityCache;
+	const uint32 cacheKey = useCache ? ComputePartitionVisibilityCacheKey(context) : 0;
+	if (useCache && LoadPartitionVisibilityCache(context, cacheKey))
+	{
+		BuildPartitionConnectedComponents();
+	}
+	else
+	{
+		BuildPartitionVisibilitySamples(context.DungeonGenerateActors);
+		BuildPartitionConnectedComponents();
+		if (bUsePortalPartitionVisibility)
+			BuildPartitionPortals(context.DungeonGenerateActors);
+		BuildPrecomputedPartitionVisibility();
+		ResetPartitionPortals();
+		if (useCache)
+			SavePartitionVisibilityCache(context, cacheKey);
+	}
+
 	ResetPartitionTransitionQueue();
 }
 
+/*
+ * Regroups the instanced meshes of all collected dungeon actors by partition cell.
+ * The activators of the clusters are registered by FinalizePartitionBuild.
+ * 収集済みダンジョン actor のインスタンスメッシュをパーティションのセルでまとめ直します。
+ * クラスターのアクティベーターは FinalizePartitionBuild で登録されます。
+ */
+void ADungeonMainLevelScriptActor::AlignDungeonActorInstancedMeshClusters(const FPartitionBuildContext& context) const
+{
+	for (ADungeonGenerateActor* dungeonGenerateActor : context.DungeonGenerateActors)
+	{
+		dungeonGenerateActor->AlignInstancedMeshClustersToPartitions(mBounding.Min, mPartitionWorldSize);
+	}
+}
+
 /*
  * Pushes the newly computed culling distance range back to all collected dungeon actors.
  * 新しく計算したカリング距離範囲を収集済みダンジョン actor へ反映します。
@@ -422,6 +575,144 @@ void ADungeonMainLevelScriptActor::RefreshActivatorComponentRegistrations()
 				activatorComponent->RefreshPartitionRegistration(this);
 		}
 	}
+
+	ResyncMovableActivatorComponents();
+}
+
+/*
+ * 移動するアクティベータコンポーネントは配列でまとめて保持し、毎フレーム一度に位置を調べます
+ */
+void ADungeonMainLevelScriptActor::RegisterMovableActivatorComponent(UDungeonComponentActivatorComponent* component)
+{
+	check(IsInGameThread());
+	if (!IsValid(component) || component->mMovableActivatorIndex != INDEX_NONE)
+		return;
+
+	const FVector location = component->GetPartitionRegistrationWorldLocation(component->GetOwner());
+	component->mMovableActivatorIndex = mMovableActivatorComponents.Add(component);
+	mMovableActivatorLocations.Add(location);
+	mMovableActivatorPartitionIndices.Add(FindPartitionIndex(location));
+}
+
+void ADungeonMainLevelScriptActor::UnregisterMovableActivatorComponent(UDungeonComponentActivatorComponent* component)
+{
+	check(IsInGameThread());
+	const int32 index = component->mMovableActivatorIndex;
+	if (!mMovableActivatorComponents.IsValidIndex(index) || mMovableActivatorComponents[index] != component)
+		return;
+
+	component->mMovableActivatorIndex = INDEX_NONE;
+	RemoveMovableActivatorComponentAt(index);
+}
+
+/*
+ * 末尾の要素を取り除く位置へ移して、並列の配列も同じように詰めます
+ */
+void ADungeonMainLevelScriptActor::RemoveMovableActivatorComponentAt(const int32 index)
+{
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+	mMovableActivatorComponents.RemoveAtSwap(index, 1, EAllowShrinking::No);
+	mMovableActivatorLocations.RemoveAtSwap(index, 1, EAllowShrinking::No);
+	mMovableActivatorPartitionIndices.RemoveAtSwap(index, 1, EAllowShrinking::No);
+#else
+	mMovableActivatorComponents.RemoveAtSwap(index, 1, false);
+	mMovableActivatorLocations.RemoveAtSwap(index, 1, false);
+	mMovableActivatorPartitionIndices.RemoveAtSwap(index, 1, false);
+#endif
+
+	// 末尾から移動してきたコンポーネントの位置を更新します
+	if (mMovableActivatorComponents.IsValidIndex(index) && mMovableActivatorComponents[index])
+		mMovableActivatorComponents[index]->mMovableActivatorIndex = index;
+}
+
+void ADungeonMainLevelScriptActor::ResetMovableActivatorComponents()
+{
+	for (UDungeonComponentActivatorComponent* component : mMovableActivatorComponents)
+	{
+		if (component)
+			component->mMovableActivatorIndex = INDEX_NONE;
+	}
+	mMovableActivatorComponents.Reset();
+	mMovableActivatorLocations.Reset();
+	mMovableActivatorPartitionIndices.Reset();
+	mMovedActivatorIndices.Reset();
+}
+
+/*
+ * パーティションを作り直すと番号が変わるので、追跡している位置と所属パーティションを取り直します
+ */
+void ADungeonMainLevelScriptActor::ResyncMovableActivatorComponents()
+{
+	for (int32 index = 0; index < mMovableActivatorComponents.Num(); ++index)
+	{
+		const UDungeonComponentActivatorComponent* component = mMovableActivatorComponents[index];
+		if (!IsValid(component))
+			continue;
+
+		const FVector location = component->GetPartitionRegistrationWorldLocation(component->GetOwner());
+		mMovableActivatorLocations[index] = location;
+		mMovableActivatorPartitionIndices[index] = FindPartitionIndex(location);
+	}
+}
+
+/*
+ * 位置とパーティションの検索は読み取りだけなので並列に行い、
+ * パーティションを移動したコンポーネントの登録変更だけをGameThreadでまとめて反映します。
+ * EndPlayを経ずに破棄されたコンポーネントは、並列に処理する前に末尾と入れ替えて取り除きます。
+ */
+void ADungeonMainLevelScriptActor::UpdateMovableActivatorComponents()
+{
+	// 末尾から調べるので、入れ替えで移ってくるコンポーネントは調べ終わっています
+	for (int32 index = mMovableActivatorComponents.Num() - 1; index >= 0; --index)
+	{
+		UDungeonComponentActivatorComponent* component = mMovableActivatorComponents[index];
+		if (IsValid(component))
+			continue;
+
+		if (component)
+			component->mMovableActivatorIndex = INDEX_NONE;
+		RemoveMovableActivatorComponentAt(index);
+	}
+
+	const int32 componentCount = mMovableActivatorComponents.Num();
+	if (componentCount == 0)
+		return;
+
+	mMovedActivatorIndices.SetNumUninitialized(componentCount);
+	std::atomic<int32> movedCount = 0;
+	ParallelFor(componentCount, [this, &movedCount](const int32 index)
+		{
+			const UDungeonComponentActivatorComponent* component = mMovableActivatorComponents[index];
+			if (!IsValid(component))
+				return;
+
+			const FVector location = component->GetPartitionRegistrationWorldLocation(component->GetOwner());
+			if (FVector::DistSquared(mMovableActivatorLocations[index], location) < MovableActivatorDetectionDistance * MovableActivatorDetectionDistance)
+				return;
+
+			mMovableActivatorLocations[index] = location;
+			const int32 partitionIndex = FindPartitionIndex(location);
+			if (partitionIndex == mMovableActivatorPartitionIndices[index])
+				return;
+
+			mMovableActivatorPartitionIndices[index] = partitionIndex;
+			mMovedActivatorIndices[movedCount.fetch_add(1, std::memory_order_relaxed)] = index;
+		},
+		componentCount < MinParallelMovableActivatorCount ? EParallelForFlags::ForceSingleThread : EParallelForFlags::None
+	);
+
+	// 実行ごとに登録順が変わらないように並べてから反映します
+	TArrayView<int32> movedIndices(mMovedActivatorIndices.GetData(), movedCount.load(std::memory_order_relaxed));
+	Algo::Sort(movedIndices);
+	for (const int32 index : movedIndices)
+	{
+		UDungeonComponentActivatorComponent* component = mMovableActivatorComponents[index];
+		if (!IsValid(component))
+			continue;
+
+		const int32 partitionIndex = mMovableActivatorPartitionIndices[index];
+		component->MoveToPartition(DungeonPartitions.IsValidIndex(partitionIndex) ? DungeonPartitions[partitionIndex].Get() : nullptr);
+	}
 }
 
 void ADungeonMainLevelScriptActor::ApplyCurrentPartitionActivationState()
@@ -437,18 +728,10 @@ void ADungeonMainLevelScriptActor::ApplyCurrentPartitionActivationState()
 	if (UWorld* world = GetWorld())
 	{
 		Begin();
-		for (FConstPlayerControllerIterator iterator = world->GetPlayerControllerIterator(); iterator; ++iterator)
-		{
-			const auto* playerController = iterator->Get();
-			if (!IsValid(playerController))
-				continue;
-
-			const auto& playerPawn = playerController->GetPawn();
-			if (IsValid(playerPawn) && playerPawn->IsPlayerControlled())
-				Mark(playerPawn->GetActorLocation());
-		}
+		MarkPlayerViewers(*world);
 		End(0.f);
 
+		SyncShadowCastingLightLimit();
 		if (MaxShadowCastingPointAndSpotLights > 0)
 			UpdateShadowCastingPointAndSpotLights();
 	}
@@ -461,108 +744,202 @@ void ADungeonMainLevelScriptActor::ApplyCurrentPartitionActivationState()
 
 void ADungeonMainLevelScriptActor::ResetPartitionTransitionQueue()
 {
-	mPendingPartitionTransitions.Reset();
-	mPendingPartitionTransitionReadIndex = 0;
+	// 視点の追跡をやり直し、次の End で全てのパーティションを更新します
+	mPartitionUpdateRequiresFullScan = true;
+	mPartitionViewers.Reset();
+	mSourcePartitionViewerCounts.Init(0, DungeonPartitions.Num());
+	mPartitionViewerCounts.Init(0, DungeonPartitions.Num());
+	mScheduledPartitionUpdates.Init(false, DungeonPartitions.Num());
+	mChangedPartitionIndices.Reset();
+	mInactivatingPartitionIndices.Reset();
+	mPendingPartitionPrefetches.Reset();
+	mQueuedPartitionPrefetches.Init(false, DungeonPartitions.Num());
+	mShadowCastingPartitionIndices.Reset();
+	mShadowCastingPartitionPositions.Init(INDEX_NONE, DungeonPartitions.Num());
+	mShadowReleasedPartitionIndices.Reset();
+	mShadowCastingRequiresFullScan = true;
+	mPendingPartitionActivations.Reset(DungeonPartitions.Num());
+	mPendingPartitionInactivations.Reset(DungeonPartitions.Num());
+	mPartitionTransitionPrioritiesDirty = false;
 	mDesiredPartitionActivation.Reset(DungeonPartitions.Num());
-	mQueuedPartitionTransitions.Reset(DungeonPartitions.Num());
 
 	for (UDungeonPartition* partition : DungeonPartitions)
 	{
+		if (IsValid(partition))
+			partition->Unmark();
 		const bool isActive = IsValid(partition) && partition->IsPartitionActivate();
 		mDesiredPartitionActivation.Add(isActive ? 1 : 0);
-		mQueuedPartitionTransitions.Add(0);
 	}
 }
 
+/*
+ * UDungeonComponentActivatorComponent の登録は GameThread 以外からも行われるのでロックします
+ */
+void ADungeonMainLevelScriptActor::EnqueueRegisteredPartition(UDungeonPartition* partition)
+{
+	UE::TScopeLock lock(mPendingRegisteredPartitionsMutex);
+	mPendingRegisteredPartitions.Add(partition);
+}
+
+void ADungeonMainLevelScriptActor::FlushPendingRegisteredPartitions()
+{
+	TArray<TObjectPtr<UDungeonPartition>> pendingRegisteredPartitions;
+	{
+		UE::TScopeLock lock(mPendingRegisteredPartitionsMutex);
+		Swap(pendingRegisteredPartitions, mPendingRegisteredPartitions);
+	}
+
+	for (UDungeonPartition* partition : pendingRegisteredPartitions)
+	{
+		if (IsValid(partition))
+		{
+			partition->FlushRegisteredComponents();
+
+			// 登録されたライトは影を落とした状態なので、見えていなければ消します
+			if (const int32* partitionIndex = mPartitionIndexByCell.Find(partition->GetCellCoordinate()))
+				ReleaseShadowCastingPartition(*partitionIndex);
+		}
+	}
+}
+
+void ADungeonMainLevelScriptActor::ResetPendingRegisteredPartitions()
+{
+	UE::TScopeLock lock(mPendingRegisteredPartitionsMutex);
+	mPendingRegisteredPartitions.Reset();
+}
+
+/*
+ * 既に登録されているパーティションは重複させずに、その場で優先度を更新します
+ */
 void ADungeonMainLevelScriptActor::EnqueuePartitionTransition(const int32 partitionIndex)
 {
-	if (!DungeonPartitions.IsValidIndex(partitionIndex))
-		return;
-	if (!mQueuedPartitionTransitions.IsValidIndex(partitionIndex))
-		return;
-	if (mQueuedPartitionTransitions[partitionIndex] != 0)
+	if (!DungeonPartitions.IsValidIndex(partitionIndex) || !mDesiredPartitionActivation.IsValidIndex(partitionIndex))
 		return;
 
-	mPendingPartitionTransitions.Add(partitionIndex);
-	mQueuedPartitionTransitions[partitionIndex] = 1;
+	if (mDesiredPartitionActivation[partitionIndex] != 0)
+	{
+		mPendingPartitionInactivations.Remove(partitionIndex);
+		mPendingPartitionActivations.Push(partitionIndex, ComputePartitionTransitionPriority(partitionIndex, true));
+	}
+	else
+	{
+		mPendingPartitionActivations.Remove(partitionIndex);
+		mPendingPartitionInactivations.Push(partitionIndex, ComputePartitionTransitionPriority(partitionIndex, false));
+	}
+}
+
+/*
+ * アクティブ化は最も近い視点に近いほど、非アクティブ化は遠いほど優先します。
+ * アクティブ化では視点から見えているパーティションを、待ち時間で残しているだけのパーティションより先にします。
+ */
+float ADungeonMainLevelScriptActor::ComputePartitionTransitionPriority(const int32 partitionIndex, const bool activate) const
+{
+	const FBox& bounds = DungeonPartitions[partitionIndex]->GetBounds();
+	double nearestDistanceSquared = mPartitionViewers.IsEmpty() ? 0.0 : TNumericLimits<double>::Max();
+	for (const auto& viewer : mPartitionViewers)
+		nearestDistanceSquared = FMath::Min(nearestDistanceSquared, bounds.ComputeSquaredDistanceToPoint(viewer.Value.Location));
+	const float nearestDistance = static_cast<float>(FMath::Sqrt(nearestDistanceSquared));
+
+	if (!activate)
+		return -nearestDistance;
+
+	const bool visible = mPartitionViewerCounts.IsValidIndex(partitionIndex) && mPartitionViewerCounts[partitionIndex] > 0;
+	return visible ? nearestDistance : nearestDistance + static_cast<float>(mTheoreticalMaxVisibilityDistance) + mBounding.GetSize().Size();
+}
+
+/*
+ * フレームで最初の切り替えは予算に関係なく処理するので、コストの大きいパーティションでも必ず進みます
+ */
+bool ADungeonMainLevelScriptActor::CanSpendPartitionTransitionBudget(const UDungeonPartition* partition, const FPartitionTransitionCost& cost, const double spentMilliseconds) const
+{
+	if (PartitionTransitionBudgetMilliseconds <= 0.f || spentMilliseconds <= 0.0)
+		return true;
+	return spentMilliseconds + cost.Estimate(partition->GetActivatorComponentCount()) <= PartitionTransitionBudgetMilliseconds;
 }
 
 void ADungeonMainLevelScriptActor::ProcessPartitionTransitionQueue()
 {
-	if (mDesiredPartitionActivation.Num() != DungeonPartitions.Num() || mQueuedPartitionTransitions.Num() != DungeonPartitions.Num())
+	if (mDesiredPartitionActivation.Num() != DungeonPartitions.Num())
 	{
 		ResetPartitionTransitionQueue();
 		return;
 	}
 
-	int32 remainingActivations = MaxPartitionActivationsPerFrame > 0 ? MaxPartitionActivationsPerFrame : TNumericLimits<int32>::Max();
-	int32 remainingInactivations = MaxPartitionInactivationsPerFrame > 0 ? MaxPartitionInactivationsPerFrame : TNumericLimits<int32>::Max();
-	const int32 pendingCount = mPendingPartitionTransitions.Num() - mPendingPartitionTransitionReadIndex;
-	for (int32 processedCount = 0; processedCount < pendingCount; ++processedCount)
+	// 視点がパーティションを移動したら、待っているパーティションの優先度をまとめて更新します
+	if (mPartitionTransitionPrioritiesDirty)
 	{
-		if (!mPendingPartitionTransitions.IsValidIndex(mPendingPartitionTransitionReadIndex))
-			break;
-
-		const int32 partitionIndex = mPendingPartitionTransitions[mPendingPartitionTransitionReadIndex++];
-		if (!DungeonPartitions.IsValidIndex(partitionIndex) || !mQueuedPartitionTransitions.IsValidIndex(partitionIndex))
-			continue;
-
-		UDungeonPartition* partition = DungeonPartitions[partitionIndex];
-		if (!IsValid(partition))
-		{
-			mQueuedPartitionTransitions[partitionIndex] = 0;
-			continue;
-		}
-
-		const bool desiredActive = mDesiredPartitionActivation[partitionIndex] != 0;
-		const bool currentActive = partition->IsPartitionActivate();
-		if (desiredActive == currentActive)
-		{
-			mQueuedPartitionTransitions[partitionIndex] = 0;
-			partition->FlushRegisteredComponents();
-			continue;
-		}
-
-		if (desiredActive)
-		{
-			if (remainingActivations <= 0)
+		mPendingPartitionActivations.Reprioritize([this](const int32 partitionIndex)
 			{
-				mPendingPartitionTransitions.Add(partitionIndex);
-				continue;
+				return ComputePartitionTransitionPriority(partitionIndex, true);
 			}
-
-			partition->CallPartitionActivate(false);
-			--remainingActivations;
-		}
-		else
-		{
-			if (remainingInactivations <= 0)
+		);
+		mPendingPartitionInactivations.Reprioritize([this](const int32 partitionIndex)
 			{
-				mPendingPartitionTransitions.Add(partitionIndex);
-				continue;
+				return ComputePartitionTransitionPriority(partitionIndex, false);
 			}
+		);
+		mPartitionTransitionPrioritiesDirty = false;
+	}
 
-			partition->CallPartitionInactivate();
-			--remainingInactivations;
-		}
+	// 切り替える必要がなくなったパーティションを先頭から取り除きます
+	auto popUnchangedPartitions = [this](FDungeonPartitionTransitionQueue& queue)
+	{
+		while (!queue.IsEmpty())
+		{
+			const int32 partitionIndex = queue.Top();
+			UDungeonPartition* partition = DungeonPartitions[partitionIndex];
+			if (IsValid(partition) && (mDesiredPartitionActivation[partitionIndex] != 0) != partition->IsPartitionActivate())
+				return true;
 
-		mQueuedPartitionTransitions[partitionIndex] = 0;
-	}
+			queue.Pop();
+			if (IsValid(partition))
+				partition->FlushRegisteredComponents();
+		}
+		return false;
+	};
 
-	if (mPendingPartitionTransitionReadIndex >= mPendingPartitionTransitions.Num())
+	double activationMilliseconds = 0.0;
+	int32 remainingActivations = MaxPartitionActivationsPerFrame > 0 ? MaxPartitionActivationsPerFrame : TNumericLimits<int32>::Max();
+	while (remainingActivations > 0 && popUnchangedPartitions(mPendingPartitionActivations))
 	{
-		mPendingPartitionTransitions.Reset();
-		mPendingPartitionTransitionReadIndex = 0;
+		UDungeonPartition* partition = DungeonPartitions[mPendingPartitionActivations.Top()];
+		if (!CanSpendPartitionTransitionBudget(partition, mPartitionActivationCost, activationMilliseconds))
+			break;
+
+		mPendingPartitionActivations.Pop();
+		const int32 componentCount = partition->GetActivatorComponentCount();
+		const uint64 startCycles = FPlatformTime::Cycles64();
+		partition->CallPartitionActivate(false);
+		const double milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles);
+		mPartitionActivationCost.Measure(componentCount, milliseconds);
+		activationMilliseconds += milliseconds;
+		--remainingActivations;
+		++mPartitionActivationCount;
 	}
-	else if (mPendingPartitionTransitionReadIndex > 0 && mPendingPartitionTransitionReadIndex * 2 >= mPendingPartitionTransitions.Num())
+
+	// 非アクティブ化はアクティブ化の残りの予算を使いますが、毎フレーム少なくとも1つは処理します
+	double inactivationMilliseconds = 0.0;
+	int32 remainingInactivations = MaxPartitionInactivationsPerFrame > 0 ? MaxPartitionInactivationsPerFrame : TNumericLimits<int32>::Max();
+	while (remainingInactivations > 0 && popUnchangedPartitions(mPendingPartitionInactivations))
 	{
-#if UE_VERSION_NEWER_THAN(5, 6, 0)
-		mPendingPartitionTransitions.RemoveAt(0, mPendingPartitionTransitionReadIndex, EAllowShrinking::No);
-#else
-		mPendingPartitionTransitions.RemoveAt(0, mPendingPartitionTransitionReadIndex);
-#endif
-		mPendingPartitionTransitionReadIndex = 0;
+		UDungeonPartition* partition = DungeonPartitions[mPendingPartitionInactivations.Top()];
+		if (inactivationMilliseconds > 0.0 && !CanSpendPartitionTransitionBudget(partition, mPartitionInactivationCost, activationMilliseconds + inactivationMilliseconds))
+			break;
+
+		mPendingPartitionInactivations.Pop();
+		const int32 componentCount = partition->GetActivatorComponentCount();
+		const uint64 startCycles = FPlatformTime::Cycles64();
+		partition->CallPartitionInactivate();
+		const double milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles);
+		mPartitionInactivationCost.Measure(componentCount, milliseconds);
+		inactivationMilliseconds += milliseconds;
+		--remainingInactivations;
+		++mPartitionInactivationCount;
 	}
+
+	// 余ったアクティブ化の枠と予算で先読みを処理します
+	double spentMilliseconds = activationMilliseconds + inactivationMilliseconds;
+	ProcessPartitionPrefetchQueue(remainingActivations, spentMilliseconds);
 }
 
 void ADungeonMainLevelScriptActor::EndPlay(const EEndPlayReason::Type endPlayReason)
@@ -571,6 +948,9 @@ void ADungeonMainLevelScriptActor::EndPlay(const EEndPlayReason::Type endPlayRea
 
 	DungeonPartitions.Reset();
 	mPartitionIndexByCell.Reset();
+	mPartitionAisleLinks.Reset();
+	ResetPendingRegisteredPartitions();
+	ResetMovableActivatorComponents();
 	ResetPrecomputedPartitionVisibility();
 	mBounding.Init();
 	ResetPartitionTransitionQueue();
@@ -590,23 +970,13 @@ void ADungeonMainLevelScriptActor::Tick(float deltaSeconds)
 	{
 		if (const UWorld* world = GetValid(GetWorld()))
 		{
+			UpdateMovableActivatorComponents();
 			Begin();
-			for (FConstPlayerControllerIterator iterator = world->GetPlayerControllerIterator(); iterator; ++iterator)
-			{
-				const auto* playerController = iterator->Get();
-				if (IsValid(playerController))
-				{
-					const auto& playerPawn = playerController->GetPawn();
-					if (IsValid(playerPawn) && playerPawn->IsPlayerControlled())
-					{
-						// プレイヤー周辺をマークする
-						Mark(playerPawn->GetActorLocation());
-					}
-				}
-			}
+			MarkPlayerViewers(*world);
 			End(deltaSeconds);
 
 			// ポイントライトおよびスポットライトの影を落とすか制御
+			SyncShadowCastingLightLimit();
 			if (MaxShadowCastingPointAndSpotLights > 0)
 				UpdateShadowCastingPointAndSpotLights();
 		}
@@ -644,6 +1014,44 @@ UDungeonPartition* ADungeonMainLevelScriptActor::Find(const FVector& worldLocati
 	return DungeonPartitions[partitionIndex];
 }
 
+/*
+ * 境界が複数のセルにまたがる巨大なアクター用です。
+ * 重なるセルにパーティションが無い場合は境界の中心で検索します。
+ */
+void ADungeonMainLevelScriptActor::FindPartitions(const FBox& worldBounds, TArray<UDungeonPartition*>& outPartitions) const
+{
+	outPartitions.Reset();
+	if (!worldBounds.IsValid || !mBounding.IsValid || DungeonPartitions.IsEmpty())
+		return;
+
+	const FBox overlap = worldBounds.Overlap(mBounding);
+	if (overlap.IsValid)
+	{
+		const FIntVector minimumCell = ToPartitionCell(overlap.Min);
+		const FIntVector maximumCell = ToPartitionCell(overlap.Max);
+		for (int32 z = minimumCell.Z; z <= maximumCell.Z; ++z)
+		{
+			for (int32 y = minimumCell.Y; y <= maximumCell.Y; ++y)
+			{
+				for (int32 x = minimumCell.X; x <= maximumCell.X; ++x)
+				{
+					if (const int32* partitionIndex = mPartitionIndexByCell.Find(FIntVector(x, y, z)))
+					{
+						if (UDungeonPartition* partition = DungeonPartitions[*partitionIndex])
+							outPartitions.AddUnique(partition);
+					}
+				}
+			}
+		}
+	}
+
+	if (outPartitions.IsEmpty())
+	{
+		if (UDungeonPartition* partition = Find(worldBounds.GetCenter()))
+			outPartitions.Add(partition);
+	}
+}
+
 /*
  * 点で検索しているので、巨大なアクターは誤判定に注意してください。
  */
@@ -812,8 +1220,9 @@ void ADungeonMainLevelScriptActor::BuildSparsePartitionGraph(const TArray<ADunge
 void ADungeonMainLevelScriptActor::ResetPrecomputedPartitionVisibility()
 {
 	mPartitionVisibilitySamples.Reset();
-	mPartitionPotentialVisibilityMasks.Reset();
+	mPartitionPotentialVisibilityRows.Reset();
 	mPartitionConnectedComponents.Reset();
+	ResetPartitionPortals();
 }
 
 void ADungeonMainLevelScriptActor::BuildPartitionVisibilitySamples(const TArray<ADungeonGenerateActor*>& dungeonGenerateActors)
@@ -972,35 +1381,135 @@ void ADungeonMainLevelScriptActor::BuildPartitionConnectedComponents()
 	}
 }
 
-void ADungeonMainLevelScriptActor::BuildPrecomputedPartitionVisibility()
+/*
+ * Gate や通路の入口を含め、パーティション境界をまたいで視線が通るグリッド面を
+ * パーティションの組と境界平面ごとにまとめてポータルにします。
+ * 同じ平面上に複数の開口がある場合は、それらを囲む矩形を一つのポータルとして扱います。
+ */
+void ADungeonMainLevelScriptActor::BuildPartitionPortals(const TArray<ADungeonGenerateActor*>& dungeonGenerateActors)
 {
-	mPartitionPotentialVisibilityMasks.Reset();
+	ResetPartitionPortals();
+	mPartitionPortalIndices.SetNum(DungeonPartitions.Num());
 	if (DungeonPartitions.IsEmpty())
 		return;
 
-	const int32 partitionCount = DungeonPartitions.Num();
-	const int32 wordCount = (partitionCount + 63) / 64;
-	mPartitionPotentialVisibilityMasks.SetNum(partitionCount);
-	for (TArray<uint64>& row : mPartitionPotentialVisibilityMasks)
+	// (小さいパーティション番号, 大きいパーティション番号, 軸 + 3 * アクター番号, 境界平面のグリッド座標)
+	TMap<TTuple<int32, int32, int32, int32>, int32> portalIndexByKey;
+
+	for (int32 actorIndex = 0; actorIndex < dungeonGenerateActors.Num(); ++actorIndex)
 	{
-		row.Init(0ull, wordCount);
-	}
+		const ADungeonGenerateActor* dungeonGenerateActor = dungeonGenerateActors[actorIndex];
+		if (!IsValid(dungeonGenerateActor) || !IsValid(dungeonGenerateActor->mParameter))
+			continue;
 
-	if (mPartitionVisibilitySamples.Num() != partitionCount || mPartitionConnectedComponents.Num() != partitionCount)
-		return;
+		const std::shared_ptr<const dungeon::Generator> generator = dungeonGenerateActor->GetGenerator();
+		if (generator == nullptr)
+			continue;
 
-	const double maximumVisibilityDistanceSquared =
-		mTheoreticalMaxVisibilityDistance > 0.f ?
-		FMath::Square(static_cast<double>(mTheoreticalMaxVisibilityDistance)) :
-		TNumericLimits<double>::Max();
-	const int32 visibilityDilationHopCount = FMath::Max(0, PrecomputedVisibilityDilationHopCount);
+		const auto& voxel = generator->GetVoxel();
+		if (voxel == nullptr)
+			continue;
 
-	ParallelFor(partitionCount, [this, partitionCount, maximumVisibilityDistanceSquared, visibilityDilationHopCount](const int32 sourcePartitionIndex)
+		const UDungeonGenerateParameter* parameter = dungeonGenerateActor->mParameter;
+		const FVector actorLocation = dungeonGenerateActor->GetActorLocation();
+		const FVector gridSize = parameter->GetGridSize().To3D();
+		const FVector gridHalfSize = gridSize * 0.5f;
+		voxel->Each([this, &voxel, &portalIndexByKey, actorIndex, parameter, actorLocation, gridSize, gridHalfSize](const FIntVector& location, const dungeon::Grid& grid)
+			{
+				if (!IsTraversableGrid(grid))
+					return true;
+
+				const FVector worldMinimum = parameter->ToWorld(location) + actorLocation;
+				const int32 partitionIndex = FindPartitionIndex(worldMinimum + gridHalfSize);
+				if (!DungeonPartitions.IsValidIndex(partitionIndex))
+					return true;
+
+				for (uint8 axis = 0; axis < 3; ++axis)
+				{
+					if (!voxel->IsVisibilityTransitionOpen(location, axis, 1))
+						continue;
+
+					FIntVector neighborLocation = location;
+					neighborLocation[axis] += 1;
+					FVector neighborWorldCenter = worldMinimum + gridHalfSize;
+					neighborWorldCenter[axis] += gridSize[axis];
+					const int32 neighborPartitionIndex = FindPartitionIndex(neighborWorldCenter);
+					if (!DungeonPartitions.IsValidIndex(neighborPartitionIndex) || neighborPartitionIndex == partitionIndex)
+						continue;
+
+					FVector faceMinimum = worldMinimum;
+					faceMinimum[axis] += gridSize[axis];
+					FVector faceMaximum = worldMinimum + gridSize;
+
+					const TTuple<int32, int32, int32, int32> key(
+						FMath::Min(partitionIndex, neighborPartitionIndex),
+						FMath::Max(partitionIndex, neighborPartitionIndex),
+						axis + 3 * actorIndex,
+						neighborLocation[axis]
+					);
+					int32* portalIndex = portalIndexByKey.Find(key);
+					if (portalIndex == nullptr)
+					{
+						FPartitionPortal& portal = mPartitionPortals.AddDefaulted_GetRef();
+						portal.PartitionIndices[0] = partitionIndex;
+						portal.PartitionIndices[1] = neighborPartitionIndex;
+						portal.Axis = axis;
+						portalIndex = &portalIndexByKey.Add(key, mPartitionPortals.Num() - 1);
+						mPartitionPortalIndices[partitionIndex].Add(*portalIndex);
+						mPartitionPortalIndices[neighborPartitionIndex].Add(*portalIndex);
+					}
+
+					FPartitionPortal& portal = mPartitionPortals[*portalIndex];
+					portal.Bounds += faceMinimum;
+					portal.Bounds += faceMaximum;
+				}
+
+				return true;
+			}
+		);
+	}
+
+	DUNGEON_GENERATOR_LOG(TEXT("PartitionPortals: %d portals, %d partitions"), mPartitionPortals.Num(), DungeonPartitions.Num());
+}
+
+void ADungeonMainLevelScriptActor::ResetPartitionPortals()
+{
+	mPartitionPortals.Empty();
+	mPartitionPortalIndices.Empty();
+}
+
+void ADungeonMainLevelScriptActor::BuildPrecomputedPartitionVisibility()
+{
+	mPartitionPotentialVisibilityRows.Reset();
+	if (DungeonPartitions.IsEmpty())
+		return;
+
+	const int32 partitionCount = DungeonPartitions.Num();
+	const int32 wordCount = (partitionCount + 63) / 64;
+	mPartitionPotentialVisibilityRows.SetNum(partitionCount);
+
+	if (mPartitionVisibilitySamples.Num() != partitionCount || mPartitionConnectedComponents.Num() != partitionCount)
+		return;
+
+	const double maximumVisibilityDistanceSquared =
+		mTheoreticalMaxVisibilityDistance > 0.f ?
+		FMath::Square(static_cast<double>(mTheoreticalMaxVisibilityDistance)) :
+		TNumericLimits<double>::Max();
+	const int32 visibilityDilationHopCount = FMath::Max(0, PrecomputedVisibilityDilationHopCount);
+	const bool usePortals = bUsePortalPartitionVisibility && mPartitionPortalIndices.Num() == partitionCount;
+
+	ParallelFor(partitionCount, [this, partitionCount, wordCount, maximumVisibilityDistanceSquared, visibilityDilationHopCount, usePortals](const int32 sourcePartitionIndex)
 		{
 			if (!DungeonPartitions.IsValidIndex(sourcePartitionIndex) || !IsValid(DungeonPartitions[sourcePartitionIndex]))
 				return;
 
-			TArray<uint64>& row = mPartitionPotentialVisibilityMasks[sourcePartitionIndex];
+			// ビット列で集計してから行の形式に圧縮します
+			TArray<uint64> row;
+			row.Init(0ull, wordCount);
+			ON_SCOPE_EXIT
+			{
+				mPartitionPotentialVisibilityRows[sourcePartitionIndex].Assign(row);
+			};
 			const UDungeonPartition* sourcePartition = DungeonPartitions[sourcePartitionIndex];
 			auto setVisible = [&row](const int32 partitionIndex)
 			{
@@ -1051,6 +1560,42 @@ void ADungeonMainLevelScriptActor::BuildPrecomputedPartitionVisibility()
 
 			setVisibleWithDilation(sourcePartitionIndex);
 
+			if (usePortals)
+			{
+				// ソースの領域全体を視点として、ポータルを通して見えるパーティションを集めます
+				TArray<uint64> portalRow;
+				portalRow.Init(0ull, row.Num());
+				TBitArray<> pathPartitions(false, partitionCount);
+				pathPartitions[sourcePartitionIndex] = true;
+				int32 remainingPortalVisits = MaxPortalVisitsPerSourcePartition;
+				const bool completed = TraversePartitionPortals(sourcePartition->GetBounds(), sourcePartitionIndex, 0, FPartitionPortalPlanes(), pathPartitions, portalRow, maximumVisibilityDistanceSquared, remainingPortalVisits);
+
+				if (completed)
+				{
+					for (const int32 neighborIndex : sourcePartition->GetNeighborIndices())
+					{
+						if (DungeonPartitions.IsValidIndex(neighborIndex))
+							portalRow[neighborIndex / 64] |= (1ull << (neighborIndex % 64));
+					}
+
+					for (int32 wordIndex = 0; wordIndex < portalRow.Num(); ++wordIndex)
+					{
+						for (uint64 word = portalRow[wordIndex]; word != 0; word &= word - 1)
+						{
+							const int32 targetPartitionIndex = wordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(word));
+							if (targetPartitionIndex == sourcePartitionIndex || !IsValid(DungeonPartitions[targetPartitionIndex]))
+								continue;
+							if (mPartitionConnectedComponents[sourcePartitionIndex] != mPartitionConnectedComponents[targetPartitionIndex])
+								continue;
+							setVisibleWithDilation(targetPartitionIndex);
+						}
+					}
+					return;
+				}
+
+				DUNGEON_GENERATOR_LOG(TEXT("Partition %d exceeded the portal traversal limit and falls back to sample tracing"), sourcePartitionIndex);
+			}
+
 			for (int32 targetPartitionIndex = 0; targetPartitionIndex < partitionCount; ++targetPartitionIndex)
 			{
 				if (targetPartitionIndex == sourcePartitionIndex)
@@ -1072,51 +1617,212 @@ void ADungeonMainLevelScriptActor::BuildPrecomputedPartitionVisibility()
 	);
 }
 
-bool ADungeonMainLevelScriptActor::HasPrecomputedPartitionVisibility() const noexcept
+/*
+ * Teller の cell-portal 可視性と同様に、送信元のパーティション領域と通過してきたポータルを
+ * 分離する平面で次のポータルを切り取り、残った領域があれば隣のパーティションを可視として奥へ進みます。
+ * 視点を点ではなく送信元の領域全体として扱い、パーティション内部の遮蔽も考慮しないので、
+ * 送信元のどこから見える場合も可視になる保守的な結果になります。
+ * 探索数または深さが上限を超えた場合は false を返します。
+ */
+bool ADungeonMainLevelScriptActor::TraversePartitionPortals(const FBox& sourceBounds, const int32 partitionIndex, const int32 depth, const FPartitionPortalPlanes& clipPlanes, TBitArray<>& pathPartitions, TArray<uint64>& row, const double maximumVisibilityDistanceSquared, int32& remainingPortalVisits) const
 {
-	return
-		mPartitionVisibilitySamples.Num() == DungeonPartitions.Num() &&
-		mPartitionPotentialVisibilityMasks.Num() == DungeonPartitions.Num() &&
-		mPartitionConnectedComponents.Num() == DungeonPartitions.Num() &&
-		DungeonPartitions.IsEmpty() == false;
+	if (depth > MaxPortalTraversalDepth)
+		return false;
+
+	FPartitionPortalPolygon polygon;
+	FPartitionPortalPolygon clippedPolygon;
+	FPartitionPortalPlanes nextClipPlanes;
+
+	for (const int32 portalIndex : mPartitionPortalIndices[partitionIndex])
+	{
+		const FPartitionPortal& portal = mPartitionPortals[portalIndex];
+		const int32 nextPartitionIndex = portal.PartitionIndices[0] == partitionIndex ? portal.PartitionIndices[1] : portal.PartitionIndices[0];
+		if (pathPartitions[nextPartitionIndex])
+			continue;
+
+		if (--remainingPortalVisits < 0)
+			return false;
+
+		const uint8 axis = portal.Axis;
+		const double planeCoordinate = portal.Bounds.Min[axis];
+		const uint8 axis1 = (axis + 1) % 3;
+		const uint8 axis2 = (axis + 2) % 3;
+		polygon.SetNum(4);
+		for (int32 i = 0; i < 4; ++i)
+		{
+			FVector& vertex = polygon[i];
+			vertex[axis] = planeCoordinate;
+			vertex[axis1] = (i == 1 || i == 2) ? portal.Bounds.Max[axis1] : portal.Bounds.Min[axis1];
+			vertex[axis2] = (i >= 2) ? portal.Bounds.Max[axis2] : portal.Bounds.Min[axis2];
+		}
+
+		for (const FPlane& clipPlane : clipPlanes)
+		{
+			ClipPortalPolygon(polygon, clipPlane, clippedPolygon);
+			Swap(polygon, clippedPolygon);
+			if (polygon.Num() < 3)
+				break;
+		}
+		if (polygon.Num() < 3)
+			continue;
+
+		const FBox polygonBounds(polygon.GetData(), polygon.Num());
+		if (ComputeSquaredDistanceBetweenBounds(sourceBounds, polygonBounds) > maximumVisibilityDistanceSquared)
+			continue;
+
+		row[nextPartitionIndex / 64] |= (1ull << (nextPartitionIndex % 64));
+
+		// 送信元がポータルの平面の片側にあれば奥側を、さらに送信元とポータルの分離平面の内側を次の視錐台にします
+		nextClipPlanes.Reset();
+		if (sourceBounds.Max[axis] <= planeCoordinate + PortalClipTolerance)
+		{
+			FVector portalNormal = FVector::ZeroVector;
+			portalNormal[axis] = 1.0;
+			nextClipPlanes.Emplace(polygon[0], portalNormal);
+		}
+		else if (sourceBounds.Min[axis] >= planeCoordinate - PortalClipTolerance)
+		{
+			FVector portalNormal = FVector::ZeroVector;
+			portalNormal[axis] = -1.0;
+			nextClipPlanes.Emplace(polygon[0], portalNormal);
+		}
+		AppendSeparatingPlanes(sourceBounds, polygon, nextClipPlanes);
+
+		pathPartitions[nextPartitionIndex] = true;
+		const bool completed = TraversePartitionPortals(sourceBounds, nextPartitionIndex, depth + 1, nextClipPlanes, pathPartitions, row, maximumVisibilityDistanceSquared, remainingPortalVisits);
+		pathPartitions[nextPartitionIndex] = false;
+		if (!completed)
+			return false;
+	}
+
+	return true;
 }
 
-bool ADungeonMainLevelScriptActor::IsPartitionLoadControlAvailable() const noexcept
+/*
+ * 同じシードとパラメータから生成されたダンジョンは同じ CRC32 になるので、
+ * 可視性の計算方法のバージョン、ダンジョンの CRC32 と配置、パーティションの寸法、可視性の設定からキーを作ります。
+ */
+uint32 ADungeonMainLevelScriptActor::ComputePartitionVisibilityCacheKey(const FPartitionBuildContext& context) const
 {
-	return bEnableLoadControl && bUsePrecomputedPartitionVisibility && HasPrecomputedPartitionVisibility();
+	uint32 key = 0;
+	auto append = [&key](const auto& value)
+	{
+		key = FCrc::MemCrc32(&value, sizeof(value), key);
+	};
+
+	append(PartitionVisibilityAlgorithmVersion);
+
+	for (const ADungeonGenerateActor* dungeonGenerateActor : context.DungeonGenerateActors)
+	{
+		append(dungeonGenerateActor->CalculateCRC32());
+		append(dungeonGenerateActor->GetActorLocation());
+	}
+	append(mBounding.Min);
+	append(mBounding.Max);
+	append(mPartitionGridCount);
+	append(mPartitionWorldSize);
+	append(mTheoreticalMaxVisibilityDistance);
+	append(PrecomputedVisibilityDilationHopCount);
+	append(bUsePortalPartitionVisibility);
+	return key;
 }
 
-void ADungeonMainLevelScriptActor::MarkPrecomputedPartitionVisibility(const int32 sourcePartitionIndex) const
+/*
+ * パーティションの並びが一致する場合だけキャッシュを採用します。
+ */
+bool ADungeonMainLevelScriptActor::LoadPartitionVisibilityCache(const FPartitionBuildContext& context, const uint32 cacheKey)
 {
-	if (!HasPrecomputedPartitionVisibility())
-		return;
-	if (!DungeonPartitions.IsValidIndex(sourcePartitionIndex))
-		return;
+	FDungeonPartitionVisibilityCache cache(cacheKey);
+	if (!cache.Load())
+		return false;
 
+	if (cache.PartitionCells.Num() != DungeonPartitions.Num())
+		return false;
 	for (int32 partitionIndex = 0; partitionIndex < DungeonPartitions.Num(); ++partitionIndex)
 	{
-		if (!IsPrecomputedPartitionVisible(sourcePartitionIndex, partitionIndex))
-			continue;
-		if (!DungeonPartitions.IsValidIndex(partitionIndex) || !IsValid(DungeonPartitions[partitionIndex]))
-			continue;
+		if (!IsValid(DungeonPartitions[partitionIndex]) || DungeonPartitions[partitionIndex]->GetCellCoordinate() != cache.PartitionCells[partitionIndex])
+			return false;
+	}
 
-		DungeonPartitions[partitionIndex]->Mark();
+	bool validRows = true;
+	for (const FDungeonPartitionVisibilityRow& row : cache.PotentialVisibilityRows)
+	{
+		row.ForEach([this, &validRows](const int32 partitionIndex)
+			{
+				validRows &= DungeonPartitions.IsValidIndex(partitionIndex);
+			}
+		);
+	}
+	if (!validRows)
+		return false;
+
+	mPartitionVisibilitySamples.Reset();
+	mPartitionVisibilitySamples.SetNum(DungeonPartitions.Num());
+	for (int32 partitionIndex = 0; partitionIndex < DungeonPartitions.Num(); ++partitionIndex)
+	{
+		for (const FDungeonPartitionVisibilityCache::FSample& cachedSample : cache.PartitionSamples[partitionIndex])
+		{
+			if (!context.DungeonGenerateActors.IsValidIndex(cachedSample.ActorIndex))
+				continue;
+
+			FPartitionVisibilitySample& sample = mPartitionVisibilitySamples[partitionIndex].AddDefaulted_GetRef();
+			sample.DungeonGenerateActor = context.DungeonGenerateActors[cachedSample.ActorIndex];
+			sample.GridLocation = cachedSample.GridLocation;
+			sample.WorldLocation = cachedSample.WorldLocation;
+		}
 	}
+
+	mPartitionPotentialVisibilityRows = MoveTemp(cache.PotentialVisibilityRows);
+	DUNGEON_GENERATOR_LOG(TEXT("Loaded partition visibility cache '%s'"), *cache.GetPath());
+	return true;
+}
+
+void ADungeonMainLevelScriptActor::SavePartitionVisibilityCache(const FPartitionBuildContext& context, const uint32 cacheKey) const
+{
+	if (mPartitionPotentialVisibilityRows.Num() != DungeonPartitions.Num() || mPartitionVisibilitySamples.Num() != DungeonPartitions.Num())
+		return;
+
+	FDungeonPartitionVisibilityCache cache(cacheKey);
+	cache.PartitionCells.Reserve(DungeonPartitions.Num());
+	cache.PartitionSamples.SetNum(DungeonPartitions.Num());
+	for (int32 partitionIndex = 0; partitionIndex < DungeonPartitions.Num(); ++partitionIndex)
+	{
+		const UDungeonPartition* partition = DungeonPartitions[partitionIndex];
+		cache.PartitionCells.Add(IsValid(partition) ? partition->GetCellCoordinate() : FIntVector::ZeroValue);
+		for (const FPartitionVisibilitySample& sample : mPartitionVisibilitySamples[partitionIndex])
+		{
+			FDungeonPartitionVisibilityCache::FSample& cachedSample = cache.PartitionSamples[partitionIndex].AddDefaulted_GetRef();
+			cachedSample.ActorIndex = context.DungeonGenerateActors.IndexOfByKey(sample.DungeonGenerateActor);
+			cachedSample.GridLocation = sample.GridLocation;
+			cachedSample.WorldLocation = sample.WorldLocation;
+		}
+	}
+	cache.PotentialVisibilityRows = mPartitionPotentialVisibilityRows;
+	cache.Save();
+}
+
+bool ADungeonMainLevelScriptActor::HasPrecomputedPartitionVisibility() const noexcept
+{
+	return
+		mPartitionVisibilitySamples.Num() == DungeonPartitions.Num() &&
+		mPartitionPotentialVisibilityRows.Num() == DungeonPartitions.Num() &&
+		mPartitionConnectedComponents.Num() == DungeonPartitions.Num() &&
+		DungeonPartitions.IsEmpty() == false;
+}
+
+bool ADungeonMainLevelScriptActor::IsPartitionLoadControlAvailable() const noexcept
+{
+	return bEnableLoadControl && bUsePrecomputedPartitionVisibility && HasPrecomputedPartitionVisibility();
 }
 
 bool ADungeonMainLevelScriptActor::IsPrecomputedPartitionVisible(const int32 sourcePartitionIndex, const int32 targetPartitionIndex) const noexcept
 {
-	if (!mPartitionPotentialVisibilityMasks.IsValidIndex(sourcePartitionIndex))
+	if (!mPartitionPotentialVisibilityRows.IsValidIndex(sourcePartitionIndex))
 		return false;
 	if (!DungeonPartitions.IsValidIndex(targetPartitionIndex))
 		return false;
 
-	const TArray<uint64>& row = mPartitionPotentialVisibilityMasks[sourcePartitionIndex];
-	const int32 wordIndex = targetPartitionIndex / 64;
-	if (!row.IsValidIndex(wordIndex))
-		return false;
-
-	return (row[wordIndex] & (1ull << (targetPartitionIndex % 64))) != 0;
+	return mPartitionPotentialVisibilityRows[sourcePartitionIndex].Contains(targetPartitionIndex);
 }
 
 bool ADungeonMainLevelScriptActor::IsPartitionPairPotentiallyVisible(const int32 sourcePartitionIndex, const int32 targetPartitionIndex) const
@@ -1150,8 +1856,6 @@ bool ADungeonMainLevelScriptActor::TracePartitionVisibility(const FPartitionVisi
 		return false;
 	if (dungeonGenerateActor != targetSample.DungeonGenerateActor)
 		return false;
-	if (!IsValid(dungeonGenerateActor->mParameter))
-		return false;
 
 	const std::shared_ptr<const dungeon::Generator> generator = dungeonGenerateActor->GetGenerator();
 	if (generator == nullptr)
@@ -1160,112 +1864,9 @@ bool ADungeonMainLevelScriptActor::TracePartitionVisibility(const FPartitionVisi
 	const auto& voxel = generator->GetVoxel();
 	if (voxel == nullptr)
 		return false;
-	if (!voxel->Contain(sourceSample.GridLocation) || !voxel->Contain(targetSample.GridLocation))
-		return false;
-
-	auto isTransitionOpen = [voxel](const FIntVector& fromCell, const FIntVector& toCell)
-	{
-		if (!voxel->Contain(fromCell) || !voxel->Contain(toCell))
-			return false;
-
-		const dungeon::Grid& fromGrid = voxel->Get(fromCell);
-		const dungeon::Grid& toGrid = voxel->Get(toCell);
-		if (!IsTraversableGrid(fromGrid) || !IsTraversableGrid(toGrid))
-			return false;
-
-		const FIntVector delta = toCell - fromCell;
-		if (delta == FIntVector(1, 0, 0))
-			return !fromGrid.HasEastWall() && !toGrid.HasWestWall();
-		if (delta == FIntVector(-1, 0, 0))
-			return !fromGrid.HasWestWall() && !toGrid.HasEastWall();
-		if (delta == FIntVector(0, 1, 0))
-			return !fromGrid.HasSouthWall() && !toGrid.HasNorthWall();
-		if (delta == FIntVector(0, -1, 0))
-			return !fromGrid.HasNorthWall() && !toGrid.HasSouthWall();
-		if (delta == FIntVector(0, 0, 1))
-			return !fromGrid.HasCeiling() && !toGrid.HasFloor();
-		if (delta == FIntVector(0, 0, -1))
-			return !fromGrid.HasFloor() && !toGrid.HasCeiling();
-
-		return false;
-	};
-
-	auto canTraverseDelta = [&isTransitionOpen](const FIntVector& startCell, const FIntVector& targetCell)
-	{
-		const FIntVector delta = targetCell - startCell;
-		if (FMath::Abs(delta.X) > 1 || FMath::Abs(delta.Y) > 1 || FMath::Abs(delta.Z) > 1)
-			return false;
-
-		const int32 manhattanDistance = FMath::Abs(delta.X) + FMath::Abs(delta.Y) + FMath::Abs(delta.Z);
-		if (manhattanDistance == 0)
-			return true;
-		if (manhattanDistance == 1)
-			return isTransitionOpen(startCell, targetCell);
-
-		std::array<FIntVector, 3> axisSteps = {
-			FIntVector::ZeroValue,
-			FIntVector::ZeroValue,
-			FIntVector::ZeroValue
-		};
-		int32 axisCount = 0;
-		if (delta.X != 0)
-			axisSteps[axisCount++] = FIntVector(delta.X > 0 ? 1 : -1, 0, 0);
-		if (delta.Y != 0)
-			axisSteps[axisCount++] = FIntVector(0, delta.Y > 0 ? 1 : -1, 0);
-		if (delta.Z != 0)
-			axisSteps[axisCount++] = FIntVector(0, 0, delta.Z > 0 ? 1 : -1);
-
-		const uint8 completeMask = static_cast<uint8>((1u << axisCount) - 1u);
-		std::function<bool(const FIntVector&, uint8)> traverse = [&](const FIntVector& currentCell, const uint8 usedMask)
-		{
-			if (usedMask == completeMask)
-				return true;
 
-			for (int32 axisIndex = 0; axisIndex < axisCount; ++axisIndex)
-			{
-				const uint8 axisMask = static_cast<uint8>(1u << axisIndex);
-				if ((usedMask & axisMask) != 0)
-					continue;
-
-				const FIntVector nextCell = currentCell + axisSteps[axisIndex];
-				if (!isTransitionOpen(currentCell, nextCell))
-					continue;
-				if (traverse(nextCell, static_cast<uint8>(usedMask | axisMask)))
-					return true;
-			}
-
-			return false;
-		};
-
-		return traverse(startCell, 0u);
-	};
-
-	const FVector gridSize = dungeonGenerateActor->mParameter->GetGridSize().To3D();
-	const double minimumGridSize = FMath::Max(1.0, static_cast<double>(FMath::Min3(gridSize.X, gridSize.Y, gridSize.Z)));
-	const FVector deltaWorld = targetSample.WorldLocation - sourceSample.WorldLocation;
-	const double distance = deltaWorld.Size();
-	if (distance <= KINDA_SMALL_NUMBER)
-		return true;
-
-	const double stepDistance = FMath::Max(minimumGridSize * 0.25, 1.0);
-	const int32 stepCount = FMath::Max(1, FMath::CeilToInt(distance / stepDistance));
-	const FVector actorLocation = dungeonGenerateActor->GetActorLocation();
-
-	FIntVector currentCell = sourceSample.GridLocation;
-	for (int32 stepIndex = 1; stepIndex <= stepCount; ++stepIndex)
-	{
-		const float alpha = static_cast<float>(stepIndex) / static_cast<float>(stepCount);
-		const FVector worldLocation = FMath::Lerp(sourceSample.WorldLocation, targetSample.WorldLocation, alpha);
-		const FIntVector nextCell = dungeonGenerateActor->mParameter->ToGrid(worldLocation - actorLocation);
-		if (!voxel->Contain(nextCell))
-			return false;
-		if (!canTraverseDelta(currentCell, nextCell))
-			return false;
-
-		currentCell = nextCell;
-	}
-
-	return canTraverseDelta(currentCell, targetSample.GridLocation);
+	// グリッド中心同士を結ぶ線分が通過するグリッドを一度ずつ調べる
+	return voxel->TraceVisibility(sourceSample.GridLocation, targetSample.GridLocation);
 }
 
 #if 1
@@ -1358,42 +1959,123 @@ FInt32Interval ADungeonMainLevelScriptActor::ComputeTerrainCullingDistanceRange(
 }
 #endif
 
-void ADungeonMainLevelScriptActor::Begin() const
+void ADungeonMainLevelScriptActor::Begin()
 {
-	for (UDungeonPartition* partition : DungeonPartitions)
+	++mViewerFrame;
+}
+
+/*
+ * プレイヤーが操作するポーンに加えて、ポーンを持たない観戦者などは視点の位置を使います。
+ * 分割画面のローカルプレイヤーやサーバー上のリモートプレイヤーもそれぞれ視点として扱います。
+ */
+void ADungeonMainLevelScriptActor::MarkPlayerViewers(const UWorld& world)
+{
+	for (FConstPlayerControllerIterator iterator = world.GetPlayerControllerIterator(); iterator; ++iterator)
 	{
-		check(IsValid(partition));
-		partition->Unmark();
+		const APlayerController* playerController = iterator->Get();
+		if (!IsValid(playerController))
+			continue;
+
+		const APawn* playerPawn = playerController->GetPawn();
+		if (IsValid(playerPawn) && playerPawn->IsPlayerControlled())
+		{
+			// プレイヤー周辺をマークする
+			Mark(playerController->GetUniqueID(), playerPawn->GetActorLocation(), playerPawn->GetVelocity());
+		}
+		else if (playerController->PlayerCameraManager != nullptr)
+		{
+			FVector viewLocation;
+			FRotator viewRotation;
+			playerController->GetPlayerViewPoint(viewLocation, viewRotation);
+			Mark(playerController->GetUniqueID(), viewLocation);
+		}
 	}
 }
 
-void ADungeonMainLevelScriptActor::Mark(const FVector& playerLocation) const
+/*
+ * 視点が別のパーティションへ移動した時だけ、可視集合の差分を参照数に反映します
+ */
+void ADungeonMainLevelScriptActor::Mark(const uint32 viewerId, const FVector& viewLocation, const FVector& viewVelocity)
 {
 	if (!IsPartitionLoadControlAvailable())
 		return;
 
-	// mBounding.Minを原点にした座標系に変換
-	const int32 startPartitionIndex = FindPartitionIndex(playerLocation);
-	if (!DungeonPartitions.IsValidIndex(startPartitionIndex))
-		return;
+	const int32 sourcePartitionIndex = FindPartitionIndex(viewLocation);
+	FPartitionViewer& viewer = mPartitionViewers.FindOrAdd(viewerId);
+	viewer.Location = viewLocation;
+	viewer.Frame = mViewerFrame;
+	if (viewer.PartitionIndex != sourcePartitionIndex)
+	{
+		ChangeViewerPartition(viewer.PartitionIndex, sourcePartitionIndex);
+		viewer.PartitionIndex = sourcePartitionIndex;
+	}
 
-	MarkPrecomputedPartitionVisibility(startPartitionIndex);
+	// 予測したパーティションが変わった時だけ先読みを登録します
+	if (bEnablePartitionPrefetch)
+	{
+		const int32 predictedPartitionIndex = PredictViewerPartition(sourcePartitionIndex, viewLocation, viewVelocity);
+		if (viewer.PredictedPartitionIndex != predictedPartitionIndex)
+		{
+			viewer.PredictedPartitionIndex = predictedPartitionIndex;
+			if (predictedPartitionIndex != sourcePartitionIndex)
+				EnqueuePartitionPrefetch(predictedPartitionIndex);
+		}
+	}
 }
 
 void ADungeonMainLevelScriptActor::End(const float deltaSeconds)
 {
-	if (mDesiredPartitionActivation.Num() != DungeonPartitions.Num() || mQueuedPartitionTransitions.Num() != DungeonPartitions.Num())
+	if (mDesiredPartitionActivation.Num() != DungeonPartitions.Num())
 	{
 		ResetPartitionTransitionQueue();
 	}
 
-	for (int32 partitionIndex = 0; partitionIndex < DungeonPartitions.Num(); ++partitionIndex)
+	// このフレームでMarkされなかった視点を取り除きます
+	for (auto iterator = mPartitionViewers.CreateIterator(); iterator; ++iterator)
+	{
+		if (iterator->Value.Frame != mViewerFrame)
+		{
+			ChangeViewerPartition(iterator->Value.PartitionIndex, INDEX_NONE);
+			iterator.RemoveCurrent();
+		}
+	}
+
+	// 参照数が0をまたいだパーティションと、非アクティブ化を待っているパーティションだけを更新します。
+	// それ以外のパーティションは状態が変化しません。
+	TArray<int32>& updatePartitionIndices = mPartitionUpdateIndices;
+	updatePartitionIndices.Reset();
+	if (mPartitionUpdateRequiresFullScan)
+	{
+		ResetPendingRegisteredPartitions();
+		for (int32 partitionIndex = 0; partitionIndex < DungeonPartitions.Num(); ++partitionIndex)
+		{
+			check(IsValid(DungeonPartitions[partitionIndex]));
+			DungeonPartitions[partitionIndex]->FlushRegisteredComponents();
+			updatePartitionIndices.Add(partitionIndex);
+		}
+		mPartitionUpdateRequiresFullScan = false;
+	}
+	else
+	{
+		FlushPendingRegisteredPartitions();
+		updatePartitionIndices.Append(mChangedPartitionIndices);
+		for (const int32 partitionIndex : mInactivatingPartitionIndices)
+		{
+			if (!mScheduledPartitionUpdates[partitionIndex])
+				updatePartitionIndices.Add(partitionIndex);
+		}
+	}
+
+	for (const int32 partitionIndex : mChangedPartitionIndices)
+		mScheduledPartitionUpdates[partitionIndex] = false;
+	mChangedPartitionIndices.Reset();
+	mInactivatingPartitionIndices.Reset();
+
+	for (const int32 partitionIndex : updatePartitionIndices)
 	{
 		UDungeonPartition* partition = DungeonPartitions[partitionIndex];
 		check(IsValid(partition));
 
-		partition->FlushRegisteredComponents();
-
 		bool desiredActive;
 		if (partition->IsMarked())
 		{
@@ -1403,6 +2085,8 @@ void ADungeonMainLevelScriptActor::End(const float deltaSeconds)
 		else
 		{
 			desiredActive = partition->UpdatePartitionInactivateRemainTimer(deltaSeconds);
+			if (desiredActive)
+				mInactivatingPartitionIndices.Add(partitionIndex);
 		}
 
 		mDesiredPartitionActivation[partitionIndex] = desiredActive ? 1 : 0;
@@ -1413,6 +2097,253 @@ void ADungeonMainLevelScriptActor::End(const float deltaSeconds)
 	ProcessPartitionTransitionQueue();
 }
 
+/*
+ * 通路の両端のゲートと、接続している部屋の床の中心があるパーティションを結びます。
+ * 部屋から通路へ、通路から反対側の部屋へと予測を進めるために使います。
+ */
+void ADungeonMainLevelScriptActor::BuildPartitionAisleLinks(const TArray<ADungeonGenerateActor*>& dungeonGenerateActors)
+{
+	mPartitionAisleLinks.Reset();
+	mPartitionAisleLinks.SetNum(DungeonPartitions.Num());
+
+	auto link = [this](const int32 partitionIndex0, const int32 partitionIndex1)
+	{
+		if (partitionIndex0 == partitionIndex1 || !mPartitionAisleLinks.IsValidIndex(partitionIndex0) || !mPartitionAisleLinks.IsValidIndex(partitionIndex1))
+			return;
+		mPartitionAisleLinks[partitionIndex0].AddUnique(partitionIndex1);
+		mPartitionAisleLinks[partitionIndex1].AddUnique(partitionIndex0);
+	};
+
+	for (const ADungeonGenerateActor* dungeonGenerateActor : dungeonGenerateActors)
+	{
+		if (!IsValid(dungeonGenerateActor) || !IsValid(dungeonGenerateActor->mParameter))
+			continue;
+
+		const std::shared_ptr<const dungeon::Generator> generator = dungeonGenerateActor->GetGenerator();
+		if (generator == nullptr)
+			continue;
+
+		const FVector gridSize = dungeonGenerateActor->mParameter->GetGridSize().To3D();
+		const FVector offset = dungeonGenerateActor->GetActorLocation() + FVector(gridSize.X * 0.5, gridSize.Y * 0.5, gridSize.Z * 0.5);
+		generator->EachAisle([this, &link, &gridSize, &offset](const dungeon::Aisle& aisle)
+			{
+				int32 gatePartitionIndices[2];
+				for (size_t i = 0; i < 2; ++i)
+				{
+					const std::shared_ptr<const dungeon::Point>& point = aisle.GetPoint(i);
+					gatePartitionIndices[i] = FindPartitionIndex(FVector(*point) * gridSize + offset);
+					if (const std::shared_ptr<dungeon::Room>& room = point->GetOwnerRoom())
+						link(FindPartitionIndex(FVector(room->GetGroundCenter()) * gridSize + offset), gatePartitionIndices[i]);
+				}
+				link(gatePartitionIndices[0], gatePartitionIndices[1]);
+				return true;
+			}
+		);
+	}
+}
+
+/*
+ * 速度の方向へ隣接しているパーティションを辿り、残った距離で通路の接続を辿ります。
+ * 壁の向こうのパーティションへ予測が飛ばないように、隣接していないパーティションでは止まります。
+ */
+int32 ADungeonMainLevelScriptActor::PredictViewerPartition(const int32 partitionIndex, const FVector& viewLocation, const FVector& viewVelocity) const
+{
+	if (!DungeonPartitions.IsValidIndex(partitionIndex))
+		return INDEX_NONE;
+
+	const FVector reach = viewVelocity * FMath::Max(PartitionPrefetchSeconds, 0.f);
+	const double reachLength = reach.Size();
+	const double stepLength = mPartitionWorldSize.GetMin() * 0.5;
+	if (reachLength <= UE_KINDA_SMALL_NUMBER || stepLength <= UE_KINDA_SMALL_NUMBER)
+		return partitionIndex;
+
+	constexpr int32 MaxPredictionSteps = 32;
+	const int32 stepCount = FMath::Clamp(FMath::CeilToInt32(reachLength / stepLength), 1, MaxPredictionSteps);
+	int32 predictedPartitionIndex = partitionIndex;
+	double travelledLength = 0.0;
+	for (int32 step = 1; step <= stepCount; ++step)
+	{
+		const double ratio = static_cast<double>(step) / stepCount;
+		const int32 nextPartitionIndex = FindPartitionIndex(viewLocation + reach * ratio);
+		if (nextPartitionIndex == predictedPartitionIndex)
+		{
+			travelledLength = reachLength * ratio;
+			continue;
+		}
+		if (!DungeonPartitions.IsValidIndex(nextPartitionIndex) || !DungeonPartitions[predictedPartitionIndex]->GetNeighborIndices().Contains(nextPartitionIndex))
+			break;
+
+		predictedPartitionIndex = nextPartitionIndex;
+		travelledLength = reachLength * ratio;
+	}
+
+	// 進行方向に向かう通路の接続があれば、残った距離の範囲で辿ります
+	if (mPartitionAisleLinks.IsValidIndex(predictedPartitionIndex))
+	{
+		const FVector direction = reach / reachLength;
+		const FVector origin = DungeonPartitions[predictedPartitionIndex]->GetBounds().GetCenter();
+		const double remainingLength = reachLength - travelledLength;
+		double bestAlignment = 0.7;
+		int32 bestPartitionIndex = INDEX_NONE;
+		for (const int32 linkedPartitionIndex : mPartitionAisleLinks[predictedPartitionIndex])
+		{
+			const FVector toLinked = DungeonPartitions[linkedPartitionIndex]->GetBounds().GetCenter() - origin;
+			const double distance = toLinked.Size();
+			if (distance <= UE_KINDA_SMALL_NUMBER || distance > remainingLength)
+				continue;
+
+			const double alignment = FVector::DotProduct(toLinked / distance, direction);
+			if (alignment > bestAlignment)
+			{
+				bestAlignment = alignment;
+				bestPartitionIndex = linkedPartitionIndex;
+			}
+		}
+		if (bestPartitionIndex != INDEX_NONE)
+			predictedPartitionIndex = bestPartitionIndex;
+	}
+
+	return predictedPartitionIndex;
+}
+
+/*
+ * 予測したパーティションから見えるパーティションのうち、まだ誰にも見られていないものを先読みに登録します
+ */
+void ADungeonMainLevelScriptActor::EnqueuePartitionPrefetch(const int32 sourcePartitionIndex)
+{
+	if (!mPartitionPotentialVisibilityRows.IsValidIndex(sourcePartitionIndex))
+		return;
+
+	mPartitionPotentialVisibilityRows[sourcePartitionIndex].ForEach([this](const int32 partitionIndex)
+		{
+			if (!mQueuedPartitionPrefetches.IsValidIndex(partitionIndex) || mQueuedPartitionPrefetches[partitionIndex])
+				return;
+			if (mPartitionViewerCounts[partitionIndex] > 0 || !IsValid(DungeonPartitions[partitionIndex]) || DungeonPartitions[partitionIndex]->IsPartitionActivate())
+				return;
+
+			mQueuedPartitionPrefetches[partitionIndex] = true;
+			mPendingPartitionPrefetches.Add(partitionIndex);
+		}
+	);
+}
+
+/*
+ * 新しい予測ほど当たりやすいので、後から登録したものから処理します。
+ * 先読みしたパーティションは非アクティブ化の待ち時間を設定するので、見られなければ非アクティブ化されます。
+ */
+void ADungeonMainLevelScriptActor::ProcessPartitionPrefetchQueue(int32& remainingActivations, double& spentMilliseconds)
+{
+	while (remainingActivations > 0 && !mPendingPartitionPrefetches.IsEmpty())
+	{
+		const int32 partitionIndex = mPendingPartitionPrefetches.Last();
+		UDungeonPartition* partition = DungeonPartitions[partitionIndex];
+		const bool skip = !IsValid(partition) || partition->IsPartitionActivate() || mPendingPartitionActivations.Contains(partitionIndex);
+
+		// 先読みは最も優先度が低いので、予算が残っている時だけ処理します
+		if (!skip && PartitionTransitionBudgetMilliseconds > 0.f && spentMilliseconds + mPartitionActivationCost.Estimate(partition->GetActivatorComponentCount()) > PartitionTransitionBudgetMilliseconds)
+			break;
+
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+		mPendingPartitionPrefetches.Pop(EAllowShrinking::No);
+#else
+		mPendingPartitionPrefetches.Pop(false);
+#endif
+		mQueuedPartitionPrefetches[partitionIndex] = false;
+		if (skip)
+			continue;
+
+		const int32 componentCount = partition->GetActivatorComponentCount();
+		const uint64 startCycles = FPlatformTime::Cycles64();
+		partition->CallPartitionActivate(true);
+		const double milliseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - startCycles);
+		mPartitionActivationCost.Measure(componentCount, milliseconds);
+		spentMilliseconds += milliseconds;
+		mDesiredPartitionActivation[partitionIndex] = 1;
+		SchedulePartitionUpdate(partitionIndex);
+		--remainingActivations;
+		++mPartitionActivationCount;
+		++mPartitionPrefetchCount;
+	}
+}
+
+/*
+ * 視点の数は送信元のパーティションごとに数えるので、同じパーティションに複数の視点がいても行は一度だけ反映されます。
+ * 送信元の視点数が0をまたいだ時だけ、移動前と移動後の行の排他的論理和に含まれるパーティションの参照数を更新します。
+ */
+void ADungeonMainLevelScriptActor::ChangeViewerPartition(const int32 oldSourcePartitionIndex, const int32 newSourcePartitionIndex)
+{
+	// 待っている切り替えの優先度は視点の位置で決まるので、次の処理で更新します
+	mPartitionTransitionPrioritiesDirty = true;
+
+	int32 releasedSourcePartitionIndex = INDEX_NONE;
+	if (mSourcePartitionViewerCounts.IsValidIndex(oldSourcePartitionIndex) && mSourcePartitionViewerCounts[oldSourcePartitionIndex] > 0)
+	{
+		if (--mSourcePartitionViewerCounts[oldSourcePartitionIndex] == 0)
+			releasedSourcePartitionIndex = oldSourcePartitionIndex;
+	}
+
+	int32 acquiredSourcePartitionIndex = INDEX_NONE;
+	if (mSourcePartitionViewerCounts.IsValidIndex(newSourcePartitionIndex))
+	{
+		if (mSourcePartitionViewerCounts[newSourcePartitionIndex]++ == 0)
+			acquiredSourcePartitionIndex = newSourcePartitionIndex;
+	}
+
+	if (releasedSourcePartitionIndex == acquiredSourcePartitionIndex)
+		return;
+
+	static const FDungeonPartitionVisibilityRow emptyRow;
+	const FDungeonPartitionVisibilityRow& oldRow = mPartitionPotentialVisibilityRows.IsValidIndex(releasedSourcePartitionIndex) ? mPartitionPotentialVisibilityRows[releasedSourcePartitionIndex] : emptyRow;
+	const FDungeonPartitionVisibilityRow& newRow = mPartitionPotentialVisibilityRows.IsValidIndex(acquiredSourcePartitionIndex) ? mPartitionPotentialVisibilityRows[acquiredSourcePartitionIndex] : emptyRow;
+	FDungeonPartitionVisibilityRow::ForEachDifference(oldRow, newRow,
+		[this](const int32 partitionIndex)
+		{
+			RemovePartitionViewerReference(partitionIndex);
+		},
+		[this](const int32 partitionIndex)
+		{
+			AddPartitionViewerReference(partitionIndex);
+		}
+	);
+}
+
+void ADungeonMainLevelScriptActor::AddPartitionViewerReference(const int32 partitionIndex)
+{
+	if (!mPartitionViewerCounts.IsValidIndex(partitionIndex) || !IsValid(DungeonPartitions[partitionIndex]))
+		return;
+
+	if (mPartitionViewerCounts[partitionIndex]++ == 0)
+	{
+		DungeonPartitions[partitionIndex]->Mark();
+		SchedulePartitionUpdate(partitionIndex);
+		AddShadowCastingPartition(partitionIndex);
+	}
+}
+
+void ADungeonMainLevelScriptActor::RemovePartitionViewerReference(const int32 partitionIndex)
+{
+	if (!mPartitionViewerCounts.IsValidIndex(partitionIndex) || !IsValid(DungeonPartitions[partitionIndex]))
+		return;
+	if (mPartitionViewerCounts[partitionIndex] <= 0)
+		return;
+
+	if (--mPartitionViewerCounts[partitionIndex] == 0)
+	{
+		DungeonPartitions[partitionIndex]->Unmark();
+		SchedulePartitionUpdate(partitionIndex);
+		RemoveShadowCastingPartition(partitionIndex);
+	}
+}
+
+void ADungeonMainLevelScriptActor::SchedulePartitionUpdate(const int32 partitionIndex)
+{
+	if (!mScheduledPartitionUpdates.IsValidIndex(partitionIndex) || mScheduledPartitionUpdates[partitionIndex])
+		return;
+
+	mScheduledPartitionUpdates[partitionIndex] = true;
+	mChangedPartitionIndices.Add(partitionIndex);
+}
+
 void ADungeonMainLevelScriptActor::ForceActivate()
 {
 	ResetPartitionTransitionQueue();
@@ -1435,6 +2366,79 @@ void ADungeonMainLevelScriptActor::ForceInactivate()
 	ResetPartitionTransitionQueue();
 }
 
+SIZE_T ADungeonMainLevelScriptActor::GetAllocatedSize() const
+{
+	// UDungeonPartitionは別のオブジェクトとして集計されるので配列だけを数えます
+	SIZE_T size = DungeonPartitions.GetAllocatedSize();
+	size += mPartitionIndexByCell.GetAllocatedSize();
+	size += mPartitionVisibilitySamples.GetAllocatedSize();
+	for (const auto& samples : mPartitionVisibilitySamples)
+		size += samples.GetAllocatedSize();
+	size += mPartitionPotentialVisibilityRows.GetAllocatedSize();
+	for (const auto& row : mPartitionPotentialVisibilityRows)
+		size += row.GetAllocatedSize();
+	size += mPartitionConnectedComponents.GetAllocatedSize();
+	size += mDesiredPartitionActivation.GetAllocatedSize();
+	size += mPendingPartitionActivations.GetAllocatedSize();
+	size += mPendingPartitionInactivations.GetAllocatedSize();
+	size += mPartitionViewers.GetAllocatedSize();
+	size += mSourcePartitionViewerCounts.GetAllocatedSize();
+	size += mPartitionViewerCounts.GetAllocatedSize();
+	size += mChangedPartitionIndices.GetAllocatedSize();
+	size += mInactivatingPartitionIndices.GetAllocatedSize();
+	size += mPartitionUpdateIndices.GetAllocatedSize();
+	size += mScheduledPartitionUpdates.GetAllocatedSize();
+	size += mPartitionAisleLinks.GetAllocatedSize();
+	for (const auto& links : mPartitionAisleLinks)
+		size += links.GetAllocatedSize();
+	size += mPendingPartitionPrefetches.GetAllocatedSize();
+	size += mQueuedPartitionPrefetches.GetAllocatedSize();
+	size += mShadowCastingPartitionIndices.GetAllocatedSize();
+	size += mShadowCastingPartitionPositions.GetAllocatedSize();
+	size += mShadowReleasedPartitionIndices.GetAllocatedSize();
+	size += mShadowCastingLightCandidates.GetAllocatedSize();
+	size += mMovableActivatorComponents.GetAllocatedSize();
+	size += mMovableActivatorLocations.GetAllocatedSize();
+	size += mMovableActivatorPartitionIndices.GetAllocatedSize();
+	size += mMovedActivatorIndices.GetAllocatedSize();
+	return size;
+}
+
+void ADungeonMainLevelScriptActor::ReportAllocatedSize(FOutputDevice& outputDevice) const
+{
+	const auto toKiB = [](const SIZE_T size) { return static_cast<double>(size) / 1024.0; };
+
+	SIZE_T partitionSize = DungeonPartitions.GetAllocatedSize();
+	for (const UDungeonPartition* partition : DungeonPartitions)
+	{
+		if (IsValid(partition))
+			partitionSize += partition->GetAllocatedSize();
+	}
+	SIZE_T visibilitySampleSize = mPartitionVisibilitySamples.GetAllocatedSize();
+	for (const auto& samples : mPartitionVisibilitySamples)
+		visibilitySampleSize += samples.GetAllocatedSize();
+	SIZE_T visibilityMaskSize = mPartitionPotentialVisibilityRows.GetAllocatedSize();
+	int32 sparseRowCount = 0;
+	for (const auto& row : mPartitionPotentialVisibilityRows)
+	{
+		visibilityMaskSize += row.GetAllocatedSize();
+		if (row.IsSparse())
+			++sparseRowCount;
+	}
+
+	outputDevice.Logf(TEXT("%s: %.2f KiB"), *GetName(), toKiB(GetAllocatedSize()));
+	outputDevice.Logf(TEXT("  Partitions        : %.2f KiB (%d separate objects)"), toKiB(partitionSize), DungeonPartitions.Num());
+	outputDevice.Logf(TEXT("  PartitionIndex    : %.2f KiB"), toKiB(mPartitionIndexByCell.GetAllocatedSize()));
+	outputDevice.Logf(TEXT("  VisibilitySamples : %.2f KiB"), toKiB(visibilitySampleSize));
+	outputDevice.Logf(TEXT("  VisibilityMasks   : %.2f KiB (%d/%d sparse rows)"), toKiB(visibilityMaskSize), sparseRowCount, mPartitionPotentialVisibilityRows.Num());
+}
+
+void ADungeonMainLevelScriptActor::GetResourceSizeEx(FResourceSizeEx& cumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(cumulativeResourceSize);
+	cumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetAllocatedSize());
+}
+
 bool ADungeonMainLevelScriptActor::IsEnableLoadControl() const noexcept
 {
 	return IsPartitionLoadControlAvailable();
@@ -1451,82 +2455,148 @@ void ADungeonMainLevelScriptActor::UpdateShadowCastingPointAndSpotLights()
 	if (!IsValid(playerController))
 		return;
 
-	// ポイントライト継承クラスを回収するコンテナ
-	using PointLightPair = std::pair<float, UPointLightComponent*>;
-	std::vector<PointLightPair> pointLightComponents;
-
 	// カメラの位置と向きを取得
 	FVector cameraLocation;
 	FRotator cameraRotation;
 	playerController->GetPlayerViewPoint(cameraLocation, cameraRotation);
-	const FVector cameraDirection = cameraRotation.Vector();
+	UpdateShadowCastingPointAndSpotLights(cameraLocation, cameraRotation.Vector());
+}
 
-	// 有効な全てのパーティエーションを調べる
-	for (UDungeonPartition* partition : DungeonPartitions)
+/*
+ * 影を落とす候補は視点から見えているパーティションのライトだけで、上位だけを部分的に選びます。
+ * 影を落としているライトは近くにあるものとして評価し、状態が変わるライトだけSetCastShadowsを呼びます。
+ */
+void ADungeonMainLevelScriptActor::UpdateShadowCastingPointAndSpotLights(const FVector& cameraLocation, const FVector& cameraDirection)
+{
+	auto disableShadows = [](const UDungeonPartition* partition)
 	{
-		check(IsValid(partition));
+		partition->EachDungeonComponentActivatorComponent([](const UDungeonComponentActivatorComponent* dungeonComponentActivatorComponent)
+			{
+				dungeonComponentActivatorComponent->EachControlledLightCastShadow([](UPointLightComponent* pointLightComponent)
+					{
+						// 強制的に影を落とさない
+						if (pointLightComponent->CastShadows)
+							pointLightComponent->SetCastShadows(false);
+					}
+				);
+			}
+		);
+	};
 
-		if (!partition->IsMarked())
+	// 見えなくなったパーティションのライトの影を消す
+	if (mShadowCastingRequiresFullScan)
+	{
+		for (const UDungeonPartition* partition : DungeonPartitions)
 		{
-			partition->EachDungeonComponentActivatorComponent([](const UDungeonComponentActivatorComponent* dungeonComponentActivatorComponent)
-				{
-					dungeonComponentActivatorComponent->EachControlledLightCastShadow([](UPointLightComponent* pointLightComponent)
-						{
-							// 強制的に影を落とさない
-							pointLightComponent->SetCastShadows(false);
-						}
-					);
-				}
-			);
+			check(IsValid(partition));
+			if (!partition->IsMarked())
+				disableShadows(partition);
 		}
-		else
+		mShadowCastingRequiresFullScan = false;
+	}
+	else
+	{
+		for (const int32 partitionIndex : mShadowReleasedPartitionIndices)
 		{
-			partition->EachDungeonComponentActivatorComponent([&pointLightComponents, &cameraLocation, &cameraDirection](const UDungeonComponentActivatorComponent* dungeonComponentActivatorComponent)
-				{
-					dungeonComponentActivatorComponent->EachControlledLightCastShadow([&pointLightComponents, &cameraLocation, &cameraDirection](UPointLightComponent* pointLightComponent)
+			const UDungeonPartition* partition = DungeonPartitions[partitionIndex];
+			if (IsValid(partition) && !partition->IsMarked())
+				disableShadows(partition);
+		}
+	}
+	mShadowReleasedPartitionIndices.Reset();
+
+	// 見えているパーティションのライトを回収する
+	TArray<FShadowCastingLightCandidate>& candidates = mShadowCastingLightCandidates;
+	candidates.Reset();
+	const float hysteresisDistance = FMath::Max(ShadowCastingLightHysteresisDistance, 0.f);
+	for (const int32 partitionIndex : mShadowCastingPartitionIndices)
+	{
+		DungeonPartitions[partitionIndex]->EachDungeonComponentActivatorComponent([&candidates, &cameraLocation, &cameraDirection, hysteresisDistance](const UDungeonComponentActivatorComponent* dungeonComponentActivatorComponent)
+			{
+				dungeonComponentActivatorComponent->EachControlledLightCastShadow([&candidates, &cameraLocation, &cameraDirection, hysteresisDistance](UPointLightComponent* pointLightComponent)
+					{
+						const auto toTarget = pointLightComponent->GetComponentLocation() - cameraLocation;
+						const float distance = toTarget.Size();
+						if (!FMath::IsNearlyZero(distance))
 						{
-							const auto toTarget = pointLightComponent->GetComponentLocation() - cameraLocation;
-							const float distance = toTarget.Size();
-							if (!FMath::IsNearlyZero(distance))
-							{
-								const auto direction = toTarget / distance;
-								const float dot = FVector::DotProduct(cameraDirection, direction);
-								// 正面に近い（dot が大きい）ほど値が大きい
-								// 距離が短い（distance が小さい）ほど値が大きい
-								const float score = FMath::Max(FMath::Cos(FMath::DegreesToRadians(60.f)), dot) / FMath::Sqrt(distance);
-								pointLightComponents.emplace_back(score, pointLightComponent);
-							}
+							const auto direction = toTarget / distance;
+							const float dot = FVector::DotProduct(cameraDirection, direction);
+							// 影を落としているライトは近くにあるものとして扱う
+							const float scoredDistance = pointLightComponent->CastShadows ? FMath::Max(distance - hysteresisDistance, 1.f) : distance;
+							// 正面に近い（dot が大きい）ほど値が大きい
+							// 距離が短い（distance が小さい）ほど値が大きい
+							const float score = FMath::Max(FMath::Cos(FMath::DegreesToRadians(60.f)), dot) / FMath::Sqrt(scoredDistance);
+							candidates.Add({ score, pointLightComponent });
 						}
-					);
-				}
-			);
-		}
+					}
+				);
+			}
+		);
 	}
 
-	// 降順に並び替える
-	std::sort(pointLightComponents.begin(), pointLightComponents.end(), [](const PointLightPair& l, const PointLightPair& r)
-		{
-			return l.first > r.first;
-		}
-	);
+	// 上位のライトだけを先頭に集める
+	const int32 enablePointLightComponentSize = FMath::Min<int32>(MaxShadowCastingPointAndSpotLights, candidates.Num());
+	if (enablePointLightComponentSize < candidates.Num())
+	{
+		std::nth_element(candidates.GetData(), candidates.GetData() + enablePointLightComponentSize, candidates.GetData() + candidates.Num(), [](const FShadowCastingLightCandidate& l, const FShadowCastingLightCandidate& r)
+			{
+				return l.Score > r.Score;
+			}
+		);
+	}
 
-	// UPointLightComponentへ反映する
+	// 状態が変わるUPointLightComponentだけに反映する
+	for (int32 i = 0; i < candidates.Num(); ++i)
 	{
-		size_t i = 0;
-		const auto enablePointLightComponentSize = std::min<size_t>(MaxShadowCastingPointAndSpotLights, pointLightComponents.size());
-		while (i < enablePointLightComponentSize)
-		{
-			pointLightComponents[i].second->SetCastShadows(true);
-			++i;
-		}
-		while (i < pointLightComponents.size())
-		{
-			pointLightComponents[i].second->SetCastShadows(false);
-			++i;
-		}
+		const bool castShadows = i < enablePointLightComponentSize;
+		UPointLightComponent* pointLightComponent = candidates[i].PointLightComponent;
+		if (static_cast<bool>(pointLightComponent->CastShadows) != castShadows)
+			pointLightComponent->SetCastShadows(castShadows);
 	}
 }
 
+/*
+ * 視点から見えるようになったパーティションのライトを影の候補にします
+ */
+void ADungeonMainLevelScriptActor::AddShadowCastingPartition(const int32 partitionIndex)
+{
+	if (!mShadowCastingPartitionPositions.IsValidIndex(partitionIndex) || mShadowCastingPartitionPositions[partitionIndex] != INDEX_NONE)
+		return;
+
+	mShadowCastingPartitionPositions[partitionIndex] = mShadowCastingPartitionIndices.Add(partitionIndex);
+}
+
+/*
+ * 見えなくなったパーティションは候補から外し、次の更新でライトの影を消します
+ */
+void ADungeonMainLevelScriptActor::RemoveShadowCastingPartition(const int32 partitionIndex)
+{
+	if (!mShadowCastingPartitionPositions.IsValidIndex(partitionIndex))
+		return;
+
+	const int32 position = mShadowCastingPartitionPositions[partitionIndex];
+	if (position == INDEX_NONE)
+		return;
+
+	mShadowCastingPartitionPositions[partitionIndex] = INDEX_NONE;
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+	mShadowCastingPartitionIndices.RemoveAtSwap(position, 1, EAllowShrinking::No);
+#else
+	mShadowCastingPartitionIndices.RemoveAtSwap(position, 1, false);
+#endif
+	if (mShadowCastingPartitionIndices.IsValidIndex(position))
+		mShadowCastingPartitionPositions[mShadowCastingPartitionIndices[position]] = position;
+
+	ReleaseShadowCastingPartition(partitionIndex);
+}
+
+void ADungeonMainLevelScriptActor::ReleaseShadowCastingPartition(const int32 partitionIndex)
+{
+	// 影を制御しない時は溜め込まない
+	if (MaxShadowCastingPointAndSpotLights > 0 && !mShadowCastingRequiresFullScan)
+		mShadowReleasedPartitionIndices.Add(partitionIndex);
+}
+
 void ADungeonMainLevelScriptActor::ForceActivateShadowCastingPointAndSpotLights()
 {
 	for (UDungeonPartition* partition : DungeonPartitions)
@@ -1547,6 +2617,44 @@ void ADungeonMainLevelScriptActor::ForceActivateShadowCastingPointAndSpotLights(
 			);
 		}
 	}
+
+	// 次に影を制御する時は全てのライトを調べ直す
+	mShadowCastingRequiresFullScan = true;
+	mShadowReleasedPartitionIndices.Reset();
+}
+
+/*
+ * 上限が0の間は影を消したパーティションを記録しないので、上限が変わったら全てのライトを選び直します。
+ * 無制限になった場合は選択で影を消したライトも含めて全てのライトに影を落とさせます。
+ */
+void ADungeonMainLevelScriptActor::SyncShadowCastingLightLimit()
+{
+	if (mAppliedMaxShadowCastingPointAndSpotLights == MaxShadowCastingPointAndSpotLights)
+		return;
+	mAppliedMaxShadowCastingPointAndSpotLights = MaxShadowCastingPointAndSpotLights;
+
+	if (MaxShadowCastingPointAndSpotLights == 0)
+	{
+		for (const UDungeonPartition* partition : DungeonPartitions)
+		{
+			if (!IsValid(partition))
+				continue;
+
+			partition->EachDungeonComponentActivatorComponent([](const UDungeonComponentActivatorComponent* dungeonComponentActivatorComponent)
+				{
+					dungeonComponentActivatorComponent->EachControlledLightCastShadow([](UPointLightComponent* pointLightComponent)
+						{
+							if (!pointLightComponent->CastShadows)
+								pointLightComponent->SetCastShadows(true);
+						}
+					);
+				}
+			);
+		}
+	}
+
+	mShadowCastingRequiresFullScan = true;
+	mShadowReleasedPartitionIndices.Reset();
 }
 
 #if WITH_EDITOR
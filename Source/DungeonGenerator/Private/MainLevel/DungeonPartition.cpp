@@ -6,6 +6,7 @@
 
 #include "MainLevel/DungeonPartition.h"
 #include "MainLevel/DungeonComponentActivatorComponent.h"
+#include "MainLevel/DungeonMainLevelScriptActor.h"
 
 /*
  * UDungeonComponentActivatorComponentのTickComponentは
@@ -15,9 +16,20 @@ void UDungeonPartition::RegisterActivatorComponent(UDungeonComponentActivatorCom
 {
 	if (IsValid(component))
 	{
-		UE::TScopeLock lock(mActivatorAndRegisteredComponentsMutex);
-		RegisteredComponents.Emplace(component);
-		ActivatorComponents.Emplace(component);
+		bool firstRegisteredComponent;
+		{
+			UE::TScopeLock lock(mActivatorAndRegisteredComponentsMutex);
+			firstRegisteredComponent = RegisteredComponents.IsEmpty();
+			RegisteredComponents.Emplace(component);
+			ActivatorComponents.Emplace(component);
+		}
+
+		// 登録待ちになった事を通知して、次のフレームで反映してもらいます
+		if (firstRegisteredComponent)
+		{
+			if (ADungeonMainLevelScriptActor* owner = GetTypedOuter<ADungeonMainLevelScriptActor>())
+				owner->EnqueueRegisteredPartition(this);
+		}
 	}
 }
 
@@ -93,6 +105,12 @@ void UDungeonPartition::CallPartitionInactivate()
 	}
 }
 
+void UDungeonPartition::GetResourceSizeEx(FResourceSizeEx& cumulativeResourceSize)
+{
+	Super::GetResourceSizeEx(cumulativeResourceSize);
+	cumulativeResourceSize.AddDedicatedSystemMemoryBytes(GetAllocatedSize());
+}
+
 bool UDungeonPartition::IsEmpty() const
 {
 	return ActivatorComponents.Num() == 0;
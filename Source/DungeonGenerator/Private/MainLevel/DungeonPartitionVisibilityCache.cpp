@@ -0,0 +1,175 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "MainLevel/DungeonPartitionVisibilityCache.h"
+#include "Core/Debug/Debug.h"
+#include <HAL/FileManager.h>
+#include <Misc/Crc.h>
+#include <Misc/DateTime.h>
+#include <Misc/FileHelper.h>
+#include <Serialization/MemoryReader.h>
+#include <Serialization/MemoryWriter.h>
+
+namespace
+{
+	// 'DGPV'
+	constexpr uint32 CacheFileMagic = 0x56504744;
+	// ファイルの形式を変更した場合は更新してください
+	constexpr uint32 CacheFileVersion = 2;
+
+	// 保存するキャッシュファイルの最大数と、削除するまでの日数
+	constexpr int32 MaxCacheFileCount = 32;
+	constexpr double MaxCacheFileAgeDays = 30.0;
+
+	struct FCacheFileHeader final
+	{
+		uint32 Magic = CacheFileMagic;
+		uint32 Version = CacheFileVersion;
+		uint32 Key = 0;
+		uint32 PayloadCrc32 = 0;
+		int64 PayloadSize = 0;
+
+		friend FArchive& operator<<(FArchive& archive, FCacheFileHeader& header)
+		{
+			archive << header.Magic;
+			archive << header.Version;
+			archive << header.Key;
+			archive << header.PayloadCrc32;
+			archive << header.PayloadSize;
+			return archive;
+		}
+	};
+}
+
+FDungeonPartitionVisibilityCache::FDungeonPartitionVisibilityCache(const uint32 key) noexcept
+	: mKey(key)
+{
+}
+
+FString FDungeonPartitionVisibilityCache::GetDirectory()
+{
+	return dungeon::GetDebugDirectory() / TEXT("PartitionVisibility");
+}
+
+FString FDungeonPartitionVisibilityCache::GetPath() const
+{
+	return GetDirectory() / FString::Printf(TEXT("%08x.dgpvs"), mKey);
+}
+
+/*
+ * 古いキャッシュファイルと、最大数を超えた古い順のキャッシュファイルを削除します
+ */
+void FDungeonPartitionVisibilityCache::Evict()
+{
+	const FString directory = GetDirectory();
+	TArray<FString> fileNames;
+	IFileManager& fileManager = IFileManager::Get();
+	fileManager.FindFiles(fileNames, *(directory / TEXT("*.dgpvs")), true, false);
+
+	TArray<TPair<FDateTime, FString>> files;
+	files.Reserve(fileNames.Num());
+	for (const FString& fileName : fileNames)
+	{
+		const FString path = directory / fileName;
+		files.Emplace(fileManager.GetTimeStamp(*path), path);
+	}
+	files.Sort([](const TPair<FDateTime, FString>& l, const TPair<FDateTime, FString>& r)
+		{
+			return l.Key > r.Key;
+		}
+	);
+
+	const FDateTime expiration = FDateTime::UtcNow() - FTimespan::FromDays(MaxCacheFileAgeDays);
+	for (int32 index = 0; index < files.Num(); ++index)
+	{
+		if (index < MaxCacheFileCount && files[index].Key >= expiration)
+			continue;
+
+		if (fileManager.Delete(*files[index].Value, false, false, true))
+			DUNGEON_GENERATOR_LOG(TEXT("Evicted partition visibility cache '%s'"), *files[index].Value);
+	}
+}
+
+void FDungeonPartitionVisibilityCache::Serialize(FArchive& archive)
+{
+	archive << PartitionCells;
+	archive << PartitionSamples;
+	archive << PotentialVisibilityRows;
+}
+
+bool FDungeonPartitionVisibilityCache::Save() const
+{
+	TArray<uint8> payload;
+	{
+		FMemoryWriter writer(payload);
+		const_cast<FDungeonPartitionVisibilityCache*>(this)->Serialize(writer);
+	}
+
+	FCacheFileHeader header;
+	header.Key = mKey;
+	header.PayloadCrc32 = FCrc::MemCrc32(payload.GetData(), payload.Num());
+	header.PayloadSize = payload.Num();
+
+	TArray<uint8> buffer;
+	buffer.Reserve(sizeof(FCacheFileHeader) + payload.Num());
+	{
+		FMemoryWriter writer(buffer);
+		writer << header;
+	}
+	buffer.Append(payload);
+
+	const FString path = GetPath();
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(path), true);
+	if (!FFileHelper::SaveArrayToFile(buffer, *path))
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Failed to write partition visibility cache '%s'"), *path);
+		return false;
+	}
+
+	DUNGEON_GENERATOR_LOG(TEXT("Saved partition visibility cache '%s' (%d bytes)"), *path, buffer.Num());
+	Evict();
+	return true;
+}
+
+bool FDungeonPartitionVisibilityCache::Load()
+{
+	const FString path = GetPath();
+	if (!IFileManager::Get().FileExists(*path))
+		return false;
+
+	TArray<uint8> buffer;
+	if (!FFileHelper::LoadFileToArray(buffer, *path))
+		return false;
+
+	FMemoryReader reader(buffer);
+	FCacheFileHeader header;
+	reader << header;
+	if (reader.IsError() || header.Magic != CacheFileMagic || header.Version != CacheFileVersion || header.Key != mKey)
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Partition visibility cache '%s' does not match and is ignored"), *path);
+		return false;
+	}
+
+	const int64 payloadOffset = reader.Tell();
+	if (header.PayloadSize != buffer.Num() - payloadOffset ||
+		header.PayloadCrc32 != FCrc::MemCrc32(buffer.GetData() + payloadOffset, static_cast<int32>(header.PayloadSize)))
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Partition visibility cache '%s' is corrupted and is ignored"), *path);
+		return false;
+	}
+
+	Serialize(reader);
+	if (reader.IsError() || PartitionSamples.Num() != PartitionCells.Num() || PotentialVisibilityRows.Num() != PartitionCells.Num())
+	{
+		DUNGEON_GENERATOR_WARNING(TEXT("Partition visibility cache '%s' could not be read and is ignored"), *path);
+		PartitionCells.Reset();
+		PartitionSamples.Reset();
+		PotentialVisibilityRows.Reset();
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,69 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "MainLevel/DungeonPartitionVisibilityRow.h"
+
+/*
+ * パーティション番号1つ(4バイト)とビット列1ワード(8バイト)の大きさを比べて形式を選びます
+ */
+void FDungeonPartitionVisibilityRow::Assign(const TArray<uint64>& words)
+{
+	Reset();
+
+	int32 lastWordIndex = INDEX_NONE;
+	for (int32 wordIndex = 0; wordIndex < words.Num(); ++wordIndex)
+	{
+		if (words[wordIndex] == 0)
+			continue;
+		mCount += FMath::CountBits(words[wordIndex]);
+		lastWordIndex = wordIndex;
+	}
+
+	const int32 wordCount = lastWordIndex + 1;
+	mSparse = static_cast<SIZE_T>(mCount) * sizeof(int32) <= static_cast<SIZE_T>(wordCount) * sizeof(uint64);
+	if (mSparse)
+	{
+		mIndices.Reserve(mCount);
+		for (int32 wordIndex = 0; wordIndex < wordCount; ++wordIndex)
+		{
+			for (uint64 word = words[wordIndex]; word != 0; word &= word - 1)
+				mIndices.Add(wordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(word)));
+		}
+	}
+	else
+	{
+		mWords.Append(words.GetData(), wordCount);
+	}
+}
+
+void FDungeonPartitionVisibilityRow::UnionInto(TArray<uint64>& words) const
+{
+	if (mSparse)
+	{
+		for (const int32 partitionIndex : mIndices)
+		{
+			const int32 wordIndex = partitionIndex / 64;
+			if (words.Num() <= wordIndex)
+				words.SetNumZeroed(wordIndex + 1);
+			words[wordIndex] |= 1ull << (partitionIndex % 64);
+		}
+		return;
+	}
+
+	if (words.Num() < mWords.Num())
+		words.SetNumZeroed(mWords.Num());
+	for (int32 wordIndex = 0; wordIndex < mWords.Num(); ++wordIndex)
+		words[wordIndex] |= mWords[wordIndex];
+}
+
+FArchive& operator<<(FArchive& archive, FDungeonPartitionVisibilityRow& row)
+{
+	archive << row.mSparse;
+	archive << row.mCount;
+	archive << row.mIndices;
+	archive << row.mWords;
+	return archive;
+}
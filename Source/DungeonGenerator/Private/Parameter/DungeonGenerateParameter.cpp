@@ -10,6 +10,7 @@
 #include "PluginInformation.h"
 #include "Core/Debug/BuildInformation.h"
 #include "Core/Debug/Debug.h"
+#include "Core/GenerateParameter.h"
 #include "Core/Math/Random.h"
 #include "Core/Voxelization/Grid.h"
 #include "SubActor/DungeonRoomSensorDatabase.h"
@@ -214,6 +215,75 @@ void UDungeonGenerateParameter::SetGeneratedRandomSeed(const int32 generatedRand
 	}
 }
 
+void UDungeonGenerateParameter::ToGenerateParameter(dungeon::GenerateParameter& generateParameter, const int32 randomSeed, const int32 playerStartCount) const
+{
+	generateParameter.GetRandom()->SetSeed(randomSeed);
+	generateParameter.SetNumberOfCandidateRooms(NumberOfCandidateRooms);
+	generateParameter.SetMinRoomWidth(RoomWidth.Min);
+	generateParameter.SetMaxRoomWidth(RoomWidth.Max);
+	generateParameter.SetMinRoomDepth(RoomDepth.Min);
+	generateParameter.SetMaxRoomDepth(RoomDepth.Max);
+	generateParameter.SetMinRoomHeight(RoomHeight.Min);
+	generateParameter.SetMaxRoomHeight(RoomHeight.Max);
+	generateParameter.SetMergeRooms(MergeRooms);
+	generateParameter.SetMissionGraph(IsUseMissionGraph());
+	generateParameter.SetAisleComplexity(GetAisleComplexity());
+	generateParameter.SetAisleCeilingHeightPolicy(static_cast<dungeon::AisleCeilingHeightPolicy>(GetAisleCeilingHeightPolicy()));
+	generateParameter.SetGenerateSlopeInRoom(GenerateSlopeInRoom);
+	generateParameter.SetGenerateStructuralColumn(GenerateStructuralColumn);
+	generateParameter.SetSkylightChancePercent(SkylightChancePercent);
+	EDungeonStartLocationPolicy startLocationPolicy = StartLocationPolicy;
+	if (IsUseMissionGraph())
+	{
+		if (startLocationPolicy == EDungeonStartLocationPolicy::UseMultiStart)
+		{
+			DUNGEON_GENERATOR_WARNING(TEXT("StartLocationPolicy requires UseMissionGraph disabled. Falling back to UseSouthernMost."));
+			startLocationPolicy = EDungeonStartLocationPolicy::UseSouthernMost;
+		}
+	}
+	generateParameter.SetStartLocationPolicy(static_cast<dungeon::StartLocationPolicy>(startLocationPolicy));
+	uint8 startRoomCount = 1;
+	if (startLocationPolicy == EDungeonStartLocationPolicy::UseMultiStart)
+	{
+		if (playerStartCount <= 0)
+		{
+			DUNGEON_GENERATOR_WARNING(TEXT("UseMultiStart requires at least one PlayerStart. Falling back to a single start room."));
+		}
+		startRoomCount = static_cast<uint8>(FMath::Clamp(playerStartCount, 1, 255));
+	}
+	generateParameter.SetStartRoomCount(startRoomCount);
+
+	if (MergeRooms)
+	{
+		generateParameter.SetHorizontalRoomMargin(0);
+		generateParameter.SetVerticalRoomMargin(0);
+		generateParameter.SetExpansionPolicy(dungeon::ExpansionPolicy::ExpandHorizontally);
+		generateParameter.SetNumberOfCandidateFloors(0);
+		generateParameter.SetMissionGraph(false);
+		generateParameter.SetAisleComplexity(0);
+	}
+	else
+	{
+		generateParameter.SetHorizontalRoomMargin(RoomMargin);
+		if (ExpansionPolicy == EDungeonExpansionPolicy::Flat)
+		{
+			generateParameter.SetVerticalRoomMargin(0);
+			generateParameter.SetExpansionPolicy(dungeon::ExpansionPolicy::Flat);
+			generateParameter.SetNumberOfCandidateFloors(0);
+		}
+		else
+		{
+			generateParameter.SetVerticalRoomMargin(VerticalRoomMargin);
+			generateParameter.SetExpansionPolicy(static_cast<dungeon::ExpansionPolicy>(ExpansionPolicy));
+			generateParameter.SetNumberOfCandidateFloors(NumberOfCandidateFloors);
+		}
+	}
+
+	check(generateParameter.GetMinRoomWidth() <= generateParameter.GetMaxRoomWidth());
+	check(generateParameter.GetMinRoomDepth() <= generateParameter.GetMaxRoomDepth());
+	check(generateParameter.GetMinRoomHeight() <= generateParameter.GetMaxRoomHeight());
+}
+
 int32 UDungeonGenerateParameter::GetGeneratedDungeonCRC32() const noexcept
 {
 	return GeneratedDungeonCRC32;
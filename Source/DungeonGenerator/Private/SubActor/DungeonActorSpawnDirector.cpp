@@ -19,9 +19,11 @@
  */
 
 #include "SubActor/DungeonActorSpawnDirector.h"
+#include "DungeonGenerateActor.h"
 #include "Core/Debug/Debug.h"
 #include "Core/Helper/DrawLots.h"
 #include <Engine/World.h>
+#include <EngineUtils.h>
 #include <GameFramework/Pawn.h>
 
 ADungeonActorSpawnDirector::ADungeonActorSpawnDirector(const FObjectInitializer& objectInitializer)
@@ -67,6 +69,10 @@ void ADungeonActorSpawnDirector::Tick(float DeltaSeconds)
 		mActors.erase(i, mActors.end());
 	}
 
+	// ナビゲーションメッシュの構築中はスポーンしたアクターが移動できないので待つ
+	if (WaitForNavigationReady && !IsNavigationReady())
+		return;
+
 	// インターバル時間を超えている？
 	mElapsedTime += DeltaSeconds;
 	while (mElapsedTime >= SpawnIntervalTime)
@@ -108,3 +114,13 @@ void ADungeonActorSpawnDirector::Tick(float DeltaSeconds)
 		}
 	}
 }
+
+bool ADungeonActorSpawnDirector::IsNavigationReady() const
+{
+	for (TActorIterator<ADungeonGenerateActor> iterator(GetWorld()); iterator; ++iterator)
+	{
+		if (!iterator->IsNavigationReady())
+			return false;
+	}
+	return true;
+}
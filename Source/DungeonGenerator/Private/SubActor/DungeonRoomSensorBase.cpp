@@ -7,6 +7,7 @@
 #include "SubActor/DungeonRoomSensorBase.h"
 #include "SubActor/DungeonDoorBase.h"
 #include "DungeonGenerateBase.h"
+#include "DungeonAssetPrefetcher.h"
 #include "Core/Debug/Debug.h"
 #include "Core/Helper/Crc.h"
 #include "Core/Math/Random.h"
@@ -256,6 +257,7 @@ void ADungeonRoomSensorBase::InvokeFinalize()
 		OnFinalize(true);
 		mSynchronizedRandom.ResetOwner();
 		mState = State::Finalized;
+		++mSpawnSerial;
 	}
 }
 
@@ -279,6 +281,33 @@ void ADungeonRoomSensorBase::InvokeResume()
 	}
 }
 
+void ADungeonRoomSensorBase::InvokeEnter()
+{
+	if (mOverlapCount == 0)
+		InvokeResume();
+	++mOverlapCount;
+}
+
+void ADungeonRoomSensorBase::InvokeLeave(const bool fallToAbyss)
+{
+	if (mOverlapCount == 0)
+		return;
+
+	--mOverlapCount;
+	if (mOverlapCount == 0)
+		InvokeReset(fallToAbyss);
+}
+
+/*
+ * FDungeonRoomOccupancyTrackerが入室と退室を通知する場合、センサーの箱はオーバーラップを検出しません。
+ * 箱の大きさはIdealNumberOfActorなどで使うので残します。
+ */
+void ADungeonRoomSensorBase::DisableOverlapSensor()
+{
+	Bounding->SetGenerateOverlapEvents(false);
+	Bounding->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+}
+
 void ADungeonRoomSensorBase::AddDungeonDoor(ADungeonDoorBase* dungeonDoorBase)
 {
 	DungeonDoors.Add(dungeonDoorBase);
@@ -333,15 +362,42 @@ void ADungeonRoomSensorBase::SpawnActorInRoomImpl(const FSoftObjectPath& spawnAc
 		FTransform transform;
 		if (RandomTransform(transform, 100.f, false))
 		{
-			const FSoftObjectPath path(spawnActorPath.ToString() + "_C");
-			const TSoftClassPtr<AActor> softClassPointer(path);
-			auto* actorClass = softClassPointer.LoadSynchronous();
-			SpawnActorFromClass(actorClass, transform, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding, nullptr, true);
+			/*
+			 * 同期乱数の消費はここで済ませ、読み込まれていないクラスはスポーンだけを読み込み完了まで遅らせます。
+			 * 生成直後に要求したFDungeonAssetPrefetcherの読み込みが終わっていれば直ちにスポーンします。
+			 * 読み込み中に終了したセンサーは、プールから再利用されていてもスポーンしません。
+			 * ジェネレーターがスポーンしたセンサーは、読み込みを待ったスポーンをジェネレーターの読み込みで数えます。
+			 */
+			auto onLoaded = [weakThis = TWeakObjectPtr<ADungeonRoomSensorBase>(this), spawnSerial = mSpawnSerial, transform](UClass* actorClass)
+				{
+					if (weakThis.IsValid() && weakThis->mSpawnSerial == spawnSerial && actorClass)
+						weakThis->SpawnActorFromClass(actorClass, transform, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding, nullptr, true);
+				};
+			if (const auto assetPrefetcher = mAssetPrefetcher.lock())
+				assetPrefetcher->LoadClass(spawnActorPath, MoveTemp(onLoaded));
+			else
+				FDungeonAssetPrefetcher::LoadClassAsync(spawnActorPath, MoveTemp(onLoaded));
 			break;
 		}
 	} while (force);
 }
 
+void ADungeonRoomSensorBase::CollectSpawnActorPaths(TArray<FSoftObjectPath>& outPaths, const bool rooms, const bool key, const bool uniqueKey) const
+{
+	if (rooms)
+	{
+		for (const FSoftObjectPath& spawnActorPath : SpawnActors)
+		{
+			if (spawnActorPath.IsValid())
+				outPaths.AddUnique(spawnActorPath);
+		}
+	}
+	if (key && SpawnKeyActor.IsValid())
+		outPaths.AddUnique(SpawnKeyActor);
+	if (uniqueKey && SpawnUniqueKeyActor.IsValid())
+		outPaths.AddUnique(SpawnUniqueKeyActor);
+}
+
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 void ADungeonRoomSensorBase::OnBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
@@ -349,11 +405,7 @@ void ADungeonRoomSensorBase::OnBeginOverlap(UPrimitiveComponent* OverlappedCompo
 	if (const APawn* otherPawn = Cast<APawn>(OtherActor))
 	{
 		if (IsValid(otherPawn->GetController<APlayerController>()))
-		{
-			if (mOverlapCount == 0)
-				InvokeResume();
-			++mOverlapCount;
-		}
+			InvokeEnter();
 	}
 }
 
@@ -372,11 +424,7 @@ void ADungeonRoomSensorBase::OnEndOverlap(UPrimitiveComponent* OverlappedCompone
 	if (const APawn* otherPawn = Cast<APawn>(OtherActor))
 	{
 		if (IsValid(otherPawn->GetController<APlayerController>()))
-		{
-			--mOverlapCount;
-			if (mOverlapCount == 0)
-				InvokeReset(fallToAbyss);
-		}
+			InvokeLeave(fallToAbyss);
 	}
 
 	// 奈落落下通知
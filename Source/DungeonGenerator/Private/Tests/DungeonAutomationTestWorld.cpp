@@ -0,0 +1,82 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Tests/DungeonAutomationTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "DungeonGenerateActor.h"
+#include "Core/Generator.h"
+#include "MainLevel/DungeonMainLevelScriptActor.h"
+#include "Parameter/DungeonGenerateParameter.h"
+#include <Engine/Engine.h>
+#include <Engine/World.h>
+#include <UObject/Package.h>
+#include <UObject/UObjectGlobals.h>
+
+namespace
+{
+	// プラグインに含まれるサンプルのダンジョン生成パラメータ
+	const TCHAR* SampleParameterPath = TEXT("/DungeonGenerator/Parameters/DGP_Sample.DGP_Sample");
+}
+
+FDungeonAutomationTestWorld::FDungeonAutomationTestWorld()
+{
+	mWorld = UWorld::CreateWorld(EWorldType::Game, false, TEXT("DungeonAutomationTestWorld"));
+	mWorld->AddToRoot();
+	FWorldContext& worldContext = GEngine->CreateNewWorldContext(EWorldType::Game);
+	worldContext.SetCurrentWorld(mWorld);
+
+	// アクターを初期化する前にレベルスクリプトアクターを差し替えます
+	FActorSpawnParameters spawnParameters;
+	spawnParameters.ObjectFlags = RF_Transient;
+	mLevelScriptActor = mWorld->SpawnActor<ADungeonMainLevelScriptActor>(spawnParameters);
+	mWorld->PersistentLevel->LevelScriptActor = mLevelScriptActor;
+
+	mWorld->InitializeActorsForPlay(FURL());
+	mWorld->BeginPlay();
+}
+
+FDungeonAutomationTestWorld::~FDungeonAutomationTestWorld()
+{
+	GEngine->DestroyWorldContext(mWorld);
+	mWorld->DestroyWorld(false);
+	mWorld->RemoveFromRoot();
+}
+
+ADungeonGenerateActor* FDungeonAutomationTestWorld::Generate(const int32 randomSeed, const bool generateSimplifiedCollision)
+{
+	const UDungeonGenerateParameter* sampleParameter = LoadObject<UDungeonGenerateParameter>(nullptr, SampleParameterPath);
+	if (!IsValid(sampleParameter))
+		return nullptr;
+
+	// サンプルのアセットを書き換えないように複製して乱数の種を固定します
+	UDungeonGenerateParameter* parameter = DuplicateObject<UDungeonGenerateParameter>(sampleParameter, GetTransientPackage());
+	parameter->RandomSeed = randomSeed;
+
+	// 自動生成を止めてから初期化します
+	ADungeonGenerateActor* dungeonGenerateActor = mWorld->SpawnActorDeferred<ADungeonGenerateActor>(ADungeonGenerateActor::StaticClass(), FTransform::Identity);
+	if (!IsValid(dungeonGenerateActor))
+		return nullptr;
+	dungeonGenerateActor->AutoGenerateAtStart = false;
+	dungeonGenerateActor->GenerateSimplifiedCollision = generateSimplifiedCollision;
+	dungeonGenerateActor->FinishSpawning(FTransform::Identity);
+
+	// 生成が終わるとレベルスクリプトアクターがパーティションを構築し直します
+	dungeonGenerateActor->GenerateDungeonWithParameter(parameter);
+	if (!dungeonGenerateActor->IsGenerated())
+		return nullptr;
+
+	mDungeonGenerateActor = dungeonGenerateActor;
+	mParameter = parameter;
+	return dungeonGenerateActor;
+}
+
+std::shared_ptr<const dungeon::Generator> FDungeonAutomationTestWorld::GetGenerator() const
+{
+	return IsValid(mDungeonGenerateActor) ? mDungeonGenerateActor->GetGenerator() : nullptr;
+}
+
+#endif
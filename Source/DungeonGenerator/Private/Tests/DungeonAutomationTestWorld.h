@@ -0,0 +1,105 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include <memory>
+
+class ADungeonGenerateActor;
+class ADungeonMainLevelScriptActor;
+class UDungeonGenerateParameter;
+class UWorld;
+
+namespace dungeon
+{
+	class Generator;
+}
+
+/**
+ * Transient game world for automation tests.
+ * ADungeonMainLevelScriptActor is used as the level script, and dungeons are generated
+ * from a copy of the sample parameter of the plugin, so no map or player is required.
+ *
+ * 自動テスト用の一時的なゲームワールドです。
+ * レベルスクリプトにADungeonMainLevelScriptActorを使い、プラグインのサンプルパラメータの
+ * 複製からダンジョンを生成するので、マップやプレイヤーを必要としません。
+ */
+class FDungeonAutomationTestWorld final
+{
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	FDungeonAutomationTestWorld();
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonAutomationTestWorld();
+
+	FDungeonAutomationTestWorld(const FDungeonAutomationTestWorld&) = delete;
+	FDungeonAutomationTestWorld& operator=(const FDungeonAutomationTestWorld&) = delete;
+
+	/**
+	 * Generate a dungeon with a fixed random seed
+	 * 固定した乱数の種でダンジョンを生成します
+	 * @param[in]	randomSeed					乱数の種
+	 * @param[in]	generateSimplifiedCollision	床、壁、天井を簡略化したコリジョンに置き換えるならtrue
+	 * @return		nullptr if the sample parameter cannot be loaded or the generation failed
+	 */
+	ADungeonGenerateActor* Generate(const int32 randomSeed, const bool generateSimplifiedCollision = false);
+
+	/**
+	 * Get the world
+	 * ワールドを取得します
+	 */
+	UWorld* GetWorld() const noexcept;
+
+	/**
+	 * Get the level script actor
+	 * レベルスクリプトアクターを取得します
+	 */
+	ADungeonMainLevelScriptActor* GetLevelScriptActor() const noexcept;
+
+	/**
+	 * Get the generator of the last generated dungeon
+	 * 最後に生成したダンジョンの生成器を取得します
+	 */
+	std::shared_ptr<const dungeon::Generator> GetGenerator() const;
+
+	/**
+	 * Get the parameter of the last generated dungeon
+	 * 最後に生成したダンジョンのパラメータを取得します
+	 */
+	const UDungeonGenerateParameter* GetParameter() const noexcept;
+
+private:
+	UWorld* mWorld = nullptr;
+	ADungeonMainLevelScriptActor* mLevelScriptActor = nullptr;
+	ADungeonGenerateActor* mDungeonGenerateActor = nullptr;
+	UDungeonGenerateParameter* mParameter = nullptr;
+};
+
+inline UWorld* FDungeonAutomationTestWorld::GetWorld() const noexcept
+{
+	return mWorld;
+}
+
+inline ADungeonMainLevelScriptActor* FDungeonAutomationTestWorld::GetLevelScriptActor() const noexcept
+{
+	return mLevelScriptActor;
+}
+
+inline const UDungeonGenerateParameter* FDungeonAutomationTestWorld::GetParameter() const noexcept
+{
+	return mParameter;
+}
+
+#endif
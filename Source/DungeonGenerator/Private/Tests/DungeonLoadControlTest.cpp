@@ -0,0 +1,137 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Tests/DungeonAutomationTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "MainLevel/DungeonLoadControlSimulator.h"
+#include "MainLevel/DungeonMainLevelScriptActor.h"
+#include <Misc/AutomationTest.h>
+
+namespace
+{
+	constexpr int32 RandomSeed = 12345;
+	constexpr int32 PawnCount = 4;
+	constexpr int32 FrameCount = 1800;
+
+	FDungeonLoadControlSimulator::FSettings MakeSettings()
+	{
+		FDungeonLoadControlSimulator::FSettings settings;
+		settings.PawnCount = PawnCount;
+		settings.FrameCount = FrameCount;
+		settings.RandomSeed = RandomSeed;
+		settings.Prefetch = 0;
+		// 時間の予算は実行環境で変わるので、個数だけで制限します
+		settings.TransitionBudgetMilliseconds = 0.f;
+		return settings;
+	}
+}
+
+/*
+ * 切り替えの個数を制限しなければ、視点がいるパーティションとそこから見えるパーティションは
+ * 入ったフレームのうちにアクティブになります
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonLoadControlUnlimitedTest, "DungeonGenerator.MainLevel.LoadControl.Unlimited",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonLoadControlUnlimitedTest::RunTest(const FString& Parameters)
+{
+	FDungeonAutomationTestWorld testWorld;
+	if (!TestNotNull(TEXT("Generated dungeon"), testWorld.Generate(RandomSeed)))
+		return false;
+
+	ADungeonMainLevelScriptActor* levelScriptActor = testWorld.GetLevelScriptActor();
+	if (!TestTrue(TEXT("Partition load control is available"), levelScriptActor->IsPartitionLoadControlAvailable()))
+		return false;
+
+	FDungeonLoadControlSimulator::FSettings settings = MakeSettings();
+	settings.MaxActivationsPerFrame = 0;
+	settings.MaxInactivationsPerFrame = 0;
+
+	FDungeonLoadControlSimulator simulator(levelScriptActor);
+	if (!TestTrue(TEXT("Simulation ran"), simulator.Run(settings)))
+		return false;
+	simulator.Report(*GLog);
+
+	const TArray<FDungeonLoadControlSimulator::FFrame>& frames = simulator.GetFrames();
+	for (int32 frameIndex = 0; frameIndex < frames.Num(); ++frameIndex)
+	{
+		const FDungeonLoadControlSimulator::FFrame& frame = frames[frameIndex];
+		TestEqual(FString::Printf(TEXT("Viewers in inactive partitions at frame %d"), frameIndex), frame.InactiveViewerPartitions, 0);
+		TestEqual(FString::Printf(TEXT("Queue depth at frame %d"), frameIndex), frame.QueueDepth, 0);
+	}
+
+	TestTrue(TEXT("Pawns entered partitions"), simulator.GetTimeToActiveSeconds().Num() > 0);
+	TestEqual(TEXT("Unresolved activations"), simulator.GetUnresolvedActivationCount(), 0);
+	for (const float seconds : simulator.GetTimeToActiveSeconds())
+		TestEqual(TEXT("Time to active"), seconds, 0.f);
+	for (const float seconds : simulator.GetTimeToVisibleSeconds())
+		TestEqual(TEXT("Time to visible"), seconds, 0.f);
+
+	return true;
+}
+
+/*
+ * 切り替えの個数を制限すると、1フレームの切り替えは上限を超えず、
+ * 入ったパーティションは数フレーム後にアクティブになります
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonLoadControlBudgetTest, "DungeonGenerator.MainLevel.LoadControl.Budget",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonLoadControlBudgetTest::RunTest(const FString& Parameters)
+{
+	FDungeonAutomationTestWorld testWorld;
+	if (!TestNotNull(TEXT("Generated dungeon"), testWorld.Generate(RandomSeed)))
+		return false;
+
+	ADungeonMainLevelScriptActor* levelScriptActor = testWorld.GetLevelScriptActor();
+	if (!TestTrue(TEXT("Partition load control is available"), levelScriptActor->IsPartitionLoadControlAvailable()))
+		return false;
+
+	constexpr int32 MaxActivationsPerFrame = 1;
+	constexpr int32 MaxInactivationsPerFrame = 2;
+	FDungeonLoadControlSimulator::FSettings settings = MakeSettings();
+	settings.MaxActivationsPerFrame = MaxActivationsPerFrame;
+	settings.MaxInactivationsPerFrame = MaxInactivationsPerFrame;
+
+	FDungeonLoadControlSimulator simulator(levelScriptActor);
+	if (!TestTrue(TEXT("Simulation ran"), simulator.Run(settings)))
+		return false;
+	simulator.Report(*GLog);
+
+	const TArray<FDungeonLoadControlSimulator::FFrame>& frames = simulator.GetFrames();
+	TestEqual(TEXT("Simulated frames"), frames.Num(), FrameCount);
+	for (int32 frameIndex = 0; frameIndex < frames.Num(); ++frameIndex)
+	{
+		const FDungeonLoadControlSimulator::FFrame& frame = frames[frameIndex];
+		TestTrue(FString::Printf(TEXT("Activations at frame %d are within the limit"), frameIndex), frame.Activations <= MaxActivationsPerFrame);
+		TestTrue(FString::Printf(TEXT("Inactivations at frame %d are within the limit"), frameIndex), frame.Inactivations <= MaxInactivationsPerFrame);
+	}
+
+	// 視点がいるパーティションは視点までの距離が0なので最も優先され、ポーンの数と同程度のフレームでアクティブになります
+	const float maxTimeToActiveSeconds = static_cast<float>(PawnCount * 2) * settings.DeltaSeconds;
+	TestTrue(TEXT("Pawns entered partitions"), simulator.GetTimeToActiveSeconds().Num() > 0);
+	for (const float seconds : simulator.GetTimeToActiveSeconds())
+		TestTrue(FString::Printf(TEXT("Time to active %f is within %f seconds"), seconds, maxTimeToActiveSeconds), seconds <= maxTimeToActiveSeconds + UE_KINDA_SMALL_NUMBER);
+
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonLoadControlViewerIdTest, "DungeonGenerator.MainLevel.LoadControl.ViewerId",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonLoadControlViewerIdTest::RunTest(const FString& Parameters)
+{
+	// UObject::GetUniqueIDは負にならないint32なので、シミュレーションの視点IDはその範囲の外になります
+	for (int32 pawnIndex = 0; pawnIndex < PawnCount; ++pawnIndex)
+	{
+		const uint32 viewerId = FDungeonLoadControlSimulator::GetSimulatedViewerId(pawnIndex);
+		TestTrue(FString::Printf(TEXT("Viewer ID of pawn %d is outside the UObject unique ID range"), pawnIndex), viewerId > static_cast<uint32>(MAX_int32));
+	}
+	return true;
+}
+
+#endif
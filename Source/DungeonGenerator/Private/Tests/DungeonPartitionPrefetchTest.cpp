@@ -0,0 +1,249 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Tests/DungeonAutomationTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "MainLevel/DungeonLoadControlSimulator.h"
+#include "MainLevel/DungeonMainLevelScriptActor.h"
+#include "Parameter/DungeonGenerateParameter.h"
+#include "Core/Generator.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+#include <Misc/AutomationTest.h>
+
+namespace
+{
+	constexpr int32 RandomSeed = 12345;
+	constexpr float PawnSpeed = 450.f;
+	constexpr float DeltaSeconds = 1.f / 60.f;
+	constexpr float PrefetchSeconds = 0.5f;
+	constexpr double Reach = PawnSpeed * PrefetchSeconds;
+	constexpr double FrameStep = PawnSpeed * DeltaSeconds;
+
+	bool IsWalkableGrid(const dungeon::Grid& grid)
+	{
+		return (grid.IsKindOfRoomType() || grid.IsKindOfAisleType()) && grid.HasFloor();
+	}
+
+	bool IsWalkOpen(const dungeon::Voxel& voxel, const FIntVector& from, const FIntVector& to)
+	{
+		if (!voxel.Contain(from) || !voxel.Contain(to))
+			return false;
+		const dungeon::Grid& fromGrid = voxel.Get(from);
+		const dungeon::Grid& toGrid = voxel.Get(to);
+		if (!IsWalkableGrid(fromGrid) || !IsWalkableGrid(toGrid))
+			return false;
+
+		const FIntVector delta = to - from;
+		if (delta == FIntVector(1, 0, 0))
+			return !fromGrid.HasEastWall() && !toGrid.HasWestWall();
+		if (delta == FIntVector(-1, 0, 0))
+			return !fromGrid.HasWestWall() && !toGrid.HasEastWall();
+		if (delta == FIntVector(0, 1, 0))
+			return !fromGrid.HasSouthWall() && !toGrid.HasNorthWall();
+		if (delta == FIntVector(0, -1, 0))
+			return !fromGrid.HasNorthWall() && !toGrid.HasSouthWall();
+		return false;
+	}
+
+	/*
+	 * 壁にも段差にも遮られない、最も長い水平な直線の始点と終点を目の高さで求めます
+	 */
+	bool FindLongestStraightPath(const FDungeonAutomationTestWorld& testWorld, FVector& outStart, FVector& outEnd)
+	{
+		const std::shared_ptr<const dungeon::Generator> generator = testWorld.GetGenerator();
+		const UDungeonGenerateParameter* parameter = testWorld.GetParameter();
+		if (generator == nullptr || generator->GetVoxel() == nullptr || !IsValid(parameter))
+			return false;
+		const dungeon::Voxel& voxel = *generator->GetVoxel();
+
+		FIntVector bestStart;
+		FIntVector bestEnd;
+		int32 bestLength = 0;
+		voxel.Each([&voxel, &bestStart, &bestEnd, &bestLength](const FIntVector& location, const dungeon::Grid& grid)
+			{
+				if (!IsWalkableGrid(grid))
+					return true;
+
+				for (const FIntVector& step : { FIntVector(1, 0, 0), FIntVector(0, 1, 0) })
+				{
+					// 直線の始点からだけ数える
+					if (IsWalkOpen(voxel, location - step, location))
+						continue;
+
+					FIntVector end = location;
+					int32 length = 1;
+					while (IsWalkOpen(voxel, end, end + step))
+					{
+						end += step;
+						++length;
+					}
+					if (bestLength < length)
+					{
+						bestLength = length;
+						bestStart = location;
+						bestEnd = end;
+					}
+				}
+				return true;
+			}
+		);
+		if (bestLength < 2)
+			return false;
+
+		const FVector gridSize = parameter->GetGridSize().To3D();
+		const FVector centerOffset(gridSize.X * 0.5, gridSize.Y * 0.5, gridSize.Z * 0.5);
+		outStart = parameter->ToWorld(bestStart) + centerOffset;
+		outEnd = parameter->ToWorld(bestEnd) + centerOffset;
+		return true;
+	}
+
+	FDungeonLoadControlSimulator::FSettings MakeSettings(const TArray<FVector>& viewerPath)
+	{
+		double length = 0.0;
+		for (int32 i = 1; i < viewerPath.Num(); ++i)
+			length += FVector::Distance(viewerPath[i - 1], viewerPath[i]);
+
+		FDungeonLoadControlSimulator::FSettings settings;
+		settings.ViewerPaths.Add(viewerPath);
+		settings.DeltaSeconds = DeltaSeconds;
+		settings.PawnSpeed = PawnSpeed;
+		settings.Prefetch = 1;
+		settings.PrefetchSeconds = PrefetchSeconds;
+		settings.TransitionBudgetMilliseconds = 0.f;
+		settings.MaxActivationsPerFrame = 0;
+		settings.MaxInactivationsPerFrame = 0;
+		// 終点で止まった後も、最後の予測の当たり外れが決まるまで続けます
+		settings.FrameCount = FMath::CeilToInt32(length / FrameStep) + FMath::CeilToInt32(PrefetchSeconds / DeltaSeconds) + 2;
+		return settings;
+	}
+
+	/*
+	 * 予測したフレームの視点から、経路が曲がるか終わるまでの距離を求めます。
+	 * ポーンはMarkの前に移動するので、フレームnまでに(n+1)フレーム分進んでいます。
+	 */
+	double GetDistanceToNextWaypoint(const TArray<FVector>& viewerPath, const FDungeonLoadControlSimulator::FPrediction& prediction)
+	{
+		double travelled = static_cast<double>(prediction.Frame + 1) * FrameStep;
+		for (int32 i = 1; i < viewerPath.Num(); ++i)
+		{
+			const double length = FVector::Distance(viewerPath[i - 1], viewerPath[i]);
+			if (travelled < length)
+				return length - travelled;
+			travelled -= length;
+		}
+		return 0.0;
+	}
+
+	/*
+	 * 経路が曲がるか終わるまでに先読みの距離が残っている予測は、予測した位置まで直進するので必ず当たります。
+	 * それ以外の予測だけが外れてよいので、当たるべき予測の数と外れた予測の数を返します。
+	 */
+	void CheckPredictions(FAutomationTestBase& test, const TArray<FVector>& viewerPath, const FDungeonLoadControlSimulator& simulator, int32& outExpectedHitCount, int32& outMissCount)
+	{
+		outExpectedHitCount = 0;
+		outMissCount = 0;
+		for (const FDungeonLoadControlSimulator::FPrediction& prediction : simulator.GetPredictions())
+		{
+			const double distance = GetDistanceToNextWaypoint(viewerPath, prediction);
+			const bool expectedHit = distance >= Reach + FrameStep;
+			if (expectedHit)
+				++outExpectedHitCount;
+			if (!prediction.Hit)
+			{
+				++outMissCount;
+				if (expectedHit)
+					test.AddError(FString::Printf(TEXT("Prediction of partition %d at frame %d (%s) missed %f cm before the next waypoint"),
+						prediction.PartitionIndex, prediction.Frame, *prediction.Location.ToString(), distance));
+			}
+		}
+	}
+}
+
+/*
+ * 固定の乱数の種で生成したダンジョンの最も長い直線を進むと、先読みの予測は全て当たります
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonPartitionPrefetchStraightTest, "DungeonGenerator.MainLevel.Prefetch.Straight",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonPartitionPrefetchStraightTest::RunTest(const FString& Parameters)
+{
+	FDungeonAutomationTestWorld testWorld;
+	if (!TestNotNull(TEXT("Generated dungeon"), testWorld.Generate(RandomSeed)))
+		return false;
+
+	FVector start;
+	FVector end;
+	if (!TestTrue(TEXT("Found a straight path"), FindLongestStraightPath(testWorld, start, end)))
+		return false;
+	const TArray<FVector> viewerPath = { start, end };
+
+	FDungeonLoadControlSimulator simulator(testWorld.GetLevelScriptActor());
+	if (!TestTrue(TEXT("Simulation ran"), simulator.Run(MakeSettings(viewerPath))))
+		return false;
+	simulator.Report(*GLog);
+
+	int32 expectedHitCount;
+	int32 missCount;
+	CheckPredictions(*this, viewerPath, simulator, expectedHitCount, missCount);
+	TestTrue(TEXT("The path has predictions that must hit"), expectedHitCount > 0);
+	TestEqual(TEXT("Misses"), missCount, 0);
+	return true;
+}
+
+/*
+ * 直線の途中で引き返すと、引き返す地点の先を予測した分だけ外れます
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonPartitionPrefetchReverseTest, "DungeonGenerator.MainLevel.Prefetch.Reverse",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonPartitionPrefetchReverseTest::RunTest(const FString& Parameters)
+{
+	FDungeonAutomationTestWorld testWorld;
+	if (!TestNotNull(TEXT("Generated dungeon"), testWorld.Generate(RandomSeed)))
+		return false;
+
+	FVector start;
+	FVector end;
+	if (!TestTrue(TEXT("Found a straight path"), FindLongestStraightPath(testWorld, start, end)))
+		return false;
+
+	// 引き返す直前の予測が引き返す地点とは別のパーティションを指す地点を選びます。
+	// パーティションは箱なので、そのパーティションには往路でも復路でも入りません。
+	const ADungeonMainLevelScriptActor* levelScriptActor = testWorld.GetLevelScriptActor();
+	const FVector direction = (end - start).GetSafeNormal();
+	const double length = FVector::Distance(start, end);
+	FVector turn = FVector::ZeroVector;
+	bool foundTurn = false;
+	for (double distance = Reach + FrameStep; distance + Reach <= length; distance += FrameStep)
+	{
+		const FVector candidate = start + direction * distance;
+		const UDungeonPartition* beyond = levelScriptActor->Find(candidate + direction * Reach);
+		if (beyond != nullptr && beyond != levelScriptActor->Find(candidate) && beyond == levelScriptActor->Find(candidate + direction * (Reach - FrameStep)))
+		{
+			turn = candidate;
+			foundTurn = true;
+			break;
+		}
+	}
+	if (!TestTrue(TEXT("Found a turning point before a partition boundary"), foundTurn))
+		return false;
+	const TArray<FVector> viewerPath = { start, turn, start };
+
+	FDungeonLoadControlSimulator simulator(testWorld.GetLevelScriptActor());
+	if (!TestTrue(TEXT("Simulation ran"), simulator.Run(MakeSettings(viewerPath))))
+		return false;
+	simulator.Report(*GLog);
+
+	int32 expectedHitCount;
+	int32 missCount;
+	CheckPredictions(*this, viewerPath, simulator, expectedHitCount, missCount);
+	TestTrue(TEXT("The prediction beyond the turning point missed"), missCount > 0);
+	return true;
+}
+
+#endif
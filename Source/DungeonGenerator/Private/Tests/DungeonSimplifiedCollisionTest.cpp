@@ -0,0 +1,221 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include "Tests/DungeonAutomationTestWorld.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "DungeonGenerateActor.h"
+#include "DungeonSimplifiedCollisionComponent.h"
+#include "Parameter/DungeonGenerateParameter.h"
+#include "Core/Generator.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+#include <Engine/World.h>
+#include <EngineUtils.h>
+#include <Misc/AutomationTest.h>
+
+namespace
+{
+	constexpr int32 RandomSeed = 12345;
+	constexpr float DeltaSeconds = 1.f / 60.f;
+	// 箱はグリッドの外側に置き、タイルの面はメッシュによって境界から少しずれるので、
+	// 当たった位置のずれがグリッドの大きさのこの割合以内なら同じ面とみなします
+	constexpr double HitDistanceToleranceRatio = 0.1;
+	// 歩ける空間を調べる箱の半分の大きさのグリッドの大きさに対する割合
+	constexpr double OverlapExtentRatio = 0.3;
+	constexpr int32 MaxReportedMismatchCount = 20;
+
+	const FVector TraceDirections[] = {
+		FVector(1, 0, 0), FVector(-1, 0, 0),
+		FVector(0, 1, 0), FVector(0, -1, 0),
+		FVector(0, 0, 1), FVector(0, 0, -1)
+	};
+
+	/*
+	 * 生成で当たり判定を無効にしたタイルと簡略化したコリジョンを切り替えます
+	 */
+	class FCollisionSets final
+	{
+	public:
+		explicit FCollisionSets(UWorld* world)
+			: mWorld(world)
+		{
+			for (TActorIterator<AActor> iterator(world); iterator; ++iterator)
+			{
+				TInlineComponentArray<UPrimitiveComponent*> components(*iterator);
+				for (UPrimitiveComponent* component : components)
+				{
+					if (Cast<UDungeonSimplifiedCollisionComponent>(component))
+						mSimplifiedCollisions.Add(component);
+					else if (component->ComponentHasTag(ADungeonGenerateBase::GetDungeonGeneratorTerrainTag()) && component->GetCollisionEnabled() == ECollisionEnabled::NoCollision)
+						mReplacedTiles.Add(component);
+				}
+			}
+		}
+
+		int32 GetSimplifiedCollisionCount() const noexcept
+		{
+			return mSimplifiedCollisions.Num();
+		}
+
+		int32 GetReplacedTileCount() const noexcept
+		{
+			return mReplacedTiles.Num();
+		}
+
+		void SelectTiles()
+		{
+			for (UPrimitiveComponent* component : mSimplifiedCollisions)
+				component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			for (UPrimitiveComponent* component : mReplacedTiles)
+				component->SetCollisionEnabled(CastChecked<UPrimitiveComponent>(component->GetArchetype())->GetCollisionEnabled());
+			Flush();
+		}
+
+		void SelectSimplifiedCollision()
+		{
+			for (UPrimitiveComponent* component : mReplacedTiles)
+				component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+			for (UPrimitiveComponent* component : mSimplifiedCollisions)
+				component->SetCollisionEnabled(CastChecked<UPrimitiveComponent>(component->GetArchetype())->GetCollisionEnabled());
+			Flush();
+		}
+
+	private:
+		// 物理シーンに追加した剛体をクエリに反映させます
+		void Flush()
+		{
+			mWorld->Tick(LEVELTICK_All, DeltaSeconds);
+		}
+
+		UWorld* mWorld;
+		TArray<UPrimitiveComponent*> mSimplifiedCollisions;
+		TArray<UPrimitiveComponent*> mReplacedTiles;
+	};
+
+	struct FQueryResults final
+	{
+		// グリッドごとに方向の数だけ並べたトレースの距離（当たらなければ負）
+		TArray<double> TraceDistances;
+		TArray<bool> Overlaps;
+	};
+
+	/*
+	 * 簡略化したコリジョンが置き換える床を持つグリッドを集めます
+	 * スロープとキャットウォークは置き換えないので含めません
+	 */
+	TArray<FIntVector> CollectFloorGrids(const dungeon::Voxel& voxel)
+	{
+		TArray<FIntVector> locations;
+		voxel.Each([&locations](const FIntVector& location, const dungeon::Grid& grid)
+			{
+				if ((grid.IsKindOfRoomType() || grid.IsKindOfAisleType()) && !grid.CanBuildSlope() && grid.CanBuildFloor(true) && !grid.IsCatwalk())
+					locations.Add(location);
+				return true;
+			}
+		);
+		return locations;
+	}
+
+	/*
+	 * グリッドの中心から隣のグリッドの中心までの6方向のトレースと、グリッドの内側の重なりを調べます
+	 */
+	FQueryResults Query(const UWorld* world, const UDungeonGenerateParameter* parameter, const TArray<FIntVector>& locations)
+	{
+		const FVector gridSize = parameter->GetGridSize().To3D();
+		const FCollisionObjectQueryParams objectQueryParams(ECC_WorldStatic);
+		const FCollisionShape overlapShape = FCollisionShape::MakeBox(gridSize * OverlapExtentRatio);
+
+		FQueryResults results;
+		results.TraceDistances.Reserve(locations.Num() * UE_ARRAY_COUNT(TraceDirections));
+		results.Overlaps.Reserve(locations.Num());
+		for (const FIntVector& location : locations)
+		{
+			const FVector center = parameter->ToWorld(location) + gridSize * 0.5;
+			for (const FVector& direction : TraceDirections)
+			{
+				FHitResult hitResult;
+				const bool hit = world->LineTraceSingleByObjectType(hitResult, center, center + direction * gridSize, objectQueryParams);
+				results.TraceDistances.Add(hit ? hitResult.Distance : -1.0);
+			}
+			results.Overlaps.Add(world->OverlapAnyTestByObjectType(center, FQuat::Identity, objectQueryParams, overlapShape));
+		}
+		return results;
+	}
+}
+
+/*
+ * 固定の乱数の種で生成したダンジョンで、配置したタイルのコリジョンと簡略化したコリジョンに
+ * 同じトレースと重なりの判定を行い、結果が一致する事を確認します
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonSimplifiedCollisionTest, "DungeonGenerator.SimplifiedCollision.MatchesTiles",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonSimplifiedCollisionTest::RunTest(const FString& Parameters)
+{
+	FDungeonAutomationTestWorld testWorld;
+	if (!TestNotNull(TEXT("Generated dungeon"), testWorld.Generate(RandomSeed, true)))
+		return false;
+
+	const std::shared_ptr<const dungeon::Generator> generator = testWorld.GetGenerator();
+	const UDungeonGenerateParameter* parameter = testWorld.GetParameter();
+	if (!TestTrue(TEXT("Generator and parameter"), generator != nullptr && generator->GetVoxel() != nullptr && IsValid(parameter)))
+		return false;
+
+	FCollisionSets collisionSets(testWorld.GetWorld());
+	TestTrue(TEXT("Simplified collision was generated"), collisionSets.GetSimplifiedCollisionCount() > 0);
+	if (!TestTrue(TEXT("Tiles were replaced by simplified collision"), collisionSets.GetReplacedTileCount() > 0))
+		return false;
+
+	const TArray<FIntVector> locations = CollectFloorGrids(*generator->GetVoxel());
+	if (!TestTrue(TEXT("Floor grids"), locations.Num() > 0))
+		return false;
+
+	collisionSets.SelectTiles();
+	const FQueryResults tileResults = Query(testWorld.GetWorld(), parameter, locations);
+	collisionSets.SelectSimplifiedCollision();
+	const FQueryResults simplifiedResults = Query(testWorld.GetWorld(), parameter, locations);
+
+	const FVector gridSize = parameter->GetGridSize().To3D();
+	int32 tileHitCount = 0;
+	int32 traceMismatchCount = 0;
+	int32 overlapMismatchCount = 0;
+	const int32 directionCount = UE_ARRAY_COUNT(TraceDirections);
+	for (int32 index = 0; index < locations.Num(); ++index)
+	{
+		for (int32 directionIndex = 0; directionIndex < directionCount; ++directionIndex)
+		{
+			const int32 resultIndex = index * directionCount + directionIndex;
+			const double tileDistance = tileResults.TraceDistances[resultIndex];
+			const double simplifiedDistance = simplifiedResults.TraceDistances[resultIndex];
+			tileHitCount += tileDistance >= 0.0;
+
+			const FVector& direction = TraceDirections[directionIndex];
+			const double tolerance = FMath::Abs(direction.Dot(gridSize)) * HitDistanceToleranceRatio;
+			const bool matched = (tileDistance < 0.0) == (simplifiedDistance < 0.0) &&
+				(tileDistance < 0.0 || FMath::Abs(tileDistance - simplifiedDistance) <= tolerance);
+			if (!matched && traceMismatchCount++ < MaxReportedMismatchCount)
+			{
+				AddError(FString::Printf(TEXT("Trace from grid %s toward %s: tiles %f, simplified collision %f"),
+					*locations[index].ToString(), *direction.ToString(), tileDistance, simplifiedDistance));
+			}
+		}
+
+		if (tileResults.Overlaps[index] != simplifiedResults.Overlaps[index] && overlapMismatchCount++ < MaxReportedMismatchCount)
+		{
+			AddError(FString::Printf(TEXT("Overlap inside grid %s: tiles %d, simplified collision %d"),
+				*locations[index].ToString(), static_cast<int32>(tileResults.Overlaps[index]), static_cast<int32>(simplifiedResults.Overlaps[index])));
+		}
+	}
+
+	// 何にも当たらなければ比較にならない
+	TestTrue(TEXT("Traces hit the tiles"), tileHitCount > 0);
+	TestEqual(TEXT("Trace mismatches"), traceMismatchCount, 0);
+	TestEqual(TEXT("Overlap mismatches"), overlapMismatchCount, 0);
+	return true;
+}
+
+#endif
@@ -0,0 +1,207 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#include <CoreMinimal.h>
+
+#if WITH_DEV_AUTOMATION_TESTS
+#include "Core/Generator.h"
+#include "Core/GenerateParameter.h"
+#include "Core/Math/Random.h"
+#include "Core/Voxelization/Grid.h"
+#include "Core/Voxelization/Voxel.h"
+#include <Misc/AutomationTest.h>
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace
+{
+	constexpr int32 PairCount = 4096;
+	constexpr int32 MaxPairDistance = 24;
+
+	std::shared_ptr<const dungeon::Generator> GenerateDungeon(const uint32_t seed)
+	{
+		dungeon::GenerateParameter parameter;
+		parameter.GetRandom()->SetSeed(seed);
+		parameter.SetNumberOfCandidateRooms(24);
+		parameter.SetNumberOfCandidateFloors(3);
+		parameter.SetMinRoomWidth(3);
+		parameter.SetMaxRoomWidth(8);
+		parameter.SetMinRoomDepth(3);
+		parameter.SetMaxRoomDepth(8);
+		parameter.SetMinRoomHeight(2);
+		parameter.SetMaxRoomHeight(4);
+		parameter.SetHorizontalRoomMargin(2);
+		parameter.SetVerticalRoomMargin(1);
+		parameter.SetMissionGraph(false);
+		parameter.SetExpansionPolicy(dungeon::ExpansionPolicy::ExpandHorizontally);
+
+		auto generator = std::make_shared<dungeon::Generator>();
+		generator->Generate(parameter);
+		if (generator->GetLastError() != dungeon::Generator::Error::Success || generator->GetVoxel() == nullptr)
+			return nullptr;
+		return generator;
+	}
+
+	bool IsTransitionOpen(const dungeon::Voxel& voxel, const FIntVector& from, const FIntVector& to)
+	{
+		const auto isTraversable = [](const dungeon::Grid& grid)
+			{
+				return grid.IsKindOfRoomType() || grid.IsKindOfAisleType() || grid.IsKindOfSlopeType();
+			};
+		if (!voxel.Contain(from) || !voxel.Contain(to))
+			return false;
+		const dungeon::Grid& fromGrid = voxel.Get(from);
+		const dungeon::Grid& toGrid = voxel.Get(to);
+		if (!isTraversable(fromGrid) || !isTraversable(toGrid))
+			return false;
+
+		const FIntVector delta = to - from;
+		if (delta == FIntVector(1, 0, 0))
+			return !fromGrid.HasEastWall() && !toGrid.HasWestWall();
+		if (delta == FIntVector(-1, 0, 0))
+			return !fromGrid.HasWestWall() && !toGrid.HasEastWall();
+		if (delta == FIntVector(0, 1, 0))
+			return !fromGrid.HasSouthWall() && !toGrid.HasNorthWall();
+		if (delta == FIntVector(0, -1, 0))
+			return !fromGrid.HasNorthWall() && !toGrid.HasSouthWall();
+		if (delta == FIntVector(0, 0, 1))
+			return !fromGrid.HasCeiling() && !toGrid.HasFloor();
+		if (delta == FIntVector(0, 0, -1))
+			return !fromGrid.HasFloor() && !toGrid.HasCeiling();
+		return false;
+	}
+
+	/*
+	 * Voxel::TraceVisibilityとは独立した基準の実装です。
+	 * 線分が境界を越える時刻を全て列挙して並べ替えてから順に辿ります。
+	 * 時刻 (2k+1)/(2|delta|) は全軸の公倍数を分母にした整数で表すので、辺や頂点の通過も厳密に判定します。
+	 * 同時に越える軸はいずれかの順序で通過できれば通れるとみなします。
+	 */
+	bool ReferenceTraceVisibility(const dungeon::Voxel& voxel, const FIntVector& start, const FIntVector& goal)
+	{
+		if (!voxel.Contain(start) || !voxel.Contain(goal))
+			return false;
+
+		const FIntVector delta = goal - start;
+		int64 denominator = 2;
+		for (int32 axis = 0; axis < 3; ++axis)
+			denominator *= FMath::Max(1, FMath::Abs(delta[axis]));
+
+		// 境界を越える時刻と軸
+		TArray<TPair<int64, int32>> crossings;
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			const int32 count = FMath::Abs(delta[axis]);
+			for (int32 k = 0; k < count; ++k)
+				crossings.Emplace((2 * k + 1) * (denominator / (2 * count)), axis);
+		}
+		crossings.Sort([](const TPair<int64, int32>& l, const TPair<int64, int32>& r)
+			{
+				return l.Key != r.Key ? l.Key < r.Key : l.Value < r.Value;
+			}
+		);
+
+		FIntVector current = start;
+		for (int32 index = 0; index < crossings.Num();)
+		{
+			// 同じ時刻に越える軸をまとめる
+			std::vector<FIntVector> axisSteps;
+			const int64 time = crossings[index].Key;
+			for (; index < crossings.Num() && crossings[index].Key == time; ++index)
+			{
+				FIntVector axisStep = FIntVector::ZeroValue;
+				axisStep[crossings[index].Value] = delta[crossings[index].Value] > 0 ? 1 : -1;
+				axisSteps.push_back(axisStep);
+			}
+
+			const auto less = [](const FIntVector& l, const FIntVector& r)
+				{
+					return std::tie(l.X, l.Y, l.Z) < std::tie(r.X, r.Y, r.Z);
+				};
+			std::sort(axisSteps.begin(), axisSteps.end(), less);
+			bool open = false;
+			do
+			{
+				FIntVector cell = current;
+				open = true;
+				for (const FIntVector& axisStep : axisSteps)
+				{
+					if (!IsTransitionOpen(voxel, cell, cell + axisStep))
+					{
+						open = false;
+						break;
+					}
+					cell += axisStep;
+				}
+			} while (!open && std::next_permutation(axisSteps.begin(), axisSteps.end(), less));
+			if (!open)
+				return false;
+
+			for (const FIntVector& axisStep : axisSteps)
+				current += axisStep;
+		}
+
+		return current == goal;
+	}
+}
+
+/*
+ * 固定の乱数の種で生成したダンジョンで、Voxel::TraceVisibilityが基準の実装と一致して対称であることを確認します
+ */
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FDungeonVoxelTraceVisibilityTest, "DungeonGenerator.Core.Voxel.TraceVisibility",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+bool FDungeonVoxelTraceVisibilityTest::RunTest(const FString& Parameters)
+{
+	for (const uint32_t seed : { 1u, 2u, 3u })
+	{
+		const auto generator = GenerateDungeon(seed);
+		if (!TestNotNull(FString::Printf(TEXT("Generated dungeon for seed %u"), seed), generator.get()))
+			continue;
+		const dungeon::Voxel& voxel = *generator->GetVoxel();
+
+		std::vector<FIntVector> cells;
+		voxel.Each([&cells](const FIntVector& location, const dungeon::Grid& grid)
+			{
+				if (grid.IsKindOfRoomType() || grid.IsKindOfAisleType() || grid.IsKindOfSlopeType())
+					cells.push_back(location);
+				return true;
+			}
+		);
+		if (!TestTrue(FString::Printf(TEXT("Traversable cells for seed %u"), seed), cells.size() >= 2))
+			continue;
+
+		dungeon::Random random(seed);
+		int32 pairCount = 0;
+		int32 visibleCount = 0;
+		for (int32 attempt = 0; pairCount < PairCount && attempt < 1000000; ++attempt)
+		{
+			const FIntVector& start = cells[random.Get<size_t>(cells.size())];
+			const FIntVector& goal = cells[random.Get<size_t>(cells.size())];
+			if ((goal - start).GetAbsMax() > MaxPairDistance)
+				continue;
+			++pairCount;
+
+			const bool result = voxel.TraceVisibility(start, goal);
+			const bool reference = ReferenceTraceVisibility(voxel, start, goal);
+			visibleCount += result;
+			if (result != reference)
+				AddError(FString::Printf(TEXT("Seed %u: trace %s -> %s is %d, the reference is %d"), seed, *start.ToString(), *goal.ToString(), static_cast<int32>(result), static_cast<int32>(reference)));
+			if (result != voxel.TraceVisibility(goal, start))
+				AddError(FString::Printf(TEXT("Seed %u: trace %s -> %s is not symmetric"), seed, *start.ToString(), *goal.ToString()));
+		}
+
+		TestEqual(FString::Printf(TEXT("Pairs for seed %u"), seed), pairCount, PairCount);
+		// 全て遮られる、または全て見える結果では検証にならない
+		TestTrue(FString::Printf(TEXT("Some pairs are visible for seed %u"), seed), visibleCount > 0);
+		TestTrue(FString::Printf(TEXT("Some pairs are blocked for seed %u"), seed), visibleCount < pairCount);
+	}
+	return true;
+}
+
+#endif
@@ -0,0 +1,40 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <Commandlets/Commandlet.h>
+#include "DungeonCoreBenchmarkCommandlet.generated.h"
+
+/**
+ * Measures the building blocks of the core generator with fixed seeds and reports ns/op and allocations/op.
+ * Each optimization of a core class can be judged in isolation rather than through whole-dungeon timings.
+ *
+ * コア生成器の部品を固定の乱数の種で計測し、ns/opとallocations/opを出力します
+ * ダンジョン全体の生成時間ではなく、コアのクラス毎に最適化の効果を判断できます
+ *
+ * UnrealEditor-Cmd <Project> -run=DungeonCoreBenchmark [-Filter=<name>] [-Output=<csv>] -nullrhi
+ */
+UCLASS()
+class DUNGEONGENERATOR_API UDungeonCoreBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	explicit UDungeonCoreBenchmarkCommandlet(const FObjectInitializer& initializer);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	virtual ~UDungeonCoreBenchmarkCommandlet() override = default;
+
+	// UCommandlet overrides
+	virtual int32 Main(const FString& Params) override;
+};
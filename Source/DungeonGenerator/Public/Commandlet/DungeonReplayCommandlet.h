@@ -0,0 +1,40 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <Commandlets/Commandlet.h>
+#include "DungeonReplayCommandlet.generated.h"
+
+/**
+ * Re-runs a generation captured with DungeonGenerator.ReplayCapture and reports per-phase time and memory.
+ * Add -trace=cpu to record the run with Unreal Insights.
+ *
+ * DungeonGenerator.ReplayCaptureで記録した生成を再実行し、フェーズ毎の時間とメモリを出力します
+ * -trace=cpuを追加するとUnreal Insightsで記録できます
+ *
+ * UnrealEditor-Cmd <Project> -run=DungeonReplay -Replay=<file> [-Repeat=<count>] -nullrhi
+ */
+UCLASS()
+class DUNGEONGENERATOR_API UDungeonReplayCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	explicit UDungeonReplayCommandlet(const FObjectInitializer& initializer);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	virtual ~UDungeonReplayCommandlet() override = default;
+
+	// UCommandlet overrides
+	virtual int32 Main(const FString& Params) override;
+};
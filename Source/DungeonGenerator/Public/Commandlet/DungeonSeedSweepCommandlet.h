@@ -0,0 +1,42 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <Commandlets/Commandlet.h>
+#include "DungeonSeedSweepCommandlet.generated.h"
+
+/**
+ * Generates a range of random seeds with the core generator only and writes the results to a CSV file.
+ * No world is built, so it can be run with -nullrhi on a build machine.
+ *
+ * コアの生成器だけで乱数の種の範囲を生成し、結果をCSVファイルに出力します
+ * ワールドを構築しないため、ビルドマシン上で-nullrhiを指定して実行できます
+ * -ValidateCollisionを指定すると、ボクセルから求めた床、壁、天井の面を簡略化したコリジョンの箱が過不足なく覆っているか検証します
+ * 配置したタイルのコリジョンとの比較はDungeonGenerator.SimplifiedCollisionの自動テストで行います
+ *
+ * UnrealEditor-Cmd <Project> -run=DungeonSeedSweep -Parameter=/Game/Path/Asset -SeedStart=1 -SeedCount=1000 [-Output=<csv>] [-SingleThread] [-ValidateCollision] -nullrhi
+ */
+UCLASS()
+class DUNGEONGENERATOR_API UDungeonSeedSweepCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	explicit UDungeonSeedSweepCommandlet(const FObjectInitializer& initializer);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	virtual ~UDungeonSeedSweepCommandlet() override = default;
+
+	// UCommandlet overrides
+	virtual int32 Main(const FString& Params) override;
+};
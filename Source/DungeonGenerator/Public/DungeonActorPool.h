@@ -0,0 +1,132 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include "DungeonActorPool.generated.h"
+
+class AStaticMeshActor;
+class UInstancedStaticMeshComponent;
+class UStaticMesh;
+
+/**
+ * Pooled static mesh actors that share a mesh
+ * 同じメッシュを持つプール中のStaticMeshActor
+ */
+USTRUCT()
+struct FDungeonPooledStaticMeshActors final
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<AStaticMeshActor>> Actors;
+};
+
+/**
+ * Pooled instanced static mesh components that share a mesh
+ * 同じメッシュを持つプール中のInstancedStaticMeshComponent
+ */
+USTRUCT()
+struct FDungeonPooledInstancedStaticMeshComponents final
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UInstancedStaticMeshComponent>> Components;
+};
+
+/**
+ * Keeps terrain actors and instanced mesh components between dungeon regenerations.
+ * Objects released on disposal are hidden and reused by the next generation
+ * instead of being destroyed and spawned again. Objects left over after
+ * generation are destroyed a few at a time with Trim.
+ *
+ * ダンジョンの再生成の間で地形のアクターとインスタンスメッシュコンポーネントを保持します。
+ * 破棄時に返却されたオブジェクトは非表示になり、破棄と再スポーンの代わりに次の生成で再利用されます。
+ * 生成後に余ったオブジェクトはTrimで少しずつ破棄されます。
+ */
+USTRUCT()
+struct FDungeonActorPool final
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * StaticMeshActorをプールに返却します
+	 * 再利用できないアクター（派生クラスや生成時に作ったメッシュを持つアクター）は返却しません
+	 *
+	 * @return		返却できたらtrue
+	 */
+	bool ReleaseStaticMeshActor(AStaticMeshActor* actor);
+
+	/**
+	 * 指定メッシュのStaticMeshActorをプールから取り出します
+	 * 取り出したアクターは非表示のままなので、呼び出し元で配置してから表示して下さい
+	 *
+	 * @return		プールに無ければnullptr
+	 */
+	AStaticMeshActor* AcquireStaticMeshActor(const UStaticMesh* staticMesh);
+
+	/**
+	 * インスタンスを全て消してInstancedStaticMeshComponentをプールに返却します
+	 *
+	 * @return		返却できたらtrue
+	 */
+	bool ReleaseInstancedStaticMeshComponent(UInstancedStaticMeshComponent* component);
+
+	/**
+	 * 指定メッシュのInstancedStaticMeshComponentをプールから取り出します
+	 *
+	 * @param[in]	staticMesh		メッシュ
+	 * @param[in]	hierarchical	HierarchicalInstancedStaticMeshComponentを取り出すならtrue
+	 * @return		プールに無ければnullptr
+	 */
+	UInstancedStaticMeshComponent* AcquireInstancedStaticMeshComponent(const UStaticMesh* staticMesh, const bool hierarchical);
+
+	/**
+	 * 予算の範囲でプール中のオブジェクトを破棄します
+	 *
+	 * @param[in]	budgetSeconds	破棄に使う秒数（最低一つは破棄します）
+	 */
+	void Trim(const double budgetSeconds);
+
+	/**
+	 * プール中の全てのオブジェクトを破棄します
+	 */
+	void DestroyAll();
+
+	/**
+	 * プール中のオブジェクトの数
+	 */
+	int32 Num() const noexcept;
+
+	/**
+	 * 確保しているバイト数を取得します
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	using ComponentMap = TMap<TObjectPtr<UStaticMesh>, FDungeonPooledInstancedStaticMeshComponents>;
+
+	UInstancedStaticMeshComponent* AcquireInstancedStaticMeshComponent(ComponentMap& componentMap, const UStaticMesh* staticMesh);
+	bool TrimOne();
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UStaticMesh>, FDungeonPooledStaticMeshActors> mStaticMeshActors;
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UStaticMesh>, FDungeonPooledInstancedStaticMeshComponents> mInstancedStaticMeshComponents;
+
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UStaticMesh>, FDungeonPooledInstancedStaticMeshComponents> mHierarchicalInstancedStaticMeshComponents;
+
+	int32 mNum = 0;
+};
+
+inline int32 FDungeonActorPool::Num() const noexcept
+{
+	return mNum;
+}
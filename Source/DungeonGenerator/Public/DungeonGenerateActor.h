@@ -7,11 +7,13 @@
 #pragma once
 #include "DungeonGenerateBase.h"
 #include "DungeonInstancedMeshCluster.h"
+#include "DungeonMergedMeshCluster.h"
 #include "DungeonGenerateActor.generated.h"
 
 class CDungeonGeneratorCore;
 class UDungeonGenerateParameter;
 class UDungeonMiniMapTextureLayer;
+class UDungeonSimplifiedCollisionComponent;
 class ADungeonSubLevelScriptActor;
 class UInstancedStaticMeshComponent;
 class UHierarchicalInstancedStaticMeshComponent;
@@ -21,6 +23,9 @@ namespace dungeon
 	class Room;
 }
 
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FDungeonGenerateActorInstancedMeshReadySignature);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FDungeonGenerateActorNavigationReadySignature);
+
 /**
  * Mesh generation method
  * メッシュの生成方法
@@ -30,7 +35,30 @@ enum class EDungeonMeshGenerationMethod : uint8
 {
 	StaticMesh UMETA(DisplayName = "Static Mesh", ToolTip = "Spawn individual static mesh components."),
 	InstancedStaticMesh UMETA(DisplayName = "Instanced Static Mesh", ToolTip = "Use instanced static mesh components."),
-	HierarchicalInstancedStaticMesh UMETA(DisplayName = "Hierarchical Instanced Static Mesh", ToolTip = "Use hierarchical instanced static mesh components.")
+	HierarchicalInstancedStaticMesh UMETA(DisplayName = "Hierarchical Instanced Static Mesh", ToolTip = "Use hierarchical instanced static mesh components."),
+	MergedStaticMesh UMETA(DisplayName = "Merged Static Mesh", ToolTip = "Merge the tiles of each room and aisle into one static mesh actor. The merge runs synchronously on the game thread during generation. Packaged builds need Allow CPU Access on the tile meshes.")
+};
+
+/**
+ * How the navigation mesh is rebuilt after generation
+ * 生成後のナビゲーションメッシュの再構築方法
+ */
+UENUM()
+enum class EDungeonNavigationBuildMethod : uint8
+{
+	FitBoundsVolume UMETA(DisplayName = "Fit Bounds Volume", ToolTip = "Fit the NavMeshBoundsVolume to the dungeon every generation and rebuild every tile inside it."),
+	DirtyOccupiedTiles UMETA(DisplayName = "Dirty Occupied Tiles", ToolTip = "Keep the NavMeshBoundsVolume while it covers the dungeon and asynchronously rebuild only the tiles overlapping floor, slope and stair grids.")
+};
+
+/**
+ * How players entering and leaving rooms are detected
+ * 部屋への入室と退室の検出方法
+ */
+UENUM()
+enum class EDungeonRoomOccupancyMethod : uint8
+{
+	Overlap UMETA(DisplayName = "Overlap", ToolTip = "Each room sensor detects pawns with the overlap events of its box collision."),
+	VoxelLookup UMETA(DisplayName = "Voxel Lookup", ToolTip = "Look up the room of every player pawn in the generated voxel once per tick and disable the box collision of room sensors.")
 };
 
 /**
@@ -69,6 +97,15 @@ public:
 	UFUNCTION(Server, Reliable, BlueprintCallable, Category = "DungeonGenerator")
 	void GenerateDungeonWithParameter(UDungeonGenerateParameter* dungeonGenerateParameter);
 
+	/**
+	 * Regenerate the dungeon, keeping terrain actors and instanced mesh instances of grids that did not change.
+	 * Merged static meshes are always rebuilt.
+	 * ダンジョンを再生成し、変化しなかったグリッドの地形アクターとインスタンスメッシュのインスタンスをそのまま使います。
+	 * 結合したスタティックメッシュは常に作り直します。
+	 */
+	UFUNCTION(Server, Reliable, BlueprintCallable, Category = "DungeonGenerator")
+	void RegenerateDungeonIncrementally(UDungeonGenerateParameter* dungeonGenerateParameter);
+
 protected:
 	/**
 	 * Multicast dungeon generation to all clients
@@ -77,6 +114,13 @@ protected:
 	UFUNCTION(NetMulticast, Reliable, Category = "DungeonGenerator")
 	void MulticastOnGenerateDungeon();
 
+	/**
+	 * Multicast incremental dungeon regeneration to all clients
+	 * インクリメンタルなダンジョンの再生成を全クライアントにマルチキャストします
+	 */
+	UFUNCTION(NetMulticast, Reliable, Category = "DungeonGenerator")
+	void MulticastOnRegenerateDungeonIncrementally();
+
 public:
 	/**
 	 * Destroy dungeon
@@ -130,6 +174,48 @@ public:
 	 */
 	void SetInstancedMeshCullDistance(const FInt32Interval& cullDistance);
 
+	/**
+	 * Aligns the instanced mesh clusters to the partition cells and registers each cluster with its partition.
+	 * Clusters are regrouped only when the cells differ from the ones used when the instances were added.
+	 *
+	 * インスタンスメッシュのクラスターをパーティションのセルに揃えて、クラスター毎にパーティションへ登録します。
+	 * インスタンスを登録した時と異なるセルの時だけクラスターを組み直します。
+	 * @param[in]	partitionOrigin		パーティションのセルの原点
+	 * @param[in]	partitionSize		パーティションのセルの大きさ
+	 */
+	void AlignInstancedMeshClustersToPartitions(const FVector& partitionOrigin, const FVector& partitionSize);
+
+	/**
+	 * Have all hierarchical instanced mesh trees finished building?
+	 * 全てのHierarchicalInstancedStaticMeshのツリーの構築が完了したか調べます
+	 */
+	UFUNCTION(BlueprintPure, Category = "DungeonGenerator")
+	bool IsInstancedMeshReady() const noexcept;
+
+	/**
+	 * Has the navigation mesh of the generated dungeon finished building?
+	 * 生成したダンジョンのナビゲーションメッシュの構築が完了したか調べます
+	 */
+	UFUNCTION(BlueprintPure, Category = "DungeonGenerator|Navigation")
+	bool IsNavigationReady() const noexcept;
+
+	/**
+	 * Rebuilds the navigation mesh tiles overlapping floor, slope and stair grids inside the bounds.
+	 * Call this after changing a room, passing the bounds of the room.
+	 * OnNavigationReady is notified again when the rebuild finishes.
+	 *
+	 * 範囲内の床、スロープ、階段のグリッドに重なるナビゲーションメッシュのタイルを再構築します
+	 * 部屋を変更した後に部屋の範囲を渡して呼び出して下さい。
+	 * 再構築が完了するとOnNavigationReadyが再び通知されます。
+	 * @param[in]	bounds		ワールド座標の範囲
+	 */
+	UFUNCTION(BlueprintCallable, Category = "DungeonGenerator|Navigation")
+	void DirtyNavigationInBounds(const FBox& bounds);
+
+	// ADungeonGenerateBase overrides
+	virtual SIZE_T GetAllocatedSize() const override;
+	virtual void ReportAllocatedSize(FOutputDevice& outputDevice) const override;
+
 	// AActor overrides
 	virtual void PreInitializeComponents() override;
 	virtual void PostInitializeComponents() override;
@@ -143,16 +229,33 @@ private:
 	// ADungeonGenerateBase overrides
 	virtual void OnPreDungeonGeneration() override;
 	virtual void OnPostDungeonGeneration(const bool result) override;
+	virtual bool UseVoxelRoomOccupancy() const override;
 	virtual void Dispose(const bool flushStreamLevels) override;
 	virtual void FitNavMeshBoundsVolume() override;
 
-	static uint32 InstancedMeshHash(const FVector& position, const double quantizationSize = 50 * 100);
+	uint64 InstancedMeshClusterKey(const FVector& position) const;
+	FVector InstancedMeshClusterCenter(const uint64 key) const;
+	FVector ComputeInstancedMeshClusterSize() const;
+	void RegroupInstancedMeshClusters();
+	void ScheduleInstancedMeshTreeBuilds();
 	void BeginInstanceTransaction();
 	void AddInstance(UStaticMesh* staticMesh, const FTransform& transform, const EDungeonMeshGenerationMethod meshGenerationMethod);
 	void EndInstanceTransaction();
 	void DestroyAllInstance();
 	void ApplyInstancedMeshCullDistance();
-
+	void AddMergedMesh(UStaticMesh* staticMesh, const FTransform& transform);
+	void BuildMergedMeshes();
+	void ProcessInstancedMeshTreeBuilds();
+	void FinishInstancedMeshTreeBuilds();
+	bool ContainNavMeshBoundsVolume(const FBox& bounds) const;
+	int32 DirtyOccupiedNavigationTiles(const FBox& bounds);
+	void BeginNavigationBuild();
+	void ProcessNavigationBuild();
+	void CollectCollisionReplacedMeshes();
+	void BuildSimplifiedCollision();
+	void DestroySimplifiedCollision();
+
+	void GenerateImplementation(const bool incremental);
 	void PreGenerateImplementation();
 	void PostGenerateImplementation() const;
 
@@ -205,6 +308,95 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator")
 	EDungeonMeshGenerationMethod DungeonWallRoofPillarMeshGenerationMethod = EDungeonMeshGenerationMethod::HierarchicalInstancedStaticMesh;
 
+	/**
+	 * Size in grids of the 3D cells that group instanced meshes into clusters.
+	 * An axis of 0 uses 5 grids horizontally and the maximum room height vertically,
+	 * so that stacked floors are kept in separate clusters.
+	 * When the level script is ADungeonMainLevelScriptActor, the clusters are aligned to the partition cells instead
+	 * and each partition shows and hides its own clusters.
+	 *
+	 * インスタンスメッシュをクラスターにまとめる3次元セルのグリッド数です。
+	 * 0の軸は水平方向に5グリッド、垂直方向に部屋の最大の高さを使うので、
+	 * 重なった階は別のクラスターになります。
+	 * レベルスクリプトがADungeonMainLevelScriptActorの場合は、代わりにパーティションのセルに揃え、
+	 * パーティション毎に自分のクラスターを表示または非表示にします。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", AdvancedDisplay, meta = (ClampMin = "0"))
+	FIntVector InstancedMeshClusterGridSize = FIntVector::ZeroValue;
+
+	/**
+	 * Milliseconds per frame spent launching asynchronous tree builds of hierarchical instanced meshes.
+	 * At least one build is launched each frame.
+	 *
+	 * HierarchicalInstancedStaticMeshの非同期ツリー構築の開始に1フレームで使うミリ秒です。
+	 * 1フレームに少なくとも1つの構築を開始します。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DungeonGenerator", AdvancedDisplay, meta = (ClampMin = "0"))
+	float InstancedMeshTreeBuildBudgetMilliseconds = 2.f;
+
+	/**
+	 * If enabled, OnGenerationSuccess is broadcast after all hierarchical instanced mesh trees have been built.
+	 * If disabled, it is broadcast as soon as generation finishes, and the trees may still be building.
+	 *
+	 * 有効にすると、全てのHierarchicalInstancedStaticMeshのツリーの構築が終わってからOnGenerationSuccessを通知します。
+	 * 無効の場合は生成の完了時に通知するので、ツリーはまだ構築中の事があります。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DungeonGenerator", AdvancedDisplay)
+	bool NotifyGenerationSuccessAfterInstancedMeshReady = false;
+
+	/**
+	 * Replace the collision of floor, wall and ceiling tiles with boxes built from the voxel.
+	 * The boxes are merged per room and aisle and put on one component each. Slopes, catwalks and pillars keep their own collision.
+	 *
+	 * 床、壁、天井のタイルの当たり判定をボクセルから作った箱に置き換えます。
+	 * 箱は部屋と通路ごとにまとめて、それぞれ一つのコンポーネントに入れます。スロープ、キャットウォーク、柱は自身の当たり判定を使います。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator|Collision")
+	bool GenerateSimplifiedCollision = false;
+
+	/**
+	 * Thickness of the simplified collision boxes
+	 * 簡略化したコリジョンの箱の厚み
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator|Collision", meta = (EditCondition = "GenerateSimplifiedCollision", ClampMin = "1"))
+	float SimplifiedCollisionThickness = 20.f;
+
+	/**
+	 * Notification that all hierarchical instanced mesh trees have been built after generation.
+	 * It is broadcast after OnGenerationSuccess unless NotifyGenerationSuccessAfterInstancedMeshReady is enabled.
+	 *
+	 * 生成後に全てのHierarchicalInstancedStaticMeshのツリーの構築が完了した通知です。
+	 * NotifyGenerationSuccessAfterInstancedMeshReadyが無効ならOnGenerationSuccessより後に通知します。
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "DungeonGenerator|Event")
+	FDungeonGenerateActorInstancedMeshReadySignature OnInstancedMeshReady;
+
+	/**
+	 * How the navigation mesh is rebuilt after generation.
+	 * RuntimeGenerationMode of RecastNavMesh must be Dynamic.
+	 *
+	 * 生成後のナビゲーションメッシュの再構築方法です。
+	 * RecastNavMeshのRuntimeGenerationModeをDynamicにして下さい。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator|Navigation")
+	EDungeonNavigationBuildMethod NavigationBuildMethod = EDungeonNavigationBuildMethod::FitBoundsVolume;
+
+	/**
+	 * Notification that the navigation mesh has been built after generation or DirtyNavigationInBounds
+	 * 生成後またはDirtyNavigationInBounds後にナビゲーションメッシュの構築が完了した通知
+	 */
+	UPROPERTY(BlueprintAssignable, Category = "DungeonGenerator|Event")
+	FDungeonGenerateActorNavigationReadySignature OnNavigationReady;
+
+	/**
+	 * How players entering and leaving rooms are detected.
+	 * VoxelLookup follows the tick interval of this actor and has no room sensor margins.
+	 *
+	 * 部屋への入室と退室の検出方法です。
+	 * VoxelLookupはこのアクターのティック間隔で判定し、ルームセンサーのマージンは使いません。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator|RoomSensor")
+	EDungeonRoomOccupancyMethod RoomOccupancyMethod = EDungeonRoomOccupancyMethod::Overlap;
 
 	/**
 	 * build job tag
@@ -265,9 +457,51 @@ protected:
 	 * UInstancedStaticMeshComponentまたはUHierarchicalInstancedStaticMeshComponentのクラスターを管理します
 	 */
 	UPROPERTY(Transient)
-	TMap<uint32, FDungeonInstancedMeshCluster> mInstancedMeshCluster;
+	TMap<uint64, FDungeonInstancedMeshCluster> mInstancedMeshCluster;
+
+	/**
+	 * Tiles of each room or aisle waiting to be merged during generation
+	 * 生成中に結合を待っている部屋または通路ごとのタイル
+	 */
+	UPROPERTY(Transient)
+	TMap<uint64, FDungeonMergedMeshCluster> mMergedMeshCluster;
+
+	/**
+	 * Simplified collision of each room or aisle
+	 * 部屋または通路ごとの簡略化したコリジョン
+	 */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UDungeonSimplifiedCollisionComponent>> mSimplifiedCollisionComponents;
 
 private:
+	// インスタンスメッシュのクラスターのセルの原点と大きさ
+	FVector mInstancedMeshClusterOrigin = FVector::ZeroVector;
+	FVector mInstancedMeshClusterSize = FVector(25 * 100);
+	// クラスターのセルをパーティションのセルに揃えたか
+	bool mInstancedMeshClusterAlignedToPartition = false;
+	// インクリメンタルな再生成で再利用するので次のDisposeでクラスターを破棄しない
+	bool mRetainInstancedMeshClusters = false;
 	FInt32Interval mInstancedMeshCullDistance = { 0, 0};
+
+	// 簡略化したコリジョンに置き換えるので当たり判定を無効にするタイルのメッシュ
+	TSet<const UStaticMesh*> mCollisionReplacedMeshes;
+
+	// 簡略化したコリジョンの検証に使う置き換えたタイルのバウンディングボックス（ダンジョンの原点からの相対座標）
+	TArray<FBox> mCollisionReplacedTileBounds;
+
+	// ツリー構築の開始を待っているコンポーネント
+	TArray<TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent>> mPendingInstancedMeshTreeBuilds;
+	// 非同期でツリーを構築中のコンポーネント
+	TArray<TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent>> mBuildingInstancedMeshTrees;
+	float mDefaultTickInterval = 0.f;
+	// ナビゲーションメッシュの再構築を要求したフレーム
+	uint64 mNavigationBuildRequestFrame = 0;
+	bool mInstancedMeshReady = true;
+	// ツリーの構築が終わるまで遅らせている生成成功の通知
+	bool mGenerationSuccessDeferred = false;
+	bool mNavigationReady = true;
 	bool mIsGeneratingDungeon = false;
+
+	// friend class
+	friend class FDungeonAutomationTestWorld;
 };
@@ -22,6 +22,7 @@
 #include <unordered_map>
 #include <vector>
 
+#include "DungeonActorPool.h"
 #include "DungeonDeferredSpawnManager.h"
 #include "DungeonGenerateBase.generated.h"
 
@@ -35,8 +36,12 @@ class ADungeonGenerateBase;
 class UDungeonGenerateParameter;
 class UDungeonComponentActivatorComponent;
 class ANavMeshBoundsVolume;
+class FDungeonAssetPrefetcher;
+class FDungeonIncrementalRegeneration;
+class FDungeonRoomOccupancyTracker;
 class APlayerStart;
 class AStaticMeshActor;
+class UInstancedStaticMeshComponent;
 class ULevel;
 class ULevelStreamingDynamic;
 class UStaticMesh;
@@ -45,6 +50,7 @@ namespace dungeon
 {
 	class Identifier;
 	class Generator;
+	class GenerateReplay;
 	class Grid;
 	class Random;
 	class Room;
@@ -113,6 +119,7 @@ protected:
 	bool BeginDungeonGenerationPhase_InitializeCore(const dungeon::GenerateParameter& generateParameter);
 	bool BeginDungeonGenerationPhase_RunGenerator(dungeon::GenerateParameter& generateParameter, bool hasAuthority);
 	void BeginDungeonGenerationPhase_BuildWorld(const dungeon::GenerateParameter& generateParameter, bool hasAuthority);
+	void SaveGenerateReplay(const dungeon::GenerateReplay& replay, const double seconds) const;
 
 	/**
 	 * End Generate dungeon
@@ -132,6 +139,41 @@ public:
 	 */
 	virtual void Dispose(const bool flushStreamLevels);
 
+protected:
+	/**
+	 * Prepares the next generation to reuse terrain actors of unchanged grids.
+	 * Call this before Dispose. Terrain actors whose grid and neighbouring grids are
+	 * unchanged in the next generation are kept, the rest are discarded after generation.
+	 *
+	 * 次の生成で変化していないグリッドの地形アクターを再利用する準備をします。
+	 * Disposeの前に呼び出して下さい。次の生成でグリッドと隣のグリッドが変化していない
+	 * 地形アクターは残り、それ以外は生成後に破棄されます。
+	 * @return		前回の生成結果が無ければfalse
+	 */
+	bool BeginIncrementalRegeneration();
+
+	/**
+	 * Adds the instances of a terrain instanced mesh component as reuse candidates.
+	 * Call this after BeginIncrementalRegeneration and keep the component through Dispose.
+	 * Candidates that are not reused are removed from the component after generation.
+	 *
+	 * 地形のインスタンスメッシュコンポーネントのインスタンスを再利用の候補に追加します。
+	 * BeginIncrementalRegenerationの後に呼び出し、コンポーネントはDisposeで破棄せずに残して下さい。
+	 * 再利用されなかった候補は生成後にコンポーネントから取り除かれます。
+	 */
+	void AddIncrementalRegenerationCandidate(UInstancedStaticMeshComponent* component);
+
+	/**
+	 * Keeps an unchanged instance with the same mesh and transform instead of adding a new one
+	 * 新しく追加する代わりに、同じメッシュとトランスフォームを持つ変化していないインスタンスを残します
+	 * @return		再利用できるインスタンスが無ければfalse
+	 */
+	bool ReuseIncrementalRegenerationInstance(const UStaticMesh* staticMesh, const FTransform& transform, const bool hierarchical);
+
+private:
+	void FinishIncrementalRegeneration();
+
+public:
 	/**
 	 * Get start position
 	 */
@@ -188,7 +230,7 @@ private:
 	template<typename T = AActor> T* SpawnActorDeferredImpl(const FString& folderPath, const FTransform& transform, AActor* ownerActor, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod) const;
 	template<typename T = AActor> T* SpawnActorImpl(UClass* actorClass, const FString& folderPath, const FTransform& transform, AActor* ownerActor, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod) const;
 	template<typename T = AActor> T* SpawnActorDeferredImpl(UClass* actorClass, const FString& folderPath, const FTransform& transform, AActor* ownerActor, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod) const;
-	void DestroySpawnedActors() const;
+	void DestroySpawnedActors();
 
 protected:
 	static void DestroySpawnedActors(UWorld* world);
@@ -277,6 +319,8 @@ protected:
 	virtual void OnPreDungeonGeneration();
 	// dungeon::Generator::Generate後イベント
 	virtual void OnPostDungeonGeneration(const bool result);
+	// ルームセンサーのオーバーラップの代わりにボクセルで入室を判定するならtrue
+	virtual bool UseVoxelRoomOccupancy() const;
 
 	////////////////////////////////////////////////////////////////////////////
 	// Terrain
@@ -328,8 +372,10 @@ private:
 	void CreateImplement_AddChandelier(const RoomAndRoomSensorMap& roomSensorCache, const bool hasAuthority) const;
 
 	// Room sensor
+	void CreateImplement_PrefetchAssets(const bool hasAuthority);
 	void CreateImplement_PrepareSpawnRoomSensor(RoomAndRoomSensorMap& roomSensorCache, const bool hasAuthority) const;
 	static void CreateImplement_FinishSpawnRoomSensor(const RoomAndRoomSensorMap& roomSensorCache);
+	void CreateImplement_RoomOccupancy(const RoomAndRoomSensorMap& roomSensorCache, const bool hasAuthority);
 
 	// Navigation
 	void CreateImplement_Navigation(const bool hasAuthority);
@@ -348,7 +394,6 @@ protected:
 	 */
 	void MovePlayerStart(const TArray<APlayerStart*>& startPoints);
 
-private:
 	enum class EStaticMeshPartitionRegistrationFace : uint8
 	{
 		None,
@@ -357,7 +402,18 @@ private:
 		NegativeZ,
 	};
 
-	AStaticMeshActor* SpawnStaticMeshActor(UStaticMesh* staticMesh, const FString& folderPath, const FTransform& transform, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod, const EStaticMeshPartitionRegistrationFace registrationFace = EStaticMeshPartitionRegistrationFace::None) const;
+	/**
+	 * 負荷制御コンポーネントを持つStaticMeshActorをスポーンします
+	 */
+	AStaticMeshActor* SpawnStaticMeshActor(UStaticMesh* staticMesh, const FString& folderPath, const FTransform& transform, const ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod, const EStaticMeshPartitionRegistrationFace registrationFace = EStaticMeshPartitionRegistrationFace::None);
+
+	/**
+	 * このアクターが今回の生成でスポーンまたは再利用したStaticMeshActorを取得します
+	 * タグは全てのダンジョンで共通なので、他のダンジョンのアクターと区別する時に使います
+	 */
+	const TArray<TWeakObjectPtr<AStaticMeshActor>>& GetSpawnedStaticMeshActors() const noexcept;
+
+private:
 	ADungeonDoorBase* SpawnDoorActor(UClass* actorClass, const FTransform& transform, ADungeonRoomSensorBase* ownerActor, const EDungeonRoomProps props) const;
 	AActor* SpawnTorchActor(UClass* actorClass, const FTransform& transform, ADungeonRoomSensorBase* ownerActor, ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod, const bool castShadow) const;
 	AActor* SpawnChandelierActor(UClass* actorClass, const FTransform& transform, ADungeonRoomSensorBase* ownerActor, ESpawnActorCollisionHandlingMethod spawnActorCollisionHandlingMethod) const;
@@ -388,6 +444,45 @@ private:
 	// Vegetation
 public:
 
+	////////////////////////////////////////////////////////////////////////////
+	// Memory
+public:
+	/**
+	 * Estimate the memory owned by this actor.
+	 * Components and subobjects are listed separately by memreport, so they are not included.
+	 *
+	 * このアクターが所有しているメモリ量を見積もります。
+	 * コンポーネントとサブオブジェクトはmemreportが別に集計するので含めません。
+	 * @return		bytes
+	 */
+	virtual SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Get the largest memory held by the generation structures, sampled at the end of each generation phase.
+	 * Only the PathFinder size is tracked at every allocation, so this is not a true peak.
+	 *
+	 * 生成の各フェーズの終了時に計測した、生成用データ構造が保持したメモリ量の最大値を取得します。
+	 * 確保のたびに記録しているのはPathFinderだけなので、本当の最大値ではありません。
+	 * @return		bytes
+	 */
+	SIZE_T GetGenerationSampledAllocatedSize() const noexcept;
+
+	/**
+	 * Get the largest increase of the process physical memory, sampled at the end of each generation phase
+	 * 生成の各フェーズの終了時に計測した、プロセスの物理メモリ使用量の増加の最大値を取得します
+	 * @return		bytes
+	 */
+	uint64 GetGenerationSampledUsedPhysicalDelta() const noexcept;
+
+	/**
+	 * Output the memory usage to the output device (called from memreport)
+	 * メモリ使用量を出力デバイスに出力します（memreportから呼ばれます）
+	 */
+	virtual void ReportAllocatedSize(FOutputDevice& outputDevice) const;
+
+private:
+	void SampleGenerationMemory(const uint64 usedPhysicalAtStart);
+
 	////////////////////////////////////////////////////////////////////////////
 	// Debug
 public:
@@ -411,6 +506,7 @@ private:
 protected:
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	virtual void Tick(float DeltaSeconds) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& CumulativeResourceSize) override;
 
 	////////////////////////////////////////////////////////////////////////////
 	// member variables
@@ -433,6 +529,14 @@ protected:
 	UPROPERTY(Transient)
 	UDungeonAisleGridMap* mAisleGridMap;
 
+	/**
+	 * Terrain actors and instanced mesh components kept for the next generation.
+	 *
+	 * 次の生成のために保持している地形のアクターとインスタンスメッシュコンポーネントです。
+	 */
+	UPROPERTY(Transient)
+	FDungeonActorPool mActorPool;
+
 private:
 	std::shared_ptr<dungeon::Generator> mGenerator;
 	std::shared_ptr<dungeon::Random> mLocalRandom;
@@ -448,17 +552,46 @@ private:
 
 	FDungeonDeferredSpawnManager mDungeonDeferredSpawnManager;
 
+	// インクリメンタルな再生成で再利用する前回の地形アクター
+	std::shared_ptr<FDungeonIncrementalRegeneration> mIncrementalRegeneration;
+
+	// 生成したレイアウトがスポーンするアクターの非同期読み込み
+	std::shared_ptr<FDungeonAssetPrefetcher> mAssetPrefetcher;
+
+	// ボクセルで部屋への入室を判定する追跡
+	std::shared_ptr<FDungeonRoomOccupancyTracker> mRoomOccupancyTracker;
 
 	// 生成時のCRC32
 	mutable uint32_t mCrc32AtCreation = ~0;
 
+	// 生成の各フェーズの終了時に計測したメモリ使用量の最大値
+	SIZE_T mGenerationSampledAllocatedSize = 0;
+	uint64 mGenerationSampledUsedPhysicalDelta = 0;
+
+	// 今回の生成でスポーンまたは再利用したStaticMeshActor
+	TArray<TWeakObjectPtr<AStaticMeshActor>> mSpawnedStaticMeshActors;
+
+	// 破棄するたびに進める番号（読み込み待ちのスポーンが古い生成の物か判定する）
+	uint32 mGenerationSerial = 0;
+
 	// 生成済みフラグ
 	bool mGenerated = false;
 
 	// friend class
 	friend class ADungeonMainLevelScriptActor;
+	friend class FDungeonLoadControlSimulator;
 };
 
+inline SIZE_T ADungeonGenerateBase::GetGenerationSampledAllocatedSize() const noexcept
+{
+	return mGenerationSampledAllocatedSize;
+}
+
+inline uint64 ADungeonGenerateBase::GetGenerationSampledUsedPhysicalDelta() const noexcept
+{
+	return mGenerationSampledUsedPhysicalDelta;
+}
+
 inline const FName& ADungeonGenerateBase::GetDungeonGeneratorTag()
 {
 	static const FName DungeonGeneratorTag(TEXT("DungeonGenerator"));
@@ -587,4 +720,7 @@ void ADungeonGenerateBase::EachActors(const std::function<bool(const T*)>& funct
 	}
 }
 
-
+inline const TArray<TWeakObjectPtr<AStaticMeshActor>>& ADungeonGenerateBase::GetSpawnedStaticMeshActors() const noexcept
+{
+	return mSpawnedStaticMeshActors;
+}
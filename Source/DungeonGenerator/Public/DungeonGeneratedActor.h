@@ -41,8 +41,17 @@ public:
 	 */
 	bool Generate(const UDungeonGenerateParameter* parameter);
 
+	/**
+	 * Regenerate the dungeon, keeping terrain actors of grids that did not change
+	 * ダンジョンを再生成し、変化しなかったグリッドの地形アクターをそのまま使います
+	 * @param[in]	parameter		UDungeonGenerateParameter
+	 * @return		If false, generation fails
+	 */
+	bool RegenerateIncrementally(const UDungeonGenerateParameter* parameter);
+
 private:
 	static ADungeonGeneratedActor* SpawnDungeonActor(UWorld* world, const FVector& location);
+	bool GenerateImplementation(const UDungeonGenerateParameter* parameter);
 	bool mIsGeneratingDungeon = false;
 
 	// friend class
@@ -6,8 +6,11 @@
 
 #pragma once
 #include <Math/Interval.h>
+#include <functional>
 #include "DungeonInstancedMeshCluster.generated.h"
 
+struct FDungeonActorPool;
+class UDungeonComponentActivatorComponent;
 class UHierarchicalInstancedStaticMeshComponent;
 class UInstancedStaticMeshComponent;
 class UStaticMesh;
@@ -33,9 +36,10 @@ public:
 	 *
 	 * @param[inout]	actor			検索先、登録先アクター
 	 * @param[in]		staticMesh		検索または登録するメッシュコンポーネント
+	 * @param[inout]	pool			生成の代わりに取り出すコンポーネントのプール（nullptrなら常に生成）
 	 * @return			発見または生成したInstancedStaticMeshComponent
 	 */
-	UInstancedStaticMeshComponent* FindOrCreateInstance(AActor* actor, UStaticMesh* staticMesh);
+	UInstancedStaticMeshComponent* FindOrCreateInstance(AActor* actor, UStaticMesh* staticMesh, FDungeonActorPool* pool = nullptr);
 
 	/**
 	 * 指定アクターに指定メッシュが含まれているか検索します。
@@ -43,30 +47,75 @@ public:
 	 *
 	 * @param[inout]	actor			検索先、登録先アクター
 	 * @param[in]		staticMesh		検索または登録するメッシュコンポーネント
+	 * @param[inout]	pool			生成の代わりに取り出すコンポーネントのプール（nullptrなら常に生成）
 	 * @return			発見または生成したInstancedStaticMeshComponent
 	 */
-	UHierarchicalInstancedStaticMeshComponent* FindOrCreateHierarchicalInstance(AActor* actor, UStaticMesh* staticMesh);
+	UHierarchicalInstancedStaticMeshComponent* FindOrCreateHierarchicalInstance(AActor* actor, UStaticMesh* staticMesh, FDungeonActorPool* pool = nullptr);
 
 	/**
 	 * 大量に登録する終了処理
-	 * FoliageInstancedStaticMeshComponentのツリー再構築を要求します
+	 * ツリーは構築せずに、ツリーの構築が必要なHierarchicalInstancedStaticMeshComponentを回収します
+	 *
+	 * @param[out]		outdatedComponents	ツリーの構築が必要なコンポーネント
 	 */
-	void EndTransaction();
+	void EndTransaction(TArray<TWeakObjectPtr<UHierarchicalInstancedStaticMeshComponent>>& outdatedComponents);
 
 	/**
 	 * 全てを破棄する
+	 * poolを指定した場合は破棄せずにプールへ返却します
 	 */
-	void DestroyAll();
+	void DestroyAll(FDungeonActorPool* pool = nullptr);
 
 	/**
 	 * カリング距離を設定します
 	 */
 	void SetCullDistance(const FInt32Interval& cullDistances);
 
+	/**
+	 * 指定したメッシュのコンポーネントの当たり判定を無効にし、それ以外のコンポーネントは既定の当たり判定に戻します
+	 * プールから取り出したコンポーネントは前回の生成の設定が残っているので、生成ごとに呼び出して下さい
+	 *
+	 * @param[in]		staticMeshes	当たり判定を無効にするメッシュ
+	 */
+	void DisableCollision(const TSet<const UStaticMesh*>& staticMeshes);
+
+	/**
+	 * 登録しているコンポーネントの配列が確保しているメモリ量を見積もります
+	 * コンポーネント自身はmemreportが別に集計するので含めません
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * コンポーネントをパーティションに登録するアクティベータを設定します
+	 * パーティションが非アクティブな間はコンポーネントを表示しません
+	 *
+	 * @param[inout]	actor							コンポーネントを所有しているアクター
+	 * @param[in]		partitionRegistrationLocation	登録するパーティションの位置
+	 */
+	void SetPartitionActivator(AActor* actor, const FVector& partitionRegistrationLocation);
+
+	/**
+	 * 登録しているインスタンスをコンポーネント毎に取り出します
+	 *
+	 * @param[in]		function	メッシュ、階層化したコンポーネントか、インスタンスのトランスフォーム
+	 */
+	void EachInstances(const std::function<void(UStaticMesh*, bool, const TArray<FTransform>&)>& function) const;
+
+	/**
+	 * 登録しているコンポーネントを取り出します
+	 */
+	void EachComponents(const std::function<void(UInstancedStaticMeshComponent*)>& function) const;
+
 protected:
 	/**
 	 * 登録するInstancedStaticMeshComponentまたはHierarchicalInstancedStaticMeshComponent
 	 */
 	UPROPERTY(Transient)
 	TArray<TObjectPtr<UInstancedStaticMeshComponent>> mComponents;
+
+	/**
+	 * コンポーネントをパーティションに登録するアクティベータ
+	 */
+	UPROPERTY(Transient)
+	TObjectPtr<UDungeonComponentActivatorComponent> mActivatorComponent;
 };
@@ -0,0 +1,81 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include "DungeonMergedMeshCluster.generated.h"
+
+class UStaticMesh;
+
+/**
+ * Collects the tiles of one room or aisle and merges them into a single static mesh.
+ * The merged mesh has one section per material.
+ *
+ * 部屋または通路のタイルを集めて、一つのスタティックメッシュに結合します。
+ * 結合したメッシュはマテリアルごとに一つのセクションを持ちます。
+ */
+USTRUCT()
+struct FDungeonMergedMeshCluster final
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * タイルを追加します
+	 *
+	 * @param[in]		staticMesh		タイルのメッシュ
+	 * @param[in]		transform		タイルのワールドトランスフォーム
+	 */
+	void Add(UStaticMesh* staticMesh, const FTransform& transform);
+
+	/**
+	 * タイルが無いか調べます
+	 */
+	bool IsEmpty() const noexcept;
+
+	/**
+	 * タイルの位置の中心を取得します
+	 */
+	FVector GetCenter() const;
+
+	/**
+	 * CPUから頂点を読めるタイルを結合したメッシュを生成します
+	 * 頂点を読めないメッシュのタイルは結合せずにunmergedStaticMeshesとunmergedTransformsに追加します
+	 *
+	 * @param[in]		outer					生成するメッシュのOuter
+	 * @param[in]		pivot					結合したメッシュの原点のワールド座標
+	 * @param[out]		unmergedStaticMeshes	結合できなかったタイルのメッシュ
+	 * @param[out]		unmergedTransforms		結合できなかったタイルのトランスフォーム
+	 * @return			結合したメッシュ。結合できるタイルが無い場合はnullptr
+	 */
+	UStaticMesh* Build(UObject* outer, const FVector& pivot, TArray<UStaticMesh*>& unmergedStaticMeshes, TArray<FTransform>& unmergedTransforms) const;
+
+	/**
+	 * 全てのタイルを取り除きます
+	 */
+	void Reset();
+
+	/**
+	 * 確保しているバイト数を取得します
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * CPUからメッシュの頂点を読めるか調べます
+	 */
+	static bool CanMerge(const UStaticMesh* staticMesh);
+
+protected:
+	/**
+	 * Tile meshes
+	 * タイルのメッシュ
+	 */
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UStaticMesh>> mStaticMeshes;
+
+	// タイルのトランスフォーム（mStaticMeshesと同じ順番）
+	TArray<FTransform> mTransforms;
+};
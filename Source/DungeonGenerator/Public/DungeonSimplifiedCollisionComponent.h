@@ -0,0 +1,65 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <Components/PrimitiveComponent.h>
+#include "DungeonSimplifiedCollisionComponent.generated.h"
+
+class UBodySetup;
+
+/**
+ * Collision-only component holding the merged boxes of one room or aisle.
+ * It has no render proxy, and its simple collision is also used for complex queries.
+ *
+ * 一つの部屋または通路のまとめた箱を持つコリジョン専用のコンポーネントです。
+ * 描画はせず、単純コリジョンを複雑なクエリにも使います。
+ */
+UCLASS(ClassGroup = "DungeonGenerator")
+class DUNGEONGENERATOR_API UDungeonSimplifiedCollisionComponent : public UPrimitiveComponent
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	explicit UDungeonSimplifiedCollisionComponent(const FObjectInitializer& objectInitializer);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	virtual ~UDungeonSimplifiedCollisionComponent() override = default;
+
+	/**
+	 * 箱を設定して物理状態を作り直します
+	 * @param[in]	boxes		コンポーネントのローカル座標の箱
+	 */
+	void SetBoxes(const TArray<FBox>& boxes);
+
+	/**
+	 * 箱の数
+	 */
+	int32 GetBoxCount() const noexcept;
+
+	// UPrimitiveComponent overrides
+	virtual UBodySetup* GetBodySetup() override;
+	virtual FBoxSphereBounds CalcBounds(const FTransform& LocalToWorld) const override;
+
+private:
+	UPROPERTY(Transient)
+	TObjectPtr<UBodySetup> mBodySetup;
+
+	FBox mLocalBounds = FBox(EForceInit::ForceInit);
+	int32 mBoxCount = 0;
+};
+
+inline int32 UDungeonSimplifiedCollisionComponent::GetBoxCount() const noexcept
+{
+	return mBoxCount;
+}
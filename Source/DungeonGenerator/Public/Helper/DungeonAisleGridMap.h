@@ -81,6 +81,15 @@ public:
 			func(aisleGrid.second);
 	}
 
+	/**
+	 * Estimate the memory held by the map
+	 * マップが確保しているメモリ量を見積もります
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	// UObject
+	virtual void GetResourceSizeEx(FResourceSizeEx& cumulativeResourceSize) override;
+
 private:
 	std::unordered_map<uint16_t, TArray<FDungeonAisleGrid>> mAisleGridMap;
 
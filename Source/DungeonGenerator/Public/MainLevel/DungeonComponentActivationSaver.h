@@ -36,6 +36,13 @@ public:
 	 */
 	void Stash(const AActor* actor, const std::function<std::pair<bool, T>(UActorComponent*)>& function);
 
+	/**
+	 * Records the activity of the specified components
+	 * @param[in]	components
+	 * @param[in]	function
+	 */
+	void Stash(const TArray<TWeakObjectPtr<UActorComponent>>& components, const std::function<std::pair<bool, T>(UActorComponent*)>& function);
+
 	/**
 	 * Restore the activity of recorded components
 	 * @param[in]	function
@@ -77,6 +84,25 @@ inline void DungeonComponentActivationSaver<T>::Stash(const AActor* actor, const
 	}
 }
 
+template<typename T>
+inline void DungeonComponentActivationSaver<T>::Stash(const TArray<TWeakObjectPtr<UActorComponent>>& components, const std::function<std::pair<bool, T>(UActorComponent*)>& function)
+{
+	mActivations.clear();
+
+	for (const TWeakObjectPtr<UActorComponent>& weakComponent : components)
+	{
+		UActorComponent* component = weakComponent.Get();
+		if (!IsValid(component))
+			continue;
+
+		const std::pair<bool, T> result = function(component);
+		if (result.first)
+		{
+			mActivations.emplace_back(std::make_pair(component, result.second));
+		}
+	}
+}
+
 template<typename T>
 inline void DungeonComponentActivationSaver<T>::Pop(const std::function<void(UActorComponent*, const T)>& function)
 {
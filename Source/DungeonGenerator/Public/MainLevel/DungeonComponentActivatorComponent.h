@@ -76,6 +76,24 @@ public:
 	 */
 	void SetFixedPartitionRegistrationWorldLocation(const FVector& worldLocation) noexcept;
 
+	/**
+	 * Registers with every partition overlapped by the world bounds instead of a single location.
+	 * The owner stays active while any of those partitions is active, and it is no longer tracked as a moving actor.
+	 *
+	 * 一点ではなくワールド境界に重なる全てのパーティションに登録します。
+	 * いずれかのパーティションがアクティブな間はオーナーもアクティブになり、移動するアクターとしては追跡されなくなります。
+	 */
+	void SetPartitionRegistrationWorldBounds(const FBox& worldBounds);
+
+	/**
+	 * Controls only the specified components instead of every component of the owner actor.
+	 * Call this before the partition deactivates the components.
+	 *
+	 * オーナーアクターの全てのコンポーネントではなく、指定したコンポーネントだけを制御します。
+	 * パーティションがコンポーネントを無効にする前に呼び出して下さい。
+	 */
+	void SetControlledComponents(const TArray<UActorComponent*>& components);
+
 	// Actor
 	UFUNCTION(BlueprintCallable, Category = "DungeonGenerator")
 	void SaveAndDisableActorTickEnable(const EDungeonComponentActivateReason activateReason);
@@ -113,7 +131,6 @@ public:
 	// overrides
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
-	virtual void TickComponent(float deltaTime, enum ELevelTick tickType, FActorComponentTickFunction* thisTickFunction) override;
 
 protected:
 	/**
@@ -138,12 +155,29 @@ private:
 	void ShiftFixedPartitionRegistrationWorldLocation(const FVector& worldOffset) noexcept;
 
 	void RefreshPartitionRegistration(ADungeonMainLevelScriptActor* dungeonMainLevelScriptActor);
+	void RegisterMovableTracking(const AActor* ownerActor);
 	void TickImplement(const FVector& location);
+	void MoveToPartition(UDungeonPartition* currentDungeonPartition);
+	void MoveToPartitions(const TArray<UDungeonPartition*>& currentDungeonPartitions);
+	void UnregisterFromAdditionalPartitions();
+	bool IsAnyRegisteredPartitionActivate() const;
 	FVector GetPartitionRegistrationWorldLocation(const AActor* ownerActor) const noexcept;
 	bool HasFixedPartitionRegistrationWorldLocation() const noexcept;
 	void CallPartitionActivate();
 	void CallPartitionInactivate();
 
+	/**
+	 * Restores the states saved by the partition and leaves the partition before the owner is pooled
+	 * オーナーがプールされる前にパーティションが保存した状態を戻してパーティションから退出します
+	 */
+	void ResetForPool();
+
+	/**
+	 * Registers with the partition again after the owner is taken out of the pool
+	 * オーナーがプールから取り出された後にパーティションへ登録し直します
+	 */
+	void ReuseFromPool();
+
 	// Actor
 	void SaveAndDisableActorTickEnable(const EDungeonComponentActivateReason activateReason, AActor* owner);
 
@@ -214,18 +248,28 @@ private:
 	DungeonComponentActivationSaver<bool> mComponentVisibilitySaver;
 	DungeonComponentActivationSaver<ECollisionEnabled::Type> mComponentCollisionEnabledSaver;
 	std::vector<TWeakObjectPtr<UPointLightComponent>> mPointLightComponents;
+	// 制御するコンポーネント（空ならオーナーアクターの全てのコンポーネント）
+	TArray<TWeakObjectPtr<UActorComponent>> mControlledComponents;
 
 	TWeakObjectPtr<ADungeonMainLevelScriptActor> mDungeonLevelScriptActor;
 	TWeakObjectPtr<UDungeonPartition> mLastDungeonPartition;
+	// 境界で登録した時にmLastDungeonPartition以外で登録しているパーティション
+	TArray<TWeakObjectPtr<UDungeonPartition>> mAdditionalDungeonPartitions;
 	FVector mFixedPartitionRegistrationWorldLocation = FVector::ZeroVector;
-	FVector mLastLocation = FVector::ZeroVector;
+	FBox mPartitionRegistrationWorldBounds = FBox(ForceInit);
+	// ADungeonMainLevelScriptActorが追跡している位置（追跡していないならINDEX_NONE）
+	int32 mMovableActivatorIndex = INDEX_NONE;
 
 	bool bHasFixedPartitionRegistrationWorldLocation = false;
 	bool mTickSaver = false;
+	// オーナーがプールされている間はパーティションに登録しません
+	bool mPooled = false;
 
 	friend class ADungeonMainLevelScriptActor;
 	friend class ADungeonGenerateBase;
 	friend class UDungeonPartition;
+	friend struct FDungeonActorPool;
+	friend struct FDungeonInstancedMeshCluster;
 };
 
 inline bool UDungeonComponentActivatorComponent::IsEnableOwnerActorTickControl() const noexcept
@@ -298,6 +342,8 @@ inline void UDungeonComponentActivatorComponent::ShiftFixedPartitionRegistration
 {
 	if (bHasFixedPartitionRegistrationWorldLocation)
 		mFixedPartitionRegistrationWorldLocation += worldOffset;
+	if (mPartitionRegistrationWorldBounds.IsValid)
+		mPartitionRegistrationWorldBounds = mPartitionRegistrationWorldBounds.ShiftBy(worldOffset);
 }
 
 inline void UDungeonComponentActivatorComponent::EachControlledLightCastShadow(const std::function<void(UPointLightComponent*)>& function) const
@@ -0,0 +1,255 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <Containers/Array.h>
+#include <Math/RandomStream.h>
+
+class ADungeonMainLevelScriptActor;
+class FOutputDevice;
+
+/**
+ * Moves scripted viewers along the aisle graph of the generated dungeons, or along fixed paths,
+ * and measures the partition load control of ADungeonMainLevelScriptActor frame by frame.
+ * No player controller or rendering is required, so it can run headless.
+ *
+ * 生成済みダンジョンの通路グラフ、または固定した経路に沿ってスクリプトで視点を移動させ、
+ * ADungeonMainLevelScriptActorのパーティション負荷コントロールをフレーム毎に計測します。
+ * プレイヤーコントローラーや描画を必要としないので、ヘッドレスで実行できます。
+ */
+class DUNGEONGENERATOR_API FDungeonLoadControlSimulator final
+{
+public:
+	/**
+	 * Simulation settings
+	 * シミュレーションの設定
+	 */
+	struct FSettings final
+	{
+		int32 PawnCount = 1;
+		int32 FrameCount = 3600;
+		float DeltaSeconds = 1.f / 60.f;
+		// cm/s
+		float PawnSpeed = 450.f;
+		int32 RandomSeed = 0;
+		// 先読みの有効性（負の値ならアクターの設定を使う）
+		int32 Prefetch = -1;
+		// 先読みで予測する秒数（負の値ならアクターの設定を使う）
+		float PrefetchSeconds = -1.f;
+		// 1フレームの切り替えに使うミリ秒（負の値ならアクターの設定を使う）
+		float TransitionBudgetMilliseconds = -1.f;
+		// 1フレームのアクティブ化の最大数（負の値ならアクターの設定を使う）
+		int32 MaxActivationsPerFrame = -1;
+		// 1フレームの非アクティブ化の最大数（負の値ならアクターの設定を使う）
+		int32 MaxInactivationsPerFrame = -1;
+		// 固定した視点の経路（空でなければポーン毎に経路を一度だけ辿り、終点で止まる）
+		TArray<TArray<FVector>> ViewerPaths;
+	};
+
+	/**
+	 * Measurements for one frame
+	 * 1フレームの計測結果
+	 */
+	struct FFrame final
+	{
+		double LoadControlMilliseconds = 0.0;
+		double ShadowMilliseconds = 0.0;
+		int32 Activations = 0;
+		int32 Inactivations = 0;
+		int32 QueueDepth = 0;
+		int32 ActivePartitions = 0;
+		// 非アクティブなパーティションの中にいる視点の数
+		int32 InactiveViewerPartitions = 0;
+	};
+
+	/**
+	 * Partition predicted for prefetching.
+	 * It is a hit if the viewer entered the partition within the prefetch seconds.
+	 *
+	 * 先読みのために予測したパーティションです。
+	 * 先読みの秒数以内に視点がそのパーティションに入れば当たりです。
+	 */
+	struct FPrediction final
+	{
+		int32 PawnIndex = INDEX_NONE;
+		int32 Frame = 0;
+		int32 PartitionIndex = INDEX_NONE;
+		// 予測した時の視点の位置
+		FVector Location = FVector::ZeroVector;
+		bool Hit = false;
+	};
+
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	explicit FDungeonLoadControlSimulator(ADungeonMainLevelScriptActor* levelScriptActor);
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonLoadControlSimulator() = default;
+
+	/**
+	 * Run the simulation. The activation state follows the real players again when finished.
+	 * シミュレーションを実行します。終了後は実際のプレイヤーに従ったアクティブ状態に戻ります。
+	 * @return		false if there is no partition or route to simulate
+	 */
+	bool Run(const FSettings& settings);
+
+	/**
+	 * Output the summary
+	 * 集計結果を出力します
+	 */
+	void Report(FOutputDevice& outputDevice) const;
+
+	/**
+	 * Get the per-frame measurements
+	 * フレーム毎の計測結果を取得します
+	 */
+	const TArray<FFrame>& GetFrames() const noexcept;
+
+	/**
+	 * Get the seconds until every partition visible from a newly entered partition became active
+	 * 新しく入ったパーティションから見える全てのパーティションがアクティブになるまでの秒数を取得します
+	 */
+	const TArray<float>& GetTimeToVisibleSeconds() const noexcept;
+
+	/**
+	 * Get the seconds until a newly entered partition itself became active
+	 * 新しく入ったパーティション自体がアクティブになるまでの秒数を取得します
+	 */
+	const TArray<float>& GetTimeToActiveSeconds() const noexcept;
+
+	/**
+	 * Get the number of entered partitions that had not become active when the simulation ended
+	 * シミュレーション終了時にアクティブになっていなかった入ったパーティションの数を取得します
+	 */
+	int32 GetUnresolvedActivationCount() const noexcept;
+
+	/**
+	 * Get the prefetch predictions whose result was decided
+	 * 当たり外れが決まった先読みの予測を取得します
+	 */
+	const TArray<FPrediction>& GetPredictions() const noexcept;
+
+	/**
+	 * Get the number of prefetch predictions that hit
+	 * 当たった先読みの予測の数を取得します
+	 */
+	int32 GetPredictionHitCount() const noexcept;
+
+	/**
+	 * Get the number of prefetch predictions that missed
+	 * 外れた先読みの予測の数を取得します
+	 */
+	int32 GetPredictionMissCount() const noexcept;
+
+	/**
+	 * Get the viewer ID given to a simulated pawn.
+	 * The IDs start above the range of UObject unique IDs, so they never collide with player controllers.
+	 *
+	 * シミュレーションするポーンの視点IDを取得します。
+	 * UObjectのユニークIDの範囲より上から始まるので、プレイヤーコントローラーと衝突しません。
+	 */
+	static uint32 GetSimulatedViewerId(const int32 pawnIndex) noexcept;
+
+private:
+	struct FRoute final
+	{
+		TArray<FVector> Waypoints;
+		int32 Nodes[2] = { INDEX_NONE, INDEX_NONE };
+	};
+
+	struct FPawn final
+	{
+		int32 RouteIndex = INDEX_NONE;
+		int32 WaypointIndex = 0;
+		bool Reverse = false;
+		FVector Location = FVector::ZeroVector;
+		FVector Direction = FVector::ForwardVector;
+		int32 PartitionIndex = INDEX_NONE;
+		int32 PredictedPartitionIndex = INDEX_NONE;
+		bool Stopped = false;
+	};
+
+	struct FVisibilityWait final
+	{
+		int32 PartitionIndex = INDEX_NONE;
+		int32 EnteredFrame = 0;
+	};
+
+	void BuildRoutes();
+	void BuildFixedRoutes();
+	void StartRoute(FPawn& pawn, const int32 nodeIndex);
+	void Advance(FPawn& pawn, float distance);
+	const FVector& GetWaypoint(const FPawn& pawn, const int32 step) const;
+	int32 GetWaypointCount(const FPawn& pawn) const;
+	bool IsVisibleSetActive(const int32 partitionIndex) const;
+
+	ADungeonMainLevelScriptActor* mLevelScriptActor;
+	FSettings mSettings;
+	FRandomStream mRandom;
+	TArray<FRoute> mRoutes;
+	TArray<TArray<int32>> mRoutesByNode;
+	TArray<FPawn> mPawns;
+	TArray<FVisibilityWait> mVisibilityWaits;
+	TArray<FFrame> mFrames;
+	TArray<float> mTimeToVisibleSeconds;
+	TArray<FVisibilityWait> mActivationWaits;
+	TArray<float> mTimeToActiveSeconds;
+	TArray<FPrediction> mPendingPredictions;
+	TArray<FPrediction> mPredictions;
+	uint32 mPrefetchCount = 0;
+	int32 mPartitionCount = 0;
+};
+
+inline const TArray<FDungeonLoadControlSimulator::FFrame>& FDungeonLoadControlSimulator::GetFrames() const noexcept
+{
+	return mFrames;
+}
+
+inline const TArray<float>& FDungeonLoadControlSimulator::GetTimeToVisibleSeconds() const noexcept
+{
+	return mTimeToVisibleSeconds;
+}
+
+inline const TArray<float>& FDungeonLoadControlSimulator::GetTimeToActiveSeconds() const noexcept
+{
+	return mTimeToActiveSeconds;
+}
+
+inline int32 FDungeonLoadControlSimulator::GetUnresolvedActivationCount() const noexcept
+{
+	return mActivationWaits.Num();
+}
+
+inline const TArray<FDungeonLoadControlSimulator::FPrediction>& FDungeonLoadControlSimulator::GetPredictions() const noexcept
+{
+	return mPredictions;
+}
+
+inline int32 FDungeonLoadControlSimulator::GetPredictionHitCount() const noexcept
+{
+	int32 count = 0;
+	for (const FPrediction& prediction : mPredictions)
+		count += prediction.Hit ? 1 : 0;
+	return count;
+}
+
+inline int32 FDungeonLoadControlSimulator::GetPredictionMissCount() const noexcept
+{
+	return mPredictions.Num() - GetPredictionHitCount();
+}
+
+inline uint32 FDungeonLoadControlSimulator::GetSimulatedViewerId(const int32 pawnIndex) noexcept
+{
+	// UObject::GetUniqueIDは負にならないint32のインデックスを返します
+	return static_cast<uint32>(MAX_int32) + 1u + static_cast<uint32>(pawnIndex);
+}
@@ -6,11 +6,14 @@
 
 #pragma once
 #include "DungeonPartition.h"
+#include "DungeonPartitionTransitionQueue.h"
+#include "DungeonPartitionVisibilityRow.h"
 #include <CoreMinimal.h>
 #include <Containers/Array.h>
 #include <Containers/Map.h>
 #include <Engine/LevelScriptActor.h>
 #include <Math/Box.h>
+#include <Misc/SpinLock.h>
 #include "DungeonMainLevelScriptActor.generated.h"
 
 class ADungeonGenerateActor;
@@ -91,6 +94,13 @@ public:
 	 */
 	UDungeonPartition* Find(const FVector& worldLocation) const noexcept;
 
+	/**
+	 * Find every DungeonPartition overlapped by the world bounds
+	 *
+	 * ワールド境界に重なる全てのDungeonPartitionを検索します
+	 */
+	void FindPartitions(const FBox& worldBounds, TArray<UDungeonPartition*>& outPartitions) const;
+
 	/**
 	 * Is load control effective?
 	 *
@@ -114,10 +124,27 @@ public:
 	 */
 	void RebuildSparsePartitionGraphAndRefresh();
 
+	/**
+	 * Estimate the memory owned by this actor, such as the precomputed visibility.
+	 * The partitions are separate objects and are not included.
+	 *
+	 * 事前計算した可視情報など、このアクターが所有しているメモリ量を見積もります。
+	 * パーティションは別のオブジェクトなので含めません。
+	 * @return		bytes
+	 */
+	SIZE_T GetAllocatedSize() const;
+
+	/**
+	 * Output the memory usage to the output device (called from memreport)
+	 * メモリ使用量を出力デバイスに出力します（memreportから呼ばれます）
+	 */
+	void ReportAllocatedSize(FOutputDevice& outputDevice) const;
+
 	// override
 	virtual void PreInitializeComponents() override;
 	virtual void EndPlay(const EEndPlayReason::Type endPlayReason) override;
 	virtual void Tick(float deltaSeconds) override;
+	virtual void GetResourceSizeEx(FResourceSizeEx& cumulativeResourceSize) override;
 
 private:
 	struct FPartitionVisibilitySample
@@ -127,6 +154,61 @@ private:
 		FVector WorldLocation = FVector::ZeroVector;
 	};
 
+	/*
+	 * Opening between two partitions, bounded by the open grid faces on one boundary plane.
+	 * 境界平面上の開いたグリッド面を囲む、2つのパーティション間の開口部です。
+	 */
+	struct FPartitionPortal
+	{
+		int32 PartitionIndices[2] = { INDEX_NONE, INDEX_NONE };
+		FBox Bounds = FBox(ForceInit);
+		uint8 Axis = 0;
+	};
+
+	/*
+	 * Partition a tracked viewer is currently in.
+	 * 追跡している視点が現在いるパーティションです。
+	 */
+	struct FPartitionViewer
+	{
+		FVector Location = FVector::ZeroVector;
+		int32 PartitionIndex = INDEX_NONE;
+		int32 PredictedPartitionIndex = INDEX_NONE;
+		uint32 Frame = 0;
+	};
+
+	/*
+	 * Measured cost of a partition transition, used to spend the per-frame time budget.
+	 * フレームごとの処理時間の予算を使うための、パーティション切り替えの計測コストです。
+	 */
+	struct FPartitionTransitionCost
+	{
+		double MillisecondsPerComponent = 0.01;
+
+		double Estimate(const int32 componentCount) const noexcept
+		{
+			return MillisecondsPerComponent * FMath::Max(componentCount, 1);
+		}
+
+		void Measure(const int32 componentCount, const double milliseconds) noexcept
+		{
+			MillisecondsPerComponent = FMath::Lerp(MillisecondsPerComponent, milliseconds / FMath::Max(componentCount, 1), 0.125);
+		}
+	};
+
+	/*
+	 * Light that may cast shadows, scored by distance and direction from the camera.
+	 * カメラからの距離と向きで評価した、影を落とす候補のライトです。
+	 */
+	struct FShadowCastingLightCandidate
+	{
+		float Score = 0.f;
+		UPointLightComponent* PointLightComponent = nullptr;
+	};
+
+	using FPartitionPortalPolygon = TArray<FVector, TInlineAllocator<8>>;
+	using FPartitionPortalPlanes = TArray<FPlane, TInlineAllocator<10>>;
+
 	/*
 	 * Identifies why the partition build pipeline is running.
 	 * パーティション構築パイプラインの実行理由を表します。
@@ -243,6 +325,12 @@ private:
 	 */
 	void BuildPartitionRuntimeData(const FPartitionBuildContext& context);
 
+	/*
+	 * Regroups instanced meshes of dungeon actors by partition cell.
+	 * ダンジョン actor のインスタンスメッシュをパーティションのセルでまとめ直します。
+	 */
+	void AlignDungeonActorInstancedMeshClusters(const FPartitionBuildContext& context) const;
+
 	/*
 	 * Applies updated culling distances back to dungeon actors.
 	 * 更新後のカリング距離をダンジョン actor へ反映します。
@@ -264,29 +352,59 @@ private:
 	void ResetPrecomputedPartitionVisibility();
 	void BuildPartitionVisibilitySamples(const TArray<ADungeonGenerateActor*>& dungeonGenerateActors);
 	void BuildPartitionConnectedComponents();
+	void BuildPartitionPortals(const TArray<ADungeonGenerateActor*>& dungeonGenerateActors);
+	void ResetPartitionPortals();
 	void BuildPrecomputedPartitionVisibility();
+	uint32 ComputePartitionVisibilityCacheKey(const FPartitionBuildContext& context) const;
+	bool LoadPartitionVisibilityCache(const FPartitionBuildContext& context, uint32 cacheKey);
+	void SavePartitionVisibilityCache(const FPartitionBuildContext& context, uint32 cacheKey) const;
+	bool TraversePartitionPortals(const FBox& sourceBounds, int32 partitionIndex, int32 depth, const FPartitionPortalPlanes& clipPlanes, TBitArray<>& pathPartitions, TArray<uint64>& row, double maximumVisibilityDistanceSquared, int32& remainingPortalVisits) const;
 	bool HasPrecomputedPartitionVisibility() const noexcept;
 	bool IsPartitionLoadControlAvailable() const noexcept;
-	void MarkPrecomputedPartitionVisibility(int32 sourcePartitionIndex) const;
+	void ChangeViewerPartition(int32 oldSourcePartitionIndex, int32 newSourcePartitionIndex);
+	void AddPartitionViewerReference(int32 partitionIndex);
+	void RemovePartitionViewerReference(int32 partitionIndex);
+	void SchedulePartitionUpdate(int32 partitionIndex);
 	bool IsPrecomputedPartitionVisible(int32 sourcePartitionIndex, int32 targetPartitionIndex) const noexcept;
 	bool IsPartitionPairPotentiallyVisible(int32 sourcePartitionIndex, int32 targetPartitionIndex) const;
 	static bool TracePartitionVisibility(const FPartitionVisibilitySample& sourceSample, const FPartitionVisibilitySample& targetSample);
 	void RefreshActivatorComponentRegistrations();
+	void RegisterMovableActivatorComponent(UDungeonComponentActivatorComponent* component);
+	void UnregisterMovableActivatorComponent(UDungeonComponentActivatorComponent* component);
+	void RemoveMovableActivatorComponentAt(const int32 index);
+	void ResetMovableActivatorComponents();
+	void ResyncMovableActivatorComponents();
+	void UpdateMovableActivatorComponents();
 	void ApplyCurrentPartitionActivationState();
 	void ResetPartitionTransitionQueue();
+	void EnqueueRegisteredPartition(UDungeonPartition* partition);
+	void FlushPendingRegisteredPartitions();
+	void ResetPendingRegisteredPartitions();
 	void EnqueuePartitionTransition(int32 partitionIndex);
+	float ComputePartitionTransitionPriority(int32 partitionIndex, bool activate) const;
+	bool CanSpendPartitionTransitionBudget(const UDungeonPartition* partition, const FPartitionTransitionCost& cost, double spentMilliseconds) const;
 	void ProcessPartitionTransitionQueue();
 	FInt32Interval ComputeTerrainCullingDistanceRange() const noexcept;
 
-	void Begin() const;
-	void Mark(const FVector& playerLocation) const;
+	void Begin();
+	void MarkPlayerViewers(const UWorld& world);
+	void Mark(uint32 viewerId, const FVector& viewLocation, const FVector& viewVelocity = FVector::ZeroVector);
+	void BuildPartitionAisleLinks(const TArray<ADungeonGenerateActor*>& dungeonGenerateActors);
+	int32 PredictViewerPartition(int32 partitionIndex, const FVector& viewLocation, const FVector& viewVelocity) const;
+	void EnqueuePartitionPrefetch(int32 sourcePartitionIndex);
+	void ProcessPartitionPrefetchQueue(int32& remainingActivations, double& spentMilliseconds);
 	void End(const float deltaSeconds);
 
 	/**
 	 * ポイントライトおよびスポットライトの影を落とすか制御します
 	 */
 	void UpdateShadowCastingPointAndSpotLights();
+	void UpdateShadowCastingPointAndSpotLights(const FVector& cameraLocation, const FVector& cameraDirection);
 	void ForceActivateShadowCastingPointAndSpotLights();
+	void SyncShadowCastingLightLimit();
+	void AddShadowCastingPartition(int32 partitionIndex);
+	void RemoveShadowCastingPartition(int32 partitionIndex);
+	void ReleaseShadowCastingPartition(int32 partitionIndex);
 
 	void ForceActivate();
 	void ForceInactivate();
@@ -354,6 +472,42 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", meta = (ClampMin = "0"))
 	int32 PrecomputedVisibilityDilationHopCount = 1;
 
+	/**
+	 * Builds the precomputed potential visibility sets by clipping view frustums through
+	 * the portals between partitions instead of tracing every pair of partition samples.
+	 * Partitions whose portal traversal exceeds the work limit fall back to sample tracing.
+	 *
+	 * パーティション同士のサンプルを総当たりでトレースする代わりに、
+	 * パーティション間のポータルで視錐台をクリップして PVS を構築します。
+	 * ポータルの探索量が上限を超えたパーティションはサンプルのトレースで構築します。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", meta = (EditCondition = "bUsePrecomputedPartitionVisibility"))
+	bool bUsePortalPartitionVisibility = false;
+
+	/**
+	 * Stores the precomputed potential visibility sets under Saved/DungeonGenerator
+	 * and reuses them while the dungeon CRC32 and the partition settings do not change.
+	 *
+	 * 事前計算した PVS を Saved/DungeonGenerator に保存し、
+	 * ダンジョンの CRC32 とパーティション設定が変わらない間は再利用します。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", meta = (EditCondition = "bUsePrecomputedPartitionVisibility"))
+	bool bUsePartitionVisibilityCache = false;
+
+	/**
+	 * Time in milliseconds spent on partition activations and inactivations in a single frame.
+	 * Partitions closest to the players are activated first and the farthest are inactivated first,
+	 * and the cost of each partition is estimated from its component count and the measured time.
+	 * Set to 0 to limit the transitions only by the per-frame counts.
+	 *
+	 * 1 フレーム内でパーティションのアクティブ化と非アクティブ化に使う時間（ミリ秒）です。
+	 * プレイヤーに近いパーティションからアクティブ化し、遠いパーティションから非アクティブ化します。
+	 * 各パーティションのコストはコンポーネント数と計測した時間から見積もります。
+	 * 0 を指定するとフレームごとの個数だけで制限します。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", meta = (ClampMin = "0"))
+	float PartitionTransitionBudgetMilliseconds = 2.f;
+
 	/**
 	 * Maximum number of partition activations processed in a single frame.
 	 * Set to 0 to remove the per-frame activation limit.
@@ -374,6 +528,26 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", meta = (ClampMin = "0"))
 	int32 MaxPartitionInactivationsPerFrame = 16;
 
+	/**
+	 * Predicts where each player will be a few seconds ahead from its velocity and the aisle connections,
+	 * and activates the partitions visible from there with the activation budget left over in each frame.
+	 * Prefetched partitions are inactivated again if no player comes to see them.
+	 *
+	 * 速度と通路の接続から数秒後のプレイヤーの位置を予測し、そこから見えるパーティションを
+	 * 各フレームで余ったアクティブ化の枠で先にアクティブ化します。
+	 * 先読みしたパーティションは、プレイヤーが見に来なければ再び非アクティブ化されます。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator")
+	bool bEnablePartitionPrefetch = false;
+
+	/**
+	 * How many seconds ahead the player position is predicted for prefetching.
+	 *
+	 * 先読みのためにプレイヤーの位置を予測する秒数です。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "DungeonGenerator", meta = (ClampMin = "0", EditCondition = "bEnablePartitionPrefetch"))
+	float PartitionPrefetchSeconds = 1.5f;
+
 	/**
 	 * Maximum number of point lights or spotlights casting shadows
 	 * Unlimited if 0
@@ -384,6 +558,16 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DungeonGenerator")
 	uint8 MaxShadowCastingPointAndSpotLights = 12;
 
+	/**
+	 * Distance in centimeters by which a light already casting shadows is treated as closer,
+	 * so that lights near the selection boundary do not switch their shadows every frame.
+	 *
+	 * 既に影を落としているライトを近くにあるものとして扱う距離（cm）です。
+	 * 選択の境界付近にあるライトの影が毎フレーム切り替わらないようにします。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DungeonGenerator", meta = (ClampMin = "0"))
+	float ShadowCastingLightHysteresisDistance = 200.f;
+
 	/**
 	 * Load control effectiveness
 	 * 負荷コントロールの有効性
@@ -408,10 +592,63 @@ private:
 	bool mLastEnableLoadControl;
 	TMap<FIntVector, int32> mPartitionIndexByCell;
 	TArray<TArray<FPartitionVisibilitySample>> mPartitionVisibilitySamples;
-	TArray<TArray<uint64>> mPartitionPotentialVisibilityMasks;
+	TArray<FDungeonPartitionVisibilityRow> mPartitionPotentialVisibilityRows;
 	TArray<int32> mPartitionConnectedComponents;
-	TArray<int32> mPendingPartitionTransitions;
+	TArray<FPartitionPortal> mPartitionPortals;
+	TArray<TArray<int32>> mPartitionPortalIndices;
 	TArray<uint8> mDesiredPartitionActivation;
-	TArray<uint8> mQueuedPartitionTransitions;
-	int32 mPendingPartitionTransitionReadIndex = 0;
+
+	// アクティブ化と非アクティブ化を待っているパーティションと、その計測コスト
+	FDungeonPartitionTransitionQueue mPendingPartitionActivations;
+	FDungeonPartitionTransitionQueue mPendingPartitionInactivations;
+	FPartitionTransitionCost mPartitionActivationCost;
+	FPartitionTransitionCost mPartitionInactivationCost;
+	bool mPartitionTransitionPrioritiesDirty = false;
+	uint32 mPartitionActivationCount = 0;
+	uint32 mPartitionInactivationCount = 0;
+
+	// 視点ごとのパーティション、送信元パーティションごとの視点数、
+	// 視点がいる送信元パーティションから見えているパーティションごとの参照数
+	TMap<uint32, FPartitionViewer> mPartitionViewers;
+	TArray<int32> mSourcePartitionViewerCounts;
+	TArray<int32> mPartitionViewerCounts;
+	uint32 mViewerFrame = 0;
+
+	// End で更新対象にするパーティション
+	TArray<int32> mChangedPartitionIndices;
+	TArray<int32> mInactivatingPartitionIndices;
+	TArray<int32> mPartitionUpdateIndices;
+	TBitArray<> mScheduledPartitionUpdates;
+
+	// 通路でつながったパーティションと先読み待ちのパーティション
+	TArray<TArray<int32>> mPartitionAisleLinks;
+	TArray<int32> mPendingPartitionPrefetches;
+	TBitArray<> mQueuedPartitionPrefetches;
+	uint32 mPartitionPrefetchCount = 0;
+	bool mPartitionUpdateRequiresFullScan = true;
+
+	// 影を落とすライトの候補になるパーティション、候補から外れて影を消すパーティション
+	TArray<int32> mShadowCastingPartitionIndices;
+	TArray<int32> mShadowCastingPartitionPositions;
+	TArray<int32> mShadowReleasedPartitionIndices;
+	TArray<FShadowCastingLightCandidate> mShadowCastingLightCandidates;
+	bool mShadowCastingRequiresFullScan = true;
+	// 最後に反映したMaxShadowCastingPointAndSpotLights
+	uint8 mAppliedMaxShadowCastingPointAndSpotLights = 0;
+
+	// 移動するアクティベータコンポーネントと、最後に調べた位置と所属パーティション
+	UPROPERTY(Transient)
+	TArray<TObjectPtr<UDungeonComponentActivatorComponent>> mMovableActivatorComponents;
+	TArray<FVector> mMovableActivatorLocations;
+	TArray<int32> mMovableActivatorPartitionIndices;
+	TArray<int32> mMovedActivatorIndices;
+
+	// 登録待ちのアクティベータコンポーネントを持つパーティション
+	TArray<TObjectPtr<UDungeonPartition>> mPendingRegisteredPartitions;
+	UE::FSpinLock mPendingRegisteredPartitionsMutex;
+
+	// friend class
+	friend class FDungeonLoadControlSimulator;
+	friend class UDungeonComponentActivatorComponent;
+	friend class UDungeonPartition;
 };
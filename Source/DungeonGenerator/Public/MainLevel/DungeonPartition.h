@@ -39,6 +39,9 @@ public:
 	explicit UDungeonPartition(const FObjectInitializer& objectInitializer);
 	virtual ~UDungeonPartition() override = default;
 
+	// UObject
+	virtual void GetResourceSizeEx(FResourceSizeEx& cumulativeResourceSize) override;
+
 private:
 	void RegisterActivatorComponent(UDungeonComponentActivatorComponent* component);
 	void UnregisterActivatorComponent(UDungeonComponentActivatorComponent* component);
@@ -57,6 +60,7 @@ private:
 	void CallPartitionInactivate();
 
 	bool IsEmpty() const;
+	int32 GetActivatorComponentCount() const noexcept;
 	void ResetGraphData();
 	void SetCellCoordinate(const FIntVector& cellCoordinate) noexcept;
 	const FIntVector& GetCellCoordinate() const noexcept;
@@ -65,6 +69,7 @@ private:
 	void AddNeighborIndex(const int32 neighborIndex);
 	const TArray<int32>& GetNeighborIndices() const noexcept;
 	void EachDungeonComponentActivatorComponent(const std::function<void(UDungeonComponentActivatorComponent*)>& function) const;
+	SIZE_T GetAllocatedSize() const;
 
 protected:
 	/**
@@ -140,4 +145,16 @@ inline bool UDungeonPartition::IsMarked() const noexcept
 	return mMarked;
 }
 
+inline int32 UDungeonPartition::GetActivatorComponentCount() const noexcept
+{
+	return ActivatorComponents.Num();
+}
+
+inline SIZE_T UDungeonPartition::GetAllocatedSize() const
+{
+	return ActivatorComponents.GetAllocatedSize()
+		+ RegisteredComponents.GetAllocatedSize()
+		+ mNeighborIndices.GetAllocatedSize();
+}
+
 
@@ -0,0 +1,252 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <Containers/Array.h>
+#include <Misc/EngineVersionComparison.h>
+
+/**
+ * Priority queue of partitions waiting for activation or inactivation.
+ * Each partition is queued at most once, and pushing a queued partition again
+ * moves it to its new priority in place. Smaller priorities are popped first.
+ *
+ * アクティブ化または非アクティブ化を待っているパーティションの優先度付きキューです。
+ * 各パーティションは一度だけ登録され、登録済みのパーティションを再度追加すると
+ * その場で新しい優先度の位置へ移動します。優先度の小さい方から取り出されます。
+ */
+class DUNGEONGENERATOR_API FDungeonPartitionTransitionQueue final
+{
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	FDungeonPartitionTransitionQueue() = default;
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonPartitionTransitionQueue() = default;
+
+	/**
+	 * Removes all partitions and accepts partition indices less than partitionCount
+	 * 全てのパーティションを取り除き、partitionCount未満のパーティション番号を受け付けます
+	 */
+	void Reset(const int32 partitionCount);
+
+	/**
+	 * Is the partition queued?
+	 * パーティションが登録されているか調べます
+	 */
+	bool Contains(const int32 partitionIndex) const noexcept;
+
+	/**
+	 * Number of queued partitions
+	 * 登録されているパーティションの数
+	 */
+	int32 Num() const noexcept;
+
+	/**
+	 * Is the queue empty?
+	 * キューが空か調べます
+	 */
+	bool IsEmpty() const noexcept;
+
+	/**
+	 * Queues the partition, or changes its priority if already queued
+	 * パーティションを登録します。登録済みなら優先度を変更します
+	 */
+	void Push(const int32 partitionIndex, const float priority);
+
+	/**
+	 * Removes the partition
+	 * パーティションを取り除きます
+	 * @return		false if the partition was not queued
+	 */
+	bool Remove(const int32 partitionIndex);
+
+	/**
+	 * Get the partition with the smallest priority
+	 * 最も優先度の小さいパーティションを取得します
+	 */
+	int32 Top() const;
+
+	/**
+	 * Removes and returns the partition with the smallest priority
+	 * 最も優先度の小さいパーティションを取り除いて返します
+	 */
+	int32 Pop();
+
+	/**
+	 * Recomputes the priority of every queued partition and rebuilds the heap
+	 * 登録されている全てのパーティションの優先度を計算し直してヒープを再構築します
+	 * @param[in]	function	パーティション番号を受け取り優先度を返す関数
+	 */
+	template<typename Function>
+	void Reprioritize(Function&& function);
+
+	/**
+	 * Get the number of bytes allocated
+	 * 確保しているバイト数を取得します
+	 */
+	SIZE_T GetAllocatedSize() const noexcept;
+
+private:
+	struct FEntry final
+	{
+		int32 PartitionIndex = INDEX_NONE;
+		float Priority = 0.f;
+	};
+
+	void SiftUp(int32 heapIndex);
+	void SiftDown(int32 heapIndex);
+	void Place(const int32 heapIndex, const FEntry& entry);
+
+	// 二分ヒープ
+	TArray<FEntry> mHeap;
+	// パーティション番号ごとのヒープ内の位置（未登録ならINDEX_NONE）
+	TArray<int32> mHeapIndices;
+};
+
+inline void FDungeonPartitionTransitionQueue::Reset(const int32 partitionCount)
+{
+	mHeap.Reset();
+	mHeapIndices.Init(INDEX_NONE, partitionCount);
+}
+
+inline bool FDungeonPartitionTransitionQueue::Contains(const int32 partitionIndex) const noexcept
+{
+	return mHeapIndices.IsValidIndex(partitionIndex) && mHeapIndices[partitionIndex] != INDEX_NONE;
+}
+
+inline int32 FDungeonPartitionTransitionQueue::Num() const noexcept
+{
+	return mHeap.Num();
+}
+
+inline bool FDungeonPartitionTransitionQueue::IsEmpty() const noexcept
+{
+	return mHeap.IsEmpty();
+}
+
+inline void FDungeonPartitionTransitionQueue::Push(const int32 partitionIndex, const float priority)
+{
+	if (!mHeapIndices.IsValidIndex(partitionIndex))
+		return;
+
+	int32 heapIndex = mHeapIndices[partitionIndex];
+	if (heapIndex == INDEX_NONE)
+	{
+		heapIndex = mHeap.Add({ partitionIndex, priority });
+		mHeapIndices[partitionIndex] = heapIndex;
+		SiftUp(heapIndex);
+		return;
+	}
+
+	const float oldPriority = mHeap[heapIndex].Priority;
+	mHeap[heapIndex].Priority = priority;
+	if (priority < oldPriority)
+		SiftUp(heapIndex);
+	else
+		SiftDown(heapIndex);
+}
+
+inline bool FDungeonPartitionTransitionQueue::Remove(const int32 partitionIndex)
+{
+	if (!Contains(partitionIndex))
+		return false;
+
+	const int32 heapIndex = mHeapIndices[partitionIndex];
+	mHeapIndices[partitionIndex] = INDEX_NONE;
+
+#if UE_VERSION_NEWER_THAN(5, 6, 0)
+	const FEntry last = mHeap.Pop(EAllowShrinking::No);
+#else
+	const FEntry last = mHeap.Pop(false);
+#endif
+
+	// 末尾の要素を空いた位置へ移して、ヒープの順序を直します
+	if (heapIndex < mHeap.Num())
+	{
+		const float removedPriority = mHeap[heapIndex].Priority;
+		Place(heapIndex, last);
+		if (last.Priority < removedPriority)
+			SiftUp(heapIndex);
+		else
+			SiftDown(heapIndex);
+	}
+	return true;
+}
+
+inline int32 FDungeonPartitionTransitionQueue::Top() const
+{
+	check(!mHeap.IsEmpty());
+	return mHeap[0].PartitionIndex;
+}
+
+inline int32 FDungeonPartitionTransitionQueue::Pop()
+{
+	const int32 partitionIndex = Top();
+	Remove(partitionIndex);
+	return partitionIndex;
+}
+
+template<typename Function>
+inline void FDungeonPartitionTransitionQueue::Reprioritize(Function&& function)
+{
+	for (FEntry& entry : mHeap)
+		entry.Priority = function(entry.PartitionIndex);
+
+	// 葉ではない要素を後ろから沈めてヒープを再構築します
+	for (int32 heapIndex = mHeap.Num() / 2 - 1; heapIndex >= 0; --heapIndex)
+		SiftDown(heapIndex);
+}
+
+inline SIZE_T FDungeonPartitionTransitionQueue::GetAllocatedSize() const noexcept
+{
+	return mHeap.GetAllocatedSize() + mHeapIndices.GetAllocatedSize();
+}
+
+inline void FDungeonPartitionTransitionQueue::SiftUp(int32 heapIndex)
+{
+	const FEntry entry = mHeap[heapIndex];
+	while (heapIndex > 0)
+	{
+		const int32 parentIndex = (heapIndex - 1) / 2;
+		if (!(entry.Priority < mHeap[parentIndex].Priority))
+			break;
+		Place(heapIndex, mHeap[parentIndex]);
+		heapIndex = parentIndex;
+	}
+	Place(heapIndex, entry);
+}
+
+inline void FDungeonPartitionTransitionQueue::SiftDown(int32 heapIndex)
+{
+	const FEntry entry = mHeap[heapIndex];
+	const int32 count = mHeap.Num();
+	for (;;)
+	{
+		int32 childIndex = heapIndex * 2 + 1;
+		if (childIndex >= count)
+			break;
+		if (childIndex + 1 < count && mHeap[childIndex + 1].Priority < mHeap[childIndex].Priority)
+			++childIndex;
+		if (!(mHeap[childIndex].Priority < entry.Priority))
+			break;
+		Place(heapIndex, mHeap[childIndex]);
+		heapIndex = childIndex;
+	}
+	Place(heapIndex, entry);
+}
+
+inline void FDungeonPartitionTransitionQueue::Place(const int32 heapIndex, const FEntry& entry)
+{
+	mHeap[heapIndex] = entry;
+	mHeapIndices[entry.PartitionIndex] = heapIndex;
+}
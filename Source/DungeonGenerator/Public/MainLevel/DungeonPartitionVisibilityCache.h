@@ -0,0 +1,106 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include "MainLevel/DungeonPartitionVisibilityRow.h"
+#include <Containers/Array.h>
+
+/**
+ * Persists the precomputed partition visibility of ADungeonMainLevelScriptActor on disk.
+ * The file is identified by a key made from the visibility algorithm version, the dungeon CRC32
+ * and the partition settings, and its payload is validated with a CRC32 checksum when loaded.
+ *
+ * ADungeonMainLevelScriptActorの事前計算したパーティション可視性をディスクに保存します。
+ * ファイルは可視性の計算方法のバージョン、ダンジョンのCRC32とパーティション設定から作ったキーで識別され、
+ * 読み込み時にペイロードをCRC32チェックサムで検証します。
+ */
+class DUNGEONGENERATOR_API FDungeonPartitionVisibilityCache final
+{
+public:
+	/**
+	 * Visibility sample point of a partition
+	 * パーティションの可視判定サンプル点
+	 */
+	struct FSample final
+	{
+		int32 ActorIndex = INDEX_NONE;
+		FIntVector GridLocation = FIntVector::ZeroValue;
+		FVector WorldLocation = FVector::ZeroVector;
+
+		friend FArchive& operator<<(FArchive& archive, FSample& sample)
+		{
+			archive << sample.ActorIndex;
+			archive << sample.GridLocation;
+			archive << sample.WorldLocation;
+			return archive;
+		}
+	};
+
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	explicit FDungeonPartitionVisibilityCache(const uint32 key) noexcept;
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonPartitionVisibilityCache() = default;
+
+	/**
+	 * Get the key
+	 * キーを取得します
+	 */
+	uint32 GetKey() const noexcept;
+
+	/**
+	 * Get the path of the cache file for the key
+	 * キーに対応するキャッシュファイルのパスを取得します
+	 */
+	FString GetPath() const;
+
+	/**
+	 * Write to the cache file.
+	 * Old cache files are evicted afterwards so that the directory does not grow without limit.
+	 *
+	 * キャッシュファイルに書き込みます。
+	 * ディレクトリが際限なく大きくならないように、書き込み後に古いキャッシュファイルを削除します。
+	 * @return		true if successful
+	 */
+	bool Save() const;
+
+	/**
+	 * Read from the cache file. Fails if the key, version or checksum does not match.
+	 * キャッシュファイルから読み込みます。キー、バージョン、チェックサムが一致しない場合は失敗します。
+	 * @return		true if successful
+	 */
+	bool Load();
+
+public:
+	// パーティションのセル座標（パーティション番号順）
+	TArray<FIntVector> PartitionCells;
+
+	// パーティションごとの可視判定サンプル点
+	TArray<TArray<FSample>> PartitionSamples;
+
+	// パーティションごとの可視性
+	TArray<FDungeonPartitionVisibilityRow> PotentialVisibilityRows;
+
+private:
+	static FString GetDirectory();
+	static void Evict();
+	void Serialize(FArchive& archive);
+
+	uint32 mKey;
+};
+
+inline uint32 FDungeonPartitionVisibilityCache::GetKey() const noexcept
+{
+	return mKey;
+}
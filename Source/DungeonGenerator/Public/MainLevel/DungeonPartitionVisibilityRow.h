@@ -0,0 +1,206 @@
+/**
+ * @author		Shun Moriya
+ * @copyright	2025- Shun Moriya
+ * All Rights Reserved.
+ */
+
+#pragma once
+#include <CoreMinimal.h>
+#include <Containers/Array.h>
+#include <Algo/BinarySearch.h>
+
+/**
+ * One row of the partition visibility set.
+ * Corridor dungeons produce very sparse rows, so the row is stored either as a sorted
+ * list of partition indices or as dense bit words, whichever is smaller.
+ *
+ * パーティション可視集合の1行です。
+ * 通路の多いダンジョンでは行が非常に疎になるので、パーティション番号のソート済みリストと
+ * ビット列のうち小さい方の形式で保持します。
+ */
+class DUNGEONGENERATOR_API FDungeonPartitionVisibilityRow final
+{
+public:
+	/**
+	 * constructor
+	 * コンストラクタ
+	 */
+	FDungeonPartitionVisibilityRow() = default;
+
+	/**
+	 * destructor
+	 * デストラクタ
+	 */
+	~FDungeonPartitionVisibilityRow() = default;
+
+	/**
+	 * Compresses dense bit words into this row
+	 * ビット列を圧縮して設定します
+	 */
+	void Assign(const TArray<uint64>& words);
+
+	/**
+	 * Removes all partitions
+	 * 全てのパーティションを取り除きます
+	 */
+	void Reset();
+
+	/**
+	 * Is the partition contained?
+	 * パーティションが含まれているか調べます
+	 */
+	bool Contains(const int32 partitionIndex) const noexcept;
+
+	/**
+	 * Number of contained partitions
+	 * 含まれているパーティションの数
+	 */
+	int32 Num() const noexcept;
+
+	/**
+	 * Is the row stored as a sorted index list?
+	 * ソート済みのパーティション番号リストで保持しているか調べます
+	 */
+	bool IsSparse() const noexcept;
+
+	/**
+	 * Calls the function for each contained partition in ascending order
+	 * 含まれているパーティションを昇順に関数に渡します
+	 */
+	template<typename Function>
+	void ForEach(Function&& function) const;
+
+	/**
+	 * ORs the contained partitions into dense bit words
+	 * 含まれているパーティションをビット列に論理和で合成します
+	 */
+	void UnionInto(TArray<uint64>& words) const;
+
+	/**
+	 * Calls the functions for the partitions that leave or enter when switching from one row to another
+	 * 行を切り替えた時に外れるパーティションと加わるパーティションを関数に渡します
+	 * @param[in]	from		切り替え前の行
+	 * @param[in]	to			切り替え後の行
+	 * @param[in]	onRemoved	fromだけに含まれるパーティション番号を受け取る関数
+	 * @param[in]	onAdded		toだけに含まれるパーティション番号を受け取る関数
+	 */
+	template<typename RemovedFunction, typename AddedFunction>
+	static void ForEachDifference(const FDungeonPartitionVisibilityRow& from, const FDungeonPartitionVisibilityRow& to, RemovedFunction&& onRemoved, AddedFunction&& onAdded);
+
+	/**
+	 * Get the number of bytes allocated
+	 * 確保しているバイト数を取得します
+	 */
+	SIZE_T GetAllocatedSize() const noexcept;
+
+	friend FArchive& operator<<(FArchive& archive, FDungeonPartitionVisibilityRow& row);
+
+private:
+	// 疎な場合はパーティション番号のソート済みリスト
+	TArray<int32> mIndices;
+	// 密な場合はビット列
+	TArray<uint64> mWords;
+	int32 mCount = 0;
+	bool mSparse = true;
+};
+
+inline void FDungeonPartitionVisibilityRow::Reset()
+{
+	mIndices.Empty();
+	mWords.Empty();
+	mCount = 0;
+	mSparse = true;
+}
+
+inline bool FDungeonPartitionVisibilityRow::Contains(const int32 partitionIndex) const noexcept
+{
+	if (partitionIndex < 0)
+		return false;
+
+	if (mSparse)
+		return Algo::BinarySearch(mIndices, partitionIndex) != INDEX_NONE;
+
+	const int32 wordIndex = partitionIndex / 64;
+	return mWords.IsValidIndex(wordIndex) && (mWords[wordIndex] & (1ull << (partitionIndex % 64))) != 0;
+}
+
+inline int32 FDungeonPartitionVisibilityRow::Num() const noexcept
+{
+	return mCount;
+}
+
+inline bool FDungeonPartitionVisibilityRow::IsSparse() const noexcept
+{
+	return mSparse;
+}
+
+template<typename Function>
+inline void FDungeonPartitionVisibilityRow::ForEach(Function&& function) const
+{
+	if (mSparse)
+	{
+		for (const int32 partitionIndex : mIndices)
+			function(partitionIndex);
+		return;
+	}
+
+	for (int32 wordIndex = 0; wordIndex < mWords.Num(); ++wordIndex)
+	{
+		for (uint64 word = mWords[wordIndex]; word != 0; word &= word - 1)
+			function(wordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(word)));
+	}
+}
+
+/*
+ * 両方が疎ならソート済みリストを併合し、それ以外はビット列の排他的論理和で差分を求めます
+ */
+template<typename RemovedFunction, typename AddedFunction>
+inline void FDungeonPartitionVisibilityRow::ForEachDifference(const FDungeonPartitionVisibilityRow& from, const FDungeonPartitionVisibilityRow& to, RemovedFunction&& onRemoved, AddedFunction&& onAdded)
+{
+	if (from.mSparse && to.mSparse)
+	{
+		int32 fromIndex = 0;
+		int32 toIndex = 0;
+		while (fromIndex < from.mIndices.Num() || toIndex < to.mIndices.Num())
+		{
+			if (toIndex >= to.mIndices.Num() || (fromIndex < from.mIndices.Num() && from.mIndices[fromIndex] < to.mIndices[toIndex]))
+			{
+				onRemoved(from.mIndices[fromIndex++]);
+			}
+			else if (fromIndex >= from.mIndices.Num() || to.mIndices[toIndex] < from.mIndices[fromIndex])
+			{
+				onAdded(to.mIndices[toIndex++]);
+			}
+			else
+			{
+				++fromIndex;
+				++toIndex;
+			}
+		}
+		return;
+	}
+
+	TArray<uint64> fromWords;
+	TArray<uint64> toWords;
+	from.UnionInto(fromWords);
+	to.UnionInto(toWords);
+	const int32 wordCount = FMath::Max(fromWords.Num(), toWords.Num());
+	fromWords.SetNumZeroed(wordCount);
+	toWords.SetNumZeroed(wordCount);
+	for (int32 wordIndex = 0; wordIndex < wordCount; ++wordIndex)
+	{
+		const uint64 difference = fromWords[wordIndex] ^ toWords[wordIndex];
+		if (difference == 0)
+			continue;
+
+		for (uint64 word = difference & fromWords[wordIndex]; word != 0; word &= word - 1)
+			onRemoved(wordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(word)));
+		for (uint64 word = difference & toWords[wordIndex]; word != 0; word &= word - 1)
+			onAdded(wordIndex * 64 + static_cast<int32>(FMath::CountTrailingZeros64(word)));
+	}
+}
+
+inline SIZE_T FDungeonPartitionVisibilityRow::GetAllocatedSize() const noexcept
+{
+	return mIndices.GetAllocatedSize() + mWords.GetAllocatedSize();
+}
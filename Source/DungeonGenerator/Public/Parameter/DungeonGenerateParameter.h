@@ -20,6 +20,11 @@ class UDungeonRoomSensorDatabase;
 class UDungeonPartsSelector;
 struct FPropertyChangedEvent;
 
+namespace dungeon
+{
+	struct GenerateParameter;
+}
+
 /**
  * Dungeon expansion policy
  * ダンジョンの拡張ポリシー
@@ -247,6 +252,15 @@ private:
 	 */
 	void SetGeneratedRandomSeed(const int32 generatedRandomSeed);
 
+	/**
+	 * Convert to the generation parameters of the core
+	 * コアの生成パラメータに変換します
+	 * @param[out]	generateParameter	変換先の生成パラメータ
+	 * @param[in]	randomSeed			乱数の種
+	 * @param[in]	playerStartCount	レベルに配置されたPlayerStartの数（UseMultiStartで使用）
+	 */
+	void ToGenerateParameter(dungeon::GenerateParameter& generateParameter, const int32 randomSeed, const int32 playerStartCount) const;
+
 #if WITH_EDITOR
 	void DumpToJson() const;
 	FString GetJsonDefaultDirectory() const;
@@ -654,6 +668,8 @@ protected:
 	friend class ADungeonGenerateBase;
 	friend class ADungeonGenerateActor;
 	friend class FDungeonParameterValidator;
+	friend class UDungeonSeedSweepCommandlet;
+	friend class FDungeonAutomationTestWorld;
 };
 
 inline int32 UDungeonGenerateParameter::GetRandomSeed() const
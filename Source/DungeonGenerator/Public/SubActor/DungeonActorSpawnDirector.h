@@ -116,7 +116,19 @@ protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DungeonGenerator")
 	uint8 MaxSpawnedActorsInWorld = 10;
 
+	/**
+	 * Do not spawn actors until the navigation mesh of every DungeonGenerateActor in the world has been built.
+	 * Off by default so that existing spawn timing is unchanged; enable it when AI needs the navigation mesh on spawn.
+	 *
+	 * ワールド内の全てのDungeonGenerateActorのナビゲーションメッシュが構築されるまでアクターをスポーンしません。
+	 * 既存のスポーンのタイミングを変えないように既定では無効です。スポーン直後にAIがナビゲーションメッシュを必要とする場合に有効にして下さい。
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "DungeonGenerator")
+	bool WaitForNavigationReady = false;
+
 private:
+	bool IsNavigationReady() const;
+
 	std::shared_ptr<dungeon::Random> mRandom;
 	std::vector<TWeakObjectPtr<AActor>> mActors;
 	float mElapsedTime = 0.f;
@@ -16,6 +16,7 @@
 
 // forward declaration
 class ADungeonDoorBase;
+class FDungeonAssetPrefetcher;
 class UBoxComponent;
 class UPrimitiveComponent;
 
@@ -338,11 +339,23 @@ private:
 	void InvokeFinalize();
 	void InvokeReset(const bool fallToAbyss);
 	void InvokeResume();
+	void InvokeEnter();
+	void InvokeLeave(const bool fallToAbyss);
+	void DisableOverlapSensor();
 	bool FindFloorHeightPosition(FVector& result, const FVector& startPosition, const FVector& endPosition, const float offsetHeight) const;
 
 	void SpawnActorsInRoomImpl();
 	void SpawnActorInRoomImpl(const FSoftObjectPath& spawnActorPath, const bool force);
 
+	/**
+	 * 部屋の種類とアイテムに応じてスポーンするアクターのパスを収集します
+	 * @param[out]	outPaths		ブループリントのパス
+	 * @param[in]	rooms			HallまたはHanareの部屋があるならtrue
+	 * @param[in]	key				鍵のある部屋があるならtrue
+	 * @param[in]	uniqueKey		ユニークな鍵のある部屋があるならtrue
+	 */
+	void CollectSpawnActorPaths(TArray<FSoftObjectPath>& outPaths, const bool rooms, const bool key, const bool uniqueKey) const;
+
 protected:
 	/**
 	 * Room Bounding Box
@@ -538,7 +551,12 @@ private:
 		Finalized,
 	};
 	State mState = State::Invalid;
+	// 終了するたびに進める番号（読み込み待ちのスポーンが古い部屋の物か判定する）
+	uint32 mSpawnSerial = 0;
+	// スポーンしたジェネレーターの読み込み（読み込みを待ったスポーンを数える）
+	std::weak_ptr<FDungeonAssetPrefetcher> mAssetPrefetcher;
 	bool mEntered = true;
 
 	friend class ADungeonGenerateBase;
+	friend class FDungeonRoomOccupancyTracker;
 };
@@ -63,6 +63,16 @@ public:
 	 */
 	void OnEndGeneration(UDungeonRandom* synchronizedRandom, const UDungeonAisleGridMap* aisleGridMap, const float verticalGridSize, const std::function<void(const FSoftObjectPath&, const FTransform&)>& spawnActor) const;
 
+	/**
+	 * 登録されたRoomSensorのクラスを取得します
+	 */
+	const TArray<TObjectPtr<UClass>>& GetRoomSensorClasses() const noexcept;
+
+	/**
+	 * 通路にスポーンするアクターのパスを取得します
+	 */
+	const TArray<FSoftObjectPath>& GetSpawnActorInAisle() const noexcept;
+
 protected:
 	/**
 	 * Room Sensor Generation Rules
@@ -87,3 +97,13 @@ protected:
 	UPROPERTY(EditAnywhere, Category = "DungeonGenerator|Aisle", meta = (AllowedClasses = "/Script/Engine.Blueprint"))
 	TArray<FSoftObjectPath> SpawnActorInAisle;
 };
+
+inline const TArray<TObjectPtr<UClass>>& UDungeonRoomSensorDatabase::GetRoomSensorClasses() const noexcept
+{
+	return DungeonRoomSensorClass;
+}
+
+inline const TArray<FSoftObjectPath>& UDungeonRoomSensorDatabase::GetSpawnActorInAisle() const noexcept
+{
+	return SpawnActorInAisle;
+}
@@ -180,6 +180,17 @@ TSharedRef<SDockTab> FDungeonGenerateEditorModule::OnSpawnPluginTab(const FSpawn
 					.OnClicked_Raw(this, &FDungeonGenerateEditorModule::OnClickedGenerateButton)
 			];
 
+		dungeonBox->AddSlot()
+			.VAlign(VAlign_Center)
+			.FillHeight(1.f)
+			.Padding(2.f)
+			[
+				SAssignNew(mRegenerateDungeonButton, SButton)
+					.Text(LOCTEXT("RegenerateDungeonButton", "Regenerate changed grids"))
+					.ToolTipText(LOCTEXT("RegenerateDungeonButtonToolTip", "Regenerate the dungeon and keep terrain meshes of grids that did not change"))
+					.OnClicked_Raw(this, &FDungeonGenerateEditorModule::OnClickedRegenerateButton)
+			];
+
 		dungeonBox->AddSlot()
 			.VAlign(VAlign_Center)
 			.FillHeight(1.f)
@@ -327,6 +338,7 @@ void FDungeonGenerateEditorModule::UpdateGenerateButtonEnabled() const
 {
 	const bool enabled = mDungeonGenerateParameter.IsValid() && !HasValidationErrors();
 	mGenerateDungeonButton->SetEnabled(enabled);
+	mRegenerateDungeonButton->SetEnabled(enabled);
 }
 
 void FDungeonGenerateEditorModule::RunValidation(const bool bDeepCheck)
@@ -510,6 +522,44 @@ FReply FDungeonGenerateEditorModule::OnClickedGenerateButton()
 	return FReply::Handled();
 }
 
+/*
+ * 生成済みのダンジョンアクターを再利用し、変化しなかったグリッドの地形メッシュを残して再生成します。
+ * 生成済みのダンジョンが無ければ通常の生成を行います。
+ */
+FReply FDungeonGenerateEditorModule::OnClickedRegenerateButton()
+{
+	ADungeonGeneratedActor* dungeonActor = mDungeonActor.Get();
+	if (!IsValid(dungeonActor) || !dungeonActor->IsGenerated())
+		return OnClickedGenerateButton();
+
+	RunValidation(false);
+	if (HasValidationErrors())
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("ValidationFailed", "Generation aborted. Resolve validation errors first."));
+		return FReply::Unhandled();
+	}
+
+	const UDungeonGenerateParameter* dungeonGenerateParameter = mDungeonGenerateParameter.Get();
+	if (dungeonGenerateParameter == nullptr)
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("Message", "Set the DungeonGenerateParameter"));
+		return FReply::Unhandled();
+	}
+
+	if (!dungeonActor->RegenerateIncrementally(dungeonGenerateParameter))
+	{
+		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("Message", "Failed to generate dungeon"));
+		OnClickedClearButton();
+		return FReply::Unhandled();
+	}
+
+	// Set random seeds for generated dungeons
+	const int32 value = dungeonGenerateParameter->GetGeneratedRandomSeed();
+	mRandomSeedValue->SetText(FText::FromString(FString::FromInt(value)));
+
+	return FReply::Handled();
+}
+
 FReply FDungeonGenerateEditorModule::OnClickedClearButton()
 {
 	DisposeDungeon(GetWorldFromGameViewport(), false);
@@ -54,6 +54,7 @@ private:
 	FString FormatIssuesForClipboard() const;
 
 	FReply OnClickedGenerateButton();
+	FReply OnClickedRegenerateButton();
 	FReply OnClickedClearButton();
 
 	void DisposeDungeon(UWorld* world, const bool flushLevelStreaming);
@@ -67,6 +68,7 @@ private:
 	TSharedPtr<FUICommandList> PluginCommands;
 	TSharedPtr<SEditableTextBox> mRandomSeedValue;
 	TSharedPtr<SButton> mGenerateDungeonButton;
+	TSharedPtr<SButton> mRegenerateDungeonButton;
 	TSharedPtr<SButton> mVerifyButton;
 	TSharedPtr<SButton> mCopyDiagnosticsButton;
 	TSharedPtr<SListView<TSharedPtr<FDungeonValidationIssue>>> mValidationListView;